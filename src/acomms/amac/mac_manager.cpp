@@ -22,6 +22,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -58,6 +59,7 @@ void goby::acomms::MACManager::startup(const protobuf::MACConfig& cfg)
     {
         case protobuf::MAC_POLLED:
         case protobuf::MAC_FIXED_DECENTRALIZED:
+        case protobuf::MAC_ADAPTIVE_DECENTRALIZED:
             std::list<protobuf::ModemTransmission>::clear();
             for (int i = 0, n = cfg_.slot_size(); i < n; ++i)
             {
@@ -74,6 +76,16 @@ void goby::acomms::MACManager::startup(const protobuf::MACConfig& cfg)
                 glog.is(DEBUG1) && glog << group(glog_mac_group_)
                                         << "Using the Decentralized MAC_FIXED_DECENTRALIZED scheme"
                                         << std::endl;
+            else if (cfg_.type() == protobuf::MAC_ADAPTIVE_DECENTRALIZED)
+                glog.is(DEBUG1) && glog << group(glog_mac_group_)
+                                        << "Using the Decentralized MAC_ADAPTIVE_DECENTRALIZED "
+                                           "scheme, coordinated by modem id: "
+                                        << adaptive_coordinator() << std::endl;
+
+            adaptive_demand_.clear();
+            adaptive_allocation_.clear();
+            // listen for an allocation before transmitting
+            adaptive_quiet_cycles_ = 0;
             break;
 
         default: return;
@@ -131,7 +143,7 @@ void goby::acomms::MACManager::begin_slot()
         return;
     }
 
-    protobuf::ModemTransmission s = *current_slot_;
+    protobuf::ModemTransmission s = adaptive() ? adaptive_cycle_[adaptive_slot_] : *current_slot_;
     s.set_time_with_units(time::convert<time::MicroTime>(next_slot_t_));
 
     bool we_are_transmitting = true;
@@ -142,6 +154,27 @@ void goby::acomms::MACManager::begin_slot()
             we_are_transmitting = (s.src() == cfg_.modem_id()) || s.always_initiate();
             break;
 
+        case protobuf::MAC_ADAPTIVE_DECENTRALIZED:
+            we_are_transmitting =
+                !adaptive_quiet_ && ((s.src() == cfg_.modem_id()) || s.always_initiate());
+            if (we_are_transmitting)
+            {
+                auto& status = *s.MutableExtension(protobuf::adaptive_mac);
+                status.set_queue_depth(adaptive_queue_depth());
+
+                // the allocation for the next cycle is made the first time the coordinator transmits in this one
+                if (cfg_.modem_id() == adaptive_coordinator())
+                {
+                    auto next_cycle = adaptive_cycle_number_ + 1;
+                    if (!adaptive_allocation_.count(next_cycle))
+                        adaptive_allocation_[next_cycle] = adaptive_allocate();
+                    status.set_cycle(next_cycle);
+                    for (auto index : adaptive_allocation_[next_cycle])
+                        status.add_slot_index(index);
+                }
+            }
+            break;
+
         case protobuf::MAC_POLLED:
             // we always transmit (poll)
             // but be quiet in the case where src = 0
@@ -155,15 +188,11 @@ void goby::acomms::MACManager::begin_slot()
     {
         glog << group(glog_mac_group_) << "Cycle order: [";
 
-        for (std::list<protobuf::ModemTransmission>::iterator
-                 it = std::list<protobuf::ModemTransmission>::begin(),
-                 n = end();
-             it != n; ++it)
-        {
-            if (it == current_slot_)
-                glog << group(glog_mac_group_) << " " << green;
+        auto print_slot = [](const protobuf::ModemTransmission& slot, bool current) {
+            if (current)
+                glog << " " << green;
 
-            switch (it->type())
+            switch (slot.type())
             {
                 case protobuf::ModemTransmission::DATA: glog << "d"; break;
                 case protobuf::ModemTransmission::DRIVER_SPECIFIC: glog << "s"; break;
@@ -171,7 +200,21 @@ void goby::acomms::MACManager::begin_slot()
                 default: break;
             }
 
-            glog << it->src() << "/" << it->dest() << "@" << it->rate() << " " << nocolor;
+            glog << slot.src() << "/" << slot.dest() << "@" << slot.rate() << " " << nocolor;
+        };
+
+        if (adaptive())
+        {
+            for (decltype(adaptive_slot_) i = 0, n = adaptive_cycle_.size(); i < n; ++i)
+                print_slot(adaptive_cycle_[i], i == adaptive_slot_);
+        }
+        else
+        {
+            for (std::list<protobuf::ModemTransmission>::iterator
+                     it = std::list<protobuf::ModemTransmission>::begin(),
+                     n = end();
+                 it != n; ++it)
+                print_slot(*it, it == current_slot_);
         }
         glog << " ]" << std::endl;
     }
@@ -203,6 +246,17 @@ void goby::acomms::MACManager::increment_slot()
                 current_slot_ = std::list<protobuf::ModemTransmission>::begin();
             break;
 
+        case protobuf::MAC_ADAPTIVE_DECENTRALIZED:
+            next_slot_t_ += time::convert_duration<std::chrono::microseconds>(
+                adaptive_cycle_[adaptive_slot_].slot_seconds_with_units());
+
+            if (++adaptive_slot_ == adaptive_cycle_.size())
+            {
+                ++adaptive_cycle_number_;
+                adaptive_begin_cycle();
+            }
+            break;
+
         default: break;
     }
 }
@@ -270,6 +324,13 @@ void goby::acomms::MACManager::update()
                             << "The next MAC TDMA cycle begins at time: " << next_slot_t_
                             << std::endl;
 
+    // the allocation of the current cycle is unknown, so adaptive cycles always start at the beginning
+    if (adaptive())
+    {
+        adaptive_cycle_number_ = cycles_since_reference_;
+        adaptive_begin_cycle();
+    }
+
     // if we can start cycles in the middle, do it
     if (cfg_.start_cycle_in_middle() && std::list<protobuf::ModemTransmission>::size() > 1 &&
         (cfg_.type() == protobuf::MAC_FIXED_DECENTRALIZED || cfg_.type() == protobuf::MAC_POLLED))
@@ -292,12 +353,200 @@ void goby::acomms::MACManager::update()
 
 goby::time::SystemClock::duration goby::acomms::MACManager::cycle_duration()
 {
+    if (adaptive() && cfg_.adaptive().has_cycle_seconds())
+        return time::convert_duration<goby::time::SystemClock::duration>(
+            cfg_.adaptive().cycle_seconds_with_units());
+
     time::MicroTime length = 0;
     for (const protobuf::ModemTransmission& slot : *this)
         length += slot.slot_seconds_with_units<time::MicroTime>();
+
+    // leave room for slots to be repeated for nodes with a backlog
+    if (adaptive())
+        length *= 2;
+
     return time::convert_duration<goby::time::SystemClock::duration>(length);
 }
 
+void goby::acomms::MACManager::handle_modem_receive(const protobuf::ModemTransmission& m)
+{
+    if (!adaptive() || !m.HasExtension(protobuf::adaptive_mac))
+        return;
+
+    const auto& status = m.GetExtension(protobuf::adaptive_mac);
+    if (status.has_queue_depth())
+        adaptive_demand_[m.src()] = status.queue_depth();
+
+    // only the coordinator allocates, and only future cycles can be changed
+    if (m.src() == adaptive_coordinator() && m.src() != cfg_.modem_id() && status.has_cycle() &&
+        status.cycle() > adaptive_cycle_number_)
+    {
+        adaptive_allocation_[status.cycle()] =
+            std::vector<std::uint32_t>(status.slot_index().begin(), status.slot_index().end());
+
+        glog.is(DEBUG2) && glog << group(glog_mac_group_) << "Received allocation for cycle "
+                                << status.cycle() << " from coordinator" << std::endl;
+    }
+}
+
+int goby::acomms::MACManager::adaptive_coordinator() const
+{
+    if (cfg_.adaptive().has_coordinator_id())
+        return cfg_.adaptive().coordinator_id();
+    else if (cfg_.slot_size() > 0)
+        return cfg_.slot(0).src();
+    else
+        return BROADCAST_ID;
+}
+
+std::uint32_t goby::acomms::MACManager::adaptive_queue_depth()
+{
+    std::uint32_t queue_depth = 0;
+    signal_queue_depth_request(&queue_depth);
+    adaptive_demand_[cfg_.modem_id()] = queue_depth;
+    return queue_depth;
+}
+
+std::vector<std::uint32_t> goby::acomms::MACManager::adaptive_allocate()
+{
+    const std::vector<protobuf::ModemTransmission> slots(
+        std::list<protobuf::ModemTransmission>::begin(), end());
+    const auto& adaptive_cfg = cfg_.adaptive();
+
+    adaptive_queue_depth();
+    std::vector<std::uint32_t> demand(slots.size(), 0);
+    for (decltype(demand.size()) i = 0, n = slots.size(); i < n; ++i)
+    {
+        auto it = adaptive_demand_.find(slots[i].src());
+        // slots that don't belong to a single node (e.g. always_initiate) don't grow
+        if (it != adaptive_demand_.end() && !slots[i].always_initiate())
+            demand[i] = it->second;
+    }
+
+    auto slot_duration = [&](std::size_t i) {
+        return time::convert_duration<std::chrono::microseconds>(
+            slots[i].slot_seconds_with_units());
+    };
+
+    std::vector<unsigned> repeats(slots.size(), adaptive_cfg.min_slots());
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(cycle_duration());
+    for (decltype(slots.size()) i = 0, n = slots.size(); i < n; ++i)
+        remaining -= repeats[i] * slot_duration(i);
+
+    // hand out the remaining time one slot at a time, each to the slot with the highest demand per repeat (ties go to the earliest slot)
+    for (;;)
+    {
+        int best = -1;
+        for (int i = 0, n = slots.size(); i < n; ++i)
+        {
+            if (demand[i] == 0 || slot_duration(i) > remaining ||
+                (adaptive_cfg.max_slots() > 0 && repeats[i] >= adaptive_cfg.max_slots()))
+                continue;
+
+            if (best < 0 || static_cast<std::uint64_t>(demand[i]) * (repeats[best] + 1) >
+                                static_cast<std::uint64_t>(demand[best]) * (repeats[i] + 1))
+                best = i;
+        }
+        if (best < 0)
+            break;
+        ++repeats[best];
+        remaining -= slot_duration(best);
+    }
+
+    std::vector<std::uint32_t> order(slots.size());
+    for (decltype(order.size()) i = 0, n = order.size(); i < n; ++i) order[i] = i;
+    if (adaptive_cfg.reorder())
+        std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return demand[a] > demand[b];
+        });
+
+    std::vector<std::uint32_t> allocation;
+    for (auto i : order) allocation.insert(allocation.end(), repeats[i], i);
+    return allocation;
+}
+
+void goby::acomms::MACManager::adaptive_begin_cycle()
+{
+    adaptive_slot_ = 0;
+
+    const std::vector<protobuf::ModemTransmission> slots(
+        std::list<protobuf::ModemTransmission>::begin(), end());
+
+    // the coordinator only lacks an allocation after a restart or a skipped cycle
+    if (cfg_.modem_id() == adaptive_coordinator() &&
+        !adaptive_allocation_.count(adaptive_cycle_number_))
+        adaptive_allocation_[adaptive_cycle_number_] = adaptive_allocate();
+
+    std::vector<std::uint32_t> allocation;
+    auto it = adaptive_allocation_.find(adaptive_cycle_number_);
+    if (it != adaptive_allocation_.end() &&
+        std::all_of(it->second.begin(), it->second.end(),
+                    [&](std::uint32_t i) { return i < slots.size(); }))
+    {
+        allocation = it->second;
+        adaptive_quiet_cycles_ = 0;
+        adaptive_quiet_ = false;
+    }
+    else
+    {
+        for (decltype(slots.size()) i = 0, n = slots.size(); i < n; ++i) allocation.push_back(i);
+
+        // without the coordinator's allocation, transmitting might collide with the nodes that have it
+        adaptive_quiet_ = (++adaptive_quiet_cycles_ <= cfg_.adaptive().max_quiet_cycles());
+        glog.is(DEBUG1) && glog << group(glog_mac_group_) << warn << "No allocation for cycle "
+                                << adaptive_cycle_number_ << ", "
+                                << (adaptive_quiet_ ? "staying quiet"
+                                                    : "falling back to the configured slots")
+                                << std::endl;
+    }
+
+    // keep only the allocation for the next cycle
+    for (auto a_it = adaptive_allocation_.begin(); a_it != adaptive_allocation_.end();)
+    {
+        if (a_it->first != adaptive_cycle_number_ + 1)
+            a_it = adaptive_allocation_.erase(a_it);
+        else
+            ++a_it;
+    }
+
+    adaptive_cycle_.clear();
+    time::MicroTime length = 0;
+    for (auto i : allocation)
+    {
+        adaptive_cycle_.push_back(slots[i]);
+        length += slots[i].slot_seconds_with_units<time::MicroTime>();
+    }
+
+    if (adaptive_cycle_.empty())
+        return;
+
+    // time not wanted by any node (e.g. no demand, or max_slots reached) is shared equally: the configured slots are repeated in order while they fit. Every node does the same, so this needn't be part of the coordinator's allocation.
+    auto spare = time::convert_duration<time::MicroTime>(cycle_duration()) - length;
+    for (bool added = true; added;)
+    {
+        added = false;
+        for (const auto& slot : slots)
+        {
+            auto slot_length = slot.slot_seconds_with_units<time::MicroTime>();
+            if (slot_length.value() > 0 && slot_length <= spare)
+            {
+                adaptive_cycle_.push_back(slot);
+                spare -= slot_length;
+                added = true;
+            }
+        }
+    }
+
+    // stretch the last slot by what remains (less than any one slot) to keep the cycle length (and therefore the cycle boundaries) fixed
+    if (spare.value() > 0)
+        adaptive_cycle_.back().set_slot_seconds_with_units(
+            adaptive_cycle_.back().slot_seconds_with_units<time::MicroTime>() + spare);
+    else if (spare.value() < 0)
+        glog.is(WARN) && glog << group(glog_mac_group_)
+                              << "Adaptive cycle is longer than cycle_seconds: check min_slots"
+                              << std::endl;
+}
+
 std::ostream& goby::acomms::operator<<(std::ostream& os, const MACManager& mac)
 {
     for (std::list<protobuf::ModemTransmission>::const_iterator it = mac.begin(), n = mac.end();
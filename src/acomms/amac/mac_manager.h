@@ -25,6 +25,10 @@
 #ifndef MAC20091019H
 #define MAC20091019H
 
+#include <cstdint>
+#include <map>
+#include <vector>
+
 #include "goby/acomms/modem_driver.h"
 #include "goby/acomms/protobuf/amac.pb.h"
 #include "goby/acomms/protobuf/amac_config.pb.h"
@@ -75,6 +79,9 @@ class MACManager : public std::list<protobuf::ModemTransmission>
 
     bool running() { return started_up_; }
 
+    /// \brief Reads the demand (and, from the coordinator, the cycle allocation) piggybacked on received transmissions when using MAC_ADAPTIVE_DECENTRALIZED. Typically connected to ModemDriverBase::signal_receive using bind().
+    void handle_modem_receive(const protobuf::ModemTransmission& m);
+
     //@}
 
     /// \name Modem Signals
@@ -91,6 +98,11 @@ class MACManager : public std::list<protobuf::ModemTransmission>
 
     boost::signals2::signal<void(const protobuf::ModemTransmission& m)> signal_slot_start;
 
+    /// \brief Signals a request for the number of bytes queued for transmission at this node (MAC_ADAPTIVE_DECENTRALIZED only). This is advertised to the other nodes and used to allocate the following cycles.
+    ///
+    /// "queue_depth": pointer to the value to set (defaults to 0)
+    boost::signals2::signal<void(std::uint32_t* queue_depth)> signal_queue_depth_request;
+
     /// \example acomms/amac/amac_simple/amac_simple.cpp
 
     unsigned cycle_count() { return std::list<protobuf::ModemTransmission>::size(); }
@@ -110,6 +122,15 @@ class MACManager : public std::list<protobuf::ModemTransmission>
     unsigned cycle_sum();
     void position_blank();
 
+    // MAC_ADAPTIVE_DECENTRALIZED
+    bool adaptive() const { return cfg_.type() == protobuf::MAC_ADAPTIVE_DECENTRALIZED; }
+    int adaptive_coordinator() const;
+    std::uint32_t adaptive_queue_depth();
+    // slot indices for the next cycle, from the current demand
+    std::vector<std::uint32_t> adaptive_allocate();
+    // sets up adaptive_cycle_ for adaptive_cycle_number_
+    void adaptive_begin_cycle();
+
     // allowed offset from actual end of slot
 
     const time::SystemClock::duration allowed_skew_{std::chrono::seconds(2)};
@@ -129,6 +150,17 @@ class MACManager : public std::list<protobuf::ModemTransmission>
 
     unsigned cycles_since_reference_;
 
+    // MAC_ADAPTIVE_DECENTRALIZED: the list holds the configured slots, and each cycle is built from these
+    std::vector<protobuf::ModemTransmission> adaptive_cycle_;
+    std::vector<protobuf::ModemTransmission>::size_type adaptive_slot_{0};
+    std::uint64_t adaptive_cycle_number_{0};
+    // modem id -> last advertised queue depth
+    std::map<int, std::uint32_t> adaptive_demand_;
+    // cycle number -> slot indices, as allocated by the coordinator
+    std::map<std::uint64_t, std::vector<std::uint32_t>> adaptive_allocation_;
+    unsigned adaptive_quiet_cycles_{0};
+    bool adaptive_quiet_{false};
+
     bool started_up_;
 
     std::string glog_mac_group_;
@@ -56,6 +56,7 @@ inline void bind(MACManager& mac, ModemDriverBase& driver)
 {
     goby::acomms::connect(&mac.signal_initiate_transmission, &driver,
                           &ModemDriverBase::handle_initiate_transmission);
+    goby::acomms::connect(&driver.signal_receive, &mac, &MACManager::handle_modem_receive);
 }
 
 /// creates bindings for a RouteManager to control a particular queue (QueueManager)
@@ -89,6 +90,7 @@ inline void unbind(MACManager& mac, ModemDriverBase& driver)
 {
     goby::acomms::disconnect(&mac.signal_initiate_transmission, &driver,
                              &ModemDriverBase::handle_initiate_transmission);
+    goby::acomms::disconnect(&driver.signal_receive, &mac, &MACManager::handle_modem_receive);
 }
 
 /// creates unbindings for a RouteManager to control a particular queue (QueueManager)
@@ -238,6 +238,14 @@ template <typename T, typename Clock = goby::time::SteadyClock> class DynamicSub
     /// \brief Retrieves the size of the queue
     size_type size() const { return data_.size(); }
 
+    /// \brief Retrieves the number of bytes of data in the queue
+    size_type bytes() const
+    {
+        size_type bytes = 0;
+        for (const auto& datum : data_) bytes += data_size(datum.second.data);
+        return bytes;
+    }
+
     /// \brief Pop the value on the top of the queue
     void pop() { data_.pop_front(); }
 
@@ -475,6 +483,17 @@ template <typename T, typename Clock = goby::time::SteadyClock> class DynamicBuf
         return size;
     }
 
+    /// \brief Number of bytes of data in the buffer (that is, sum of the subbuffer bytes)
+    size_type bytes() const
+    {
+        size_type bytes = 0;
+        for (const auto& sub_id_p : sub_)
+        {
+            for (const auto& sub_p : sub_id_p.second) bytes += sub_p.second.bytes();
+        }
+        return bytes;
+    }
+
     /// \brief Returns the top value in a priority contest between all subbuffers
     ///
     /// \param dest_id Modem id for this packet (can be QUERY_DESTINATION_ID to query all possible destinations)
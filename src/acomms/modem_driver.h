@@ -44,10 +44,16 @@
 // Iridium shore-side RUDICS/SBD driver
 #include "goby/acomms/modemdriver/iridium_shore_driver.h"
 
+// Iridium shore-side RUDICS/SBD driver for large fleets (connections serviced by a thread pool)
+#include "goby/acomms/modemdriver/iridium_shore_sharded_driver.h"
+
 // User Datagram Protocol (UDP) driver (point-to-point only)
 #include "goby/acomms/modemdriver/udp_driver.h"
 
 // UDP Multicast driver
 #include "goby/acomms/modemdriver/udp_multicast_driver.h"
 
+// Simulated acoustic modem (discrete-event channel model)
+#include "goby/acomms/modemdriver/acoustic_sim_driver.h"
+
 #endif
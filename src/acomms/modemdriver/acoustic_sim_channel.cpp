@@ -0,0 +1,258 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+
+#include "goby/exception.h"
+#include "goby/util/debug_logger.h"
+
+#include "acoustic_sim_channel.h"
+
+using goby::glog;
+using namespace goby::util::logger;
+
+goby::acomms::AcousticChannelSimulator::AcousticChannelSimulator(
+    const acoustic_sim::protobuf::ChannelConfig& cfg)
+    : cfg_(cfg), rng_(cfg.seed())
+{
+}
+
+std::shared_ptr<goby::acomms::AcousticChannelSimulator>
+goby::acomms::AcousticChannelSimulator::channel(const std::string& name,
+                                                const acoustic_sim::protobuf::ChannelConfig& cfg)
+{
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<AcousticChannelSimulator>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto channel = registry[name].lock();
+    if (!channel)
+    {
+        channel = std::make_shared<AcousticChannelSimulator>(cfg);
+        registry[name] = channel;
+    }
+    return channel;
+}
+
+void goby::acomms::AcousticChannelSimulator::add_node(int modem_id, const Position& position)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (nodes_.count(modem_id))
+        glog.is(WARN) && glog << "Modem id " << modem_id
+                              << " is already on the simulated channel: replacing it" << std::endl;
+    nodes_[modem_id] = Node();
+    nodes_[modem_id].position = position;
+}
+
+void goby::acomms::AcousticChannelSimulator::remove_node(int modem_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes_.erase(modem_id);
+}
+
+void goby::acomms::AcousticChannelSimulator::set_position(int modem_id, const Position& position)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    node(modem_id).position = position;
+}
+
+void goby::acomms::AcousticChannelSimulator::transmit(int modem_id, const std::string& bytes,
+                                                      Clock::time_point start,
+                                                      Clock::duration duration)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Node& tx_node = node(modem_id);
+    const Clock::time_point end = start + duration;
+    ++stats_.transmissions;
+
+    auto overlaps = [](Clock::time_point a_start, Clock::time_point a_end,
+                       Clock::time_point b_start, Clock::time_point b_end) {
+        return a_start < b_end && b_start < a_end;
+    };
+
+    if (cfg_.half_duplex())
+    {
+        // we cannot hear anything arriving while we transmit
+        for (auto& rx_pair : tx_node.pending)
+        {
+            Reception& rx = rx_pair.second;
+            if (rx.status == Reception::Status::OK && overlaps(rx.rx_start, rx.rx_end, start, end))
+                rx.status = Reception::Status::HALF_DUPLEX;
+        }
+    }
+
+    // no reception can begin before this transmission does
+    auto& transmitting = tx_node.transmitting;
+    transmitting.erase(std::remove_if(transmitting.begin(), transmitting.end(),
+                                      [&](const std::pair<Clock::time_point, Clock::time_point>& tx) {
+                                          return tx.second < start;
+                                      }),
+                       transmitting.end());
+    transmitting.push_back(std::make_pair(start, end));
+
+    const double bits = bytes.size() * 8.0;
+    for (auto& rx_node_pair : nodes_)
+    {
+        Node& rx_node = rx_node_pair.second;
+        if (&rx_node == &tx_node)
+            continue;
+
+        const double distance = range(tx_node, rx_node);
+        if (distance > cfg_.max_range())
+        {
+            ++stats_.out_of_range;
+            continue;
+        }
+
+        const auto delay =
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                distance / cfg_.sound_speed()));
+
+        Reception rx;
+        rx.src = modem_id;
+        rx.bytes = bytes;
+        rx.tx_start = start;
+        rx.rx_start = start + delay;
+        rx.rx_end = end + delay;
+
+        if (cfg_.packet_loss_probability() > 0 && uniform_(rng_) < cfg_.packet_loss_probability())
+            rx.status = Reception::Status::LOST;
+        else if (cfg_.bit_error_rate() > 0 &&
+                 uniform_(rng_) >= std::pow(1 - cfg_.bit_error_rate(), bits))
+            rx.status = Reception::Status::BIT_ERROR;
+
+        if (cfg_.half_duplex() && rx.status == Reception::Status::OK)
+        {
+            for (const auto& tx : rx_node.transmitting)
+            {
+                if (overlaps(rx.rx_start, rx.rx_end, tx.first, tx.second))
+                {
+                    rx.status = Reception::Status::HALF_DUPLEX;
+                    break;
+                }
+            }
+        }
+
+        if (cfg_.collisions())
+        {
+            for (auto& other_pair : rx_node.pending)
+            {
+                Reception& other = other_pair.second;
+                if (overlaps(rx.rx_start, rx.rx_end, other.rx_start, other.rx_end))
+                {
+                    if (other.status == Reception::Status::OK)
+                        other.status = Reception::Status::COLLISION;
+                    if (rx.status == Reception::Status::OK)
+                        rx.status = Reception::Status::COLLISION;
+                }
+            }
+        }
+
+        rx_node.pending.insert(std::make_pair(rx.rx_end, rx));
+    }
+}
+
+std::vector<goby::acomms::AcousticChannelSimulator::Reception>
+goby::acomms::AcousticChannelSimulator::receive(int modem_id, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Reception> received;
+    auto& pending = node(modem_id).pending;
+    auto end_it = pending.upper_bound(now);
+    for (auto it = pending.begin(); it != end_it; ++it)
+    {
+        Reception& rx = it->second;
+        switch (rx.status)
+        {
+            case Reception::Status::OK:
+                ++stats_.received;
+                received.push_back(std::move(rx));
+                break;
+            case Reception::Status::LOST: ++stats_.lost; break;
+            case Reception::Status::BIT_ERROR: ++stats_.bit_errors; break;
+            case Reception::Status::COLLISION: ++stats_.collisions; break;
+            case Reception::Status::HALF_DUPLEX: ++stats_.half_duplex; break;
+        }
+    }
+    pending.erase(pending.begin(), end_it);
+    return received;
+}
+
+goby::acomms::AcousticChannelSimulator::Clock::time_point
+goby::acomms::AcousticChannelSimulator::next_event_time() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto next = Clock::time_point::max();
+    for (const auto& node_pair : nodes_)
+    {
+        if (!node_pair.second.pending.empty())
+            next = std::min(next, node_pair.second.pending.begin()->first);
+    }
+    return next;
+}
+
+goby::acomms::AcousticChannelSimulator::Clock::duration
+goby::acomms::AcousticChannelSimulator::propagation_delay(int modem_id_a, int modem_id_b) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+        range(node(modem_id_a), node(modem_id_b)) / cfg_.sound_speed()));
+}
+
+goby::acomms::AcousticChannelSimulator::Statistics
+goby::acomms::AcousticChannelSimulator::statistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+double goby::acomms::AcousticChannelSimulator::range(const Node& a, const Node& b) const
+{
+    const double dx = a.position.x - b.position.x;
+    const double dy = a.position.y - b.position.y;
+    const double dz = a.position.z - b.position.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+goby::acomms::AcousticChannelSimulator::Node&
+goby::acomms::AcousticChannelSimulator::node(int modem_id)
+{
+    auto it = nodes_.find(modem_id);
+    if (it == nodes_.end())
+        throw(goby::Exception("Modem id " + std::to_string(modem_id) +
+                              " is not on the simulated acoustic channel"));
+    return it->second;
+}
+
+const goby::acomms::AcousticChannelSimulator::Node&
+goby::acomms::AcousticChannelSimulator::node(int modem_id) const
+{
+    auto it = nodes_.find(modem_id);
+    if (it == nodes_.end())
+        throw(goby::Exception("Modem id " + std::to_string(modem_id) +
+                              " is not on the simulated acoustic channel"));
+    return it->second;
+}
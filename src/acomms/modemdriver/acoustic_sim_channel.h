@@ -0,0 +1,141 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef AcousticSimChannel20201019H
+#define AcousticSimChannel20201019H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "goby/acomms/protobuf/acoustic_sim_driver.pb.h"
+#include "goby/time/system_clock.h"
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Discrete-event model of a shared underwater acoustic channel (used by AcousticSimDriver)
+///
+/// Each transmission is scheduled as a reception event at every node within range, delayed by the propagation time (range / sound speed). A reception is released to its node once the time passed to receive() reaches the end of the packet, unless it was lost to random loss, bit errors, a collision with another arrival at that node, or the node transmitting at the same time (half-duplex).
+///
+/// Times are passed in by the caller, normally from goby::time::SystemClock, which runs faster than real time when goby::time::SimulatorSettings::warp_factor is set. This class is thread-safe so drivers on different threads can share a channel.
+class AcousticChannelSimulator
+{
+  public:
+    using Clock = goby::time::SystemClock;
+
+    struct Position
+    {
+        double x{0};
+        double y{0};
+        double z{0};
+    };
+
+    struct Reception
+    {
+        enum class Status
+        {
+            OK,
+            LOST,
+            BIT_ERROR,
+            COLLISION,
+            HALF_DUPLEX
+        };
+
+        int src;
+        std::string bytes;
+        Clock::time_point tx_start;
+        Clock::time_point rx_start;
+        Clock::time_point rx_end;
+        Status status{Status::OK};
+    };
+
+    /// \brief Counts of each outcome. Receptions are counted once their end time has passed.
+    struct Statistics
+    {
+        std::uint64_t transmissions{0};
+        std::uint64_t received{0};
+        std::uint64_t out_of_range{0};
+        std::uint64_t lost{0};
+        std::uint64_t bit_errors{0};
+        std::uint64_t collisions{0};
+        std::uint64_t half_duplex{0};
+    };
+
+    AcousticChannelSimulator(const acoustic_sim::protobuf::ChannelConfig& cfg);
+
+    /// \brief Returns the channel with the given name, creating it with cfg if it does not exist (i.e. no driver holds it)
+    static std::shared_ptr<AcousticChannelSimulator>
+    channel(const std::string& name, const acoustic_sim::protobuf::ChannelConfig& cfg);
+
+    void add_node(int modem_id, const Position& position);
+    void remove_node(int modem_id);
+    void set_position(int modem_id, const Position& position);
+
+    /// \brief Transmit bytes from modem_id, occupying the channel from start for duration
+    void transmit(int modem_id, const std::string& bytes, Clock::time_point start,
+                  Clock::duration duration);
+
+    /// \brief Removes the receptions at modem_id that end by now and returns those received successfully, in order of arrival
+    std::vector<Reception> receive(int modem_id, Clock::time_point now);
+
+    /// \brief End time of the earliest pending reception at any node (Clock::time_point::max() if none)
+    Clock::time_point next_event_time() const;
+
+    /// \brief Propagation delay between two nodes
+    Clock::duration propagation_delay(int modem_id_a, int modem_id_b) const;
+
+    Statistics statistics() const;
+
+    const acoustic_sim::protobuf::ChannelConfig& cfg() const { return cfg_; }
+
+  private:
+    struct Node
+    {
+        Position position;
+        // keyed on end of reception
+        std::multimap<Clock::time_point, Reception> pending;
+        // recent transmissions (start, end)
+        std::vector<std::pair<Clock::time_point, Clock::time_point>> transmitting;
+    };
+
+    double range(const Node& a, const Node& b) const;
+    Node& node(int modem_id);
+    const Node& node(int modem_id) const;
+
+  private:
+    const acoustic_sim::protobuf::ChannelConfig cfg_;
+    mutable std::mutex mutex_;
+    std::map<int, Node> nodes_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> uniform_{0, 1};
+    Statistics stats_;
+};
+} // namespace acomms
+} // namespace goby
+#endif
@@ -0,0 +1,187 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "goby/acomms/acomms_constants.h"
+#include "goby/util/binary.h"
+#include "goby/util/debug_logger.h"
+#include "goby/util/protobuf/io.h"
+
+#include "acoustic_sim_driver.h"
+
+using goby::glog;
+using namespace goby::util::logger;
+
+goby::acomms::AcousticSimDriver::AcousticSimDriver() {}
+goby::acomms::AcousticSimDriver::~AcousticSimDriver() { shutdown(); }
+
+void goby::acomms::AcousticSimDriver::startup(const protobuf::DriverConfig& cfg)
+{
+    shutdown();
+    driver_cfg_ = cfg;
+
+    channel_ = AcousticChannelSimulator::channel(sim_driver_cfg().channel(),
+                                                 sim_driver_cfg().channel_cfg());
+
+    AcousticChannelSimulator::Position position;
+    position.x = sim_driver_cfg().position().x();
+    position.y = sim_driver_cfg().position().y();
+    position.z = sim_driver_cfg().position().z();
+    channel_->add_node(driver_cfg_.modem_id(), position);
+
+    glog.is(DEBUG1) && glog << group(glog_out_group()) << "Joined simulated acoustic channel \""
+                            << sim_driver_cfg().channel()
+                            << "\": " << channel_->cfg().ShortDebugString() << std::endl;
+
+    application_ack_ids_.clear();
+    application_ack_ids_.insert(driver_cfg_.modem_id());
+    for (unsigned id : sim_driver_cfg().additional_application_ack_modem_id())
+        application_ack_ids_.insert(id);
+
+    tx_end_ = time::SystemClock::time_point();
+}
+
+void goby::acomms::AcousticSimDriver::shutdown()
+{
+    if (channel_)
+    {
+        channel_->remove_node(driver_cfg_.modem_id());
+        channel_.reset();
+    }
+}
+
+void goby::acomms::AcousticSimDriver::set_position(
+    const AcousticChannelSimulator::Position& position)
+{
+    channel_->set_position(driver_cfg_.modem_id(), position);
+}
+
+void goby::acomms::AcousticSimDriver::handle_initiate_transmission(
+    const protobuf::ModemTransmission& orig_msg)
+{
+    protobuf::ModemTransmission msg = orig_msg;
+    signal_modify_transmission(&msg);
+
+    if (!msg.has_frame_start())
+        msg.set_frame_start(next_frame_);
+
+    if (!msg.has_max_frame_bytes() || msg.max_frame_bytes() > max_frame_size(msg.rate()))
+        msg.set_max_frame_bytes(max_frame_size(msg.rate()));
+    signal_data_request(&msg);
+
+    glog.is(DEBUG1) && glog << group(glog_out_group())
+                            << "After modification, initiating transmission with " << msg
+                            << std::endl;
+
+    next_frame_ += msg.frame_size();
+
+    if (!(msg.frame_size() == 0 || msg.frame(0).empty()))
+        transmit(msg);
+}
+
+void goby::acomms::AcousticSimDriver::do_work()
+{
+    if (!channel_)
+        return;
+
+    for (const auto& rx :
+         channel_->receive(driver_cfg_.modem_id(), time::SystemClock::now()))
+    {
+        protobuf::ModemRaw raw_msg;
+        raw_msg.set_raw(rx.bytes);
+        signal_raw_incoming(raw_msg);
+
+        protobuf::ModemTransmission msg;
+        msg.ParseFromString(rx.bytes);
+
+        // like the hardware, only pass up what is addressed to us
+        if (msg.dest() == BROADCAST_ID || application_ack_ids_.count(msg.dest()))
+            receive_message(msg);
+    }
+}
+
+void goby::acomms::AcousticSimDriver::receive_message(const protobuf::ModemTransmission& msg)
+{
+    if (msg.type() != protobuf::ModemTransmission::ACK && msg.ack_requested() &&
+        application_ack_ids_.count(msg.dest()))
+    {
+        protobuf::ModemTransmission ack;
+        ack.set_type(goby::acomms::protobuf::ModemTransmission::ACK);
+        ack.set_time_with_units(goby::time::SystemClock::now<goby::time::MicroTime>());
+        ack.set_src(msg.dest());
+        ack.set_dest(msg.src());
+        ack.set_rate(msg.rate());
+        for (int i = msg.frame_start(), n = msg.frame_size() + msg.frame_start(); i < n; ++i)
+            ack.add_acked_frame(i);
+        transmit(ack);
+    }
+
+    signal_receive(msg);
+}
+
+void goby::acomms::AcousticSimDriver::transmit(const protobuf::ModemTransmission& msg)
+{
+    std::string bytes;
+    msg.SerializeToString(&bytes);
+
+    protobuf::ModemRaw raw_msg;
+    raw_msg.set_raw(bytes);
+    signal_raw_outgoing(raw_msg);
+
+    std::size_t data_bytes = 0;
+    for (const auto& frame : msg.frame()) data_bytes += frame.size();
+
+    const auto duration = std::chrono::duration_cast<time::SystemClock::duration>(
+        std::chrono::duration<double>(sim_driver_cfg().packet_overhead_seconds() +
+                                      data_bytes * BITS_IN_BYTE / bit_rate(msg.rate())));
+
+    // half-duplex: wait for any transmission still in progress
+    const auto start = std::max(time::SystemClock::now(), tx_end_);
+    tx_end_ = start + duration;
+
+    glog.is(DEBUG1) && glog << group(glog_out_group()) << "Transmitting " << bytes.size()
+                            << " bytes (" << data_bytes << " data bytes) for "
+                            << std::chrono::duration<double>(duration).count() << " s"
+                            << std::endl;
+
+    channel_->transmit(driver_cfg_.modem_id(), bytes, start, duration);
+}
+
+std::uint32_t goby::acomms::AcousticSimDriver::max_frame_size(int rate) const
+{
+    for (const auto& rate_cfg : sim_driver_cfg().rate())
+    {
+        if (rate_cfg.rate() == rate && rate_cfg.has_max_frame_size())
+            return rate_cfg.max_frame_size();
+    }
+    return sim_driver_cfg().max_frame_size();
+}
+
+double goby::acomms::AcousticSimDriver::bit_rate(int rate) const
+{
+    for (const auto& rate_cfg : sim_driver_cfg().rate())
+    {
+        if (rate_cfg.rate() == rate && rate_cfg.has_bit_rate())
+            return rate_cfg.bit_rate();
+    }
+    return sim_driver_cfg().bit_rate();
+}
@@ -0,0 +1,84 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef AcousticSimDriver20201019H
+#define AcousticSimDriver20201019H
+
+#include <memory>
+#include <set>
+
+#include "goby/acomms/modemdriver/acoustic_sim_channel.h"
+#include "goby/acomms/modemdriver/driver_base.h"
+#include "goby/acomms/protobuf/acoustic_sim_driver.pb.h"
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Simulated acoustic modem on an AcousticChannelSimulator, for benchmarking the acomms stack (MACManager, QueueManager, DynamicBuffer, intervehicle ModemDriverThread) without hardware
+///
+/// All drivers in the same process configured with the same channel name share a channel, which models propagation delay, range, packet loss, bit errors, collisions and half-duplex operation. Packet duration is packet_overhead_seconds plus the frame bits at bit_rate. Like the hardware, the driver is half-duplex: a transmission requested while the previous one is still going out starts once it ends. Set goby::time::SimulatorSettings::warp_factor to run faster than real time.
+class AcousticSimDriver : public ModemDriverBase
+{
+  public:
+    AcousticSimDriver();
+    ~AcousticSimDriver() override;
+
+    void startup(const protobuf::DriverConfig& cfg) override;
+    void shutdown() override;
+    void do_work() override;
+    void handle_initiate_transmission(const protobuf::ModemTransmission& m) override;
+
+    /// \brief Move this node (e.g. from a vehicle dynamics simulation). Only valid after startup()
+    void set_position(const AcousticChannelSimulator::Position& position);
+
+    /// \brief Channel this driver is attached to (null before startup())
+    std::shared_ptr<AcousticChannelSimulator> channel() const { return channel_; }
+
+  private:
+    void transmit(const protobuf::ModemTransmission& msg);
+    void receive_message(const protobuf::ModemTransmission& msg);
+
+    std::uint32_t max_frame_size(int rate) const;
+    double bit_rate(int rate) const;
+
+    const acoustic_sim::protobuf::Config& sim_driver_cfg() const
+    {
+        return driver_cfg_.GetExtension(acoustic_sim::protobuf::config);
+    }
+
+  private:
+    protobuf::DriverConfig driver_cfg_;
+    std::shared_ptr<AcousticChannelSimulator> channel_;
+
+    // end of our current (or last) transmission
+    time::SystemClock::time_point tx_end_;
+
+    // ids we are providing acks for, normally just our modem_id()
+    std::set<unsigned> application_ack_ids_;
+
+    std::uint32_t next_frame_{0};
+};
+} // namespace acomms
+} // namespace goby
+#endif
@@ -37,8 +37,6 @@ using goby::glog;
 using goby::acomms::iridium::protobuf::DirectIPMOHeader;
 using goby::acomms::iridium::protobuf::DirectIPMOPayload;
 using goby::acomms::iridium::protobuf::DirectIPMOPreHeader;
-using goby::acomms::iridium::protobuf::DirectIPMTHeader;
-using goby::acomms::iridium::protobuf::DirectIPMTPayload;
 using goby::util::TCPConnection;
 
 goby::acomms::IridiumShoreDriver::IridiumShoreDriver() : next_frame_(0) { init_iridium_dccl(); }
@@ -208,7 +206,9 @@ void goby::acomms::IridiumShoreDriver::send(const protobuf::ModemTransmission& m
         serialize_rudics_packet(bytes, &sbd_packet);
 
         if (modem_id_to_imei_.count(msg.dest()))
-            send_sbd_mt(sbd_packet, modem_id_to_imei_[msg.dest()]);
+            send_sbd_mt(sbd_packet, modem_id_to_imei_[msg.dest()],
+                        iridium_shore_driver_cfg().mt_sbd_server_address(),
+                        iridium_shore_driver_cfg().mt_sbd_server_port());
         else
             glog.is(WARN) && glog << "No IMEI configured for destination address " << msg.dest()
                                   << " so unabled to send SBD message." << std::endl;
@@ -329,224 +329,23 @@ void goby::acomms::IridiumShoreDriver::rudics_line(const std::string& data,
 
 void goby::acomms::IridiumShoreDriver::receive_sbd_mo()
 {
-    try
-    {
-        sbd_io_.poll();
-    }
-    catch (std::exception& e)
-    {
-        glog.is(DEBUG1) && glog << warn << "Could not handle SBD receive: " << e.what()
-                                << std::endl;
-    }
-
-    std::set<std::shared_ptr<SBDConnection> >::iterator it = mo_sbd_server_->connections().begin(),
-                                                        end = mo_sbd_server_->connections().end();
-    while (it != end)
-    {
-        const int timeout = 5;
-        if ((*it)->message().data_ready())
+    poll_sbd_mo(sbd_io_, *mo_sbd_server_, [this](const SBDMOMessageReader& message) {
+        protobuf::ModemTransmission modem_msg;
+        std::string bytes;
+        try
         {
-            protobuf::ModemTransmission modem_msg;
+            parse_rudics_packet(&bytes, message.body().payload());
+            parse_iridium_modem_message(bytes, &modem_msg);
 
-            glog.is(DEBUG1) && glog << "Rx SBD PreHeader: "
-                                    << (*it)->message().pre_header().DebugString() << std::endl;
-            glog.is(DEBUG1) && glog << "Rx SBD Header: " << (*it)->message().header().DebugString()
+            glog.is(DEBUG1) && glog << "Rx SBD ModemTransmission: " << modem_msg.ShortDebugString()
                                     << std::endl;
-            glog.is(DEBUG1) && glog << "Rx SBD Payload: " << (*it)->message().body().DebugString()
-                                    << std::endl;
-
-            std::string bytes;
-            try
-            {
-                parse_rudics_packet(&bytes, (*it)->message().body().payload());
-                parse_iridium_modem_message(bytes, &modem_msg);
-
-                glog.is(DEBUG1) && glog << "Rx SBD ModemTransmission: "
-                                        << modem_msg.ShortDebugString() << std::endl;
-
-                receive(modem_msg);
-            }
-            catch (RudicsPacketException& e)
-            {
-                glog.is(DEBUG1) && glog << warn << "Could not decode SBD packet: " << e.what()
-                                        << std::endl;
-            }
-            mo_sbd_server_->connections().erase(it++);
-        }
-        else if ((*it)->connect_time() > 0 &&
-                 (time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1) >
-                  ((*it)->connect_time() + timeout)))
-        {
-            glog.is(DEBUG1) && glog << "Removing SBD connection that has timed out:"
-                                    << (*it)->remote_endpoint_str() << std::endl;
-            mo_sbd_server_->connections().erase(it++);
-        }
-        else
-        {
-            ++it;
-        }
-    }
-}
-
-void goby::acomms::IridiumShoreDriver::send_sbd_mt(const std::string& bytes,
-                                                   const std::string& imei)
-{
-    try
-    {
-        using boost::asio::ip::tcp;
-
-        boost::asio::io_service io_service;
-
-        tcp::resolver resolver(io_service);
-        tcp::resolver::query query(
-            iridium_shore_driver_cfg().mt_sbd_server_address(),
-            goby::util::as<std::string>(iridium_shore_driver_cfg().mt_sbd_server_port()));
-        tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
-        tcp::resolver::iterator end;
 
-        tcp::socket socket(io_service);
-        boost::system::error_code error = boost::asio::error::host_not_found;
-        while (error && endpoint_iterator != end)
-        {
-            socket.close();
-            socket.connect(*endpoint_iterator++, error);
+            receive(modem_msg);
         }
-        if (error)
-            throw boost::system::system_error(error);
-
-        boost::asio::write(socket, boost::asio::buffer(create_sbd_mt_data_message(bytes, imei)));
-
-        SBDMTConfirmationMessageReader message(socket);
-        boost::asio::async_read(
-            socket, boost::asio::buffer(message.data()),
-            boost::asio::transfer_at_least(SBDMessageReader::PRE_HEADER_SIZE),
-            boost::bind(&SBDMessageReader::pre_header_handler, &message, _1, _2));
-
-        double start_time = time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1);
-        const int timeout = 5;
-
-        while (!message.data_ready() &&
-               (start_time + timeout >
-                time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1)))
-            io_service.poll();
-
-        if (message.data_ready())
+        catch (RudicsPacketException& e)
         {
-            glog.is(DEBUG1) && glog << "Tx SBD Confirmation: " << message.confirm().DebugString()
+            glog.is(DEBUG1) && glog << warn << "Could not decode SBD packet: " << e.what()
                                     << std::endl;
         }
-        else
-        {
-            glog.is(WARN) && glog << "Timeout waiting for confirmation message from DirectIP server"
-                                  << std::endl;
-        }
-    }
-    catch (std::exception& e)
-    {
-        glog.is(WARN) && glog << "Could not sent MT SBD message: " << e.what() << std::endl;
-    }
-}
-
-std::string goby::acomms::IridiumShoreDriver::create_sbd_mt_data_message(const std::string& bytes,
-                                                                         const std::string& imei)
-{
-    enum
-    {
-        PRE_HEADER_SIZE = 3,
-        BITS_PER_BYTE = 8,
-        IEI_SIZE = 3,
-        HEADER_SIZE = 21
-    };
-
-    enum
-    {
-        IEI_MT_HEADER = 0x41,
-        IEI_MT_PAYLOAD = 0x42
-    };
-
-    static int i = 0;
-    DirectIPMTHeader header;
-    header.set_iei(IEI_MT_HEADER);
-    header.set_length(HEADER_SIZE);
-    header.set_client_id(i++);
-    header.set_imei(imei);
-
-    enum
-    {
-        DISP_FLAG_FLUSH_MT_QUEUE = 0x01,
-        DISP_FLAG_SEND_RING_ALERT_NO_MTM = 0x02,
-        DISP_FLAG_UPDATE_SSD_LOCATION = 0x08,
-        DISP_FLAG_HIGH_PRIORITY_MESSAGE = 0x10,
-        DISP_FLAG_ASSIGN_MTMSN = 0x20
-    };
-
-    header.set_disposition_flags(DISP_FLAG_FLUSH_MT_QUEUE);
-
-    std::string header_bytes(IEI_SIZE + HEADER_SIZE, '\0');
-
-    std::string::size_type pos = 0;
-    enum
-    {
-        HEADER_IEI = 1,
-        HEADER_LENGTH = 2,
-        HEADER_CLIENT_ID = 3,
-        HEADER_IMEI = 4,
-        HEADER_DISPOSITION_FLAGS = 5
-    };
-
-    for (int field = HEADER_IEI; field <= HEADER_DISPOSITION_FLAGS; ++field)
-    {
-        switch (field)
-        {
-            case HEADER_IEI: header_bytes[pos++] = header.iei() & 0xff; break;
-
-            case HEADER_LENGTH:
-                header_bytes[pos++] = (header.length() >> BITS_PER_BYTE) & 0xff;
-                header_bytes[pos++] = (header.length()) & 0xff;
-                break;
-
-            case HEADER_CLIENT_ID:
-                header_bytes[pos++] = (header.client_id() >> 3 * BITS_PER_BYTE) & 0xff;
-                header_bytes[pos++] = (header.client_id() >> 2 * BITS_PER_BYTE) & 0xff;
-                header_bytes[pos++] = (header.client_id() >> BITS_PER_BYTE) & 0xff;
-                header_bytes[pos++] = (header.client_id()) & 0xff;
-                break;
-
-            case HEADER_IMEI:
-                header_bytes.replace(pos, 15, header.imei());
-                pos += 15;
-                break;
-
-            case HEADER_DISPOSITION_FLAGS:
-                header_bytes[pos++] = (header.disposition_flags() >> BITS_PER_BYTE) & 0xff;
-                header_bytes[pos++] = (header.disposition_flags()) & 0xff;
-                break;
-        }
-    }
-
-    DirectIPMTPayload payload;
-    payload.set_iei(IEI_MT_PAYLOAD);
-    payload.set_length(bytes.size());
-    payload.set_payload(bytes);
-
-    std::string payload_bytes(IEI_SIZE + bytes.size(), '\0');
-    payload_bytes[0] = payload.iei();
-    payload_bytes[1] = (payload.length() >> BITS_PER_BYTE) & 0xff;
-    payload_bytes[2] = (payload.length()) & 0xff;
-    payload_bytes.replace(3, payload.payload().size(), payload.payload());
-
-    // Protocol Revision Number (1 byte) == 1
-    // Overall Message Length (2 bytes)
-    int overall_length = header_bytes.size() + payload_bytes.size();
-    std::string pre_header_bytes(PRE_HEADER_SIZE, '\0');
-    pre_header_bytes[0] = 1;
-    pre_header_bytes[1] = (overall_length >> BITS_PER_BYTE) & 0xff;
-    pre_header_bytes[2] = (overall_length)&0xff;
-
-    glog.is(DEBUG1) && glog << "Tx SBD PreHeader: " << goby::util::hex_encode(pre_header_bytes)
-                            << std::endl;
-    glog.is(DEBUG1) && glog << "Tx SBD Header: " << header.DebugString() << std::endl;
-    glog.is(DEBUG1) && glog << "Tx SBD Payload: " << payload.DebugString() << std::endl;
-
-    return pre_header_bytes + header_bytes + payload_bytes;
+    });
 }
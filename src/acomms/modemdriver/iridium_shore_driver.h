@@ -64,9 +64,7 @@ class IridiumShoreDriver : public ModemDriverBase
     void decode_mo(iridium::protobuf::DirectIPMOPreHeader* pre_header,
                    iridium::protobuf::DirectIPMOHeader* header,
                    iridium::protobuf::DirectIPMOPayload* body, const std::string& data);
-    std::string create_sbd_mt_data_message(const std::string& payload, const std::string& imei);
     void receive_sbd_mo();
-    void send_sbd_mt(const std::string& bytes, const std::string& imei);
 
     void rudics_send(const std::string& data, ModemId id);
     void rudics_disconnect(std::shared_ptr<RUDICSConnection> connection);
@@ -30,6 +30,10 @@
 #include <boost/bind.hpp>
 #include <boost/signals2.hpp>
 
+#include <deque>
+#include <memory>
+#include <set>
+
 #include "goby/time.h"
 #include "goby/util/binary.h"
 
@@ -231,6 +235,222 @@ class RUDICSServer
     boost::asio::ip::tcp::acceptor acceptor_;
 };
 
+/// \brief RUDICS connection for use with an io_context run by a pool of threads (IridiumShoreShardedDriver)
+///
+/// All handlers for a given connection are serialized on its own strand, so different connections are serviced in parallel while each connection is single-threaded. Unlike RUDICSConnection, write() and close() may be called from any thread. The line and disconnect signals are called on the connection's strand.
+class StrandedRUDICSConnection : public std::enable_shared_from_this<StrandedRUDICSConnection>
+{
+  public:
+    static std::shared_ptr<StrandedRUDICSConnection> create(boost::asio::io_context& io)
+    {
+        return std::shared_ptr<StrandedRUDICSConnection>(new StrandedRUDICSConnection(io));
+    }
+
+    boost::asio::ip::tcp::socket& socket() { return socket_; }
+
+    void start()
+    {
+        boost::system::error_code ec;
+        auto endpoint = socket_.remote_endpoint(ec);
+        if (!ec)
+            remote_endpoint_str_ = boost::lexical_cast<std::string>(endpoint);
+        read_start();
+    }
+
+    /// \brief Queue data to write (thread-safe)
+    void write(const std::string& data)
+    {
+        auto self(shared_from_this());
+        strand_.post([this, self, data]() {
+            write_queue_.push_back(data);
+            if (write_queue_.size() == 1)
+                write_next();
+        });
+    }
+
+    /// \brief Shutdown and close the socket (thread-safe). The disconnect signal follows once the outstanding read is aborted.
+    void close()
+    {
+        auto self(shared_from_this());
+        strand_.post([this, self]() {
+            boost::system::error_code ec;
+            socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            socket_.close(ec);
+        });
+    }
+
+    /// \brief Count a bad packet, closing the connection after too many. Must be called from the line signal.
+    void add_packet_failure()
+    {
+        using goby::glog;
+        using goby::util::logger::DEBUG1;
+        const int max_packet_failures = 3;
+        if (++packet_failures_ >= max_packet_failures)
+        {
+            glog.is(DEBUG1) && glog << "More than " << max_packet_failures << " bad RUDICS packets."
+                                    << std::endl;
+            close();
+        }
+    }
+
+    boost::signals2::signal<void(const std::string& line,
+                                 std::shared_ptr<StrandedRUDICSConnection> connection)>
+        line_signal;
+    boost::signals2::signal<void(std::shared_ptr<StrandedRUDICSConnection> connection)>
+        disconnect_signal;
+
+    const std::string& remote_endpoint_str() const { return remote_endpoint_str_; }
+
+  private:
+    StrandedRUDICSConnection(boost::asio::io_context& io)
+        : strand_(io), socket_(io), remote_endpoint_str_("Unknown")
+    {
+    }
+
+    void read_start()
+    {
+        boost::asio::async_read_until(
+            socket_, buffer_, '\r',
+            strand_.wrap(boost::bind(&StrandedRUDICSConnection::handle_read, shared_from_this(),
+                                     _1, _2)));
+    }
+
+    void write_next()
+    {
+        boost::asio::async_write(
+            socket_, boost::asio::buffer(write_queue_.front()),
+            strand_.wrap(boost::bind(&StrandedRUDICSConnection::handle_write, shared_from_this(),
+                                     _1, _2)));
+    }
+
+    void handle_write(const boost::system::error_code& error, size_t bytes_transferred)
+    {
+        if (error)
+        {
+            using goby::glog;
+            using goby::util::logger::WARN;
+            glog.is(WARN) && glog << "Error writing to TCP connection: " << error << std::endl;
+            write_queue_.clear();
+            disconnect();
+            return;
+        }
+
+        write_queue_.pop_front();
+        if (!write_queue_.empty())
+            write_next();
+    }
+
+    void handle_read(const boost::system::error_code& error, size_t bytes_transferred)
+    {
+        using goby::glog;
+        using goby::util::logger::DEBUG1;
+        using goby::util::logger::WARN;
+        if (!error)
+        {
+            std::istream istrm(&buffer_);
+            std::string line;
+            std::getline(istrm, line, '\r');
+            line_signal(line + "\r", shared_from_this());
+            if (!disconnected_)
+                read_start();
+        }
+        else
+        {
+            if (error == boost::asio::error::eof)
+                glog.is(DEBUG1) && glog << "Connection reached EOF" << std::endl;
+            else if (error == boost::asio::error::operation_aborted)
+                glog.is(DEBUG1) && glog << "Read operation aborted (socket closed)" << std::endl;
+            else
+                glog.is(WARN) && glog << "Error reading from TCP connection: " << error
+                                      << std::endl;
+
+            disconnect();
+        }
+    }
+
+    // signal the disconnection exactly once, even if both the read and write fail
+    void disconnect()
+    {
+        if (disconnected_)
+            return;
+        disconnected_ = true;
+        boost::system::error_code ec;
+        socket_.close(ec);
+        disconnect_signal(shared_from_this());
+    }
+
+  private:
+    boost::asio::io_context::strand strand_;
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::streambuf buffer_;
+    std::deque<std::string> write_queue_;
+    std::string remote_endpoint_str_;
+    int packet_failures_{0};
+    bool disconnected_{false};
+};
+
+/// \brief Accepts RUDICS connections as StrandedRUDICSConnection (for use with IridiumShoreShardedDriver)
+class StrandedRUDICSServer
+{
+  public:
+    StrandedRUDICSServer(boost::asio::io_context& io_context, int port)
+        : io_(io_context),
+          acceptor_(io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port))
+    {
+    }
+
+    /// \brief Start accepting connections. Call after connecting to connect_signal.
+    void start() { start_accept(); }
+
+    /// \brief Stop accepting new connections (thread-safe)
+    void stop()
+    {
+        io_.post([this]() {
+            boost::system::error_code ec;
+            acceptor_.close(ec);
+        });
+    }
+
+    /// \brief Called (from a pool thread) for each new connection, before any data is read from it
+    boost::signals2::signal<void(std::shared_ptr<StrandedRUDICSConnection> connection)>
+        connect_signal;
+
+    unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+  private:
+    void start_accept()
+    {
+        std::shared_ptr<StrandedRUDICSConnection> new_connection =
+            StrandedRUDICSConnection::create(io_);
+        acceptor_.async_accept(new_connection->socket(),
+                               boost::bind(&StrandedRUDICSServer::handle_accept, this,
+                                           new_connection, boost::asio::placeholders::error));
+    }
+
+    void handle_accept(std::shared_ptr<StrandedRUDICSConnection> new_connection,
+                       const boost::system::error_code& error)
+    {
+        if (error == boost::asio::error::operation_aborted)
+            return;
+
+        if (!error)
+        {
+            connect_signal(new_connection);
+            new_connection->start();
+
+            using namespace goby::util::logger;
+            using goby::glog;
+            glog.is(DEBUG1) && glog << "Received connection from: "
+                                    << new_connection->remote_endpoint_str() << std::endl;
+        }
+
+        start_accept();
+    }
+
+    boost::asio::io_context& io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+};
+
 } // namespace acomms
 } // namespace goby
 
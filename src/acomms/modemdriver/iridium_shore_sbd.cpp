@@ -0,0 +1,242 @@
+// Copyright 2015-2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+
+#include "goby/acomms/protobuf/iridium_sbd_directip.pb.h"
+#include "goby/util/as.h"
+#include "goby/util/debug_logger.h"
+
+#include "iridium_shore_sbd.h"
+
+using namespace goby::util::logger;
+using goby::glog;
+using goby::acomms::iridium::protobuf::DirectIPMTHeader;
+using goby::acomms::iridium::protobuf::DirectIPMTPayload;
+
+void goby::acomms::poll_sbd_mo(boost::asio::io_context& io, SBDServer& server,
+                               const std::function<void(const SBDMOMessageReader&)>& handle)
+{
+    try
+    {
+        io.poll();
+    }
+    catch (std::exception& e)
+    {
+        glog.is(DEBUG1) && glog << warn << "Could not handle SBD receive: " << e.what()
+                                << std::endl;
+    }
+
+    std::set<std::shared_ptr<SBDConnection> >::iterator it = server.connections().begin(),
+                                                        end = server.connections().end();
+    while (it != end)
+    {
+        const int timeout = 5;
+        if ((*it)->message().data_ready())
+        {
+            glog.is(DEBUG1) && glog << "Rx SBD PreHeader: "
+                                    << (*it)->message().pre_header().DebugString() << std::endl;
+            glog.is(DEBUG1) && glog << "Rx SBD Header: " << (*it)->message().header().DebugString()
+                                    << std::endl;
+            glog.is(DEBUG1) && glog << "Rx SBD Payload: " << (*it)->message().body().DebugString()
+                                    << std::endl;
+
+            handle((*it)->message());
+            server.connections().erase(it++);
+        }
+        else if ((*it)->connect_time() > 0 &&
+                 (time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1) >
+                  ((*it)->connect_time() + timeout)))
+        {
+            glog.is(DEBUG1) && glog << "Removing SBD connection that has timed out:"
+                                    << (*it)->remote_endpoint_str() << std::endl;
+            server.connections().erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void goby::acomms::send_sbd_mt(const std::string& bytes, const std::string& imei,
+                               const std::string& server_address, unsigned server_port)
+{
+    try
+    {
+        using boost::asio::ip::tcp;
+
+        boost::asio::io_service io_service;
+
+        tcp::resolver resolver(io_service);
+        tcp::resolver::query query(server_address, goby::util::as<std::string>(server_port));
+        tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
+        tcp::resolver::iterator end;
+
+        tcp::socket socket(io_service);
+        boost::system::error_code error = boost::asio::error::host_not_found;
+        while (error && endpoint_iterator != end)
+        {
+            socket.close();
+            socket.connect(*endpoint_iterator++, error);
+        }
+        if (error)
+            throw boost::system::system_error(error);
+
+        boost::asio::write(socket, boost::asio::buffer(create_sbd_mt_data_message(bytes, imei)));
+
+        SBDMTConfirmationMessageReader message(socket);
+        boost::asio::async_read(
+            socket, boost::asio::buffer(message.data()),
+            boost::asio::transfer_at_least(SBDMessageReader::PRE_HEADER_SIZE),
+            boost::bind(&SBDMessageReader::pre_header_handler, &message, _1, _2));
+
+        double start_time = time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1);
+        const int timeout = 5;
+
+        while (!message.data_ready() &&
+               (start_time + timeout >
+                time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1)))
+            io_service.poll();
+
+        if (message.data_ready())
+        {
+            glog.is(DEBUG1) && glog << "Tx SBD Confirmation: " << message.confirm().DebugString()
+                                    << std::endl;
+        }
+        else
+        {
+            glog.is(WARN) && glog << "Timeout waiting for confirmation message from DirectIP server"
+                                  << std::endl;
+        }
+    }
+    catch (std::exception& e)
+    {
+        glog.is(WARN) && glog << "Could not sent MT SBD message: " << e.what() << std::endl;
+    }
+}
+
+std::string goby::acomms::create_sbd_mt_data_message(const std::string& bytes,
+                                                     const std::string& imei)
+{
+    enum
+    {
+        PRE_HEADER_SIZE = 3,
+        BITS_PER_BYTE = 8,
+        IEI_SIZE = 3,
+        HEADER_SIZE = 21
+    };
+
+    enum
+    {
+        IEI_MT_HEADER = 0x41,
+        IEI_MT_PAYLOAD = 0x42
+    };
+
+    // may be called concurrently by IridiumShoreShardedDriver
+    static std::atomic<int> i(0);
+    DirectIPMTHeader header;
+    header.set_iei(IEI_MT_HEADER);
+    header.set_length(HEADER_SIZE);
+    header.set_client_id(i++);
+    header.set_imei(imei);
+
+    enum
+    {
+        DISP_FLAG_FLUSH_MT_QUEUE = 0x01,
+        DISP_FLAG_SEND_RING_ALERT_NO_MTM = 0x02,
+        DISP_FLAG_UPDATE_SSD_LOCATION = 0x08,
+        DISP_FLAG_HIGH_PRIORITY_MESSAGE = 0x10,
+        DISP_FLAG_ASSIGN_MTMSN = 0x20
+    };
+
+    header.set_disposition_flags(DISP_FLAG_FLUSH_MT_QUEUE);
+
+    std::string header_bytes(IEI_SIZE + HEADER_SIZE, '\0');
+
+    std::string::size_type pos = 0;
+    enum
+    {
+        HEADER_IEI = 1,
+        HEADER_LENGTH = 2,
+        HEADER_CLIENT_ID = 3,
+        HEADER_IMEI = 4,
+        HEADER_DISPOSITION_FLAGS = 5
+    };
+
+    for (int field = HEADER_IEI; field <= HEADER_DISPOSITION_FLAGS; ++field)
+    {
+        switch (field)
+        {
+            case HEADER_IEI: header_bytes[pos++] = header.iei() & 0xff; break;
+
+            case HEADER_LENGTH:
+                header_bytes[pos++] = (header.length() >> BITS_PER_BYTE) & 0xff;
+                header_bytes[pos++] = (header.length()) & 0xff;
+                break;
+
+            case HEADER_CLIENT_ID:
+                header_bytes[pos++] = (header.client_id() >> 3 * BITS_PER_BYTE) & 0xff;
+                header_bytes[pos++] = (header.client_id() >> 2 * BITS_PER_BYTE) & 0xff;
+                header_bytes[pos++] = (header.client_id() >> BITS_PER_BYTE) & 0xff;
+                header_bytes[pos++] = (header.client_id()) & 0xff;
+                break;
+
+            case HEADER_IMEI:
+                header_bytes.replace(pos, 15, header.imei());
+                pos += 15;
+                break;
+
+            case HEADER_DISPOSITION_FLAGS:
+                header_bytes[pos++] = (header.disposition_flags() >> BITS_PER_BYTE) & 0xff;
+                header_bytes[pos++] = (header.disposition_flags()) & 0xff;
+                break;
+        }
+    }
+
+    DirectIPMTPayload payload;
+    payload.set_iei(IEI_MT_PAYLOAD);
+    payload.set_length(bytes.size());
+    payload.set_payload(bytes);
+
+    std::string payload_bytes(IEI_SIZE + bytes.size(), '\0');
+    payload_bytes[0] = payload.iei();
+    payload_bytes[1] = (payload.length() >> BITS_PER_BYTE) & 0xff;
+    payload_bytes[2] = (payload.length()) & 0xff;
+    payload_bytes.replace(3, payload.payload().size(), payload.payload());
+
+    // Protocol Revision Number (1 byte) == 1
+    // Overall Message Length (2 bytes)
+    int overall_length = header_bytes.size() + payload_bytes.size();
+    std::string pre_header_bytes(PRE_HEADER_SIZE, '\0');
+    pre_header_bytes[0] = 1;
+    pre_header_bytes[1] = (overall_length >> BITS_PER_BYTE) & 0xff;
+    pre_header_bytes[2] = (overall_length)&0xff;
+
+    glog.is(DEBUG1) && glog << "Tx SBD PreHeader: " << goby::util::hex_encode(pre_header_bytes)
+                            << std::endl;
+    glog.is(DEBUG1) && glog << "Tx SBD Header: " << header.DebugString() << std::endl;
+    glog.is(DEBUG1) && glog << "Tx SBD Payload: " << payload.DebugString() << std::endl;
+
+    return pre_header_bytes + header_bytes + payload_bytes;
+}
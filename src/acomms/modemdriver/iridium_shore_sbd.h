@@ -27,10 +27,13 @@
 #include "goby/acomms/protobuf/iridium_sbd_directip.pb.h"
 #include "goby/acomms/protobuf/rudics_shore.pb.h"
 #include "goby/time.h"
+#include "goby/util/asio-compat.h"
 #include "goby/util/binary.h"
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <functional>
+#include <set>
 
 namespace goby
 {
@@ -297,6 +300,17 @@ class SBDServer
     boost::asio::ip::tcp::acceptor acceptor_;
 };
 
+/// \brief Poll the DirectIP MO server, calling \c handle for each completed message and removing completed or timed out connections
+void poll_sbd_mo(boost::asio::io_context& io, SBDServer& server,
+                 const std::function<void(const SBDMOMessageReader&)>& handle);
+
+/// \brief Encode a DirectIP MT message (pre-header, header and payload IEs) for the given payload and destination IMEI
+std::string create_sbd_mt_data_message(const std::string& bytes, const std::string& imei);
+
+/// \brief Connect to the DirectIP MT server and send a message, blocking until it is confirmed (or a five second timeout elapses)
+void send_sbd_mt(const std::string& bytes, const std::string& imei,
+                 const std::string& server_address, unsigned server_port);
+
 } // namespace acomms
 } // namespace goby
 
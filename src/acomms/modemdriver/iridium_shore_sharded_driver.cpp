@@ -0,0 +1,536 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "goby/acomms/modemdriver/driver_exception.h"
+#include "goby/acomms/modemdriver/rudics_packet.h"
+#include "goby/time.h"
+#include "goby/util/binary.h"
+#include "goby/util/debug_logger.h"
+
+#include "iridium_shore_sharded_driver.h"
+
+using namespace goby::util::logger;
+using goby::glog;
+
+goby::acomms::IridiumShoreShardedDriver::IridiumShoreShardedDriver() { init_iridium_dccl(); }
+
+goby::acomms::IridiumShoreShardedDriver::~IridiumShoreShardedDriver()
+{
+    stop_pool();
+
+    if (receive_queue_)
+        receive_queue_->consume_all([](protobuf::ModemTransmission* msg) { delete msg; });
+}
+
+void goby::acomms::IridiumShoreShardedDriver::startup(const protobuf::DriverConfig& cfg)
+{
+    stop_pool();
+
+    driver_cfg_ = cfg;
+
+    glog.is(DEBUG1) && glog << group(glog_out_group())
+                            << "Goby Shore Iridium RUDICS/SBD driver (sharded) starting up with "
+                            << iridium_shore_driver_cfg().worker_threads() << " worker threads."
+                            << std::endl;
+
+    rudics_mac_msg_.set_src(driver_cfg_.modem_id());
+    rudics_mac_msg_.set_type(goby::acomms::protobuf::ModemTransmission::DATA);
+    rudics_mac_msg_.set_rate(RATE_RUDICS);
+
+    modem_id_to_imei_.clear();
+    imei_to_modem_id_.clear();
+    for (const auto& pair : iridium_shore_driver_cfg().modem_id_to_imei())
+    {
+        modem_id_to_imei_[pair.modem_id()] = pair.imei();
+        imei_to_modem_id_[pair.imei()] = pair.modem_id();
+    }
+
+    if (receive_queue_)
+        receive_queue_->consume_all([](protobuf::ModemTransmission* msg) { delete msg; });
+    receive_queue_.reset(new boost::lockfree::queue<protobuf::ModemTransmission*>(
+        iridium_shore_driver_cfg().receive_queue_capacity()));
+
+    pool_io_.reset(new boost::asio::io_context);
+    pool_work_.reset(new boost::asio::io_context::work(*pool_io_));
+
+    rudics_server_.reset(
+        new StrandedRUDICSServer(*pool_io_, iridium_shore_driver_cfg().rudics_server_port()));
+    rudics_server_->connect_signal.connect(
+        boost::bind(&IridiumShoreShardedDriver::rudics_connect, this, _1));
+    rudics_server_->start();
+
+    mo_sbd_server_.reset(new SBDServer(sbd_io_, iridium_shore_driver_cfg().mo_sbd_server_port()));
+
+    for (unsigned i = 0, n = std::max(1u, iridium_shore_driver_cfg().worker_threads()); i < n; ++i)
+    {
+        pool_.emplace_back([this]() {
+            for (;;)
+            {
+                try
+                {
+                    pool_io_->run();
+                    break;
+                }
+                catch (std::exception& e)
+                {
+                    glog.is(WARN) && glog << "Iridium shore worker thread caught exception: "
+                                          << e.what() << std::endl;
+                }
+            }
+        });
+    }
+}
+
+void goby::acomms::IridiumShoreShardedDriver::shutdown() { stop_pool(); }
+
+void goby::acomms::IridiumShoreShardedDriver::stop_pool()
+{
+    if (!pool_io_)
+        return;
+
+    pool_work_.reset();
+    pool_io_->stop();
+    for (auto& thread : pool_) thread.join();
+    pool_.clear();
+
+    // everything holding sockets must be destroyed before the io_context
+    rudics_server_.reset();
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(routing_mutex_);
+        remote_.clear();
+        connection_to_modem_id_.clear();
+    }
+    pool_io_.reset();
+}
+
+void goby::acomms::IridiumShoreShardedDriver::handle_initiate_transmission(
+    const protobuf::ModemTransmission& orig_msg)
+{
+    process_transmission(orig_msg);
+}
+
+void goby::acomms::IridiumShoreShardedDriver::process_transmission(protobuf::ModemTransmission msg)
+{
+    signal_modify_transmission(&msg);
+
+    if (!msg.has_frame_start())
+        msg.set_frame_start(next_frame_);
+
+    // set the frame size, if not set or if it exceeds the max configured
+    if (!msg.has_max_frame_bytes() || msg.max_frame_bytes() > iridium_driver_cfg().max_frame_size())
+        msg.set_max_frame_bytes(iridium_driver_cfg().max_frame_size());
+
+    signal_data_request(&msg);
+
+    next_frame_ += msg.frame_size();
+
+    if (!(msg.frame_size() == 0 || msg.frame(0).empty()))
+        send(msg);
+}
+
+void goby::acomms::IridiumShoreShardedDriver::do_work()
+{
+    double now = time::SystemClock::now().time_since_epoch() / std::chrono::seconds(1);
+
+    // snapshot so that vehicles calling in are not blocked while we run the MAC
+    std::vector<std::pair<ModemId, std::shared_ptr<RemoteNode>>> remotes;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(routing_mutex_);
+        remotes.assign(remote_.begin(), remote_.end());
+    }
+
+    for (const auto& id_remote : remotes)
+    {
+        ModemId id = id_remote.first;
+        RemoteNode& remote = *id_remote.second;
+
+        bool data_due = false;
+        {
+            std::lock_guard<std::mutex> lock(remote.mutex);
+            if (!remote.on_call)
+                continue;
+
+            // if we're on a call, keep pushing data at the target rate
+            const double send_wait =
+                remote.on_call->last_bytes_sent() /
+                (iridium_driver_cfg().target_bit_rate() / static_cast<double>(BITS_IN_BYTE));
+            data_due =
+                !remote.on_call->bye_sent() && now > (remote.on_call->last_tx_time() + send_wait);
+        }
+
+        // signal_data_request may block, so do not hold the lock
+        if (data_due)
+        {
+            rudics_mac_msg_.set_dest(id);
+            process_transmission(rudics_mac_msg_);
+        }
+
+        bool send_bye = false, hangup = false;
+        std::shared_ptr<StrandedRUDICSConnection> connection;
+        {
+            std::lock_guard<std::mutex> lock(remote.mutex);
+            std::shared_ptr<OnCallBase> on_call = remote.on_call;
+            if (!on_call)
+                continue;
+            connection = remote.connection;
+
+            if (!on_call->bye_sent() &&
+                now > (on_call->last_tx_time() + iridium_driver_cfg().handshake_hangup_seconds()))
+            {
+                send_bye = true;
+                on_call->set_bye_sent(true);
+            }
+
+            if ((on_call->bye_received() && on_call->bye_sent()) ||
+                (now > (on_call->last_rx_tx_time() +
+                        iridium_driver_cfg().hangup_seconds_after_empty())))
+            {
+                hangup = true;
+                remote.on_call.reset();
+            }
+        }
+
+        if (send_bye && connection)
+        {
+            glog.is(DEBUG1) && glog << "Sending bye to " << id << std::endl;
+            connection->write("bye\r");
+        }
+
+        if (hangup)
+        {
+            glog.is(DEBUG1) && glog << "Hanging up " << id << " by disconnecting" << std::endl;
+            if (connection)
+                connection->close();
+            else
+                glog.is(WARN) && glog << "Failed to find connection from ModemId " << id
+                                      << std::endl;
+        }
+    }
+
+    protobuf::ModemTransmission* msg;
+    while (receive_queue_->pop(msg))
+    {
+        std::unique_ptr<protobuf::ModemTransmission> owned_msg(msg);
+        glog.is(DEBUG2) && glog << group(glog_in_group()) << owned_msg->DebugString()
+                                << std::endl;
+        signal_receive(*owned_msg);
+    }
+
+    receive_sbd_mo();
+}
+
+void goby::acomms::IridiumShoreShardedDriver::receive(const protobuf::ModemTransmission& msg)
+{
+    if (msg.type() == protobuf::ModemTransmission::DATA && msg.ack_requested() &&
+        msg.dest() == driver_cfg_.modem_id())
+    {
+        // make any acks immediately (on the connection's strand for RUDICS)
+        protobuf::ModemTransmission ack;
+        ack.set_type(goby::acomms::protobuf::ModemTransmission::ACK);
+        ack.set_src(msg.dest());
+        ack.set_dest(msg.src());
+        ack.set_rate(msg.rate());
+        for (int i = msg.frame_start(), n = msg.frame_size() + msg.frame_start(); i < n; ++i)
+            ack.add_acked_frame(i);
+        send(ack);
+    }
+
+    auto* queued_msg = new protobuf::ModemTransmission(msg);
+    if (!receive_queue_->bounded_push(queued_msg))
+    {
+        delete queued_msg;
+        ++receive_queue_drops_;
+        glog.is(WARN) && glog << "Receive queue full: dropping message from " << msg.src()
+                              << std::endl;
+    }
+}
+
+void goby::acomms::IridiumShoreShardedDriver::send(const protobuf::ModemTransmission& msg)
+{
+    glog.is(DEBUG2) && glog << group(glog_out_group()) << msg.DebugString() << std::endl;
+
+    std::shared_ptr<RemoteNode> remote = find_remote(msg.dest());
+    std::shared_ptr<StrandedRUDICSConnection> connection;
+    bool on_call = false;
+    if (remote)
+    {
+        std::lock_guard<std::mutex> lock(remote->mutex);
+        on_call = static_cast<bool>(remote->on_call);
+        connection = remote->connection;
+    }
+
+    if (msg.rate() == RATE_RUDICS || on_call)
+    {
+        if (!connection)
+        {
+            glog.is(WARN) && glog << "Failed to find connection from ModemId " << msg.dest()
+                                  << std::endl;
+            return;
+        }
+
+        std::string bytes;
+        serialize(&bytes, msg);
+
+        // frame message
+        std::string rudics_packet;
+        serialize_rudics_packet(bytes, &rudics_packet);
+
+        glog.is(DEBUG1) && glog << "RUDICS sending bytes: " << goby::util::hex_encode(rudics_packet)
+                                << std::endl;
+        connection->write(rudics_packet);
+
+        std::lock_guard<std::mutex> lock(remote->mutex);
+        if (remote->on_call)
+        {
+            remote->on_call->set_last_tx_time(time::SystemClock::now().time_since_epoch() /
+                                              std::chrono::seconds(1));
+            remote->on_call->set_last_bytes_sent(rudics_packet.size());
+        }
+    }
+    else if (msg.rate() == RATE_SBD)
+    {
+        auto imei_it = modem_id_to_imei_.find(msg.dest());
+        if (imei_it == modem_id_to_imei_.end())
+        {
+            glog.is(WARN) && glog << "No IMEI configured for destination address " << msg.dest()
+                                  << " so unabled to send SBD message." << std::endl;
+            return;
+        }
+
+        std::string bytes;
+        serialize(&bytes, msg);
+
+        std::string sbd_packet;
+        serialize_rudics_packet(bytes, &sbd_packet);
+
+        // send_sbd_mt() blocks until the DirectIP server confirms, so run it on the pool
+        IMEI imei = imei_it->second;
+        std::string address = iridium_shore_driver_cfg().mt_sbd_server_address();
+        unsigned port = iridium_shore_driver_cfg().mt_sbd_server_port();
+        pool_io_->post([sbd_packet, imei, address, port]() {
+            send_sbd_mt(sbd_packet, imei, address, port);
+        });
+    }
+}
+
+void goby::acomms::IridiumShoreShardedDriver::rudics_connect(
+    std::shared_ptr<StrandedRUDICSConnection> connection)
+{
+    connection->line_signal.connect(
+        boost::bind(&IridiumShoreShardedDriver::rudics_line, this, _1, _2));
+    connection->disconnect_signal.connect(
+        boost::bind(&IridiumShoreShardedDriver::rudics_disconnect, this, _1));
+}
+
+void goby::acomms::IridiumShoreShardedDriver::rudics_disconnect(
+    std::shared_ptr<StrandedRUDICSConnection> connection)
+{
+    std::shared_ptr<RemoteNode> remote;
+    ModemId id = 0;
+    std::size_t remaining = 0;
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(routing_mutex_);
+        auto client_it = connection_to_modem_id_.find(connection.get());
+        if (client_it != connection_to_modem_id_.end())
+        {
+            id = client_it->second;
+            connection_to_modem_id_.erase(client_it);
+            auto remote_it = remote_.find(id);
+            if (remote_it != remote_.end())
+                remote = remote_it->second;
+        }
+        remaining = connection_to_modem_id_.size();
+    }
+
+    if (remote)
+    {
+        {
+            std::lock_guard<std::mutex> lock(remote->mutex);
+            // the vehicle may have already called back in on a new connection
+            if (remote->connection == connection)
+            {
+                remote->connection.reset();
+                remote->on_call.reset();
+            }
+        }
+        glog.is(DEBUG1) && glog << "Disconnecting client for modem id: " << id << "; "
+                                << remaining << " clients remaining." << std::endl;
+    }
+    else
+    {
+        glog.is(DEBUG1) && glog << "Disconnection received from connection that never sent a "
+                                   "Goby message: "
+                                << connection->remote_endpoint_str() << std::endl;
+    }
+}
+
+void goby::acomms::IridiumShoreShardedDriver::rudics_line(
+    const std::string& data, std::shared_ptr<StrandedRUDICSConnection> connection)
+{
+    glog.is(DEBUG1) && glog << "RUDICS received bytes: " << goby::util::hex_encode(data)
+                            << std::endl;
+
+    try
+    {
+        if (data == "goby\r" ||
+            data == "\0goby\r") // sometimes Iridium adds a 0x00 to the start of transmission
+        {
+            glog.is(DEBUG1) && glog << "Detected start of Goby RUDICS connection from "
+                                    << connection->remote_endpoint_str() << std::endl;
+        }
+        else if (data == "bye\r")
+        {
+            ModemId id;
+            std::shared_ptr<RemoteNode> remote;
+            if (find_modem_id(connection.get(), &id))
+                remote = find_remote(id);
+
+            if (remote)
+            {
+                glog.is(DEBUG1) && glog << "Detected bye from " << connection->remote_endpoint_str()
+                                        << " ID: " << id << std::endl;
+                std::lock_guard<std::mutex> lock(remote->mutex);
+                if (remote->on_call)
+                    remote->on_call->set_bye_received(true);
+            }
+            else
+            {
+                glog.is(WARN) &&
+                    glog << "Bye detected from connection we do not have in the routing table: "
+                         << connection->remote_endpoint_str() << std::endl;
+            }
+        }
+        else
+        {
+            std::string decoded_line;
+            parse_rudics_packet(&decoded_line, data);
+
+            protobuf::ModemTransmission modem_msg;
+            parse(decoded_line, &modem_msg);
+
+            glog.is(DEBUG1) && glog << "Received RUDICS message from: " << modem_msg.src()
+                                    << " to: " << modem_msg.dest()
+                                    << " from endpoint: " << connection->remote_endpoint_str()
+                                    << std::endl;
+
+            ModemId id = modem_msg.src();
+            std::shared_ptr<RemoteNode> remote = find_or_create_remote(id);
+            {
+                std::unique_lock<std::shared_timed_mutex> lock(routing_mutex_);
+                connection_to_modem_id_.insert(std::make_pair(connection.get(), id));
+            }
+            {
+                std::lock_guard<std::mutex> lock(remote->mutex);
+                if (remote->connection != connection || !remote->on_call)
+                {
+                    remote->connection = connection;
+                    remote->on_call.reset(new OnCallBase);
+                }
+                remote->on_call->set_last_rx_time(time::SystemClock::now<time::SITime>() /
+                                                  boost::units::si::seconds);
+            }
+
+            receive(modem_msg);
+        }
+    }
+    catch (RudicsPacketException& e)
+    {
+        glog.is(DEBUG1) && glog << warn << "Could not decode packet: " << e.what() << std::endl;
+        connection->add_packet_failure();
+    }
+}
+
+void goby::acomms::IridiumShoreShardedDriver::receive_sbd_mo()
+{
+    poll_sbd_mo(sbd_io_, *mo_sbd_server_, [this](const SBDMOMessageReader& message) {
+        protobuf::ModemTransmission modem_msg;
+        std::string bytes;
+        try
+        {
+            parse_rudics_packet(&bytes, message.body().payload());
+            parse(bytes, &modem_msg);
+
+            auto imei_it = imei_to_modem_id_.find(message.header().imei());
+            if (imei_it != imei_to_modem_id_.end() && imei_it->second != modem_msg.src())
+                glog.is(WARN) && glog << "SBD message from IMEI " << message.header().imei()
+                                      << " (configured as modem id " << imei_it->second
+                                      << ") has source " << modem_msg.src() << std::endl;
+
+            glog.is(DEBUG1) && glog << "Rx SBD ModemTransmission: " << modem_msg.ShortDebugString()
+                                    << std::endl;
+
+            receive(modem_msg);
+        }
+        catch (RudicsPacketException& e)
+        {
+            glog.is(DEBUG1) && glog << warn << "Could not decode SBD packet: " << e.what()
+                                    << std::endl;
+        }
+    });
+}
+
+std::shared_ptr<goby::acomms::IridiumShoreShardedDriver::RemoteNode>
+goby::acomms::IridiumShoreShardedDriver::find_remote(ModemId id) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(routing_mutex_);
+    auto it = remote_.find(id);
+    return it != remote_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<goby::acomms::IridiumShoreShardedDriver::RemoteNode>
+goby::acomms::IridiumShoreShardedDriver::find_or_create_remote(ModemId id)
+{
+    if (auto remote = find_remote(id))
+        return remote;
+
+    std::unique_lock<std::shared_timed_mutex> lock(routing_mutex_);
+    auto& remote = remote_[id];
+    if (!remote)
+        remote = std::make_shared<RemoteNode>();
+    return remote;
+}
+
+bool goby::acomms::IridiumShoreShardedDriver::find_modem_id(
+    const StrandedRUDICSConnection* connection, ModemId* id) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(routing_mutex_);
+    auto it = connection_to_modem_id_.find(connection);
+    if (it == connection_to_modem_id_.end())
+        return false;
+    *id = it->second;
+    return true;
+}
+
+void goby::acomms::IridiumShoreShardedDriver::serialize(std::string* bytes,
+                                                        const protobuf::ModemTransmission& msg)
+{
+    std::lock_guard<std::mutex> lock(dccl_mutex_);
+    serialize_iridium_modem_message(bytes, msg);
+}
+
+void goby::acomms::IridiumShoreShardedDriver::parse(const std::string& bytes,
+                                                    protobuf::ModemTransmission* msg)
+{
+    std::lock_guard<std::mutex> lock(dccl_mutex_);
+    parse_iridium_modem_message(bytes, msg);
+}
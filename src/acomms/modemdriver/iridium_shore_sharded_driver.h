@@ -0,0 +1,148 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef IridiumShoreShardedDriver20201019H
+#define IridiumShoreShardedDriver20201019H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/lockfree/queue.hpp>
+
+#include "goby/acomms/modemdriver/driver_base.h"
+#include "goby/acomms/modemdriver/iridium_driver_common.h"
+#include "goby/acomms/modemdriver/iridium_shore_rudics.h"
+#include "goby/acomms/modemdriver/iridium_shore_sbd.h"
+#include "goby/acomms/protobuf/iridium_driver.pb.h"
+#include "goby/acomms/protobuf/iridium_shore_driver.pb.h"
+
+namespace goby
+{
+namespace acomms
+{
+/// \brief Shore-side Iridium RUDICS/SBD driver for large fleets
+///
+/// Provides the same over-the-air behavior as IridiumShoreDriver. The difference is that all the RUDICS connections, and the (blocking) DirectIP MT SBD sends, are serviced by a pool of ShoreConfig::worker_threads threads. A slow or misbehaving connection therefore does not delay the others. Each connection is serialized on its own strand. Received messages are decoded (and acknowledged) on the pool, then handed to the thread calling do_work() through a lock-free queue, so all ModemDriverBase signals are still emitted from do_work().
+///
+/// ModemId, IMEI and connection routing use hash tables; the per-vehicle call state is guarded by a per-vehicle mutex.
+class IridiumShoreShardedDriver : public ModemDriverBase
+{
+  public:
+    IridiumShoreShardedDriver();
+    ~IridiumShoreShardedDriver() override;
+    void startup(const protobuf::DriverConfig& cfg) override;
+    void shutdown() override;
+    void do_work() override;
+
+    void handle_initiate_transmission(const protobuf::ModemTransmission& m) override;
+    void process_transmission(protobuf::ModemTransmission msg);
+
+    /// \brief Number of received messages dropped because the receive queue (ShoreConfig::receive_queue_capacity) was full
+    std::uint64_t receive_queue_drops() const { return receive_queue_drops_; }
+
+    /// \brief Number of RUDICS connections currently mapped to a remote modem
+    std::size_t rudics_clients() const
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(routing_mutex_);
+        return connection_to_modem_id_.size();
+    }
+
+  private:
+    using ModemId = unsigned;
+    using IMEI = std::string;
+
+    struct RemoteNode
+    {
+        // guards on_call and connection
+        std::mutex mutex;
+        std::shared_ptr<OnCallBase> on_call;
+        std::shared_ptr<StrandedRUDICSConnection> connection;
+    };
+
+    // called on the pool or from do_work(); sends any ack and queues msg for do_work()
+    void receive(const protobuf::ModemTransmission& msg);
+    void send(const protobuf::ModemTransmission& msg);
+    void receive_sbd_mo();
+
+    // pool (connection strand) callbacks
+    void rudics_connect(std::shared_ptr<StrandedRUDICSConnection> connection);
+    void rudics_disconnect(std::shared_ptr<StrandedRUDICSConnection> connection);
+    void rudics_line(const std::string& line,
+                     std::shared_ptr<StrandedRUDICSConnection> connection);
+
+    std::shared_ptr<RemoteNode> find_remote(ModemId id) const;
+    std::shared_ptr<RemoteNode> find_or_create_remote(ModemId id);
+    bool find_modem_id(const StrandedRUDICSConnection* connection, ModemId* id) const;
+
+    // the DCCL codec used for the Iridium header is not thread-safe
+    void serialize(std::string* bytes, const protobuf::ModemTransmission& msg);
+    void parse(const std::string& bytes, protobuf::ModemTransmission* msg);
+
+    void stop_pool();
+
+    const iridium::protobuf::Config& iridium_driver_cfg() const
+    {
+        return driver_cfg_.GetExtension(iridium::protobuf::config);
+    }
+
+    const iridium::protobuf::ShoreConfig& iridium_shore_driver_cfg() const
+    {
+        return driver_cfg_.GetExtension(iridium::protobuf::shore_config);
+    }
+
+  private:
+    protobuf::DriverConfig driver_cfg_;
+    protobuf::ModemTransmission rudics_mac_msg_;
+    std::uint32_t next_frame_{0};
+
+    // routing tables: remote_ and connection_to_modem_id_ change as vehicles call in (guarded by routing_mutex_); the IMEI tables are fixed at startup()
+    mutable std::shared_timed_mutex routing_mutex_;
+    std::unordered_map<ModemId, std::shared_ptr<RemoteNode>> remote_;
+    std::unordered_map<const StrandedRUDICSConnection*, ModemId> connection_to_modem_id_;
+    std::unordered_map<ModemId, IMEI> modem_id_to_imei_;
+    std::unordered_map<IMEI, ModemId> imei_to_modem_id_;
+
+    std::mutex dccl_mutex_;
+
+    // handoff from the pool to do_work(); owns the pointed-to messages
+    std::unique_ptr<boost::lockfree::queue<protobuf::ModemTransmission*>> receive_queue_;
+    std::atomic<std::uint64_t> receive_queue_drops_{0};
+
+    // recreated by each startup() so that no handlers from a previous run remain queued
+    std::unique_ptr<boost::asio::io_context> pool_io_;
+    std::unique_ptr<boost::asio::io_context::work> pool_work_;
+    std::vector<std::thread> pool_;
+    std::unique_ptr<StrandedRUDICSServer> rudics_server_;
+
+    // MO SBD sessions are short and infrequent, so are polled from do_work() as in IridiumShoreDriver
+    boost::asio::io_context sbd_io_;
+    std::shared_ptr<SBDServer> mo_sbd_server_;
+};
+} // namespace acomms
+} // namespace goby
+#endif
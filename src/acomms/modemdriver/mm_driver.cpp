@@ -46,6 +46,7 @@ using goby::util::as;
 using goby::util::hex_decode;
 using goby::util::hex_encode;
 using goby::util::NMEASentence;
+using goby::util::NMEASentenceView;
 using namespace goby::util::tcolor;
 using namespace goby::util::logger;
 using namespace goby::util::logger_lock;
@@ -591,7 +592,7 @@ void goby::acomms::MMDriver::do_work()
         // try to handle the received message, posting appropriate signals
         try
         {
-            NMEASentence nmea(in, NMEASentence::VALIDATE);
+            NMEASentenceView nmea(in, NMEASentence::VALIDATE);
             process_receive(nmea);
         }
         catch (std::exception& e)
@@ -1119,14 +1120,15 @@ void goby::acomms::MMDriver::pop_out()
 // INCOMING NMEA
 //
 
-void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
+void goby::acomms::MMDriver::process_receive(const NMEASentenceView& nmea)
 {
     // need to print this first so raw log messages appear causal (as they are)
     protobuf::ModemRaw raw_msg;
-    raw_msg.set_raw(nmea.message());
+    raw_msg.set_raw(nmea.message().data(), nmea.message().size());
     raw_msg.set_description(description_map_[nmea.front()]);
 
-    if (sentence_id_map_[nmea.sentence_id()] == CFG)
+    SentenceIDs sentence_id = sentence_id_map_[nmea.sentence_id().to_string()];
+    if (sentence_id == CFG)
         *raw_msg.mutable_description() += ":  " + cfg_map_[nmea.at(1)];
 
     glog.is(DEBUG1) && glog << group(glog_in_group()) << hydroid_gateway_modem_prefix_
@@ -1140,7 +1142,7 @@ void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
     global_fail_count_ = 0;
 
     // look at the sentence id (last three characters of the NMEA 0183 talker)
-    switch (sentence_id_map_[nmea.sentence_id()])
+    switch (sentence_id)
     {
         //
         // local modem
@@ -1218,18 +1220,18 @@ void goby::acomms::MMDriver::process_receive(const NMEASentence& nmea)
     }
 }
 
-void goby::acomms::MMDriver::caack(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::caack(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     // ACK has nothing to do with us!
-    if (as<std::int32_t>(nmea[2]) != driver_cfg_.modem_id())
+    if (nmea.as<std::int32_t>(2) != driver_cfg_.modem_id())
         return;
-    if (as<unsigned>(nmea[1]) != expected_ack_destination_)
+    if (nmea.as<unsigned>(1) != expected_ack_destination_)
         return;
 
     // WHOI counts starting at 1, Goby counts starting at 0
-    std::uint32_t frame = as<std::uint32_t>(nmea[3]) - 1;
+    std::uint32_t frame = nmea.as<std::uint32_t>(3) - 1;
 
-    handle_ack(as<std::uint32_t>(nmea[1]), as<std::uint32_t>(nmea[2]), frame, m);
+    handle_ack(nmea.as<std::uint32_t>(1), nmea.as<std::uint32_t>(2), frame, m);
 
     // if enabled cacst will signal_receive
     if (!nvram_cfg_["CST"])
@@ -1260,7 +1262,7 @@ void goby::acomms::MMDriver::handle_ack(std::uint32_t src, std::uint32_t dest, s
     }
 }
 
-void goby::acomms::MMDriver::camer(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::camer(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     int src_field = 1;
     int dest_field = 2;
@@ -1272,13 +1274,13 @@ void goby::acomms::MMDriver::camer(const NMEASentence& nmea, protobuf::ModemTran
         dest_field = 1;
     }
 
-    if (as<std::int32_t>(nmea[dest_field]) != driver_cfg_.modem_id())
+    if (nmea.as<std::int32_t>(dest_field) != driver_cfg_.modem_id())
         return;
 
     m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
     // I think these are reversed from what the manual states
-    m->set_src(as<std::uint32_t>(nmea[src_field]));
-    m->set_dest(as<std::uint32_t>(nmea[dest_field]));
+    m->set_src(nmea.as<std::uint32_t>(src_field));
+    m->set_dest(nmea.as<std::uint32_t>(dest_field));
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)
         ->set_type(micromodem::protobuf::MICROMODEM_HARDWARE_CONTROL_REPLY);
@@ -1295,7 +1297,7 @@ void goby::acomms::MMDriver::camer(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
+void goby::acomms::MMDriver::cadrq(const NMEASentenceView& nmea_in,
                                    const protobuf::ModemTransmission& m)
 {
     //$CADRQ,HHMMSS,SRC,DEST,ACK,N,F#*CS
@@ -1303,7 +1305,7 @@ void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
     NMEASentence nmea_out("$CCTXD", NMEASentence::IGNORE);
 
     // WHOI counts frames from 1, we count from 0
-    int frame = as<int>(nmea_in[6]) - 1;
+    int frame = nmea_in.as<int>(6) - 1;
 
     if (frame < m.frame_size() && !m.frame(frame).empty())
     {
@@ -1326,15 +1328,15 @@ void goby::acomms::MMDriver::cadrq(const NMEASentence& nmea_in,
     else
     {
         // send a blank message to supress further DRQ
-        nmea_out.push_back(nmea_in[2]); // SRC
-        nmea_out.push_back(nmea_in[3]); // DEST
-        nmea_out.push_back(nmea_in[4]); // ACK
+        nmea_out.push_back(nmea_in[2].to_string()); // SRC
+        nmea_out.push_back(nmea_in[3].to_string()); // DEST
+        nmea_out.push_back(nmea_in[4].to_string()); // ACK
         nmea_out.push_back("");         // no data
     }
     append_to_write_queue(nmea_out);
 }
 
-void goby::acomms::MMDriver::camsg(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::camsg(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     // CAMSG,BAD_CRC,4
     if ((nmea.as<std::string>(1) == "BAD_CRC" || nmea.as<std::string>(1) == "Bad CRC") &&
@@ -1356,17 +1358,17 @@ void goby::acomms::MMDriver::camsg(const NMEASentence& nmea, protobuf::ModemTran
     }
 }
 
-void goby::acomms::MMDriver::carxd(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::carxd(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     // WHOI counts from 1, we count from 0
-    unsigned frame = as<std::uint32_t>(nmea[4]) - 1;
+    unsigned frame = nmea.as<std::uint32_t>(4) - 1;
     if (frame == 0)
     {
         m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
-        m->set_src(as<std::uint32_t>(nmea[1]));
-        m->set_dest(as<std::uint32_t>(nmea[2]));
+        m->set_src(nmea.as<std::uint32_t>(1));
+        m->set_dest(nmea.as<std::uint32_t>(2));
         m->set_type(protobuf::ModemTransmission::DATA);
-        m->set_ack_requested(as<bool>(nmea[3]));
+        m->set_ack_requested(nmea.as<bool>(3));
     }
 
     if (!nmea[5].empty()) // don't add blank messages
@@ -1391,13 +1393,13 @@ void goby::acomms::MMDriver::carxd(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::camua(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::camua(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     //    m->Clear();
 
     m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
-    m->set_src(as<std::uint32_t>(nmea[1]));
-    m->set_dest(as<std::uint32_t>(nmea[2]));
+    m->set_src(nmea.as<std::uint32_t>(1));
+    m->set_dest(nmea.as<std::uint32_t>(2));
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)
         ->set_type(micromodem::protobuf::MICROMODEM_MINI_DATA);
@@ -1413,7 +1415,7 @@ void goby::acomms::MMDriver::camua(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::cardp(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::cardp(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     enum
     {
@@ -1427,9 +1429,9 @@ void goby::acomms::MMDriver::cardp(const NMEASentence& nmea, protobuf::ModemTran
     };
 
     m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
-    m->set_src(as<std::uint32_t>(nmea[SRC]));
-    m->set_dest(as<std::uint32_t>(nmea[DEST]));
-    m->set_rate(as<std::uint32_t>(nmea[RATE]));
+    m->set_src(nmea.as<std::uint32_t>(SRC));
+    m->set_dest(nmea.as<std::uint32_t>(DEST));
+    m->set_rate(nmea.as<std::uint32_t>(RATE));
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)
         ->set_type(micromodem::protobuf::MICROMODEM_FLEXIBLE_DATA);
@@ -1533,12 +1535,12 @@ void goby::acomms::MMDriver::process_incoming_app_ack(protobuf::ModemTransmissio
     }
 }
 
-void goby::acomms::MMDriver::cacfg(const NMEASentence& nmea)
+void goby::acomms::MMDriver::cacfg(const NMEASentenceView& nmea)
 {
     nvram_cfg_[nmea[1]] = nmea.as<int>(2);
 }
 
-void goby::acomms::MMDriver::receive_time(const NMEASentence& nmea, SentenceIDs sentence_id)
+void goby::acomms::MMDriver::receive_time(const NMEASentenceView& nmea, SentenceIDs sentence_id)
 {
     if (out_.empty() || (sentence_id == CLK && out_.front().sentence_id() != "CLK") ||
         (sentence_id == TMS && out_.front().sentence_id() != "TMS") ||
@@ -1563,7 +1565,7 @@ void goby::acomms::MMDriver::receive_time(const NMEASentence& nmea, SentenceIDs
         else if (sentence_id == TMQ)
             time_field = 1;
 
-        std::string t = nmea.at(time_field).substr(0, nmea.at(time_field).size() - 1);
+        std::string t = nmea.at(time_field).substr(0, nmea.at(time_field).size() - 1).to_string();
         boost::posix_time::time_input_facet* tif = new boost::posix_time::time_input_facet;
         tif->set_iso_extended_format();
         std::istringstream iso_time(t);
@@ -1601,7 +1603,7 @@ void goby::acomms::MMDriver::receive_time(const NMEASentence& nmea, SentenceIDs
     }
 }
 
-void goby::acomms::MMDriver::caxst(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::caxst(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     micromodem::protobuf::TransmitStatistics* xst =
         m->MutableExtension(micromodem::protobuf::transmission)->add_transmit_stat();
@@ -1659,7 +1661,7 @@ void goby::acomms::MMDriver::caxst(const NMEASentence& nmea, protobuf::ModemTran
 
         clk_mode_ = xst->clock_mode();
     }
-    catch (std::out_of_range& e) // thrown by std::vector::at() called by NMEASentence::as()
+    catch (std::out_of_range& e) // thrown by NMEASentenceView::at() called by as()
     {
         glog.is(DEBUG1) && glog << group(glog_in_group()) << warn
                                 << "$CAXST message shorter than expected" << std::endl;
@@ -1676,20 +1678,20 @@ void goby::acomms::MMDriver::caxst(const NMEASentence& nmea, protobuf::ModemTran
     }
 }
 
-void goby::acomms::MMDriver::campr(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::campr(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
 
     // $CAMPR,SRC,DEST,TRAVELTIME*CS
     // reverse src and dest so they match the original request
-    m->set_src(as<std::uint32_t>(nmea[1]));
-    m->set_dest(as<std::uint32_t>(nmea[2]));
+    m->set_src(nmea.as<std::uint32_t>(1));
+    m->set_dest(nmea.as<std::uint32_t>(2));
 
     micromodem::protobuf::RangingReply* ranging_reply =
         m->MutableExtension(micromodem::protobuf::transmission)->mutable_ranging_reply();
 
     if (nmea.size() > 3)
-        ranging_reply->add_one_way_travel_time(as<double>(nmea[3]));
+        ranging_reply->add_one_way_travel_time(nmea.as<double>(3));
 
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)
@@ -1706,13 +1708,13 @@ void goby::acomms::MMDriver::campr(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::campa(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::campa(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     m->set_time_with_units(time::SystemClock::now<time::MicroTime>());
 
     // $CAMPR,SRC,DEST*CS
-    m->set_src(as<std::uint32_t>(nmea[1]));
-    m->set_dest(as<std::uint32_t>(nmea[2]));
+    m->set_src(nmea.as<std::uint32_t>(1));
+    m->set_dest(nmea.as<std::uint32_t>(2));
 
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)
@@ -1723,17 +1725,17 @@ void goby::acomms::MMDriver::campa(const NMEASentence& nmea, protobuf::ModemTran
         signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::sntta(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::sntta(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     //    m->Clear();
 
     micromodem::protobuf::RangingReply* ranging_reply =
         m->MutableExtension(micromodem::protobuf::transmission)->mutable_ranging_reply();
 
-    ranging_reply->add_one_way_travel_time(as<double>(nmea[1]));
-    ranging_reply->add_one_way_travel_time(as<double>(nmea[2]));
-    ranging_reply->add_one_way_travel_time(as<double>(nmea[3]));
-    ranging_reply->add_one_way_travel_time(as<double>(nmea[4]));
+    ranging_reply->add_one_way_travel_time(nmea.as<double>(1));
+    ranging_reply->add_one_way_travel_time(nmea.as<double>(2));
+    ranging_reply->add_one_way_travel_time(nmea.as<double>(3));
+    ranging_reply->add_one_way_travel_time(nmea.as<double>(4));
 
     m->set_type(protobuf::ModemTransmission::DRIVER_SPECIFIC);
     m->MutableExtension(micromodem::protobuf::transmission)->set_type(last_lbl_type_);
@@ -1754,7 +1756,7 @@ void goby::acomms::MMDriver::sntta(const NMEASentence& nmea, protobuf::ModemTran
     signal_receive_and_clear(m);
 }
 
-void goby::acomms::MMDriver::carev(const NMEASentence& nmea)
+void goby::acomms::MMDriver::carev(const NMEASentenceView& nmea)
 {
     if (nmea[2] == "INIT")
     {
@@ -1790,7 +1792,7 @@ void goby::acomms::MMDriver::carev(const NMEASentence& nmea)
     }
 }
 
-void goby::acomms::MMDriver::caerr(const NMEASentence& nmea)
+void goby::acomms::MMDriver::caerr(const NMEASentenceView& nmea)
 {
     glog.is(DEBUG1) && glog << group(glog_out_group()) << warn
                             << "Micro-Modem reports error: " << nmea.message() << std::endl;
@@ -1811,10 +1813,10 @@ void goby::acomms::MMDriver::caerr(const NMEASentence& nmea)
     }
 }
 
-void goby::acomms::MMDriver::cacyc(const NMEASentence& nmea, protobuf::ModemTransmission* msg)
+void goby::acomms::MMDriver::cacyc(const NMEASentenceView& nmea, protobuf::ModemTransmission* msg)
 {
     // we're sending
-    if (as<std::int32_t>(nmea[2]) == driver_cfg_.modem_id())
+    if (nmea.as<std::int32_t>(2) == driver_cfg_.modem_id())
     {
         // handle a third-party CYC
         if (!local_cccyc_)
@@ -1826,10 +1828,10 @@ void goby::acomms::MMDriver::cacyc(const NMEASentence& nmea, protobuf::ModemTran
 
             msg->set_time_with_units(time::SystemClock::now<time::MicroTime>());
 
-            msg->set_src(as<std::uint32_t>(nmea[2]));            // ADR1
-            msg->set_dest(as<std::uint32_t>(nmea[3]));           // ADR2
-            msg->set_rate(as<std::uint32_t>(nmea[4]));           // Rate
-            msg->set_max_num_frames(as<std::uint32_t>(nmea[6])); // Npkts, number of packets
+            msg->set_src(nmea.as<std::uint32_t>(2));            // ADR1
+            msg->set_dest(nmea.as<std::uint32_t>(3));           // ADR2
+            msg->set_rate(nmea.as<std::uint32_t>(4));           // Rate
+            msg->set_max_num_frames(nmea.as<std::uint32_t>(6)); // Npkts, number of packets
             msg->set_max_frame_bytes(PACKET_SIZE[msg->rate()]);
 
             cache_outgoing_data(msg);
@@ -1842,7 +1844,7 @@ void goby::acomms::MMDriver::cacyc(const NMEASentence& nmea, protobuf::ModemTran
     // we're receiving
     else
     {
-        unsigned rate = as<std::uint32_t>(nmea[4]);
+        unsigned rate = nmea.as<std::uint32_t>(4);
         if (local_cccyc_ && rate != 0) // clear flag for next cycle
         {
             // if we poll for rates > 0, we get *two* CACYC - the one from the poll and the one from the message
@@ -1851,7 +1853,7 @@ void goby::acomms::MMDriver::cacyc(const NMEASentence& nmea, protobuf::ModemTran
             return;
         }
 
-        unsigned num_frames = as<std::uint32_t>(nmea[6]);
+        unsigned num_frames = nmea.as<std::uint32_t>(6);
         if (!frames_waiting_to_receive_.empty())
         {
             glog.is(DEBUG1) && glog << group(glog_out_group()) << warn << "flushing "
@@ -1864,7 +1866,7 @@ void goby::acomms::MMDriver::cacyc(const NMEASentence& nmea, protobuf::ModemTran
 
         // if rate 0 and we didn't send the CCCYC, we have two cacsts (one for the cacyc and one for the carxd)
         // otherwise, we have one
-        expected_remaining_cacst_ = (as<std::int32_t>(nmea[4]) == 0 && !local_cccyc_) ? 1 : 0;
+        expected_remaining_cacst_ = (nmea.as<std::int32_t>(4) == 0 && !local_cccyc_) ? 1 : 0;
 
         local_cccyc_ = false;
     }
@@ -1972,7 +1974,7 @@ void goby::acomms::MMDriver::validate_transmission_start(const protobuf::ModemTr
         throw("ModemTransmission::rate is invalid: " + as<std::string>(message.rate()));
 }
 
-void goby::acomms::MMDriver::cacst(const NMEASentence& nmea, protobuf::ModemTransmission* m)
+void goby::acomms::MMDriver::cacst(const NMEASentenceView& nmea, protobuf::ModemTransmission* m)
 {
     micromodem::protobuf::ReceiveStatistics* cst =
         m->MutableExtension(micromodem::protobuf::transmission)->add_receive_stat();
@@ -2106,7 +2108,7 @@ void goby::acomms::MMDriver::cacst(const NMEASentence& nmea, protobuf::ModemTran
         cst->set_carrier_freq(nmea.as<double>(28 + version_offset));
         cst->set_bandwidth(nmea.as<double>(29 + version_offset));
     }
-    catch (std::out_of_range& e) // thrown by std::vector::at() called by NMEASentence::as()
+    catch (std::out_of_range& e) // thrown by NMEASentenceView::at() called by as()
     {
         glog.is(DEBUG1) && glog << group(glog_in_group()) << warn
                                 << "$CACST message shorter than expected" << std::endl;
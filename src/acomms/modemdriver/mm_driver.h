@@ -166,40 +166,40 @@ class MMDriver : public ModemDriverBase
 
     // input
     void process_receive(
-        const util::NMEASentence& nmea); // parse a receive message and call proper method
+        const util::NMEASentenceView& nmea); // parse a receive message and call proper method
 
     // data cycle
-    void cacyc(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CACYC
-    void carxd(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CARXD
-    void camsg(const util::NMEASentence& nmea, protobuf::ModemTransmission* m);
+    void cacyc(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CACYC
+    void carxd(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CARXD
+    void camsg(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* m);
 
-    void caack(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAACK
+    void caack(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAACK
     void handle_ack(std::uint32_t src, std::uint32_t dest, std::uint32_t frame,
                     protobuf::ModemTransmission* m);
 
     // mini packet
-    void camua(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAMUA
+    void camua(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAMUA
 
     // flexible data protocol
-    void cardp(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CARDP
+    void cardp(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CARDP
 
     // ranging (pings)
-    void campr(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAMPR
-    void campa(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAMPA
-    void sntta(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $SNTTA
+    void campr(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAMPR
+    void campa(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAMPA
+    void sntta(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $SNTTA
 
     // hardware control
-    void camer(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAMER
+    void camer(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAMER
 
     // local modem
-    void caxst(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CAXST
-    void cacst(const util::NMEASentence& nmea, protobuf::ModemTransmission* msg); // $CACST
-    void carev(const util::NMEASentence& nmea);                                   // $CAREV
-    void caerr(const util::NMEASentence& nmea);                                   // $CAERR
-    void cacfg(const util::NMEASentence& nmea);
-    void receive_time(const util::NMEASentence& nmea, SentenceIDs sentence_id);       // $CACLK
-    void catms(const util::NMEASentence& nmea);                                       // $CATMS
-    void cadrq(const util::NMEASentence& nmea, const protobuf::ModemTransmission& m); // $CADRQ
+    void caxst(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CAXST
+    void cacst(const util::NMEASentenceView& nmea, protobuf::ModemTransmission* msg); // $CACST
+    void carev(const util::NMEASentenceView& nmea);                                   // $CAREV
+    void caerr(const util::NMEASentenceView& nmea);                                   // $CAERR
+    void cacfg(const util::NMEASentenceView& nmea);
+    void receive_time(const util::NMEASentenceView& nmea, SentenceIDs sentence_id);       // $CACLK
+    void catms(const util::NMEASentenceView& nmea);                                       // $CATMS
+    void cadrq(const util::NMEASentenceView& nmea, const protobuf::ModemTransmission& m); // $CADRQ
 
     void validate_transmission_start(const protobuf::ModemTransmission& message);
 
@@ -92,6 +92,14 @@ class Queue
 
     size_t size() const { return messages_.size(); }
 
+    // sum of the encoded sizes of the queued messages
+    size_t bytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& msg : messages_) bytes += msg.meta.non_repeated_size();
+        return bytes;
+    }
+
     boost::posix_time::ptime last_send_time() const { return last_send_time_; }
 
     boost::posix_time::ptime newest_msg_time() const
@@ -102,6 +102,14 @@ class QueueManager
     ///
     /// \param flush QueueFlush object containing details about queue to flush
     void flush_queue(const protobuf::QueueFlush& flush);
+
+    /// \brief Number of bytes (encoded) of all the messages queued, e.g. for MACManager::signal_queue_depth_request
+    std::size_t bytes() const
+    {
+        std::size_t bytes = 0;
+        for (const auto& q_pair : queues_) bytes += q_pair.second->bytes();
+        return bytes;
+    }
     //@}
 
     /// \name Modem Slots
@@ -1,5 +1,6 @@
 protobuf_generate_cpp(ACOMMS_PROTO_SRCS ACOMMS_PROTO_HDRS
   acomms/protobuf/abc_driver.proto
+  acomms/protobuf/acoustic_sim_driver.proto
   acomms/protobuf/amac_config.proto
   acomms/protobuf/amac.proto
   acomms/protobuf/benthos_atm900.proto
@@ -33,6 +34,8 @@ set(ACOMMS_SRC
   acomms/queue/queue_manager.cpp
   acomms/amac/mac_manager.cpp
   acomms/modemdriver/abc_driver.cpp
+  acomms/modemdriver/acoustic_sim_channel.cpp
+  acomms/modemdriver/acoustic_sim_driver.cpp
   acomms/modemdriver/driver_base.cpp
   acomms/modemdriver/mm_driver.cpp
   acomms/modemdriver/udp_driver.cpp
@@ -41,6 +44,8 @@ set(ACOMMS_SRC
   acomms/modemdriver/iridium_driver.cpp
   acomms/modemdriver/iridium_driver_fsm.cpp
   acomms/modemdriver/iridium_shore_driver.cpp
+  acomms/modemdriver/iridium_shore_sbd.cpp
+  acomms/modemdriver/iridium_shore_sharded_driver.cpp
   acomms/modemdriver/benthos_atm900_driver.cpp
   acomms/modemdriver/benthos_atm900_driver_fsm.cpp
   acomms/route/route.cpp
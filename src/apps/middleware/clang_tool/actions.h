@@ -55,6 +55,15 @@ struct VisualizeParameters
 };
 
 int visualize(const std::vector<std::string>& ymls, const VisualizeParameters& params);
+
+struct TopologyParameters
+{
+    std::string output_directory;
+    std::string output_file;
+    std::string deployment;
+};
+
+int topology(const std::vector<std::string>& ymls, const TopologyParameters& params);
 } // namespace clang
 } // namespace goby
 
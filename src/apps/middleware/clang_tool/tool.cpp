@@ -51,15 +51,23 @@ static cl::opt<bool> Visualize(
     cl::desc("Run visualize action (create GraphViz DOT files from multiple YML interface files)"),
     cl::cat(Goby3ToolCategory));
 
+static cl::opt<bool> Topology(
+    "topology",
+    cl::desc("Run topology action (create C++ header for goby::middleware::StaticTopology, "
+             "which drops interthread publications without subscribers, from multiple YML "
+             "interface files)"),
+    cl::cat(Goby3ToolCategory));
+
 static cl::opt<std::string>
-    OutDir("outdir", cl::desc("Specify output directory for '-viz' and '-gen' actions"),
+    OutDir("outdir",
+           cl::desc("Specify output directory for '-viz', '-gen', and '-topology' actions"),
            cl::value_desc("dir"), cl::init("."), cl::cat(Goby3ToolCategory));
 
 static cl::opt<std::string>
     OutFile("o",
             cl::desc("Specify output file name (optional, defaults to {target}_interface.yml for "
-                     "-gen and {deployment}.dot for -viz)"),
-            cl::value_desc("file.[yml|dot]"), cl::cat(Goby3ToolCategory));
+                     "-gen, {deployment}.dot for -viz, and {deployment}_topology.h for -topology)"),
+            cl::value_desc("file.[yml|dot|h]"), cl::cat(Goby3ToolCategory));
 
 static cl::opt<std::string> Target("target",
                                    cl::desc("Specify target (binary) name for '-gen' action"),
@@ -67,8 +75,8 @@ static cl::opt<std::string> Target("target",
 
 static cl::opt<std::string>
     Deployment("deployment",
-               cl::desc("Specify deployment name for '-viz' action that summarizes the collection "
-                        "of yml files or the path to a deployment yml file"),
+               cl::desc("Specify deployment name for '-viz' or '-topology' action that summarizes "
+                        "the collection of yml files or the path to a deployment yml file"),
                cl::value_desc("name"), cl::cat(Goby3ToolCategory));
 
 static cl::opt<bool> OmitDisconnected(
@@ -122,9 +130,14 @@ int main(int argc, const char** argv)
 
         return goby::clang::visualize(SharedOptionsParser.getSourcePathList(), params);
     }
+    else if (Topology)
+    {
+        goby::clang::TopologyParameters params{OutDir, OutFile, Deployment};
+        return goby::clang::topology(SharedOptionsParser.getSourcePathList(), params);
+    }
     else
     {
-        std::cerr << "Must specify an action (e.g. -gen or -viz)" << std::endl;
+        std::cerr << "Must specify an action (e.g. -gen, -viz, or -topology)" << std::endl;
         exit(EXIT_FAILURE);
     }
 }
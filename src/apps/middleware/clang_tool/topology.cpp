@@ -0,0 +1,241 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+
+#include <boost/algorithm/string.hpp>
+
+#include "actions.h"
+
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+struct ApplicationTopology
+{
+    // group -> threads publishing (directly) on interthread
+    std::map<std::string, std::set<std::string>> interthread_publishers;
+    // group -> threads subscribing, including forwarded subscriptions from outer layers (which are delivered via interthread)
+    std::map<std::string, std::set<std::string>> subscribers;
+    // group string (without numeric part) -> threads subscribing with a numeric value only known at run time (e.g. Group{"foo", vehicle_id}), which may match any numeric value
+    std::map<std::string, std::set<std::string>> any_numeric_subscribers;
+    // threads with a subscription whose group could not be determined, which may match any group
+    std::set<std::string> unresolved_subscribers;
+};
+
+bool is_literal(const std::string& numeric)
+{
+    return !numeric.empty() && std::all_of(numeric.begin(), numeric.end(), ::isdigit);
+}
+
+bool is_unresolved(const std::string& group) { return group.empty() || group == "unknown"; }
+
+// match the string produced at run time by goby::middleware::Group::operator std::string()
+// (a non-literal numeric part is kept as written, as it may also be part of the group string)
+std::string runtime_group(std::string group)
+{
+    auto pos = group.rfind("::");
+    // invalid_numeric_group: run time string is just the c_str()
+    if (pos != std::string::npos && group.substr(pos + 2) == "255")
+        group = group.substr(0, pos);
+    return group;
+}
+
+std::string identifier(std::string s)
+{
+    for (auto& c : s)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)))
+            c = '_';
+    }
+    if (s.empty() || std::isdigit(static_cast<unsigned char>(s[0])))
+        s = "_" + s;
+    return s;
+}
+
+std::string join(const std::set<std::string>& threads)
+{
+    return boost::algorithm::join(threads, ", ");
+}
+
+void add_subscribers(const YAML::Node& subscribes_node, const std::string& default_thread,
+                     ApplicationTopology& topology)
+{
+    for (const auto& s : subscribes_node)
+    {
+        std::string thread =
+            s["thread"] ? s["thread"].as<std::string>() : default_thread;
+        std::string group = s["group"] ? s["group"].as<std::string>() : std::string();
+
+        if (is_unresolved(group))
+        {
+            topology.unresolved_subscribers.insert(thread);
+            continue;
+        }
+
+        topology.subscribers[runtime_group(group)].insert(thread);
+
+        auto pos = group.rfind("::");
+        if (pos != std::string::npos && !is_literal(group.substr(pos + 2)))
+            topology.any_numeric_subscribers[group.substr(0, pos)].insert(thread);
+    }
+}
+
+// all the threads that may subscribe to the (run time) publication group
+std::set<std::string> subscribers(const std::string& group, const ApplicationTopology& topology)
+{
+    std::set<std::string> threads(topology.unresolved_subscribers);
+
+    auto add = [&](const std::map<std::string, std::set<std::string>>& m, const std::string& g) {
+        auto it = m.find(g);
+        if (it != m.end())
+            threads.insert(it->second.begin(), it->second.end());
+    };
+
+    add(topology.subscribers, group);
+    // a run time numeric value of invalid_numeric_group gives just the group string
+    add(topology.any_numeric_subscribers, group);
+    auto pos = group.rfind("::");
+    if (pos != std::string::npos)
+        add(topology.any_numeric_subscribers, group.substr(0, pos));
+
+    return threads;
+}
+
+} // namespace
+
+int goby::clang::topology(const std::vector<std::string>& yamls, const TopologyParameters& params)
+{
+    std::map<std::string, ApplicationTopology> applications;
+
+    for (const auto& yaml_file : yamls)
+    {
+        YAML::Node yaml;
+        try
+        {
+            yaml = YAML::LoadFile(yaml_file);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to parse " << yaml_file << ": " << e.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        auto& app = applications[yaml["application"].as<std::string>()];
+
+        for (const auto& layer : {"interprocess", "intermodule", "intervehicle"})
+        {
+            auto layer_node = yaml[layer];
+            if (layer_node && layer_node["subscribes"])
+                add_subscribers(layer_node["subscribes"], "unknown", app);
+        }
+
+        auto interthread_node = yaml["interthread"];
+        if (interthread_node)
+        {
+            for (const auto& thread_node : interthread_node["threads"])
+            {
+                auto thread = thread_node["name"].as<std::string>();
+                add_subscribers(thread_node["subscribes"], thread, app);
+
+                for (const auto& p : thread_node["publishes"])
+                {
+                    // publications made to interthread by an outer layer don't use the static interthread publish
+                    if (p["inner"] && p["inner"].as<bool>())
+                        continue;
+                    std::string group = p["group"] ? p["group"].as<std::string>() : std::string();
+                    // cannot be matched to the run time group, so is left out (always delivered)
+                    if (is_unresolved(group))
+                        continue;
+                    app.interthread_publishers[runtime_group(group)].insert(thread);
+                }
+            }
+        }
+    }
+
+    std::string name = params.deployment.empty() ? "goby" : params.deployment;
+    std::string output_file =
+        params.output_file.empty() ? name + "_topology.h" : params.output_file;
+    std::string file_name(params.output_directory + "/" + output_file);
+    std::ofstream ofs(file_name.c_str());
+    if (!ofs.is_open())
+    {
+        std::cerr << "Failed to open " << file_name << " for writing" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::string guard = boost::algorithm::to_upper_copy(identifier(name)) + "_TOPOLOGY_H";
+    ofs << "// Generated by goby_clang_tool -topology from:\n";
+    for (const auto& yaml_file : yamls) ofs << "//   " << yaml_file << "\n";
+    ofs << "// Do not edit; regenerate when the interface files change.\n\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include <string>\n\n"
+        << "#include \"goby/middleware/transport/static_topology.h\"\n\n"
+        << "namespace goby_topology\n{\nnamespace " << identifier(name) << "\n{\n";
+
+    for (const auto& app_p : applications)
+    {
+        const auto& app = app_p.second;
+        int dead = 0;
+        for (const auto& pub_p : app.interthread_publishers)
+            dead += subscribers(pub_p.first, app).empty() ? 1 : 0;
+
+        if (!app.unresolved_subscribers.empty())
+            std::cerr << "Warning: " << app_p.first << " has subscriptions with unresolved groups ("
+                      << join(app.unresolved_subscribers)
+                      << "), so none of its publications will be dropped" << std::endl;
+
+        ofs << "/// " << app_p.first << ": " << app.interthread_publishers.size()
+            << " interthread route(s), " << dead << " without subscribers\n"
+            << "inline void load_" << identifier(app_p.first) << "()\n{\n"
+            << "    goby::middleware::StaticTopology::load({\n";
+
+        for (const auto& pub_p : app.interthread_publishers)
+        {
+            auto threads = subscribers(pub_p.first, app);
+            ofs << "        {\"" << pub_p.first << "\", " << threads.size() << "}, // "
+                << join(pub_p.second) << " -> "
+                << (threads.empty() ? std::string("(none)") : join(threads)) << "\n";
+        }
+        ofs << "    });\n}\n\n";
+    }
+
+    ofs << "/// Load the topology for the given application name (returns false if unknown)\n"
+        << "inline bool load(const std::string& application)\n{\n";
+    for (const auto& app_p : applications)
+    {
+        ofs << "    if (application == \"" << app_p.first << "\")\n"
+            << "    {\n        load_" << identifier(app_p.first) << "();\n"
+            << "        return true;\n    }\n";
+    }
+    ofs << "    return false;\n}\n\n"
+        << "} // namespace " << identifier(name) << "\n} // namespace goby_topology\n\n#endif\n";
+
+    std::cout << "Wrote " << file_name << std::endl;
+    return 0;
+}
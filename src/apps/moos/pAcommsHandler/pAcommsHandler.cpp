@@ -22,8 +22,10 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <cctype>
 #include <dlfcn.h>
+#include <limits>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -31,9 +33,11 @@
 #include <boost/math/special_functions/fpclassify.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
+#include "goby/acomms/modemdriver/acoustic_sim_driver.h"
 #include "goby/acomms/modemdriver/benthos_atm900_driver.h"
 #include "goby/acomms/modemdriver/iridium_driver.h"
 #include "goby/acomms/modemdriver/iridium_shore_driver.h"
+#include "goby/acomms/modemdriver/iridium_shore_sharded_driver.h"
 #include "goby/acomms/modemdriver/udp_driver.h"
 #include "goby/middleware/protobuf/frontseat.pb.h"
 #include "goby/moos/moos_bluefin_driver.h"
@@ -111,6 +115,12 @@ goby::apps::moos::CpAcommsHandler::CpAcommsHandler()
     goby::acomms::connect(&queue_manager_.signal_data_on_demand, this,
                           &CpAcommsHandler::handle_encode_on_demand);
 
+    // demand advertised to the other nodes by MAC_ADAPTIVE_DECENTRALIZED
+    mac_.signal_queue_depth_request.connect([this](std::uint32_t* queue_depth) {
+        *queue_depth = std::min<std::size_t>(queue_manager_.bytes(),
+                                             std::numeric_limits<std::uint32_t>::max());
+    });
+
     process_configuration();
 
     driver_bind();
@@ -620,6 +630,14 @@ void goby::apps::moos::CpAcommsHandler::create_driver(
                 driver.reset(new goby::acomms::IridiumShoreDriver);
                 break;
 
+            case goby::acomms::protobuf::DRIVER_IRIDIUM_SHORE_SHARDED:
+                driver.reset(new goby::acomms::IridiumShoreShardedDriver);
+                break;
+
+            case goby::acomms::protobuf::DRIVER_ACOUSTIC_SIM:
+                driver.reset(new goby::acomms::AcousticSimDriver);
+                break;
+
             case goby::acomms::protobuf::DRIVER_NONE: break;
         }
     }
@@ -22,6 +22,7 @@
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "goby/middleware/coroner/groups.h"
+#include "goby/middleware/coroner/liveness.h"
 #include "goby/middleware/marshalling/protobuf.h"
 #include "goby/middleware/protobuf/coroner.pb.h"
 #include "goby/zeromq/application/single_thread.h"
@@ -44,9 +45,25 @@ class Coroner : public goby::zeromq::SingleThreadApplication<protobuf::CoronerCo
           request_interval_(goby::time::convert_duration<decltype(request_interval_)>(
               cfg().request_interval_with_units())),
           response_timeout_(goby::time::convert_duration<decltype(response_timeout_)>(
-              cfg().response_timeout_with_units()))
+              cfg().response_timeout_with_units())),
+          heartbeat_interval_(
+              cfg().has_heartbeat_interval()
+                  ? goby::time::convert_duration<decltype(heartbeat_interval_)>(
+                        cfg().heartbeat_interval_with_units())
+                  : goby::time::convert_duration<decltype(heartbeat_interval_)>(
+                        cfg().detection_latency_with_units()) /
+                        cfg().heartbeat_missed_limit()),
+          heartbeat_timeout_(heartbeat_interval_ * cfg().heartbeat_missed_limit()),
+          liveness_(heartbeat_timeout_, request_interval_ + response_timeout_,
+                    heartbeat_interval_ / 2)
     {
-        for (const std::string& expected : cfg().expected_name()) tracked_names_.insert(expected);
+        for (const std::string& expected : cfg().expected_name())
+        {
+            tracked_names_.insert(expected);
+            // expected processes that never report are declared dead after response_timeout
+            if (push_mode())
+                liveness_.expect(expected, goby::time::SystemClock::now());
+        }
 
         interprocess()
             .subscribe<middleware::groups::health_response,
@@ -55,19 +72,49 @@ class Coroner : public goby::zeromq::SingleThreadApplication<protobuf::CoronerCo
                     glog.is_debug1() && glog << "Received response: " << response.ShortDebugString()
                                              << std::endl;
                     responses_[response.name()] = response;
-                    if (!tracked_names_.count(response.name()))
+                    track(response.name());
+
+                    if (push_mode())
                     {
-                        glog.is_verbose() &&
-                            glog << "Tracking new process name: " << response.name() << std::endl;
-                        tracked_names_.insert(response.name());
+                        if (liveness_.response(response.name(), goby::time::SystemClock::now()))
+                            returned(response.name());
+                        report_changed_ = true;
                     }
                 });
+
+        if (push_mode())
+        {
+            interprocess()
+                .subscribe<middleware::groups::health_heartbeat,
+                           goby::middleware::protobuf::HealthHeartbeat>(
+                    [this](const goby::middleware::protobuf::HealthHeartbeat& heartbeat) {
+                        glog.is_debug2() && glog << "Received heartbeat: "
+                                                 << heartbeat.ShortDebugString() << std::endl;
+                        track(heartbeat.name());
+                        if (liveness_.heartbeat(heartbeat.name(), goby::time::SystemClock::now()))
+                            returned(heartbeat.name());
+
+                        // we missed the last full report (or never had one): ask for it
+                        auto it = responses_.find(heartbeat.name());
+                        if (it == responses_.end() ||
+                            it->second.report_version() != heartbeat.report_version())
+                            resync_needed_ = true;
+                    });
+        }
     }
 
     ~Coroner() {}
 
   private:
     void loop() override
+    {
+        if (push_mode())
+            loop_push();
+        else
+            loop_request_response();
+    }
+
+    void loop_request_response()
     {
         auto now = goby::time::SystemClock::now();
         if (now >= last_request_time_ + request_interval_)
@@ -82,59 +129,123 @@ class Coroner : public goby::zeromq::SingleThreadApplication<protobuf::CoronerCo
         if (waiting_for_response_ && now >= last_request_time_ + response_timeout_)
         {
             waiting_for_response_ = false;
+            publish_report();
+        }
+    }
 
-            middleware::protobuf::VehicleHealth report;
-            report.set_time_with_units(goby::time::SystemClock::now<goby::time::MicroTime>());
-            goby::middleware::protobuf::HealthState health_state =
-                goby::middleware::protobuf::HEALTH__OK;
-            for (const std::string& expected : tracked_names_)
-            {
-                auto it = responses_.find(expected);
-
-                if (it == responses_.end())
-                {
-                    glog.is_warn() && glog << "No response from: " << expected << std::endl;
-                    health_state = goby::middleware::protobuf::HEALTH__FAILED;
-                    auto& process = *report.add_process();
-                    process.set_name(expected);
-                    auto& main = *process.mutable_main();
-                    main.set_name(expected);
-                    main.set_state(goby::middleware::protobuf::HEALTH__FAILED);
-                    main.set_error(goby::middleware::protobuf::ERROR__PROCESS_DIED);
-                    main.set_error_message("Process " + expected + " has died");
-                }
-                else
-                {
-                    if (it->second.main().state() > health_state)
-                        health_state = it->second.main().state();
-                    *report.add_process() = it->second;
-                }
-            }
+    void loop_push()
+    {
+        auto now = goby::time::SystemClock::now();
+
+        // periodic requests pick up new processes and renew the heartbeat lease. Resync requests are rate limited, as all processes respond to them.
+        if (now >= last_request_time_ + request_interval_ ||
+            (resync_needed_ && now >= last_request_time_ + heartbeat_timeout_))
+        {
+            middleware::protobuf::HealthRequest request;
+            request.set_heartbeat_interval_with_units(
+                goby::time::convert_duration<goby::time::SITime>(heartbeat_interval_));
+            request.set_heartbeat_lease_with_units(
+                goby::time::convert_duration<goby::time::SITime>(3 * request_interval_));
+            interprocess().publish<middleware::groups::health_request>(request);
+            last_request_time_ = now;
+            resync_needed_ = false;
+        }
+
+        liveness_.advance(now, [this](const std::string& name) {
+            glog.is_warn() && glog << "No heartbeat or response from: " << name << std::endl;
+            responses_.erase(name);
+            report_changed_ = true;
+        });
 
-            report.set_platform(cfg().interprocess().platform());
-            report.set_state(health_state);
+        if (report_changed_ || now >= last_report_time_ + request_interval_)
+        {
+            publish_report();
+            report_changed_ = false;
+            last_report_time_ = now;
+        }
+    }
+
+    void track(const std::string& name)
+    {
+        if (!tracked_names_.count(name))
+        {
+            glog.is_verbose() && glog << "Tracking new process name: " << name << std::endl;
+            tracked_names_.insert(name);
+        }
+    }
+
+    void returned(const std::string& name)
+    {
+        glog.is_verbose() && glog << "Process returned: " << name << std::endl;
+        report_changed_ = true;
+    }
 
-            if (report.state() == goby::middleware::protobuf::HEALTH__OK)
+    void publish_report()
+    {
+        middleware::protobuf::VehicleHealth report;
+        report.set_time_with_units(goby::time::SystemClock::now<goby::time::MicroTime>());
+        goby::middleware::protobuf::HealthState health_state =
+            goby::middleware::protobuf::HEALTH__OK;
+        for (const std::string& expected : tracked_names_)
+        {
+            auto it = responses_.find(expected);
+
+            if (it == responses_.end())
             {
-                glog.is_debug1() && glog << "Vehicle report: " << report.ShortDebugString()
-                                         << std::endl;
+                // in push mode, processes are only reported dead once their heartbeat times out
+                if (push_mode() && !liveness_.dead(expected))
+                    continue;
+
+                glog.is_warn() && glog << "No response from: " << expected << std::endl;
+                health_state = goby::middleware::protobuf::HEALTH__FAILED;
+                auto& process = *report.add_process();
+                process.set_name(expected);
+                auto& main = *process.mutable_main();
+                main.set_name(expected);
+                main.set_state(goby::middleware::protobuf::HEALTH__FAILED);
+                main.set_error(goby::middleware::protobuf::ERROR__PROCESS_DIED);
+                main.set_error_message("Process " + expected + " has died");
             }
             else
             {
-                glog.is_warn() && glog << "Vehicle report: " << report.ShortDebugString()
-                                       << std::endl;
+                if (it->second.main().state() > health_state)
+                    health_state = it->second.main().state();
+                *report.add_process() = it->second;
             }
+        }
+
+        report.set_platform(cfg().interprocess().platform());
+        report.set_state(health_state);
 
-            interprocess().publish<goby::middleware::groups::health_report>(report);
+        if (report.state() == goby::middleware::protobuf::HEALTH__OK)
+        {
+            glog.is_debug1() && glog << "Vehicle report: " << report.ShortDebugString()
+                                     << std::endl;
         }
+        else
+        {
+            glog.is_warn() && glog << "Vehicle report: " << report.ShortDebugString() << std::endl;
+        }
+
+        interprocess().publish<goby::middleware::groups::health_report>(report);
     }
 
+    bool push_mode() const { return cfg().mode() == protobuf::CoronerConfig::PUSH; }
+
   private:
     goby::time::SystemClock::time_point last_request_time_{std::chrono::seconds(0)};
     goby::time::SystemClock::duration request_interval_;
     goby::time::SystemClock::duration response_timeout_;
     bool waiting_for_response_{false};
 
+    // push mode
+    goby::time::SystemClock::duration heartbeat_interval_;
+    goby::time::SystemClock::duration heartbeat_timeout_;
+    goby::middleware::coroner::LivenessMonitor<goby::time::SystemClock> liveness_;
+    goby::time::SystemClock::time_point last_report_time_{std::chrono::seconds(0)};
+    bool report_changed_{false};
+    bool resync_needed_{false};
+
     std::map<std::string, goby::middleware::protobuf::ProcessHealth> responses_;
 
     std::set<std::string> tracked_names_;
@@ -71,12 +71,25 @@ class Logger : public goby::zeromq::SingleThreadApplication<protobuf::LoggerConf
             dl_handles_.push_back(lib_handle);
         }
 
+        if (cfg().has_compression())
+            goby::middleware::log::LogEntry::set_block_compression(
+                cfg().compression().block_bytes(), cfg().compression().level());
+
         pb_plugin_.register_write_hooks(log_);
         dccl_plugin_.register_write_hooks(log_);
     }
 
     ~Logger()
     {
+        // write any remaining block and the block index
+        try
+        {
+            goby::middleware::log::LogEntry::finish(&log_);
+        }
+        catch (std::exception& e)
+        {
+            glog.is_warn() && glog << "Failed to finish log: " << e.what() << std::endl;
+        }
         log_.close();
         // set read only
         chmod(log_file_path_.c_str(), S_IRUSR | S_IRGRP);
@@ -90,6 +103,15 @@ class Logger : public goby::zeromq::SingleThreadApplication<protobuf::LoggerConf
     {
         if (do_quit)
             quit();
+
+        auto now = goby::time::SteadyClock::now();
+        if (cfg().has_compression() &&
+            now - last_block_time_ >
+                std::chrono::duration<double>(cfg().compression().max_block_seconds()))
+        {
+            goby::middleware::log::LogEntry::flush_block(&log_);
+            last_block_time_ = now;
+        }
     }
 
     static std::atomic<bool> do_quit;
@@ -97,6 +119,7 @@ class Logger : public goby::zeromq::SingleThreadApplication<protobuf::LoggerConf
   private:
     std::string log_file_path_;
     std::ofstream log_;
+    goby::time::SteadyClock::time_point last_block_time_{goby::time::SteadyClock::now()};
 
     std::vector<void*> dl_handles_;
 
@@ -0,0 +1,220 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <chrono>
+#include <dlfcn.h>
+#include <fstream>
+#include <limits>
+#include <regex>
+#include <thread>
+
+#include "goby/middleware/log.h"
+#include "goby/middleware/log/dccl_log_plugin.h"
+#include "goby/middleware/log/protobuf_log_plugin.h"
+#include "goby/time.h"
+#include "goby/zeromq/application/single_thread.h"
+#include "goby/zeromq/protobuf/playback_config.pb.h"
+
+using goby::glog;
+
+namespace goby
+{
+namespace apps
+{
+namespace zeromq
+{
+/// \brief Republishes the entries of a goby_logger file on the interprocess layer, with their original scheme, group and type
+class Playback : public goby::zeromq::SingleThreadApplication<protobuf::PlaybackConfig>
+{
+  public:
+    Playback();
+    ~Playback();
+
+  private:
+    // called as fast as possible; publishes the entries that are due
+    void loop() override;
+
+    // called on the LogPlayer's reader thread for each entry
+    bool read(goby::middleware::log::LogEntry& log_entry);
+    bool passes_filters(int scheme, const std::string& group, const std::string& type);
+
+    void finish();
+
+  private:
+    // publish at most this many entries per loop() so that the portal is still polled
+    static constexpr int max_entries_per_loop_{1000};
+    const std::chrono::milliseconds max_wait_{10};
+
+    std::vector<void*> dl_handles_;
+    std::map<int, std::unique_ptr<goby::middleware::log::LogPlugin>> plugins_;
+    std::ifstream f_in_;
+
+    std::regex type_regex_;
+    std::regex group_regex_;
+    std::regex exclude_type_regex_;
+    std::regex exclude_group_regex_;
+    std::map<goby::middleware::log::LogFilter, bool> filter_cache_;
+
+    std::chrono::steady_clock::time_point start_after_;
+    std::unique_ptr<goby::middleware::log::LogPlayer> player_;
+};
+} // namespace zeromq
+} // namespace apps
+} // namespace goby
+
+int main(int argc, char* argv[]) { return goby::run<goby::apps::zeromq::Playback>(argc, argv); }
+
+goby::apps::zeromq::Playback::Playback()
+    : goby::zeromq::SingleThreadApplication<protobuf::PlaybackConfig>(
+          std::numeric_limits<double>::infinity()),
+      f_in_(cfg().input_file().c_str(), std::ifstream::binary),
+      type_regex_(cfg().type_regex()),
+      group_regex_(cfg().group_regex()),
+      exclude_type_regex_(cfg().exclude_type_regex()),
+      exclude_group_regex_(cfg().exclude_group_regex()),
+      start_after_(std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(cfg().start_delay())))
+{
+    if (!f_in_.is_open())
+        glog.is_die() && glog << "Failed to open log: " << cfg().input_file() << std::endl;
+
+    if (cfg().mode() == protobuf::PlaybackConfig::WARPED && !(cfg().warp_factor() > 0))
+        glog.is_die() && glog << "warp_factor must be positive" << std::endl;
+
+    for (const auto& lib : cfg().load_shared_library())
+    {
+        void* lib_handle = dlopen(lib.c_str(), RTLD_LAZY);
+        if (!lib_handle)
+            glog.is_die() && glog << "Failed to open library: " << lib << std::endl;
+        dl_handles_.push_back(lib_handle);
+    }
+
+    plugins_[goby::middleware::MarshallingScheme::PROTOBUF].reset(
+        new goby::middleware::log::ProtobufPlugin);
+    plugins_[goby::middleware::MarshallingScheme::DCCL].reset(
+        new goby::middleware::log::DCCLPlugin);
+
+    for (auto& p : plugins_) p.second->register_read_hooks(f_in_);
+
+    double warp_factor = 0;
+    switch (cfg().mode())
+    {
+        case protobuf::PlaybackConfig::REAL_TIME: warp_factor = 1; break;
+        case protobuf::PlaybackConfig::WARPED: warp_factor = cfg().warp_factor(); break;
+        case protobuf::PlaybackConfig::AS_FAST_AS_POSSIBLE: break;
+    }
+
+    player_.reset(new goby::middleware::log::LogPlayer(
+        f_in_, warp_factor, cfg().prefetch_entries(),
+        [this](goby::middleware::log::LogEntry& log_entry) { return read(log_entry); }));
+}
+
+goby::apps::zeromq::Playback::~Playback()
+{
+    // stop the reader thread before the plugins and libraries it uses
+    player_.reset();
+    for (void* handle : dl_handles_) dlclose(handle);
+}
+
+bool goby::apps::zeromq::Playback::read(goby::middleware::log::LogEntry& log_entry)
+{
+    std::string group(log_entry.group());
+    if (!passes_filters(log_entry.scheme(), group, log_entry.type()))
+        return false;
+
+    if (glog.is_debug2())
+    {
+        auto plugin = plugins_.find(log_entry.scheme());
+        if (plugin != plugins_.end())
+        {
+            try
+            {
+                glog << "Read: " << group << " | " << log_entry.type() << " | "
+                     << plugin->second->debug_text_message(log_entry) << std::endl;
+            }
+            catch (goby::middleware::log::LogException& e)
+            {
+                glog << "Read: " << group << " | " << log_entry.type() << " | " << e.what()
+                     << std::endl;
+            }
+        }
+    }
+    return true;
+}
+
+bool goby::apps::zeromq::Playback::passes_filters(int scheme, const std::string& group,
+                                                  const std::string& type)
+{
+    goby::middleware::log::LogFilter filter{scheme, group, type};
+    auto it = filter_cache_.find(filter);
+    if (it == filter_cache_.end())
+    {
+        bool excluded =
+            (!cfg().exclude_type_regex().empty() && std::regex_match(type, exclude_type_regex_)) ||
+            (!cfg().exclude_group_regex().empty() && std::regex_match(group, exclude_group_regex_));
+        bool passes = !excluded && std::regex_match(type, type_regex_) &&
+                      std::regex_match(group, group_regex_);
+
+        glog.is_debug1() && glog << (passes ? "Playing" : "Skipping")
+                                 << " [scheme, type, group] = [" << scheme << ", " << type << ", "
+                                 << group << "]" << std::endl;
+
+        it = filter_cache_.insert(std::make_pair(filter, passes)).first;
+    }
+    return it->second;
+}
+
+void goby::apps::zeromq::Playback::loop()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now < start_after_)
+    {
+        std::this_thread::sleep_for(
+            std::min<std::chrono::steady_clock::duration>(start_after_ - now, max_wait_));
+        return;
+    }
+
+    bool more = player_->play(
+        [this](const goby::middleware::log::LogPlayer::Entry& entry) {
+            interprocess().publish_serialized(entry.type, entry.scheme,
+                                              reinterpret_cast<const char*>(entry.data.data()),
+                                              entry.data.size(), entry.group);
+        },
+        max_entries_per_loop_, max_wait_);
+
+    if (!more)
+        finish();
+}
+
+void goby::apps::zeromq::Playback::finish()
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_after_)
+                         .count();
+    glog.is_verbose() && glog << "Played back " << player_->entries_played() << " entries ("
+                              << player_->bytes_played() << " bytes) in " << seconds << " s ("
+                              << player_->entries_played() / seconds << " entries/s)"
+                              << std::endl;
+    quit();
+}
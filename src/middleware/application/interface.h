@@ -36,8 +36,12 @@
 #include <boost/format.hpp>
 
 #include "goby/middleware/application/configurator.h"
+#include "goby/middleware/application/thread_scheduling.h"
 #include "goby/middleware/marshalling/detail/dccl_serializer_parser.h"
+#include "goby/middleware/marshalling/detail/protobuf_arena_pool.h"
 #include "goby/middleware/protobuf/app_config.pb.h"
+#include "goby/middleware/transport/poll_scheduler.h"
+#include "goby/middleware/transport/stats.h"
 #include "goby/time.h"
 #include "goby/util/debug_logger.h"
 #include "goby/util/geodesy.h"
@@ -113,6 +117,10 @@ template <typename Config> class Application
 
     std::string app_name() { return app3_base_configuration_->name(); }
 
+  protected:
+    /// \brief Accesses the base configuration (the "app" block) common to all applications
+    const protobuf::AppConfig& app3_base_cfg() { return *app3_base_configuration_; }
+
   private:
     template <typename App>
     friend int ::goby::run(
@@ -157,6 +165,28 @@ template <typename Config> goby::middleware::Application<Config>::Application()
     if (app3_base_configuration_->has_geodesy())
         configure_geodesy();
 
+    if (app3_base_configuration_->transport_instrumentation().enable())
+        TransportStats::set_enabled(true);
+
+    if (app3_base_configuration_->has_poll_scheduling())
+    {
+        const auto& poll_cfg = app3_base_configuration_->poll_scheduling();
+        PollScheduler::configure(
+            poll_cfg.layer_budget(),
+            {poll_cfg.high_weight(), poll_cfg.normal_weight(), poll_cfg.low_weight()});
+    }
+
+    const auto& arena_cfg = app3_base_configuration_->protobuf_arena();
+    if (arena_cfg.enable())
+        ProtobufArenaPool::set_enabled(true, arena_cfg.block_size(),
+                                       arena_cfg.max_arenas_per_thread());
+
+    const auto& scheduling_cfg = app3_base_configuration_->scheduling();
+    if (scheduling_cfg.lock_memory())
+        lock_memory();
+    if (scheduling_cfg.has_main_thread())
+        apply_thread_scheduling(scheduling_cfg.main_thread(), "main");
+
     if (!app3_base_configuration_->IsInitialized())
         throw(middleware::ConfigException("Invalid base configuration"));
 
@@ -30,6 +30,8 @@
 #include "goby/middleware/application/detail/thread_type_selector.h"
 #include "goby/middleware/application/interface.h"
 #include "goby/middleware/application/thread.h"
+#include "goby/middleware/application/thread_executor.h"
+#include "goby/middleware/application/thread_scheduling.h"
 
 #include "goby/middleware/transport/interprocess.h"
 #include "goby/middleware/transport/interthread.h"
@@ -152,45 +154,74 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
         ThreadManagement() = default;
         ~ThreadManagement()
         {
-            if (thread)
+            if (thread || task)
             {
                 goby::glog.is(goby::util::logger::DEBUG1) &&
                     goby::glog << "Joining thread: " << name << std::endl;
                 alive = false;
+            }
+
+            if (thread)
+            {
                 thread->join();
             }
+            else if (task)
+            {
+                task->wake();
+                task->wait();
+            }
         }
 
         std::atomic<bool> alive{true};
         std::string name;
         std::unique_ptr<std::thread> thread;
+        // used instead of thread when the ThreadExecutor is enabled
+        std::shared_ptr<ThreadExecutor::Task> task;
     };
 
     static std::exception_ptr thread_exception_;
 
+    // declared before threads_ so that it outlives the tasks
+    std::unique_ptr<ThreadExecutor> executor_;
     std::map<std::type_index, std::map<int, ThreadManagement>> threads_;
     int running_thread_count_{0};
     InterThreadTransporter interthread_;
+    // launch_timer() index to main thread timer
+    std::map<int, typename Thread<Config, Transporter>::TimerId> launched_timers_;
 
   public:
     template <typename ThreadType> void launch_thread()
     {
-        _launch_thread<ThreadType, Config, false>(-1, this->app_cfg());
+        _launch_thread<ThreadType, Config, false>(-1, this->app_cfg(), nullptr);
     }
     template <typename ThreadType> void launch_thread(int index)
     {
-        _launch_thread<ThreadType, Config, true>(index, this->app_cfg());
+        _launch_thread<ThreadType, Config, true>(index, this->app_cfg(), nullptr);
     }
 
     template <typename ThreadType, typename ThreadConfig>
     void launch_thread(const ThreadConfig& cfg)
     {
-        _launch_thread<ThreadType, ThreadConfig, false>(-1, cfg);
+        _launch_thread<ThreadType, ThreadConfig, false>(-1, cfg, nullptr);
     }
     template <typename ThreadType, typename ThreadConfig>
     void launch_thread(int index, const ThreadConfig& cfg)
     {
-        _launch_thread<ThreadType, ThreadConfig, true>(index, cfg);
+        _launch_thread<ThreadType, ThreadConfig, true>(index, cfg, nullptr);
+    }
+
+    /// \brief Launch a thread with the given CPU affinity and scheduling policy/priority (overriding the app.scheduling.launched_threads configuration)
+    template <typename ThreadType, typename ThreadConfig>
+    void launch_thread(const ThreadConfig& cfg, const protobuf::ThreadScheduling& scheduling)
+    {
+        _launch_thread<ThreadType, ThreadConfig, false>(-1, cfg, &scheduling);
+    }
+    /// \brief Launch a thread with an index and the given CPU affinity and scheduling policy/priority (overriding the app.scheduling.launched_threads configuration)
+    template <typename ThreadType, typename ThreadConfig>
+    void launch_thread(int index, const ThreadConfig& cfg,
+                       const protobuf::ThreadScheduling& scheduling)
+    {
+        _launch_thread<ThreadType, ThreadConfig, true>(index, cfg, &scheduling);
     }
 
     template <typename ThreadType> void join_thread(int index = -1)
@@ -201,16 +232,28 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
         interthread_.publish<MainThreadBase::shutdown_group_>(ti);
     }
 
+    /// \brief Call \c on_expire from the main thread at the given frequency until join_timer<i>() is called
+    ///
+    /// This uses a periodic timer on the main thread (Thread::add_periodic_timer()) rather than launching a TimerThread.
     template <int i>
     void launch_timer(boost::units::quantity<boost::units::si::frequency> freq,
                       std::function<void()> on_expire)
     {
-        launch_thread<goby::middleware::TimerThread<i>>(freq);
-        this->interthread()
-            .template subscribe_empty<goby::middleware::TimerThread<i>::expire_group>(on_expire);
+        join_timer<i>();
+        auto period = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::duration<double>(1.0 / (freq / boost::units::si::hertz)));
+        launched_timers_[i] = this->add_periodic_timer(period, on_expire);
     }
 
-    template <int i> void join_timer() { join_thread<goby::middleware::TimerThread<i>>(); }
+    template <int i> void join_timer()
+    {
+        auto it = launched_timers_.find(i);
+        if (it != launched_timers_.end())
+        {
+            this->cancel_timer(it->second);
+            launched_timers_.erase(it);
+        }
+    }
 
     int running_thread_count() { return running_thread_count_; }
 
@@ -224,6 +267,9 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
     {
         goby::glog.set_lock_action(goby::util::logger_lock::lock);
 
+        if (this->app3_base_cfg().thread_executor().worker_threads() > 0)
+            enable_thread_executor(this->app3_base_cfg().thread_executor().worker_threads());
+
         interthread_.template subscribe<MainThreadBase::joinable_group_>(
             [this](const ThreadIdentifier& joinable) {
                 _join_thread(joinable.type_i, joinable.index);
@@ -235,6 +281,16 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
     InterThreadTransporter& interthread() { return interthread_; }
     virtual void finalize() override { join_all_threads(); }
 
+    /// \brief Run the threads subsequently launched with launch_thread() as tasks on a ThreadExecutor with the given number of worker threads, rather than on one std::thread each (also enabled by the thread_executor configuration)
+    ///
+    /// The threads' loop() and callbacks must not block, as this blocks the worker running them. The main thread is not affected.
+    void enable_thread_executor(unsigned worker_threads)
+    {
+        if (running_thread_count_ > 0)
+            throw(Exception("enable_thread_executor() must be called before launch_thread()"));
+        executor_.reset(new ThreadExecutor(worker_threads));
+    }
+
     void join_all_threads()
     {
         if (running_thread_count_ > 0)
@@ -262,12 +318,22 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
         }
     }
 
+  protected:
+    /// \brief Override to run periodic tasks on the main thread (called after each poll of the main thread)
+    ///
+    /// \return the time at which this function next needs to be called (the main thread's poll will wake up by then)
+    virtual std::chrono::system_clock::time_point main_thread_tasks()
+    {
+        return std::chrono::system_clock::time_point::max();
+    }
+
   private:
     void run() override
     {
         try
         {
-            MainThreadBase::run_once();
+            MainThreadBase::run_once(main_thread_wakeup_);
+            main_thread_wakeup_ = main_thread_tasks();
         }
         catch (std::exception& e)
         {
@@ -279,9 +345,14 @@ class MultiThreadApplicationBase : public goby::middleware::Application<Config>,
     }
 
     template <typename ThreadType, typename ThreadConfig, bool has_index>
-    void _launch_thread(int index, const ThreadConfig& cfg);
+    void _launch_thread(int index, const ThreadConfig& cfg,
+                        const protobuf::ThreadScheduling* scheduling);
 
     void _join_thread(const std::type_index& type_i, int index);
+
+  private:
+    std::chrono::system_clock::time_point main_thread_wakeup_{
+        std::chrono::system_clock::time_point::max()};
 };
 
 /// \brief Base class for building multithreaded applications for a given implementation of the InterProcessPortal. This class isn't used directly by user applications, for that use a specific implementation, e.g. zeromq::MultiThreadApplication
@@ -314,7 +385,9 @@ class MultiThreadApplication
     MultiThreadApplication(boost::units::quantity<boost::units::si::frequency> loop_freq)
         : Base(loop_freq, &intervehicle_),
           interprocess_(Base::interthread(), this->app_cfg().interprocess()),
-          intervehicle_(interprocess_)
+          intervehicle_(interprocess_),
+          health_responder_(this->app_name()),
+          transport_stats_(this->app_name(), this->app_cfg().app().transport_instrumentation())
     {
         // handle goby_terminate request
         this->interprocess()
@@ -334,11 +407,9 @@ class MultiThreadApplication
         // handle goby_coroner request
         this->interprocess().template subscribe<groups::health_request, protobuf::HealthRequest>(
             [this](const protobuf::HealthRequest& request) {
-                protobuf::ProcessHealth resp;
-                resp.set_name(this->app_name());
-                resp.set_pid(getpid());
-                this->thread_health(*resp.mutable_main());
-                this->interprocess().template publish<groups::health_response>(resp);
+                health_responder_.handle_request(
+                    request, this->interprocess(),
+                    [this](protobuf::ThreadHealth& health) { this->thread_health(health); });
             });
     }
 
@@ -357,6 +428,19 @@ class MultiThreadApplication
         health.set_name(this->app_name());
         health.set_state(goby::middleware::protobuf::HEALTH__OK);
     }
+
+    std::chrono::system_clock::time_point main_thread_tasks() override
+    {
+        health_responder_.heartbeat(interprocess_, [this](protobuf::ThreadHealth& health) {
+            this->thread_health(health);
+        });
+        transport_stats_.publish(interprocess_);
+        return std::min(health_responder_.next_heartbeat(), transport_stats_.next_report());
+    }
+
+  private:
+    coroner::HealthResponder health_responder_;
+    TransportStatsPublisher transport_stats_;
 };
 
 /// \brief Base class for building multithreaded Goby applications that do not have perform any interprocess (or outer) communications, but only communicate internally via the InterThreadTransporter
@@ -424,7 +508,7 @@ std::exception_ptr
 template <class Config, class Transporter>
 template <typename ThreadType, typename ThreadConfig, bool has_index>
 void goby::middleware::MultiThreadApplicationBase<Config, Transporter>::_launch_thread(
-    int index, const ThreadConfig& cfg)
+    int index, const ThreadConfig& cfg, const protobuf::ThreadScheduling* scheduling)
 {
     std::type_index type_i = std::type_index(typeid(ThreadType));
 
@@ -435,10 +519,50 @@ void goby::middleware::MultiThreadApplicationBase<Config, Transporter>::_launch_
     auto& thread_manager = threads_[type_i][index];
     thread_manager.alive = true;
 
+    thread_manager.name = std::string(typeid(ThreadType).name()) + "_index" + std::to_string(index);
+
+    const auto& scheduling_cfg = this->app3_base_cfg().scheduling();
+    bool has_scheduling = scheduling || scheduling_cfg.has_launched_threads();
+    protobuf::ThreadScheduling thread_scheduling =
+        scheduling ? *scheduling : scheduling_cfg.launched_threads();
+
+    if (executor_)
+    {
+        if (has_scheduling)
+            goby::glog.is_warn() &&
+                goby::glog << "Thread " << thread_manager.name
+                           << " runs on the ThreadExecutor, so its scheduling configuration ("
+                           << thread_scheduling.ShortDebugString() << ") is ignored" << std::endl;
+
+        // copy configuration
+        auto make_thread = [type_i, index, cfg]() {
+            std::shared_ptr<ThreadType> goby_thread(
+                detail::ThreadTypeSelector<ThreadType, ThreadConfig, has_index>::thread(cfg,
+                                                                                        index));
+            goby_thread->set_type_index(type_i);
+            return goby_thread;
+        };
+
+        auto on_exit = [this, type_i, index](std::exception_ptr e) {
+            if (e)
+                thread_exception_ = e;
+            interthread_.publish<MainThreadBase::joinable_group_>(ThreadIdentifier{type_i, index});
+        };
+
+        thread_manager.task =
+            executor_->launch<ThreadType>(make_thread, thread_manager.alive, on_exit);
+        ++running_thread_count_;
+        return;
+    }
+
     // copy configuration
-    auto thread_lambda = [this, type_i, index, cfg, &thread_manager]() {
+    auto thread_lambda = [this, type_i, index, cfg, &thread_manager, has_scheduling,
+                          thread_scheduling]() {
         try
         {
+            if (has_scheduling)
+                apply_thread_scheduling(thread_scheduling, thread_manager.name);
+
             std::shared_ptr<ThreadType> goby_thread(
                 detail::ThreadTypeSelector<ThreadType, ThreadConfig, has_index>::thread(cfg,
                                                                                         index));
@@ -453,7 +577,6 @@ void goby::middleware::MultiThreadApplicationBase<Config, Transporter>::_launch_
         interthread_.publish<MainThreadBase::joinable_group_>(ThreadIdentifier{type_i, index});
     };
 
-    thread_manager.name = std::string(typeid(ThreadType).name()) + "_index" + std::to_string(index);
     thread_manager.thread = std::unique_ptr<std::thread>(new std::thread(thread_lambda));
     ++running_thread_count_;
 }
@@ -466,14 +589,24 @@ void goby::middleware::MultiThreadApplicationBase<Config, Transporter>::_join_th
         throw(Exception(std::string("No thread of type: ") + type_i.name() + " and index " +
                         std::to_string(index) + " to join."));
 
-    if (threads_[type_i][index].thread)
+    auto& thread_manager = threads_[type_i][index];
+    if (thread_manager.thread || thread_manager.task)
     {
         goby::glog.is(goby::util::logger::DEBUG1) &&
             goby::glog << "Joining thread: " << type_i.name() << " index " << index << std::endl;
 
-        threads_[type_i][index].alive = false;
-        threads_[type_i][index].thread->join();
-        threads_[type_i][index].thread.reset();
+        thread_manager.alive = false;
+        if (thread_manager.thread)
+        {
+            thread_manager.thread->join();
+            thread_manager.thread.reset();
+        }
+        else
+        {
+            thread_manager.task->wake();
+            thread_manager.task->wait();
+            thread_manager.task.reset();
+        }
         --running_thread_count_;
 
         goby::glog.is(goby::util::logger::DEBUG1) &&
@@ -67,7 +67,9 @@ class SingleThreadApplication : public goby::middleware::Application<Config>,
     SingleThreadApplication(boost::units::quantity<boost::units::si::frequency> loop_freq)
         : MainThread(this->app_cfg(), loop_freq),
           interprocess_(this->app_cfg().interprocess()),
-          intervehicle_(interprocess_)
+          intervehicle_(interprocess_),
+          health_responder_(this->app_name()),
+          transport_stats_(this->app_name(), this->app_cfg().app().transport_instrumentation())
     {
         this->set_transporter(&intervehicle_);
 
@@ -89,11 +91,9 @@ class SingleThreadApplication : public goby::middleware::Application<Config>,
         // handle goby_coroner request
         this->interprocess().template subscribe<groups::health_request, protobuf::HealthRequest>(
             [this](const protobuf::HealthRequest& request) {
-                protobuf::ProcessHealth resp;
-                resp.set_name(this->app_name());
-                resp.set_pid(getpid());
-                this->thread_health(*resp.mutable_main());
-                this->interprocess().template publish<groups::health_response>(resp);
+                health_responder_.handle_request(
+                    request, this->interprocess(),
+                    [this](protobuf::ThreadHealth& health) { this->thread_health(health); });
             });
     }
 
@@ -110,7 +110,19 @@ class SingleThreadApplication : public goby::middleware::Application<Config>,
     }
 
   private:
-    void run() override { MainThread::run_once(); }
+    void run() override
+    {
+        MainThread::run_once(
+            std::min(health_responder_.next_heartbeat(), transport_stats_.next_report()));
+        health_responder_.heartbeat(interprocess_, [this](protobuf::ThreadHealth& health) {
+            this->thread_health(health);
+        });
+        transport_stats_.publish(interprocess_);
+    }
+
+  private:
+    coroner::HealthResponder health_responder_;
+    TransportStatsPublisher transport_stats_;
 };
 
 } // namespace middleware
@@ -24,11 +24,15 @@
 #ifndef THREAD20170616H
 #define THREAD20170616H
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <typeindex>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/units/systems/si.hpp>
 
@@ -38,6 +42,11 @@
 
 #include "goby/middleware/common.h"
 #include "goby/middleware/group.h"
+#include "goby/middleware/transport/receiver.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/time/simulation.h"
+#include "goby/util/debug_logger.h"
+#include "goby/util/timer_wheel.h"
 
 namespace goby
 {
@@ -68,10 +77,33 @@ template <typename Config, typename TransporterType> class Thread
     std::atomic<bool>* alive_{nullptr};
     std::type_index type_i_{std::type_index(typeid(void))};
     std::string thread_id_;
+    // lateness of each loop() call relative to loop_time_
+    LatencyHistogram loop_jitter_;
+
+    struct Timer
+    {
+        // shared so that the callback survives cancel_timer() from within itself
+        std::shared_ptr<std::function<void()>> callback;
+        // zero for one-shot timers
+        std::chrono::steady_clock::duration period;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    // keyed on the steady clock so that wall clock adjustments neither stall the timers (backward
+    // step) nor make the wheel tick through the whole gap (forward step)
+    using TimerWheel = goby::util::TimerWheel<std::uint64_t, std::chrono::steady_clock>;
+    // created by the first add_timer() / add_periodic_timer()
+    std::unique_ptr<TimerWheel> timer_wheel_;
+    std::unordered_map<std::uint64_t, Timer> timers_;
+    std::uint64_t next_timer_id_{0};
+    std::vector<std::uint64_t> expired_timers_;
 
   public:
     using Transporter = TransporterType;
 
+    /// \brief Identifies a timer added by add_timer() or add_periodic_timer()
+    using TimerId = std::uint64_t;
+
     /// \brief Construct a thread with a given configuration, underlying transporter, and index (for multiple instantiations), but without any loop() frequency
     ///
     /// \param cfg Data to configure the code running in this thread
@@ -108,22 +140,48 @@ template <typename Config, typename TransporterType> class Thread
         set_transporter(transporter);
     }
 
-    virtual ~Thread() {}
+    virtual ~Thread()
+    {
+        if (loop_jitter_.count() > 0)
+        {
+            goby::glog.is_verbose() &&
+                goby::glog << "Thread " << thread_id_ << " loop() at " << loop_frequency_hertz()
+                           << " Hz, lateness (us) p50: " << loop_jitter_.value_at_percentile(50)
+                           << ", p99: " << loop_jitter_.value_at_percentile(99)
+                           << ", p99.9: " << loop_jitter_.value_at_percentile(99.9)
+                           << ", max: " << loop_jitter_.max() << " (" << loop_jitter_.count()
+                           << " calls)" << std::endl;
+        }
+    }
 
     /// \brief Run the thread until the boolean reference passed is set false. This call blocks, and should be run in a std::thread by the caller.
     ///
     /// \param alive Reference to an atomic boolean. While alive is true, the thread will run; when alive is set false, the thread will complete (and become joinable), assuming nothing is blocking loop() or any transporter callback.
     void run(std::atomic<bool>& alive)
+    {
+        start(alive);
+        while (alive) { run_once(); }
+    }
+
+    /// \brief Cooperative alternative to run() (used by ThreadExecutor): subscribe and initialize the thread, after which the caller calls run_slice() whenever data are published to this thread or the time returned by the previous run_slice() is reached, until alive is false
+    void start(std::atomic<bool>& alive)
     {
         alive_ = &alive;
         do_subscribe();
         initialize();
-        while (alive) { run_once(); }
     }
 
+    /// \brief Handle the data queued for this thread, any timers that are due, and loop() if it is due, without blocking
+    ///
+    /// \return Time at which run_slice() next needs to be called if no data arrive first (time_point::max() if never, time_point::min() if immediately)
+    std::chrono::system_clock::time_point run_slice();
+
     /// \return the Thread index (for multiple instantiations)
     int index() const { return index_; }
 
+    /// \brief Lateness of each loop() call relative to the time it was scheduled for, i.e. the achieved loop period jitter (summarized at the verbose log level when the Thread is destroyed)
+    const LatencyHistogram& loop_jitter() const { return loop_jitter_; }
+
     std::type_index type_index() { return type_i_; }
     void set_type_index(std::type_index type_i) { type_i_ = type_i; }
 
@@ -162,10 +220,59 @@ template <typename Config, typename TransporterType> class Thread
     double loop_frequency_hertz() const { return loop_frequency_ / boost::units::si::hertz; }
     decltype(loop_frequency_) loop_frequency() const { return loop_frequency_; }
     double loop_max_frequency() const { return std::numeric_limits<double>::infinity(); }
-    void run_once();
+    /// \brief Poll the transporter once, calling loop() if it is due
+    ///
+    /// \param wakeup Return no later than this time (even if neither data nor loop() is due), allowing the caller to run other periodic tasks
+    void run_once(std::chrono::system_clock::time_point wakeup =
+                      std::chrono::system_clock::time_point::max());
 
     TransporterType& transporter() const { return *transporter_; }
 
+    /// \brief Call a function once from this thread (between polls of the transporter) after the given delay
+    ///
+    /// Timers are kept in a goby::util::TimerWheel (1 ms resolution) and the next expiry is folded into the timeout of the transporter poll, so any number of timers can be used without additional threads. Like loop(), timers are sped up by time::SimulatorSettings::warp_factor.
+    /// \param delay Time from now at which to call \c f
+    /// \param f Function to call
+    /// \return Identifier that can be passed to cancel_timer()
+    TimerId add_timer(std::chrono::system_clock::duration delay, std::function<void()> f)
+    {
+        return _add_timer(delay, std::chrono::system_clock::duration::zero(), std::move(f));
+    }
+
+    /// \brief Call a function from this thread every \c period (first call one period from now), until cancelled
+    ///
+    /// If the thread falls more than one period behind (e.g. blocked in a long callback), the missed expirations are skipped rather than called in a burst.
+    TimerId add_periodic_timer(std::chrono::system_clock::duration period, std::function<void()> f)
+    {
+        if (period <= std::chrono::system_clock::duration::zero())
+            throw(goby::Exception("Thread::add_periodic_timer() period must be positive"));
+        return _add_timer(period, period, std::move(f));
+    }
+
+    /// \brief Cancel a timer (may be called from any timer callback on this thread, including the timer's own)
+    ///
+    /// \return true if the timer was pending (one-shot timers are no longer pending once called)
+    bool cancel_timer(TimerId id)
+    {
+        if (!timers_.erase(id))
+            return false;
+        timer_wheel_->cancel(id);
+        return true;
+    }
+
+    /// \brief Number of pending timers
+    std::size_t timer_count() const { return timers_.size(); }
+
+    /// \brief Use this thread's timers for the timeouts of receiver.async_receive() (C++20 coroutines)
+    template <typename Data> void use_timers(Receiver<Data>& receiver)
+    {
+        receiver.set_timers(
+            [this](std::chrono::system_clock::duration delay, std::function<void()> f) {
+                return add_timer(delay, std::move(f));
+            },
+            [this](TimerId id) { return cancel_timer(id); });
+    }
+
     const Config& cfg() const { return cfg_; }
 
     // called after alive() is true, but before run()
@@ -218,6 +325,50 @@ template <typename Config, typename TransporterType> class Thread
                         this->thread_quit();
                 });
     }
+
+    TimerId _add_timer(std::chrono::system_clock::duration delay,
+                       std::chrono::system_clock::duration period, std::function<void()> f)
+    {
+        if (!timer_wheel_)
+            timer_wheel_.reset(new TimerWheel(std::chrono::milliseconds(1), 256));
+
+        using steady_duration = std::chrono::steady_clock::duration;
+        auto warp = time::SimulatorSettings::warp_factor;
+        TimerId id = next_timer_id_++;
+        Timer& timer = timers_[id];
+        timer.callback = std::make_shared<std::function<void()>>(std::move(f));
+        timer.period = std::chrono::duration_cast<steady_duration>(period / warp);
+        timer.expiry = std::chrono::steady_clock::now() +
+                       std::chrono::duration_cast<steady_duration>(delay / warp);
+        timer_wheel_->schedule(id, timer.expiry);
+        return id;
+    }
+
+    // earliest time that a timer may be due, converted to the system clock for the poll timeout
+    std::chrono::system_clock::time_point next_timer() const
+    {
+        if (timers_.empty())
+            return std::chrono::system_clock::time_point::max();
+
+        auto due = timer_wheel_->next_due();
+        auto steady_now = std::chrono::steady_clock::now();
+        auto system_now = std::chrono::system_clock::now();
+        return due <= steady_now
+                   ? system_now
+                   : system_now + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                      due - steady_now);
+    }
+
+    void fire_timers();
+
+    void run_loop()
+    {
+        loop_jitter_.record(std::chrono::system_clock::now() - loop_time_);
+        loop();
+        ++loop_count_;
+        loop_time_ += std::chrono::nanoseconds((unsigned long long)(
+            1000000000ull / (loop_frequency_hertz() * time::SimulatorSettings::warp_factor)));
+    }
 };
 
 } // namespace middleware
@@ -231,35 +382,96 @@ constexpr goby::middleware::Group
     goby::middleware::Thread<Config, TransporterType>::joinable_group_;
 
 template <typename Config, typename TransporterType>
-void goby::middleware::Thread<Config, TransporterType>::run_once()
+void goby::middleware::Thread<Config, TransporterType>::run_once(
+    std::chrono::system_clock::time_point wakeup)
 {
     if (!transporter_)
         throw(goby::Exception("Null transporter"));
 
+    wakeup = std::min(wakeup, next_timer());
+
     if (loop_frequency_hertz() == std::numeric_limits<double>::infinity())
     {
         // call loop as fast as possible
         transporter_->poll(std::chrono::seconds(0));
+        fire_timers();
         loop();
     }
     else if (loop_frequency_hertz() > 0)
     {
-        int events = transporter_->poll(loop_time_);
+        int events = transporter_->poll(std::min(loop_time_, wakeup));
+        fire_timers();
 
         // timeout
-        if (events == 0)
-        {
-            loop();
-            ++loop_count_;
-            loop_time_ += std::chrono::nanoseconds(
-                (unsigned long long)(1000000000ull / (loop_frequency_hertz() *
-                                                      time::SimulatorSettings::warp_factor)));
-        }
+        if (events == 0 && (wakeup >= loop_time_ || std::chrono::system_clock::now() >= loop_time_))
+            run_loop();
     }
     else
     {
         // don't call loop()
-        transporter_->poll();
+        transporter_->poll(wakeup);
+        fire_timers();
+    }
+}
+
+template <typename Config, typename TransporterType>
+std::chrono::system_clock::time_point goby::middleware::Thread<Config, TransporterType>::run_slice()
+{
+    if (!transporter_)
+        throw(goby::Exception("Null transporter"));
+
+    transporter_->poll(std::chrono::seconds(0));
+    fire_timers();
+
+    if (loop_frequency_hertz() == std::numeric_limits<double>::infinity())
+    {
+        loop();
+        return std::chrono::system_clock::time_point::min();
+    }
+    else if (loop_frequency_hertz() > 0)
+    {
+        if (std::chrono::system_clock::now() >= loop_time_)
+            run_loop();
+        return std::min(loop_time_, next_timer());
+    }
+    else
+    {
+        return next_timer();
+    }
+}
+
+template <typename Config, typename TransporterType>
+void goby::middleware::Thread<Config, TransporterType>::fire_timers()
+{
+    if (timers_.empty())
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+    expired_timers_.clear();
+    timer_wheel_->advance(now, [this](TimerId id) { expired_timers_.push_back(id); });
+
+    for (auto id : expired_timers_)
+    {
+        auto it = timers_.find(id);
+        // cancelled by an earlier callback
+        if (it == timers_.end())
+            continue;
+
+        auto callback = it->second.callback;
+        if (it->second.period > std::chrono::steady_clock::duration::zero())
+        {
+            auto& timer = it->second;
+            timer.expiry += timer.period;
+            // skip expirations missed while this thread was busy
+            if (timer.expiry <= now)
+                timer.expiry += ((now - timer.expiry) / timer.period + 1) * timer.period;
+            timer_wheel_->schedule(id, timer.expiry);
+        }
+        else
+        {
+            timers_.erase(it);
+        }
+        (*callback)();
     }
 }
 } // namespace goby
@@ -0,0 +1,260 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "thread_executor.h"
+
+namespace
+{
+// executor and index of the worker running on this operating system thread (if any)
+struct CurrentWorker
+{
+    const goby::middleware::ThreadExecutor* executor{nullptr};
+    std::size_t index{0};
+};
+thread_local CurrentWorker current_worker;
+} // namespace
+
+goby::middleware::ThreadExecutor::ThreadExecutor(unsigned workers)
+{
+    if (workers == 0)
+        workers = 1;
+
+    for (unsigned i = 0; i < workers; ++i) workers_.emplace_back(new Worker);
+    for (unsigned i = 0; i < workers; ++i)
+        workers_[i]->thread = std::thread([this, i]() { run(i); });
+}
+
+goby::middleware::ThreadExecutor::~ThreadExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        running_ = false;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) worker->thread.join();
+}
+
+void goby::middleware::ThreadExecutor::start(std::shared_ptr<Task> task)
+{
+    task->context_.id = ThreadId::task(next_task_id_++);
+
+    std::weak_ptr<Task> weak_task(task);
+    task->wake_ = std::make_shared<const std::function<void()>>([this, weak_task]() {
+        if (auto task = weak_task.lock())
+            schedule(task);
+    });
+    task->context_.wake = task->wake_;
+
+    schedule(task);
+}
+
+void goby::middleware::ThreadExecutor::schedule(const std::shared_ptr<Task>& task)
+{
+    task->notified_ = true;
+    // only one copy of a task is ever queued or running
+    if (!task->scheduled_.exchange(true))
+        push(task);
+}
+
+void goby::middleware::ThreadExecutor::push(std::shared_ptr<Task> task)
+{
+    // keep tasks woken from a worker on that worker (the data they need are likely still in its
+    // cache), otherwise distribute round-robin
+    std::size_t index = (current_worker.executor == this)
+                            ? current_worker.index
+                            : next_worker_++ % workers_.size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->queue.push_back(std::move(task));
+    }
+    ++queued_;
+
+    if (sleeping_ > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+std::shared_ptr<goby::middleware::ThreadExecutor::Task>
+goby::middleware::ThreadExecutor::pop(std::size_t worker)
+{
+    std::shared_ptr<Task> task;
+    for (std::size_t i = 0, n = workers_.size(); i < n && !task; ++i)
+    {
+        auto& victim = *workers_[(worker + i) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.queue.empty())
+            continue;
+
+        // run our own tasks in the order they were woken, steal the most recently woken
+        if (i == 0)
+        {
+            task = std::move(victim.queue.front());
+            victim.queue.pop_front();
+        }
+        else
+        {
+            task = std::move(victim.queue.back());
+            victim.queue.pop_back();
+        }
+    }
+
+    if (task)
+        --queued_;
+    return task;
+}
+
+void goby::middleware::ThreadExecutor::run(std::size_t worker)
+{
+    current_worker.executor = this;
+    current_worker.index = worker;
+
+    while (true)
+    {
+        if (Clock::now().time_since_epoch().count() >= next_timer_)
+        {
+            std::vector<std::shared_ptr<Task>> expired;
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                expired = expire_timers(Clock::now());
+            }
+            for (const auto& task : expired) schedule(task);
+        }
+
+        if (auto task = pop(worker))
+        {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (!running_)
+            break;
+
+        // push() checks sleeping_ after incrementing queued_, so incrementing sleeping_ before
+        // checking queued_ ensures that a push() between this check and the wait is not missed
+        ++sleeping_;
+        if (queued_ == 0 && next_timer_ > Clock::now().time_since_epoch().count())
+        {
+            if (timers_.empty())
+                sleep_cv_.wait(lock);
+            else
+                sleep_cv_.wait_until(lock, timers_.top().time);
+        }
+        --sleeping_;
+    }
+}
+
+void goby::middleware::ThreadExecutor::run_task(const std::shared_ptr<Task>& task)
+{
+    // data published to the task from now on are handled by this step or cause another
+    task->notified_ = false;
+
+    auto& context = detail::this_task_context();
+    auto previous_context = context;
+    context = task->context_;
+
+    Clock::time_point next_run;
+    std::exception_ptr e;
+    bool complete = false;
+    try
+    {
+        next_run = task->step();
+        complete = task->complete();
+    }
+    catch (...)
+    {
+        e = std::current_exception();
+        complete = true;
+    }
+
+    if (complete)
+    {
+        // scheduled_ is left true so the task is never queued again
+        try
+        {
+            task->finish(e);
+        }
+        catch (...)
+        {
+        }
+        context = previous_context;
+
+        {
+            std::lock_guard<std::mutex> lock(task->done_mutex_);
+            task->done_ = true;
+        }
+        task->done_cv_.notify_all();
+        return;
+    }
+
+    context = previous_context;
+
+    task->scheduled_ = false;
+    if (task->notified_ || next_run <= Clock::now())
+        schedule(task);
+    else if (next_run != Clock::time_point::max())
+        add_timer(task, next_run);
+}
+
+void goby::middleware::ThreadExecutor::add_timer(const std::shared_ptr<Task>& task,
+                                                 Clock::time_point time)
+{
+    bool earliest = false;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        task->timer_ = time;
+        earliest = timers_.empty() || time < timers_.top().time;
+        timers_.push({time, task});
+        next_timer_ = timers_.top().time.time_since_epoch().count();
+    }
+
+    // a sleeping worker may be waiting for a later timer
+    if (earliest && sleeping_ > 0)
+        sleep_cv_.notify_one();
+}
+
+std::vector<std::shared_ptr<goby::middleware::ThreadExecutor::Task>>
+goby::middleware::ThreadExecutor::expire_timers(Clock::time_point now)
+{
+    std::vector<std::shared_ptr<Task>> expired;
+    while (!timers_.empty() && timers_.top().time <= now)
+    {
+        auto entry = timers_.top();
+        timers_.pop();
+
+        // skip entries superseded by a later add_timer() for the same task
+        auto task = entry.task.lock();
+        if (task && task->timer_ == entry.time)
+        {
+            task->timer_ = Clock::time_point::max();
+            expired.push_back(task);
+        }
+    }
+
+    next_timer_ = timers_.empty() ? Clock::time_point::max().time_since_epoch().count()
+                                  : timers_.top().time.time_since_epoch().count();
+    return expired;
+}
@@ -0,0 +1,227 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ThreadExecutor20201019H
+#define ThreadExecutor20201019H
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "goby/middleware/common.h"
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Fixed-size pool of operating system threads that runs Threads (e.g. SimpleThread) as cooperative tasks
+///
+/// Each task has its own ThreadId, so its interthread subscriptions, publications (echo) and the ordering of the data delivered to it are the same as when it runs on its own std::thread. A task is scheduled when data are published to it (via the InterThreadTransporter it creates) or when its loop() or a timer is due; a task is never run by more than one worker at a time.
+///
+/// Ready tasks are queued on the worker that woke them (or round-robin when woken from outside the pool), and idle workers steal from the other workers' queues. Tasks should not block (e.g. in sleep or blocking I/O), as this blocks the worker running them.
+class ThreadExecutor
+{
+  public:
+    using Clock = std::chrono::system_clock;
+
+    /// \brief Handle to a running task
+    class Task
+    {
+      public:
+        /// \brief Block until the task has finished
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(done_mutex_);
+            done_cv_.wait(lock, [this]() { return done_; });
+        }
+
+        /// \brief Has the task finished?
+        bool finished()
+        {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            return done_;
+        }
+
+        /// \brief Schedule the task to run (e.g. after setting its alive flag false)
+        void wake() { (*wake_)(); }
+
+        /// \brief Identifier of the task (returned by this_thread_id() when called from the task)
+        const ThreadId& id() const { return context_.id; }
+
+      protected:
+        Task() = default;
+        virtual ~Task() = default;
+
+        // run the task once (within its context), returning the time it next needs to run
+        virtual Clock::time_point step() = 0;
+        // true once the task no longer needs to run
+        virtual bool complete() = 0;
+        // called once (within its context) after complete() or step() throws
+        virtual void finish(std::exception_ptr e) = 0;
+
+      private:
+        friend class ThreadExecutor;
+
+        detail::TaskContext context_;
+        std::shared_ptr<const std::function<void()>> wake_;
+
+        // in a worker's queue or running
+        std::atomic<bool> scheduled_{false};
+        // woken since the start of the last step
+        std::atomic<bool> notified_{false};
+        // wakeup registered with the executor's timer queue (protected by sleep_mutex_)
+        Clock::time_point timer_{Clock::time_point::max()};
+
+        std::mutex done_mutex_;
+        std::condition_variable done_cv_;
+        bool done_{false};
+    };
+
+    /// \param workers Number of operating system threads (at least one)
+    explicit ThreadExecutor(unsigned workers);
+
+    /// \brief Stops the workers. Tasks that have not finished are abandoned (not run again), so all tasks should be finished (and waited for) first
+    ~ThreadExecutor();
+
+    ThreadExecutor(const ThreadExecutor&) = delete;
+    ThreadExecutor& operator=(const ThreadExecutor&) = delete;
+
+    /// \brief Launch a Thread as a task
+    ///
+    /// \param make_thread Creates the Thread (called on a worker within the task's context, so that its transporters and subscriptions belong to the task)
+    /// \param alive The task runs until this is false (set by the Thread itself with thread_quit() or by the caller, who should then call Task::wake())
+    /// \param on_exit Called (within the task's context) after the Thread is destroyed, with the exception thrown by the Thread, if any
+    template <typename ThreadType>
+    std::shared_ptr<Task> launch(std::function<std::shared_ptr<ThreadType>()> make_thread,
+                                 std::atomic<bool>& alive,
+                                 std::function<void(std::exception_ptr)> on_exit)
+    {
+        auto task = std::make_shared<ThreadTask<ThreadType>>(std::move(make_thread), alive,
+                                                             std::move(on_exit));
+        start(task);
+        return task;
+    }
+
+    /// \brief Number of worker threads
+    std::size_t workers() const { return workers_.size(); }
+
+  private:
+    template <typename ThreadType> class ThreadTask : public Task
+    {
+      public:
+        ThreadTask(std::function<std::shared_ptr<ThreadType>()> make_thread,
+                   std::atomic<bool>& alive, std::function<void(std::exception_ptr)> on_exit)
+            : make_thread_(std::move(make_thread)), alive_(alive), on_exit_(std::move(on_exit))
+        {
+        }
+
+      private:
+        Clock::time_point step() override
+        {
+            if (!thread_)
+            {
+                thread_ = make_thread_();
+                thread_->start(alive_);
+            }
+            return alive_ ? thread_->run_slice() : Clock::time_point::min();
+        }
+
+        bool complete() override { return !alive_; }
+
+        void finish(std::exception_ptr e) override
+        {
+            try
+            {
+                thread_.reset();
+            }
+            catch (...)
+            {
+                if (!e)
+                    e = std::current_exception();
+            }
+            on_exit_(e);
+        }
+
+      private:
+        std::function<std::shared_ptr<ThreadType>()> make_thread_;
+        std::atomic<bool>& alive_;
+        std::function<void(std::exception_ptr)> on_exit_;
+        std::shared_ptr<ThreadType> thread_;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Task>> queue;
+        std::thread thread;
+    };
+
+    struct TimerEntry
+    {
+        Clock::time_point time;
+        std::weak_ptr<Task> task;
+        bool operator>(const TimerEntry& other) const { return time > other.time; }
+    };
+
+    void start(std::shared_ptr<Task> task);
+    void schedule(const std::shared_ptr<Task>& task);
+    void push(std::shared_ptr<Task> task);
+    std::shared_ptr<Task> pop(std::size_t worker);
+    void run(std::size_t worker);
+    void run_task(const std::shared_ptr<Task>& task);
+    void add_timer(const std::shared_ptr<Task>& task, Clock::time_point time);
+    // removes and returns the tasks whose timers have expired; sleep_mutex_ must be locked
+    std::vector<std::shared_ptr<Task>> expire_timers(Clock::time_point now);
+
+  private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::uint64_t> next_task_id_{1};
+    std::atomic<std::size_t> next_worker_{0};
+
+    // number of tasks in all the worker queues
+    std::atomic<std::size_t> queued_{0};
+    // number of workers waiting on sleep_cv_
+    std::atomic<int> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool running_{true};
+
+    // protected by sleep_mutex_
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers_;
+    // time of timers_.top() (or max), readable without the lock
+    std::atomic<Clock::rep> next_timer_{Clock::time_point::max().time_since_epoch().count()};
+};
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "goby/exception.h"
+#include "goby/util/debug_logger.h"
+
+#include "thread_scheduling.h"
+
+using goby::glog;
+
+namespace
+{
+// throws or warns (depending on scheduling.required()), returning false
+bool scheduling_error(const goby::middleware::protobuf::ThreadScheduling& scheduling,
+                      const std::string& thread_name, const std::string& what, int error)
+{
+    std::string msg = "Failed to set " + what + " for thread " + thread_name + ": " +
+                      std::strerror(error);
+    if (scheduling.required())
+        throw(goby::Exception(msg));
+    else
+        glog.is_warn() && glog << msg << std::endl;
+    return false;
+}
+} // namespace
+
+void goby::middleware::apply_thread_scheduling(const protobuf::ThreadScheduling& scheduling,
+                                               const std::string& thread_name)
+{
+    bool applied = true;
+    if (scheduling.cpu_size() > 0)
+    {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : scheduling.cpu()) CPU_SET(cpu, &cpus);
+
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error)
+            applied = scheduling_error(scheduling, thread_name, "CPU affinity", error);
+#else
+        applied = scheduling_error(scheduling, thread_name, "CPU affinity", ENOTSUP);
+#endif
+    }
+
+    int policy = SCHED_OTHER;
+    sched_param param;
+    param.sched_priority = 0;
+    switch (scheduling.policy())
+    {
+        case protobuf::ThreadScheduling::POLICY_DEFAULT: break;
+        case protobuf::ThreadScheduling::POLICY_FIFO:
+            policy = SCHED_FIFO;
+            param.sched_priority = scheduling.priority();
+            break;
+        case protobuf::ThreadScheduling::POLICY_RR:
+            policy = SCHED_RR;
+            param.sched_priority = scheduling.priority();
+            break;
+    }
+
+    if (scheduling.has_policy())
+    {
+        int error = pthread_setschedparam(pthread_self(), policy, &param);
+        if (error)
+        {
+            auto what = "scheduling policy " +
+                        protobuf::ThreadScheduling::Policy_Name(scheduling.policy()) +
+                        " (priority " + std::to_string(param.sched_priority) + ")";
+            applied = scheduling_error(scheduling, thread_name, what, error);
+        }
+    }
+
+    if (applied)
+        glog.is_debug1() && glog << "Thread " << thread_name
+                                 << " scheduling: " << scheduling.ShortDebugString() << std::endl;
+}
+
+void goby::middleware::lock_memory()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        glog.is_warn() && glog << "Failed to lock memory (mlockall): " << std::strerror(errno)
+                               << std::endl;
+    }
+    else
+    {
+        glog.is_debug1() && glog << "Locked process memory (mlockall)" << std::endl;
+    }
+}
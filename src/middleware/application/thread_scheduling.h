@@ -0,0 +1,49 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ThreadScheduling20201019H
+#define ThreadScheduling20201019H
+
+#include <string>
+
+#include "goby/middleware/protobuf/thread_scheduling.pb.h"
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Set the CPU affinity and scheduling policy/priority of the calling thread
+///
+/// On failure (e.g. insufficient privileges for a real-time policy, or CPU affinity on a platform other than Linux) this throws goby::Exception if scheduling.required() is true, otherwise it logs a warning and leaves the thread's current settings in place
+/// \param scheduling Settings to apply
+/// \param thread_name Name of the thread, used in log and exception messages
+void apply_thread_scheduling(const protobuf::ThreadScheduling& scheduling,
+                             const std::string& thread_name);
+
+/// \brief Lock all current and future pages of the process into memory (mlockall(MCL_CURRENT | MCL_FUTURE)). Failure (usually due to RLIMIT_MEMLOCK) is logged as a warning
+void lock_memory();
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -25,7 +25,10 @@
 #ifndef Common20200603H
 #define Common20200603H
 
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <sstream>
 #include <thread>
 
@@ -45,10 +48,72 @@ inline std::string to_string(goby::middleware::protobuf::Layer layer)
     boost::to_lower(name);
     return name;
 }
-inline std::string thread_id(std::thread::id i = std::this_thread::get_id())
+
+/// \brief Identifies a thread of execution to the transporters: either an operating system thread, or a task run by a ThreadExecutor (which may run on a different operating system thread each time it is scheduled)
+class ThreadId
+{
+  public:
+    ThreadId(std::thread::id id = std::thread::id()) : os_id_(id) {}
+
+    /// \brief Identifier for a ThreadExecutor task (task > 0)
+    static ThreadId task(std::uint64_t task)
+    {
+        ThreadId id;
+        id.task_ = task;
+        return id;
+    }
+
+    bool is_task() const { return task_ != 0; }
+    std::uint64_t task() const { return task_; }
+
+    std::size_t hash() const
+    {
+        return is_task() ? std::hash<std::uint64_t>{}(task_)
+                         : std::hash<std::thread::id>{}(os_id_);
+    }
+
+    bool operator==(const ThreadId& other) const
+    {
+        return task_ == other.task_ && os_id_ == other.os_id_;
+    }
+    bool operator!=(const ThreadId& other) const { return !(*this == other); }
+
+  private:
+    std::thread::id os_id_;
+    std::uint64_t task_{0};
+};
+
+namespace detail
+{
+/// \brief ThreadExecutor task currently running on this operating system thread (if any)
+struct TaskContext
+{
+    ThreadId id;
+    // called by the interthread layer when data are queued for the task
+    std::shared_ptr<const std::function<void()>> wake;
+};
+
+inline TaskContext& this_task_context()
+{
+    static thread_local TaskContext context;
+    return context;
+}
+} // namespace detail
+
+/// \brief Returns the identifier of the calling thread of execution: the ThreadExecutor task being run, or else the operating system thread
+inline ThreadId this_thread_id()
+{
+    const auto& context = detail::this_task_context();
+    return context.id.is_task() ? context.id : ThreadId(std::this_thread::get_id());
+}
+
+inline std::string thread_id(ThreadId i = this_thread_id())
 {
     std::stringstream ss;
-    ss << std::hex << std::hash<std::thread::id>{}(i);
+    if (i.is_task())
+        ss << "task" << i.task();
+    else
+        ss << std::hex << i.hash();
     return ss.str();
 }
 
@@ -80,4 +145,12 @@ inline std::string full_process_id()
 } // namespace middleware
 } // namespace goby
 
+namespace std
+{
+template <> struct hash<goby::middleware::ThreadId>
+{
+    size_t operator()(const goby::middleware::ThreadId& id) const noexcept { return id.hash(); }
+};
+} // namespace std
+
 #endif
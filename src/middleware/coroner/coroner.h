@@ -27,4 +27,6 @@
 #include "goby/middleware/coroner/groups.h"
 #include "goby/middleware/protobuf/coroner.pb.h"
 
+#include "goby/middleware/coroner/health_responder.h"
+
 #endif
@@ -37,6 +37,7 @@ namespace groups
 constexpr goby::middleware::Group health_request{"goby::health::request"};
 constexpr goby::middleware::Group health_response{"goby::health::response"};
 constexpr goby::middleware::Group health_report{"goby::health::report"};
+constexpr goby::middleware::Group health_heartbeat{"goby::health::heartbeat"};
 
 } // namespace groups
 } // namespace middleware
@@ -0,0 +1,164 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CORONER_HEALTH_RESPONDER_20201019H
+#define CORONER_HEALTH_RESPONDER_20201019H
+
+#include <chrono>
+#include <string>
+
+#include <unistd.h>
+
+#include "goby/middleware/coroner/groups.h"
+#include "goby/middleware/marshalling/protobuf.h"
+#include "goby/middleware/protobuf/coroner.pb.h"
+#include "goby/time/convert.h"
+#include "goby/time/simulation.h"
+
+namespace goby
+{
+namespace middleware
+{
+namespace coroner
+{
+/// \brief Process side of the goby_coroner health protocol, used by SingleThreadApplication and MultiThreadApplication
+///
+/// In request/response mode (the default), a full ProcessHealth is published in response to each HealthRequest. If the HealthRequest sets heartbeat_interval, the process also switches to push mode: a compact HealthHeartbeat is published every heartbeat_interval and the full ProcessHealth is only republished when its contents change (tracked by report_version). Push mode lapses if no HealthRequest is received within heartbeat_lease (e.g. goby_coroner has exited).
+class HealthResponder
+{
+  public:
+    using Clock = std::chrono::system_clock;
+
+    HealthResponder(std::string name) { report_.set_name(name); report_.set_pid(getpid()); }
+
+    /// \brief Handle a HealthRequest, publishing the full ProcessHealth
+    ///
+    /// \param request Request from goby_coroner
+    /// \param interprocess Transporter to publish the response on
+    /// \param fill_health Function called with the ThreadHealth to populate (e.g. Thread::thread_health)
+    template <typename Transporter, typename HealthFunc>
+    void handle_request(const protobuf::HealthRequest& request, Transporter& interprocess,
+                        HealthFunc fill_health)
+    {
+        auto now = Clock::now();
+        if (request.has_heartbeat_interval() && request.heartbeat_interval() > 0)
+        {
+            bool was_active = active();
+            interval_ = to_clock_duration(request.heartbeat_interval_with_units());
+            lease_end_ = request.has_heartbeat_lease()
+                             ? now + to_clock_duration(request.heartbeat_lease_with_units())
+                             : Clock::time_point::max();
+            if (!was_active)
+                next_heartbeat_ = now + interval_;
+        }
+        else
+        {
+            interval_ = Clock::duration::zero();
+        }
+
+        update_report(fill_health);
+        interprocess.template publish<groups::health_response>(report_);
+    }
+
+    /// \brief Time at which heartbeat() next needs to be called, or Clock::time_point::max() if not in push mode
+    Clock::time_point next_heartbeat() const
+    {
+        return active() ? next_heartbeat_ : Clock::time_point::max();
+    }
+
+    /// \brief Publish a HealthHeartbeat (and ProcessHealth if changed) if one is due. Call this from the main thread whenever it wakes up.
+    template <typename Transporter, typename HealthFunc>
+    void heartbeat(Transporter& interprocess, HealthFunc fill_health)
+    {
+        if (!active())
+            return;
+
+        auto now = Clock::now();
+        if (now >= lease_end_)
+        {
+            interval_ = Clock::duration::zero();
+            return;
+        }
+
+        if (now < next_heartbeat_)
+            return;
+
+        next_heartbeat_ += interval_;
+        // don't try to catch up on missed heartbeats (e.g. after a long callback)
+        if (next_heartbeat_ < now)
+            next_heartbeat_ = now + interval_;
+
+        if (update_report(fill_health))
+            interprocess.template publish<groups::health_response>(report_);
+
+        heartbeat_.set_name(report_.name());
+        heartbeat_.set_pid(report_.pid());
+        heartbeat_.set_state(report_.main().state());
+        heartbeat_.set_report_version(report_.report_version());
+        interprocess.template publish<groups::health_heartbeat>(heartbeat_);
+    }
+
+  private:
+    bool active() const { return interval_ > Clock::duration::zero(); }
+
+    template <typename Quantity> Clock::duration to_clock_duration(Quantity q)
+    {
+        // match Thread loop(), which runs faster in warped simulation time
+        return std::chrono::duration_cast<Clock::duration>(
+                   time::convert_duration<std::chrono::microseconds>(q)) /
+               time::SimulatorSettings::warp_factor;
+    }
+
+    // returns true if the report changed
+    template <typename HealthFunc> bool update_report(HealthFunc fill_health)
+    {
+        latest_.Clear();
+        fill_health(*latest_.mutable_main());
+        latest_.SerializeToString(&latest_bytes_);
+
+        if (report_.has_report_version() && latest_bytes_ == report_bytes_)
+            return false;
+
+        report_bytes_.swap(latest_bytes_);
+        report_.mutable_main()->Swap(latest_.mutable_main());
+        report_.set_report_version(report_.report_version() + 1);
+        return true;
+    }
+
+  private:
+    Clock::duration interval_{Clock::duration::zero()};
+    Clock::time_point next_heartbeat_;
+    Clock::time_point lease_end_{Clock::time_point::max()};
+
+    protobuf::ProcessHealth report_;
+    std::string report_bytes_;
+    protobuf::ProcessHealth latest_;
+    std::string latest_bytes_;
+    protobuf::HealthHeartbeat heartbeat_;
+};
+
+} // namespace coroner
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CORONER_LIVENESS_20201019H
+#define CORONER_LIVENESS_20201019H
+
+#include <set>
+#include <string>
+
+#include "goby/util/timer_wheel.h"
+
+namespace goby
+{
+namespace middleware
+{
+namespace coroner
+{
+/// \brief Push mode liveness tracking for goby_coroner
+///
+/// Processes that have sent at least one HealthHeartbeat are held to the heartbeat deadline (heartbeat_interval * heartbeat_missed_limit). Processes that only send ProcessHealth (e.g. those that do not support push mode and only answer the periodic HealthRequest) are held to the request deadline (request_interval + response_timeout) instead, so they are not declared dead between requests.
+///
+/// \tparam Clock Clock type (e.g. goby::time::SystemClock)
+template <typename Clock> class LivenessMonitor
+{
+  public:
+    using time_point = typename Clock::time_point;
+    using duration = typename Clock::duration;
+
+    /// \brief Construct the monitor
+    ///
+    /// \param heartbeat_timeout Time without a HealthHeartbeat after which a heartbeating process is dead
+    /// \param response_timeout Time without a ProcessHealth after which a response-only process is dead
+    /// \param tick Resolution of the underlying timer wheel
+    /// \param start Current time
+    LivenessMonitor(duration heartbeat_timeout, duration response_timeout, duration tick,
+                    time_point start = Clock::now())
+        : heartbeat_timeout_(heartbeat_timeout),
+          response_timeout_(response_timeout),
+          deadlines_(tick, 64, start)
+    {
+    }
+
+    /// \brief Start tracking a process that is expected to report (it is dead if nothing arrives within the response timeout)
+    void expect(const std::string& name, time_point now)
+    {
+        deadlines_.schedule(name, now + response_timeout_);
+    }
+
+    /// \brief Record a HealthHeartbeat from \c name
+    ///
+    /// \return true if \c name had previously been declared dead
+    bool heartbeat(const std::string& name, time_point now)
+    {
+        heartbeating_.insert(name);
+        deadlines_.schedule(name, now + heartbeat_timeout_);
+        return dead_.erase(name) > 0;
+    }
+
+    /// \brief Record a ProcessHealth from \c name
+    ///
+    /// \return true if \c name had previously been declared dead
+    bool response(const std::string& name, time_point now)
+    {
+        // a response does not move a heartbeating process's (shorter) deadline out
+        if (!heartbeating_.count(name))
+            deadlines_.schedule(name, now + response_timeout_);
+        return dead_.erase(name) > 0;
+    }
+
+    /// \brief Declare dead all processes whose deadline has passed, calling \c died(name) for each
+    ///
+    /// \return number of processes declared dead
+    template <typename DiedFunc> std::size_t advance(time_point now, DiedFunc died)
+    {
+        return deadlines_.advance(now, [&](const std::string& name) {
+            // it may come back without push mode support (e.g. a different build), so start over
+            heartbeating_.erase(name);
+            dead_.insert(name);
+            died(name);
+        });
+    }
+
+    /// \brief Returns true if \c name has been declared dead (and has not since reported)
+    bool dead(const std::string& name) const { return dead_.count(name); }
+
+    /// \brief Returns true if \c name has sent a HealthHeartbeat since it was last declared dead
+    bool heartbeating(const std::string& name) const { return heartbeating_.count(name); }
+
+  private:
+    duration heartbeat_timeout_;
+    duration response_timeout_;
+    goby::util::TimerWheel<std::string, Clock> deadlines_;
+    std::set<std::string> heartbeating_;
+    std::set<std::string> dead_;
+};
+
+} // namespace coroner
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -40,6 +40,7 @@ namespace gtime = goby::time;
 
 using goby::glog;
 using goby::util::NMEASentence;
+using goby::util::NMEASentenceView;
 
 using namespace goby::util::logger;
 using namespace goby::util::tcolor;
@@ -462,7 +463,7 @@ void goby::middleware::frontseat::Bluefin::try_receive()
         // try to handle the received message, posting appropriate signals
         try
         {
-            NMEASentence nmea(in, NMEASentence::VALIDATE);
+            NMEASentenceView nmea(in, NMEASentence::VALIDATE);
             process_receive(nmea);
         }
         catch (std::exception& e)
@@ -606,10 +607,10 @@ void goby::middleware::frontseat::Bluefin::write(const NMEASentence& nmea)
     }
 }
 
-void goby::middleware::frontseat::Bluefin::process_receive(const NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::process_receive(const NMEASentenceView& nmea)
 {
     gpb::Raw raw_msg;
-    raw_msg.set_raw(nmea.message());
+    raw_msg.set_raw(nmea.message().data(), nmea.message().size());
     raw_msg.set_description(description_map_[nmea.front()]);
 
     signal_raw_from_frontseat(raw_msg);
@@ -617,9 +618,10 @@ void goby::middleware::frontseat::Bluefin::process_receive(const NMEASentence& n
     nmea_demerits_ = 0;
 
     // look at the sentence id (last three characters of the NMEA 0183 talker)
-    if (sentence_id_map_.left.count(nmea.sentence_id()))
+    auto sentence_id_it = sentence_id_map_.left.find(nmea.sentence_id().to_string());
+    if (sentence_id_it != sentence_id_map_.left.end())
     {
-        switch (sentence_id_map_.left.at(nmea.sentence_id()))
+        switch (sentence_id_it->second)
         {
             case ACK: bfack(nmea); break; // nmea ack
 
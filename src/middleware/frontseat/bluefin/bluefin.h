@@ -67,24 +67,24 @@ class Bluefin : public InterfaceBase
     void try_send();
     void try_receive();
     void write(const goby::util::NMEASentence& nmea);
-    void process_receive(const goby::util::NMEASentence& nmea);
-
-    void bfack(const goby::util::NMEASentence& nmea);
-    void bfnvr(const goby::util::NMEASentence& nmea);
-    void bfsvs(const goby::util::NMEASentence& nmea);
-    void bfrvl(const goby::util::NMEASentence& nmea);
-    void bfnvg(const goby::util::NMEASentence& nmea);
-    void bfmsc(const goby::util::NMEASentence& nmea);
-    void bfsht(const goby::util::NMEASentence& nmea);
-    void bfmbs(const goby::util::NMEASentence& nmea);
-    void bfboy(const goby::util::NMEASentence& nmea);
-    void bftrm(const goby::util::NMEASentence& nmea);
-    void bfmbe(const goby::util::NMEASentence& nmea);
-    void bftop(const goby::util::NMEASentence& nmea);
-    void bfdvl(const goby::util::NMEASentence& nmea);
-    void bfmis(const goby::util::NMEASentence& nmea);
-    void bfctd(const goby::util::NMEASentence& nmea);
-    void bfctl(const goby::util::NMEASentence& nmea);
+    void process_receive(const goby::util::NMEASentenceView& nmea);
+
+    void bfack(const goby::util::NMEASentenceView& nmea);
+    void bfnvr(const goby::util::NMEASentenceView& nmea);
+    void bfsvs(const goby::util::NMEASentenceView& nmea);
+    void bfrvl(const goby::util::NMEASentenceView& nmea);
+    void bfnvg(const goby::util::NMEASentenceView& nmea);
+    void bfmsc(const goby::util::NMEASentenceView& nmea);
+    void bfsht(const goby::util::NMEASentenceView& nmea);
+    void bfmbs(const goby::util::NMEASentenceView& nmea);
+    void bfboy(const goby::util::NMEASentenceView& nmea);
+    void bftrm(const goby::util::NMEASentenceView& nmea);
+    void bfmbe(const goby::util::NMEASentenceView& nmea);
+    void bftop(const goby::util::NMEASentenceView& nmea);
+    void bfdvl(const goby::util::NMEASentenceView& nmea);
+    void bfmis(const goby::util::NMEASentenceView& nmea);
+    void bfctd(const goby::util::NMEASentenceView& nmea);
+    void bfctl(const goby::util::NMEASentenceView& nmea);
 
     std::string unix_time2nmea_time(goby::time::SystemClock::time_point time);
 
@@ -30,12 +30,12 @@ namespace gpb = goby::middleware::frontseat::protobuf;
 namespace gtime = goby::time;
 
 using goby::glog;
-using goby::util::NMEASentence;
+using goby::util::NMEASentenceView;
 using namespace goby::util::logger;
 using namespace goby::util::tcolor;
 using goby::middleware::frontseat::protobuf::BluefinConfig;
 
-void goby::middleware::frontseat::Bluefin::bfack(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfack(const goby::util::NMEASentenceView& nmea)
 {
     frontseat_providing_data_ = true;
     last_frontseat_data_time_ = gtime::SystemClock::now();
@@ -139,7 +139,7 @@ void goby::middleware::frontseat::Bluefin::bfack(const goby::util::NMEASentence&
     waiting_for_huxley_ = false;
 }
 
-void goby::middleware::frontseat::Bluefin::bfmsc(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfmsc(const goby::util::NMEASentenceView& nmea)
 {
     // TODO: See if there is something to the message contents
     // BF manual says: Arbitrary textual message. Semantics determined by the payload.
@@ -147,7 +147,7 @@ void goby::middleware::frontseat::Bluefin::bfmsc(const goby::util::NMEASentence&
         frontseat_state_ = gpb::FRONTSEAT_ACCEPTING_COMMANDS;
 }
 
-void goby::middleware::frontseat::Bluefin::bfnvg(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfnvg(const goby::util::NMEASentenceView& nmea)
 {
     frontseat_providing_data_ = true;
     last_frontseat_data_time_ = gtime::SystemClock::now();
@@ -173,11 +173,11 @@ void goby::middleware::frontseat::Bluefin::bfnvg(const goby::util::NMEASentence&
     status_.set_time_with_units(
         gtime::convert_from_nmea<gtime::MicroTime>(nmea.at(COMPUTED_TIMESTAMP)));
 
-    const std::string& lat_string = nmea.at(LATITUDE);
+    boost::string_view lat_string = nmea.at(LATITUDE);
     if (lat_string.length() > 2)
     {
-        double lat_deg = goby::util::as<double>(lat_string.substr(0, 2));
-        double lat_min = goby::util::as<double>(lat_string.substr(2, lat_string.size()));
+        double lat_deg = NMEASentenceView::field_as<double>(lat_string.substr(0, 2));
+        double lat_min = NMEASentenceView::field_as<double>(lat_string.substr(2));
         double lat = lat_deg + lat_min / 60;
         status_.mutable_global_fix()->set_lat((nmea.at(LAT_HEMISPHERE) == "S") ? -lat : lat);
     }
@@ -186,11 +186,11 @@ void goby::middleware::frontseat::Bluefin::bfnvg(const goby::util::NMEASentence&
         status_.mutable_global_fix()->set_lat(std::numeric_limits<double>::quiet_NaN());
     }
 
-    const std::string& lon_string = nmea.at(LONGITUDE);
+    boost::string_view lon_string = nmea.at(LONGITUDE);
     if (lon_string.length() > 2)
     {
-        double lon_deg = goby::util::as<double>(lon_string.substr(0, 3));
-        double lon_min = goby::util::as<double>(lon_string.substr(3, nmea.at(4).size()));
+        double lon_deg = NMEASentenceView::field_as<double>(lon_string.substr(0, 3));
+        double lon_min = NMEASentenceView::field_as<double>(lon_string.substr(3));
         double lon = lon_deg + lon_min / 60;
         status_.mutable_global_fix()->set_lon((nmea.at(LON_HEMISPHERE) == "W") ? -lon : lon);
     }
@@ -211,7 +211,7 @@ void goby::middleware::frontseat::Bluefin::bfnvg(const goby::util::NMEASentence&
     status_.mutable_pose()->set_pitch(nmea.as<double>(PITCH));
 }
 
-void goby::middleware::frontseat::Bluefin::bfnvr(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfnvr(const goby::util::NMEASentenceView& nmea)
 {
     enum
     {
@@ -249,20 +249,20 @@ void goby::middleware::frontseat::Bluefin::bfnvr(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bfsvs(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfsvs(const goby::util::NMEASentenceView& nmea)
 {
     // If the Bluefin vehicle is equipped with a sound velocity sensor, this message will provide the raw output of that sensor. If not, then an estimated value will be provided.
 
     // We don't use this, choosing to calculate it ourselves from the CTD
 }
 
-void goby::middleware::frontseat::Bluefin::bfsht(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfsht(const goby::util::NMEASentenceView& nmea)
 {
     glog.is(WARN) && glog << "Bluefin sent us the SHT message: they are shutting down!"
                           << std::endl;
 }
 
-void goby::middleware::frontseat::Bluefin::bfmbs(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfmbs(const goby::util::NMEASentenceView& nmea)
 {
     // This message is sent when the Bluefin vehicle is just beginning a new behavior in the current mission. It can be used by payloads for record-keeping or to synchronize actions with the current mission. Use of the (d--d) dive file field is considered deprecated in favor of getting the same information from BFMIS. See also the BFPLN message below.
 
@@ -279,7 +279,7 @@ void goby::middleware::frontseat::Bluefin::bfmbs(const goby::util::NMEASentence&
     glog.is(DEBUG1) && glog << "Bluefin began frontseat mission: " << behavior_type << std::endl;
 }
 
-void goby::middleware::frontseat::Bluefin::bfboy(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfboy(const goby::util::NMEASentenceView& nmea)
 {
     enum
     {
@@ -306,7 +306,7 @@ void goby::middleware::frontseat::Bluefin::bfboy(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bftrm(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bftrm(const goby::util::NMEASentenceView& nmea)
 {
     enum
     {
@@ -335,7 +335,7 @@ void goby::middleware::frontseat::Bluefin::bftrm(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bfmbe(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfmbe(const goby::util::NMEASentenceView& nmea)
 {
     enum
     {
@@ -351,13 +351,13 @@ void goby::middleware::frontseat::Bluefin::bfmbe(const goby::util::NMEASentence&
     glog.is(DEBUG1) && glog << "Bluefin ended frontseat mission: " << behavior_type << std::endl;
 }
 
-void goby::middleware::frontseat::Bluefin::bftop(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bftop(const goby::util::NMEASentenceView& nmea)
 {
     // Topside Message (Not Implemented)
     // Delivery of a message sent from the topside.
 }
 
-void goby::middleware::frontseat::Bluefin::bfdvl(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfdvl(const goby::util::NMEASentenceView& nmea)
 {
     // $BFDVL,hhmmss.ss,x.x,y.y,z.z,r1,r2,r3,r4,t.t,hhmmss.ss*hh
     //hhmmss.ss Timestamp (when message is sent)
@@ -416,7 +416,7 @@ void goby::middleware::frontseat::Bluefin::bfdvl(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bfrvl(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfrvl(const goby::util::NMEASentenceView& nmea)
 {
     // Vehicle velocity through water as estimated from thruster RPM, may be empty if no lookup table is implemented (m/s)
     enum
@@ -439,7 +439,7 @@ void goby::middleware::frontseat::Bluefin::bfrvl(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bfmis(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfmis(const goby::util::NMEASentenceView& nmea)
 {
     std::string running = nmea.at(3);
     if (running.find("Running") != std::string::npos)
@@ -465,7 +465,7 @@ void goby::middleware::frontseat::Bluefin::bfmis(const goby::util::NMEASentence&
     }
 }
 
-void goby::middleware::frontseat::Bluefin::bfctd(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfctd(const goby::util::NMEASentenceView& nmea)
 {
     gpb::InterfaceData data;
     gpb::CTDSample* ctd_sample = data.mutable_ctd_sample();
@@ -491,7 +491,7 @@ void goby::middleware::frontseat::Bluefin::bfctd(const goby::util::NMEASentence&
     signal_data_from_frontseat(data);
 }
 
-void goby::middleware::frontseat::Bluefin::bfctl(const goby::util::NMEASentence& nmea)
+void goby::middleware::frontseat::Bluefin::bfctl(const goby::util::NMEASentenceView& nmea)
 {
     if (bf_config_.accepting_commands_hook() == BluefinConfig::BFCTL_TRIGGER)
     {
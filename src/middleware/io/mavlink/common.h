@@ -74,19 +74,9 @@ class IOThreadMAVLink : public IOThreadBase
     void try_parse(std::size_t bytes_transferred);
     std::array<char, MAVLINK_MAX_PACKET_LEN>& buffer() { return buffer_; }
 
-  private:
-    void clear_buffers()
-    {
-        msg_ = {};
-        status_ = {};
-        msg_buffer_ = {};
-        status_buffer_ = {};
-    }
-
   private:
     std::array<char, MAVLINK_MAX_PACKET_LEN> buffer_;
-    mavlink::mavlink_message_t msg_{}, msg_buffer_{};
-    mavlink::mavlink_status_t status_{}, status_buffer_{};
+    MAVLinkStreamParser parser_;
 };
 } // namespace io
 } // namespace middleware
@@ -101,69 +91,16 @@ void goby::middleware::io::IOThreadMAVLink<line_in_group, line_out_group, publis
                                            IOConfig>::try_parse(std::size_t bytes_transferred)
 {
     auto bytes_begin = buffer_.begin(), bytes_end = buffer_.begin() + bytes_transferred;
-    for (auto c = bytes_begin; c != bytes_end; ++c)
-    {
-        try
-        {
-            auto res = mavlink::mavlink_frame_char_buffer(&msg_buffer_, &status_buffer_, *c, &msg_,
-                                                          &status_);
-            switch (res)
-            {
-                case mavlink::MAVLINK_FRAMING_BAD_CRC:
-                    if (status_.parse_state != mavlink::MAVLINK_PARSE_STATE_IDLE)
-                    {
-                        break; // keep parsing
-                    }
-                    else if (mavlink::mavlink_get_msg_entry(msg_.msgid) == nullptr)
-                    {
-                        goby::glog.is_debug3() &&
-                            goby::glog << "BAD CRC decoding MAVLink msg, but "
-                                          "forwarding because we don't know this msgid"
-                                       << std::endl;
-                        // forward anyway as it might be a msgid we don't know
-                        // so flow through here (no break) is intentional!!
-                    }
-                    else
-                    {
-                        goby::glog.is_warn() && goby::glog << "BAD CRC decoding MAVLink msg"
-                                                           << std::endl;
-                        break;
-                    }
-
-                case mavlink::MAVLINK_FRAMING_OK:
-                {
-                    goby::glog.is_debug3() && goby::glog << "Parsed message of id: " << msg_.msgid
-                                                         << std::endl;
-
-                    this->publish_transporter().template publish<line_in_group>(msg_);
-
-                    std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buffer;
-                    auto length = mavlink::mavlink_msg_to_send_buffer(&buffer[0], &msg_);
-                    std::string bytes(buffer.begin(), buffer.begin() + length);
-                    this->handle_read_success(length, bytes);
-                    break;
-                }
-
-                case mavlink::MAVLINK_FRAMING_INCOMPLETE: break;
-
-                case mavlink::MAVLINK_FRAMING_BAD_SIGNATURE:
-                    goby::glog.is_warn() && goby::glog << "BAD SIGNATURE decoding MAVLink msg"
-                                                       << std::endl;
-                    break;
-                default:
-                    goby::glog.is_warn() && goby::glog << "Unknown value " << res
-                                                       << " returned while decoding MAVLink msg"
-                                                       << std::endl;
-                    break;
-            }
-        }
-        catch (goby::Exception& e)
-        {
-            goby::glog.is_warn() && goby::glog << "Exception decoding MAVLink msg: " << e.what()
-                                               << std::endl;
-            clear_buffers();
-        }
-    }
+    parser_.parse(bytes_begin, bytes_end, [this](std::shared_ptr<mavlink::mavlink_message_t> msg) {
+        this->publish_transporter().template publish<line_in_group>(
+            std::shared_ptr<const mavlink::mavlink_message_t>(msg));
+
+        std::array<uint8_t, MAVLINK_MAX_PACKET_LEN> buffer;
+        auto length = mavlink::mavlink_msg_to_send_buffer(&buffer[0], msg.get());
+        auto io_msg = std::make_shared<goby::middleware::protobuf::IOData>();
+        io_msg->set_data(&buffer[0], length);
+        this->handle_read_success(length, io_msg);
+    });
 }
 
 #endif
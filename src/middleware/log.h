@@ -25,6 +25,7 @@
 #define Log20190124H
 
 #include "goby/middleware/log/log_entry.h"
+#include "goby/middleware/log/log_player.h"
 #include "goby/middleware/log/log_plugin.h"
 
 #endif
@@ -21,6 +21,8 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <zlib.h>
+
 #include "log_entry.h"
 
 using goby::middleware::log::LogEntry;
@@ -48,6 +50,17 @@ goby::middleware::log::uint<LogEntry::type_bytes_>::type
 goby::middleware::log::uint<LogEntry::version_bytes_>::type
     LogEntry::version_(LogEntry::invalid_version);
 
+std::uint32_t LogEntry::block_bytes_(0);
+int LogEntry::compression_level_(1);
+std::ostringstream LogEntry::block_out_;
+LogEntry::BlockIndexEntry LogEntry::block_;
+std::vector<LogEntry::BlockIndexEntry> LogEntry::block_index_;
+std::istringstream LogEntry::block_in_;
+
+const std::string LogEntry::magic_{"GBY3"};
+const std::string LogEntry::block_magic_{"GBYB"};
+const std::string LogEntry::index_magic_{"GBYI"};
+
 void LogEntry::parse_version(std::istream* s)
 {
     version_ = read_one<uint<version_bytes_>::type>(s);
@@ -82,238 +95,303 @@ void LogEntry::parse(std::istream* s)
     auto old_except_mask = s->exceptions();
     s->exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
 
-    int legacy_scheme = goby::middleware::MarshallingScheme::NULL_SCHEME;
-
     uint<scheme_bytes_>::type scheme(0);
 
     bool filter_matched = false;
+    bool entry_read = false;
     do
     {
-        char next_char = s->peek();
-        if (next_char != magic_[0])
+        std::istream* in = next_entry_stream(s);
+        try
+        {
+            entry_read = parse_entry(in, &scheme, &filter_matched);
+        }
+        catch (std::ios_base::failure& e)
         {
-            glog.is(WARN) && glog << "Next byte [0x" << std::hex
-                                  << (static_cast<int>(next_char) & 0xFF) << std::dec
-                                  << "] is not the start of the expected magic word [" << magic_
-                                  << "]. Seeking until next magic word." << std::endl;
+            if (in != &block_in_)
+                throw;
+
+            // block passed the CRC check so this shouldn't happen, but don't treat as end of file
+            block_in_.str(std::string());
+            block_in_.clear();
+            throw(log::LogException("Truncated entry at end of compressed block"));
         }
+    } while (!entry_read || scheme == scheme_group_index_ || scheme == scheme_type_index_ ||
+             filter_matched);
 
-        std::string magic_read(magic_.size(), '\0');
-        int discarded = 0;
+    s->exceptions(old_except_mask);
+}
 
-        for (;;)
+bool LogEntry::parse_entry(std::istream* s, uint<scheme_bytes_>::type* scheme_ptr,
+                           bool* filter_matched_ptr)
+{
+    using namespace goby::util::logger;
+    using goby::glog;
+
+    int legacy_scheme = goby::middleware::MarshallingScheme::NULL_SCHEME;
+    auto& scheme = *scheme_ptr;
+    auto& filter_matched = *filter_matched_ptr;
+
+    char next_char = s->peek();
+    if (next_char != magic_[0])
+    {
+        glog.is(WARN) && glog << "Next byte [0x" << std::hex
+                              << (static_cast<int>(next_char) & 0xFF) << std::dec
+                              << "] is not the start of the expected magic word [" << magic_
+                              << "]. Seeking until next magic word." << std::endl;
+    }
+
+    std::string magic_read(magic_.size(), '\0');
+    int discarded = 0;
+
+    for (;;)
+    {
+        s->read(&magic_read[0], magic_.size());
+        if (magic_read == magic_)
         {
-            s->read(&magic_read[0], magic_.size());
-            if (magic_read == magic_)
-            {
-                break;
-            }
-            else
-            {
-                ++discarded;
-                // rewind to read the next byte
-                s->seekg(s->tellg() - std::ios::streamoff(magic_.size() - 1));
-            }
+            break;
         }
+        else if (version_ >= 4 && s != &block_in_ &&
+                 (magic_read == block_magic_ || magic_read == index_magic_))
+        {
+            if (discarded != 0)
+                glog.is(WARN) && glog << "Found next compressed block or block index after "
+                                         "skipping "
+                                      << discarded << " bytes" << std::endl;
 
-        if (discarded != 0)
-            glog.is(WARN) && glog << "Found next magic word after skipping " << discarded
-                                  << " bytes" << std::endl;
+            read_block_or_skip_index(s, magic_read);
+            return false;
+        }
+        else
+        {
+            ++discarded;
+            // rewind to read the next byte
+            s->seekg(s->tellg() - std::ios::streamoff(magic_.size() - 1));
+        }
+    }
 
-        boost::crc_32_type crc;
-        crc.process_bytes(&magic_read[0], magic_.size());
+    if (discarded != 0)
+        glog.is(WARN) && glog << "Found next magic word after skipping " << discarded
+                              << " bytes" << std::endl;
 
-        auto size(read_one<uint<size_bytes_>::type>(s, &crc));
-        decltype(size) fixed_field_size = scheme_bytes_ + group_bytes_ + type_bytes_ + crc_bytes_;
+    boost::crc_32_type crc;
+    crc.process_bytes(&magic_read[0], magic_.size());
 
-        if (size < fixed_field_size)
-            throw(log::LogException("Invalid size read: " + std::to_string(size) +
-                                    " as message must be at least " +
-                                    std::to_string(fixed_field_size) + " bytes long"));
+    auto size(read_one<uint<size_bytes_>::type>(s, &crc));
+    decltype(size) fixed_field_size = scheme_bytes_ + group_bytes_ + type_bytes_ + crc_bytes_;
+    if (version_ >= 3)
+        fixed_field_size += timestamp_bytes_;
 
-        auto data_size = size - fixed_field_size;
-        glog.is(DEBUG2) && glog << "Reading entry of " << size << " bytes (" << data_size
-                                << " bytes data)" << std::endl;
+    if (size < fixed_field_size)
+        throw(log::LogException("Invalid size read: " + std::to_string(size) +
+                                " as message must be at least " +
+                                std::to_string(fixed_field_size) + " bytes long"));
 
-        scheme = read_one<uint<scheme_bytes_>::type>(s, &crc);
-        auto group_index(read_one<uint<group_bytes_>::type>(s, &crc));
-        auto type_index(read_one<uint<type_bytes_>::type>(s, &crc));
+    auto data_size = size - fixed_field_size;
+    glog.is(DEBUG2) && glog << "Reading entry of " << size << " bytes (" << data_size
+                            << " bytes data)" << std::endl;
 
-        auto data_start_pos = s->tellg();
-        try
-        {
-            data_.resize(data_size);
-            s->read(reinterpret_cast<char*>(&data_[0]), data_size);
+    scheme = read_one<uint<scheme_bytes_>::type>(s, &crc);
+    auto group_index(read_one<uint<group_bytes_>::type>(s, &crc));
+    auto type_index(read_one<uint<type_bytes_>::type>(s, &crc));
+    time::SystemClock::time_point timestamp;
+    if (version_ >= 3)
+        timestamp += std::chrono::microseconds(read_one<uint<timestamp_bytes_>::type>(s, &crc));
 
-            crc.process_bytes(&data_[0], data_.size());
+    auto data_start_pos = s->tellg();
+    try
+    {
+        data_.resize(data_size);
+        s->read(reinterpret_cast<char*>(&data_[0]), data_size);
 
-            auto calculated_crc = crc.checksum();
-            auto given_crc(read_one<uint<crc_bytes_>::type>(s));
+        crc.process_bytes(&data_[0], data_.size());
 
-            if (calculated_crc != given_crc)
-            {
-                // return to where we started reading data as the size might have been corrupt
-                s->seekg(data_start_pos);
-                data_.clear();
-                throw(
-                    log::LogException("Invalid CRC on packet: given: " + std::to_string(given_crc) +
-                                      ", calculated: " + std::to_string(calculated_crc)));
-            }
-        }
-        catch (std::ios_base::failure& e)
+        auto calculated_crc = crc.checksum();
+        auto given_crc(read_one<uint<crc_bytes_>::type>(s));
+
+        if (calculated_crc != given_crc)
         {
-            // clear EOF, etc.
-            s->clear();
-            // return to where data reading starting in case size was corrupted
+            // return to where we started reading data as the size might have been corrupt
             s->seekg(data_start_pos);
-            throw(log::LogException("Failed to read " + std::to_string(size) +
-                                    " bytes of data; seeking back to start of data read in hopes "
-                                    "of finding valid next message."));
+            data_.clear();
+            throw(
+                log::LogException("Invalid CRC on packet: given: " + std::to_string(given_crc) +
+                                  ", calculated: " + std::to_string(calculated_crc)));
         }
+    }
+    catch (std::ios_base::failure& e)
+    {
+        // clear EOF, etc.
+        s->clear();
+        // return to where data reading starting in case size was corrupted
+        s->seekg(data_start_pos);
+        throw(log::LogException("Failed to read " + std::to_string(size) +
+                                " bytes of data; seeking back to start of data read in hopes "
+                                "of finding valid next message."));
+    }
 
-        if (scheme == scheme_group_index_)
+    if (scheme == scheme_group_index_)
+    {
+        switch (version_)
         {
-            switch (version_)
+            case 1:
             {
-                case 1:
-                {
-                    std::string group(data_.begin(), data_.end());
+                std::string group(data_.begin(), data_.end());
 
-                    // The first type of .goby files that used a single mapping of type/group
-                    // string for all schemes. This worked fine unless the two schemes are in use that had a common type name.
-                    glog.is(DEBUG1) && glog << "Mapping group [" << group
-                                            << "] to index: " << group_index << std::endl;
+                // The first type of .goby files that used a single mapping of type/group
+                // string for all schemes. This worked fine unless the two schemes are in use that had a common type name.
+                glog.is(DEBUG1) && glog << "Mapping group [" << group
+                                        << "] to index: " << group_index << std::endl;
 
-                    groups_[legacy_scheme].left.insert({group, group_index});
-                    break;
-                }
+                groups_[legacy_scheme].left.insert({group, group_index});
+                break;
+            }
 
-                case 2:
-                {
-                    std::string group_scheme_str(data_.begin(), data_.begin() + scheme_bytes_);
-                    auto group_scheme =
-                        string_to_netint<uint<scheme_bytes_>::type>(group_scheme_str);
-
-                    std::string group(data_.begin() + scheme_bytes_, data_.end());
-                    glog.is(DEBUG1) && glog << "For scheme [" << group_scheme
-                                            << "], mapping group [" << group
-                                            << "] to index: " << group_index << std::endl;
-                    groups_[group_scheme].left.insert({group, group_index});
-
-                    if (new_group_hook[group_scheme])
-                        new_group_hook[group_scheme](goby::middleware::DynamicGroup(group));
-                    break;
-                }
+            case 2:
+            case 3:
+            case 4:
+            {
+                std::string group_scheme_str(data_.begin(), data_.begin() + scheme_bytes_);
+                auto group_scheme =
+                    string_to_netint<uint<scheme_bytes_>::type>(group_scheme_str);
+
+                std::string group(data_.begin() + scheme_bytes_, data_.end());
+                glog.is(DEBUG1) && glog << "For scheme [" << group_scheme
+                                        << "], mapping group [" << group
+                                        << "] to index: " << group_index << std::endl;
+                groups_[group_scheme].left.insert({group, group_index});
+
+                if (new_group_hook[group_scheme])
+                    new_group_hook[group_scheme](goby::middleware::DynamicGroup(group));
+                break;
             }
-            data_.clear();
         }
-        else if (scheme == scheme_type_index_)
+        data_.clear();
+    }
+    else if (scheme == scheme_type_index_)
+    {
+        switch (version_)
         {
-            switch (version_)
+            case 1:
             {
-                case 1:
-                {
-                    std::string type(data_.begin(), data_.end());
-                    glog.is(DEBUG1) && glog << "Mapping type [" << type
-                                            << "] to index: " << type_index << std::endl;
-                    types_[legacy_scheme].left.insert({type, type_index});
-                    break;
-                }
-                case 2:
-                {
-                    std::string type_scheme_str(data_.begin(), data_.begin() + scheme_bytes_);
-                    auto type_scheme = string_to_netint<uint<scheme_bytes_>::type>(type_scheme_str);
+                std::string type(data_.begin(), data_.end());
+                glog.is(DEBUG1) && glog << "Mapping type [" << type
+                                        << "] to index: " << type_index << std::endl;
+                types_[legacy_scheme].left.insert({type, type_index});
+                break;
+            }
+            case 2:
+            case 3:
+            case 4:
+            {
+                std::string type_scheme_str(data_.begin(), data_.begin() + scheme_bytes_);
+                auto type_scheme = string_to_netint<uint<scheme_bytes_>::type>(type_scheme_str);
 
-                    std::string type(data_.begin() + scheme_bytes_, data_.end());
-                    glog.is(DEBUG1) && glog << "For scheme [" << type_scheme << "], mapping type ["
-                                            << type << "] to index: " << type_index << std::endl;
-                    types_[type_scheme].left.insert({type, type_index});
+                std::string type(data_.begin() + scheme_bytes_, data_.end());
+                glog.is(DEBUG1) && glog << "For scheme [" << type_scheme << "], mapping type ["
+                                        << type << "] to index: " << type_index << std::endl;
+                types_[type_scheme].left.insert({type, type_index});
 
-                    if (new_type_hook[type_scheme])
-                        new_type_hook[type_scheme](type);
-                    break;
-                }
+                if (new_type_hook[type_scheme])
+                    new_type_hook[type_scheme](type);
+                break;
             }
-
-            data_.clear();
         }
-        else
-        {
-            scheme_ = scheme;
 
-            std::string type = "_unknown" + std::to_string(type_index) + "_";
-            auto type_it = types_[scheme].right.find(type_index),
-                 type_end_it = types_[scheme].right.end();
+        data_.clear();
+    }
+    else
+    {
+        scheme_ = scheme;
+        timestamp_ = timestamp;
+
+        auto type_it = types_[scheme].right.find(type_index),
+             type_end_it = types_[scheme].right.end();
 
-            switch (version_)
+        switch (version_)
+        {
+            case 1:
             {
-                case 1:
-                {
-                    type_it = types_[legacy_scheme].right.find(type_index);
-                    type_end_it = types_[legacy_scheme].right.end();
-                }
-                case 2: break;
+                type_it = types_[legacy_scheme].right.find(type_index);
+                type_end_it = types_[legacy_scheme].right.end();
             }
+            case 2:
+            case 3:
+            case 4: break;
+        }
 
-            if (type_it != type_end_it)
-                type = type_it->second;
-            else
-                glog.is(WARN) && glog << "No type entry in file for type index: " << type_index
-                                      << std::endl;
+        if (type_it != type_end_it)
+        {
+            type_ = type_it->second;
+        }
+        else
+        {
+            type_ = "_unknown" + std::to_string(type_index) + "_";
+            glog.is(WARN) && glog << "No type entry in file for type index: " << type_index
+                                  << std::endl;
+        }
 
-            type_ = type;
+        parsed_type_index_ = type_index;
 
-            std::string group = "_unknown" + std::to_string(group_index) + "_";
-            auto group_it = groups_[scheme].right.find(group_index),
-                 group_end_it = groups_[scheme].right.end();
+        std::string group;
+        auto group_it = groups_[scheme].right.find(group_index),
+             group_end_it = groups_[scheme].right.end();
 
-            switch (version_)
+        switch (version_)
+        {
+            case 1:
             {
-                case 1:
-                {
-                    group_it = groups_[legacy_scheme].right.find(group_index);
-                    group_end_it = groups_[legacy_scheme].right.end();
-                }
-                case 2: break;
+                group_it = groups_[legacy_scheme].right.find(group_index);
+                group_end_it = groups_[legacy_scheme].right.end();
             }
+            case 2:
+            case 3:
+            case 4: break;
+        }
 
-            if (group_it != group_end_it)
-                group = group_it->second;
-            else
-                glog.is(WARN) && glog << "No group entry in file for group index: " << group_index
-                                      << std::endl;
+        if (group_it != group_end_it)
+        {
+            group = group_it->second;
+        }
+        else
+        {
+            group = "_unknown" + std::to_string(group_index) + "_";
+            glog.is(WARN) && glog << "No group entry in file for group index: " << group_index
+                                  << std::endl;
+        }
 
-            group_ = goby::middleware::DynamicGroup(group);
+        group_ = goby::middleware::DynamicGroup(group);
 
-            LogFilter filt{scheme_, group, type_};
-            if (filter_hook.count(filt))
-            {
-                filter_matched = true;
-                filter_hook[filt](data_);
-            }
-            else
-            {
-                filter_matched = false;
-            }
-        }
-    } while (scheme == scheme_group_index_ || scheme == scheme_type_index_ || filter_matched);
+        auto filter_it = filter_hook.find(LogFilter{scheme_, group, type_});
+        filter_matched = (filter_it != filter_hook.end());
+        if (filter_matched)
+            filter_it->second(data_);
+    }
 
-    s->exceptions(old_except_mask);
+    return true;
 }
 
 void LogEntry::serialize(std::ostream* s) const
 {
+    if (block_bytes_ > 0 && version_ != invalid_version && version_ < compressed_version)
+        throw(log::LogException("Block compression must be enabled before the first entry "
+                                "is written"));
+
     auto old_except_mask = s->exceptions();
     s->exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
 
     // write version
     if (version_ == invalid_version)
     {
-        version_ = current_version;
+        // only use version 4 when it is needed, so uncompressed files remain readable by version 3 readers
+        version_ = (block_bytes_ > 0) ? compressed_version : uncompressed_version;
         std::string version_str(netint_to_string(version_));
         s->write(version_str.data(), version_str.size());
     }
 
+    // the entries (including index entries) are buffered and written by flush_block()
+    std::ostream* out = (block_bytes_ > 0) ? &block_out_ : s;
+
     std::string group(group_);
 
     // insert indexing entry if the first time we saw this group
@@ -324,7 +402,7 @@ void LogEntry::serialize(std::ostream* s) const
 
         std::string scheme_str(netint_to_string(scheme_));
         std::string scheme_plus_group = scheme_str + group;
-        _serialize(s, scheme_group_index_, index, 0, scheme_plus_group.data(),
+        _serialize(out, scheme_group_index_, index, 0, scheme_plus_group.data(),
                    scheme_plus_group.size());
 
         if (new_group_hook[scheme_])
@@ -337,7 +415,7 @@ void LogEntry::serialize(std::ostream* s) const
 
         std::string scheme_str(netint_to_string(scheme_));
         std::string scheme_plus_type = scheme_str + type_;
-        _serialize(s, scheme_type_index_, 0, index, scheme_plus_type.data(),
+        _serialize(out, scheme_type_index_, 0, index, scheme_plus_type.data(),
                    scheme_plus_type.size());
 
         if (new_type_hook[scheme_])
@@ -348,8 +426,315 @@ void LogEntry::serialize(std::ostream* s) const
     auto type_index = types_[scheme_].left.at(type_);
 
     // insert actual data
-    _serialize(s, scheme_, group_index, type_index, reinterpret_cast<const char*>(&data_[0]),
+    _serialize(out, scheme_, group_index, type_index, reinterpret_cast<const char*>(&data_[0]),
                data_.size());
 
+    if (block_bytes_ > 0)
+    {
+        if (block_.entries++ == 0)
+            block_.first_timestamp = timestamp_;
+        block_.last_timestamp = timestamp_;
+
+        if (block_out_.tellp() >= static_cast<std::streamoff>(block_bytes_))
+            flush_block(s);
+    }
+
+    s->exceptions(old_except_mask);
+}
+
+std::string LogEntry::block_header_to_string(const BlockIndexEntry& block)
+{
+    auto to_micros = [](time::SystemClock::time_point t) {
+        return static_cast<uint<timestamp_bytes_>::type>(
+            std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count());
+    };
+
+    return netint_to_string(static_cast<uint<size_bytes_>::type>(block.uncompressed_bytes)) +
+           netint_to_string(static_cast<uint<block_entries_bytes_>::type>(block.entries)) +
+           netint_to_string(to_micros(block.first_timestamp)) +
+           netint_to_string(to_micros(block.last_timestamp));
+}
+
+LogEntry::BlockIndexEntry LogEntry::read_block_header(std::istream* s, boost::crc_32_type* crc)
+{
+    BlockIndexEntry block;
+    block.uncompressed_bytes = read_one<uint<size_bytes_>::type>(s, crc);
+    block.entries = read_one<uint<block_entries_bytes_>::type>(s, crc);
+    block.first_timestamp +=
+        std::chrono::microseconds(read_one<uint<timestamp_bytes_>::type>(s, crc));
+    block.last_timestamp +=
+        std::chrono::microseconds(read_one<uint<timestamp_bytes_>::type>(s, crc));
+    return block;
+}
+
+void LogEntry::flush_block(std::ostream* s)
+{
+    std::string uncompressed = block_out_.str();
+    if (uncompressed.empty())
+        return;
+
+    uLongf compressed_size = compressBound(uncompressed.size());
+    std::string compressed(compressed_size, '\0');
+    int result = compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                           reinterpret_cast<const Bytef*>(uncompressed.data()),
+                           uncompressed.size(), compression_level_);
+    if (result != Z_OK)
+        throw(log::LogException("Failed to compress block of " +
+                                std::to_string(uncompressed.size()) +
+                                " bytes, zlib error: " + std::to_string(result)));
+    compressed.resize(compressed_size);
+
+    auto old_except_mask = s->exceptions();
+    s->exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+
+    block_.offset = s->tellp();
+    block_.uncompressed_bytes = uncompressed.size();
+    block_.compressed_bytes = compressed.size();
+
+    auto block_header = block_header_to_string(block_);
+    uint<size_bytes_>::type size = block_header.size() + compressed.size() + crc_bytes_;
+    auto header = block_magic_ + netint_to_string(size) + block_header;
+
+    boost::crc_32_type crc;
+    crc.process_bytes(header.data(), header.size());
+    crc.process_bytes(compressed.data(), compressed.size());
+    std::string cs_str(netint_to_string(static_cast<uint<crc_bytes_>::type>(crc.checksum())));
+
+    s->write(header.data(), header.size());
+    s->write(compressed.data(), compressed.size());
+    s->write(cs_str.data(), cs_str.size());
+
+    block_index_.push_back(block_);
+    block_out_.str(std::string());
+    block_ = BlockIndexEntry();
+
+    s->exceptions(old_except_mask);
+}
+
+void LogEntry::finish(std::ostream* s)
+{
+    flush_block(s);
+
+    if (block_index_.empty())
+        return;
+
+    auto old_except_mask = s->exceptions();
+    s->exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+
+    std::string body(
+        netint_to_string(static_cast<uint<block_entries_bytes_>::type>(block_index_.size())));
+    for (const auto& block : block_index_)
+    {
+        body += netint_to_string(static_cast<uint<block_offset_bytes_>::type>(block.offset));
+        body += netint_to_string(static_cast<uint<size_bytes_>::type>(block.compressed_bytes));
+        body += block_header_to_string(block);
+    }
+
+    uint<size_bytes_>::type size = body.size() + crc_bytes_;
+    std::string size_str(netint_to_string(size));
+    auto index = index_magic_ + size_str + body;
+
+    boost::crc_32_type crc;
+    crc.process_bytes(index.data(), index.size());
+    index += netint_to_string(static_cast<uint<crc_bytes_>::type>(crc.checksum()));
+    index += size_str + index_magic_;
+    s->write(index.data(), index.size());
+
+    block_index_.clear();
+
+    s->exceptions(old_except_mask);
+}
+
+std::istream* LogEntry::next_entry_stream(std::istream* s)
+{
+    // read from the current block until it is exhausted
+    return (block_in_.rdbuf()->in_avail() > 0) ? &block_in_ : s;
+}
+
+void LogEntry::read_block_or_skip_index(std::istream* s, const std::string& magic_read)
+{
+    if (magic_read == block_magic_)
+    {
+        // subsequent entries are read from block_in_ (see next_entry_stream())
+        read_block(s);
+    }
+    else
+    {
+        // the block index (only written at the end of the file)
+        auto size(read_one<uint<size_bytes_>::type>(s));
+        s->seekg(size + size_bytes_ + magic_bytes_, std::ios::cur);
+    }
+}
+
+void LogEntry::read_block(std::istream* s)
+{
+    // just after the block magic word
+    auto start_pos = s->tellg();
+    std::string uncompressed;
+
+    try
+    {
+        boost::crc_32_type crc;
+        crc.process_bytes(block_magic_.data(), block_magic_.size());
+
+        auto size(read_one<uint<size_bytes_>::type>(s, &crc));
+        auto block = read_block_header(s, &crc);
+        decltype(size) fixed_field_size = block_header_to_string(block).size() + crc_bytes_;
+        if (size < fixed_field_size)
+            throw(log::LogException("Invalid block size read: " + std::to_string(size)));
+
+        std::string compressed(size - fixed_field_size, '\0');
+        s->read(&compressed[0], compressed.size());
+        crc.process_bytes(compressed.data(), compressed.size());
+
+        auto calculated_crc = crc.checksum();
+        auto given_crc(read_one<uint<crc_bytes_>::type>(s));
+        if (calculated_crc != given_crc)
+            throw(log::LogException(
+                "Invalid CRC on compressed block: given: " + std::to_string(given_crc) +
+                ", calculated: " + std::to_string(calculated_crc)));
+
+        uncompressed.resize(block.uncompressed_bytes);
+        uLongf uncompressed_size = uncompressed.size();
+        int result = uncompress(reinterpret_cast<Bytef*>(&uncompressed[0]), &uncompressed_size,
+                                reinterpret_cast<const Bytef*>(compressed.data()),
+                                compressed.size());
+        if (result != Z_OK || uncompressed_size != uncompressed.size())
+            throw(log::LogException("Failed to decompress block, zlib error: " +
+                                    std::to_string(result)));
+
+        glog.is(goby::util::logger::DEBUG2) &&
+            glog << "Read compressed block of " << block.entries << " entries (" << size
+                 << " bytes compressed, " << uncompressed.size() << " bytes uncompressed)"
+                 << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        // clear EOF, etc.
+        s->clear();
+        // skip the magic word so that we search for the next valid entry or block
+        s->seekg(start_pos - std::ios::streamoff(magic_bytes_ - 1));
+        throw(log::LogException(std::string("Skipping invalid compressed block: ") + e.what()));
+    }
+
+    block_in_.str(uncompressed);
+    block_in_.clear();
+    block_in_.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+}
+
+std::vector<LogEntry::BlockIndexEntry> LogEntry::read_block_index(std::istream* s)
+{
+    std::vector<BlockIndexEntry> index;
+
+    auto old_except_mask = s->exceptions();
+    s->exceptions(std::ios::goodbit);
+    s->clear();
+    auto start_pos = s->tellg();
+
+    s->seekg(0, std::ios::beg);
+    auto version = read_one<uint<version_bytes_>::type>(s);
+    if (!*s || version < 4 || version == string_to_netint<decltype(version)>(magic_))
+    {
+        s->clear();
+        s->seekg(start_pos);
+        s->exceptions(old_except_mask);
+        return index;
+    }
+
+    s->exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
+
+    // use the index at the end of the file written by finish()
+    try
+    {
+        s->seekg(-std::ios::streamoff(size_bytes_ + magic_bytes_), std::ios::end);
+        auto size(read_one<uint<size_bytes_>::type>(s));
+        std::string magic_read(magic_bytes_, '\0');
+        s->read(&magic_read[0], magic_read.size());
+
+        if (magic_read == index_magic_)
+        {
+            s->seekg(-std::ios::streamoff(2 * (size_bytes_ + magic_bytes_) + size), std::ios::end);
+            boost::crc_32_type crc;
+            s->read(&magic_read[0], magic_read.size());
+            crc.process_bytes(magic_read.data(), magic_read.size());
+            auto given_size(read_one<uint<size_bytes_>::type>(s, &crc));
+            auto count(read_one<uint<block_entries_bytes_>::type>(s, &crc));
+
+            if (magic_read == index_magic_ && given_size == size)
+            {
+                for (decltype(count) i = 0; i < count; ++i)
+                {
+                    BlockIndexEntry block;
+                    auto offset = read_one<uint<block_offset_bytes_>::type>(s, &crc);
+                    auto compressed_bytes = read_one<uint<size_bytes_>::type>(s, &crc);
+                    block = read_block_header(s, &crc);
+                    block.offset = offset;
+                    block.compressed_bytes = compressed_bytes;
+                    index.push_back(block);
+                }
+
+                if (crc.checksum() == read_one<uint<crc_bytes_>::type>(s))
+                {
+                    s->clear();
+                    s->seekg(start_pos);
+                    s->exceptions(old_except_mask);
+                    return index;
+                }
+            }
+        }
+    }
+    catch (std::ios_base::failure& e)
+    {
+    }
+
+    glog.is(goby::util::logger::DEBUG1) &&
+        glog << "No block index at end of file, scanning file for compressed blocks"
+             << std::endl;
+
+    // otherwise, scan the file
+    index.clear();
+    s->clear();
+    s->seekg(version_bytes_, std::ios::beg);
+    try
+    {
+        std::string magic_read(magic_bytes_, '\0');
+        for (;;)
+        {
+            auto pos = s->tellg();
+            s->read(&magic_read[0], magic_read.size());
+            if (magic_read == block_magic_)
+            {
+                auto size(read_one<uint<size_bytes_>::type>(s));
+                BlockIndexEntry block = read_block_header(s, nullptr);
+                decltype(size) fixed_field_size = block_header_to_string(block).size() + crc_bytes_;
+                if (size >= fixed_field_size)
+                {
+                    block.offset = pos;
+                    block.compressed_bytes = size - fixed_field_size;
+                    index.push_back(block);
+                    s->seekg(pos + std::ios::streamoff(magic_bytes_ + size_bytes_ + size));
+                    continue;
+                }
+            }
+            else if (magic_read == magic_ || magic_read == index_magic_)
+            {
+                auto size(read_one<uint<size_bytes_>::type>(s));
+                if (magic_read == index_magic_)
+                    size += size_bytes_ + magic_bytes_;
+                s->seekg(s->tellg() + std::ios::streamoff(size));
+                continue;
+            }
+
+            // resynchronize
+            s->seekg(pos + std::ios::streamoff(1));
+        }
+    }
+    catch (std::ios_base::failure& e)
+    {
+    }
+
+    s->clear();
+    s->seekg(start_pos);
     s->exceptions(old_except_mask);
+    return index;
 }
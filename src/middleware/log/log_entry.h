@@ -24,11 +24,14 @@
 #ifndef LogEntry20171127H
 #define LogEntry20171127H
 
+#include <algorithm>
 #include <boost/bimap.hpp>
 #include <boost/crc.hpp>
 #include <cstdint>
+#include <sstream>
 
 #include "goby/exception.h"
+#include "goby/time/system_clock.h"
 #include "goby/util/debug_logger.h"
 
 #include "goby/middleware/group.h"
@@ -99,12 +102,21 @@ class LogEntry
     static constexpr int scheme_bytes_{2};
     static constexpr int group_bytes_{2};
     static constexpr int type_bytes_{2};
+    // version 3 and newer
+    static constexpr int timestamp_bytes_{8};
     static constexpr int crc_bytes_{4};
     static constexpr uint<scheme_bytes_>::type scheme_group_index_{0xFFFF};
     static constexpr uint<scheme_bytes_>::type scheme_type_index_{0xFFFE};
 
+    // version 4 and newer
+    static constexpr int block_entries_bytes_{4};
+    static constexpr int block_offset_bytes_{8};
+
     static constexpr int version_bytes_{4};
-    static constexpr int current_version{2};
+    // newest version that can be read; files are written as version 3 unless block compression is enabled
+    static constexpr int current_version{4};
+    static constexpr int uncompressed_version{3};
+    static constexpr int compressed_version{4};
     // "invalid_version" until version is read or written
     static uint<version_bytes_>::type version_;
     static constexpr decltype(version_) invalid_version{0};
@@ -115,10 +127,26 @@ class LogEntry
     static std::map<LogFilter, std::function<void(const std::vector<unsigned char>& data)> >
         filter_hook;
 
+    /// \brief Location and contents of a compressed block (version 4 and newer)
+    struct BlockIndexEntry
+    {
+        std::uint64_t offset{0};
+        std::uint32_t entries{0};
+        std::uint32_t uncompressed_bytes{0};
+        std::uint32_t compressed_bytes{0};
+        time::SystemClock::time_point first_timestamp;
+        time::SystemClock::time_point last_timestamp;
+    };
+
   public:
-    LogEntry(const std::vector<unsigned char>& data, int scheme, const std::string& type,
-             const Group& group)
-        : data_(data), scheme_(scheme), type_(type), group_(std::string(group))
+    LogEntry(std::vector<unsigned char> data, int scheme, const std::string& type,
+             const Group& group,
+             time::SystemClock::time_point timestamp = time::SystemClock::now())
+        : data_(std::move(data)),
+          scheme_(scheme),
+          type_(type),
+          group_(std::string(group)),
+          timestamp_(timestamp)
     {
     }
 
@@ -126,15 +154,51 @@ class LogEntry
     void parse_version(std::istream* s);
     void parse(std::istream* s);
 
-    // [GBY3][size: 4][scheme: 2][group: 2][type: 2][data][crc32: 4]
+    // [GBY3][size: 4][scheme: 2][group: 2][type: 2][timestamp: 8][data][crc32: 4]
+    // (timestamp is microseconds since the UNIX epoch, and is present for version 3 and newer)
     // if scheme == 0xFFFF what follows is not data, but the string value for the group index
     // if scheme == 0xFFFE what follows is not data, but the string value for the group index
     void serialize(std::ostream* s) const;
 
+    // version 4 and newer, when block compression is enabled:
+    // [GBYB][size: 4][uncompressed size: 4][entries: 4][first timestamp: 8][last timestamp: 8]
+    //   [zlib compressed entries][crc32: 4]
+    // where the compressed entries are a sequence of [GBY3] entries as above. Each block can be
+    // decompressed on its own, but group and type index entries are only written once (in the
+    // block where the group or type is first used).
+    // finish() appends the block index:
+    // [GBYI][size: 4][blocks: 4]([offset: 8][compressed size: 4][uncompressed size: 4][entries: 4]
+    //   [first timestamp: 8][last timestamp: 8])...[crc32: 4][size: 4][GBYI]
+
+    /// \brief Buffer the entries passed to serialize() and write them in zlib compressed blocks of block_bytes (uncompressed)
+    ///
+    /// Must be called before the first serialize(), as compressed files are written as version 4 (which older readers cannot parse) and uncompressed files as version 3.
+    ///
+    /// \param block_bytes Uncompressed size at which a block is written, or 0 to disable compression
+    /// \param level zlib compression level (1: fastest - 9: best compression)
+    static void set_block_compression(std::uint32_t block_bytes, int level = 1)
+    {
+        block_bytes_ = block_bytes;
+        compression_level_ = level;
+    }
+
+    /// \brief Compress and write the entries buffered for the current block, if any
+    static void flush_block(std::ostream* s);
+
+    /// \brief Flush the current block and write the block index. Call once after the last serialize() when using block compression.
+    static void finish(std::ostream* s);
+
+    /// \brief Read the block index, using the one written by finish() if present, or else by scanning the file. The stream position is restored afterwards.
+    static std::vector<BlockIndexEntry> read_block_index(std::istream* s);
+
     const std::vector<unsigned char>& data() const { return data_; }
     int scheme() const { return scheme_; }
     const std::string& type() const { return type_; }
+    /// \brief Index of type() in the file being parsed (unique for a given scheme within a file), or 0 if this entry wasn't parsed
+    uint<type_bytes_>::type type_index() const { return parsed_type_index_; }
     const Group& group() const { return group_; }
+    /// \brief Time the entry was logged, or time_point() (the epoch) for files older than version 3 that do not store it
+    time::SystemClock::time_point timestamp() const { return timestamp_; }
     static void reset()
     {
         groups_.clear();
@@ -146,35 +210,67 @@ class LogEntry
         group_index_ = 1;
         type_index_ = 1;
         version_ = invalid_version;
+
+        block_bytes_ = 0;
+        compression_level_ = 1;
+        block_out_.str(std::string());
+        block_ = BlockIndexEntry();
+        block_index_.clear();
+        block_in_.str(std::string());
+        block_in_.clear();
     }
 
   private:
+    // reads one entry (which may be an index entry) from s, returning true, or reads the
+    // compressed block (into block_in_) or skips the block index that is next, returning false
+    bool parse_entry(std::istream* s, uint<scheme_bytes_>::type* scheme, bool* filter_matched);
+
+    // the stream to read the next entry from: the current block if it has unread entries,
+    // otherwise s. Blocks and the block index in s are found by parse_entry() during its search
+    // for the next magic word, so that reading s never seeks back between entries (which would
+    // discard the ifstream buffer)
+    static std::istream* next_entry_stream(std::istream* s);
+    // called just after the block or index magic word (magic_read) has been read from s
+    static void read_block_or_skip_index(std::istream* s, const std::string& magic_read);
+    static void read_block(std::istream* s);
+    static std::string block_header_to_string(const BlockIndexEntry& block);
+    static BlockIndexEntry read_block_header(std::istream* s, boost::crc_32_type* crc);
+
     void _serialize(std::ostream* s, uint<scheme_bytes_>::type scheme,
                     uint<group_bytes_>::type group_index, uint<type_bytes_>::type type_index,
                     const char* data, int data_size) const
     {
-        std::string group_str(netint_to_string(group_index));
-        std::string type_str(netint_to_string(type_index));
-        std::string scheme_str(netint_to_string(scheme));
-
-        uint<size_bytes_>::type size =
-            scheme_bytes_ + group_bytes_ + type_bytes_ + data_size + crc_bytes_;
-        std::string size_str(netint_to_string(size));
-
-        auto header = magic_ + size_str + scheme_str + group_str + type_str;
-        s->write(header.data(), header.size());
+        uint<size_bytes_>::type size = scheme_bytes_ + group_bytes_ + type_bytes_ +
+                                       timestamp_bytes_ + data_size + crc_bytes_;
+
+        // assembled on the stack to avoid allocating for each entry
+        char header[magic_bytes_ + size_bytes_ + scheme_bytes_ + group_bytes_ + type_bytes_ +
+                    timestamp_bytes_];
+        char* header_end = std::copy(magic_.begin(), magic_.end(), header);
+        header_end = netint_to_array(size, header_end);
+        header_end = netint_to_array(scheme, header_end);
+        header_end = netint_to_array(group_index, header_end);
+        header_end = netint_to_array(type_index, header_end);
+        header_end = netint_to_array(
+            static_cast<uint<timestamp_bytes_>::type>(
+                std::chrono::duration_cast<std::chrono::microseconds>(timestamp_.time_since_epoch())
+                    .count()),
+            header_end);
+
+        s->write(header, header_end - header);
         s->write(data, data_size);
 
         boost::crc_32_type crc;
-        crc.process_bytes(header.data(), header.size());
+        crc.process_bytes(header, header_end - header);
         crc.process_bytes(data, data_size);
 
-        uint<crc_bytes_>::type cs(crc.checksum());
-        std::string cs_str(netint_to_string(cs));
-        s->write(cs_str.data(), cs_str.size());
+        char cs[crc_bytes_];
+        netint_to_array(static_cast<uint<crc_bytes_>::type>(crc.checksum()), cs);
+        s->write(cs, crc_bytes_);
     }
 
-    template <typename Unsigned> Unsigned read_one(std::istream* s, boost::crc_32_type* crc = 0)
+    template <typename Unsigned>
+    static Unsigned read_one(std::istream* s, boost::crc_32_type* crc = 0)
     {
         auto size = std::numeric_limits<Unsigned>::digits / 8;
         std::string str(size, '\0');
@@ -184,15 +280,23 @@ class LogEntry
         return string_to_netint<Unsigned>(str);
     }
 
-    template <typename Unsigned> std::string netint_to_string(Unsigned u) const
+    template <typename Unsigned> static std::string netint_to_string(Unsigned u)
     {
         auto size = std::numeric_limits<Unsigned>::digits / 8;
         std::string s(size, '\0');
-        for (int i = 0; i < size; ++i) s[i] = (u >> (size - (i + 1)) * 8) & 0xff;
+        netint_to_array(u, &s[0]);
         return s;
     }
 
-    template <typename Unsigned> Unsigned string_to_netint(std::string s) const
+    // writes u (big-endian) to out, returning the end of the written bytes
+    template <typename Unsigned> static char* netint_to_array(Unsigned u, char* out)
+    {
+        auto size = std::numeric_limits<Unsigned>::digits / 8;
+        for (int i = 0; i < size; ++i) out[i] = (u >> (size - (i + 1)) * 8) & 0xff;
+        return out + size;
+    }
+
+    template <typename Unsigned> static Unsigned string_to_netint(std::string s)
     {
         Unsigned u(0);
         std::string::size_type size = std::numeric_limits<Unsigned>::digits / 8;
@@ -201,7 +305,8 @@ class LogEntry
         if (s.size() < size)
             s.insert(0, size - s.size(), '\0');
 
-        for (decltype(size) i = 0; i < size; ++i) u |= (s[i] & 0xff) << ((size - (i + 1)) * 8);
+        for (decltype(size) i = 0; i < size; ++i)
+            u |= static_cast<Unsigned>(s[i] & 0xff) << ((size - (i + 1)) * 8);
         return u;
     }
 
@@ -209,7 +314,9 @@ class LogEntry
     std::vector<unsigned char> data_;
     uint<scheme_bytes_>::type scheme_;
     std::string type_;
+    uint<type_bytes_>::type parsed_type_index_{0};
     DynamicGroup group_;
+    time::SystemClock::time_point timestamp_;
 
     // map (scheme -> map (group_name -> group_index)
     static std::map<int, boost::bimap<std::string, uint<group_bytes_>::type> > groups_;
@@ -219,7 +326,19 @@ class LogEntry
     static std::map<int, boost::bimap<std::string, uint<type_bytes_>::type> > types_;
     static uint<type_bytes_>::type type_index_;
 
-    const std::string magic_{"GBY3"};
+    // block compression (writing)
+    static std::uint32_t block_bytes_;
+    static int compression_level_;
+    static std::ostringstream block_out_;
+    static BlockIndexEntry block_;
+    static std::vector<BlockIndexEntry> block_index_;
+
+    // block compression (reading)
+    static std::istringstream block_in_;
+
+    static const std::string magic_;
+    static const std::string block_magic_;
+    static const std::string index_magic_;
 };
 
 } // namespace middleware
@@ -0,0 +1,157 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "goby/util/debug_logger.h"
+
+#include "log_player.h"
+
+using goby::glog;
+using goby::middleware::log::LogPlayer;
+
+LogPlayer::LogPlayer(std::istream& in, double warp_factor, std::size_t prefetch_entries,
+                     std::function<bool(LogEntry& entry)> filter)
+    : in_(in),
+      warp_factor_(warp_factor),
+      prefetch_entries_(std::max<std::size_t>(prefetch_entries, 1)),
+      filter_(std::move(filter))
+{
+    reader_ = std::thread([this]() { read(); });
+}
+
+LogPlayer::~LogPlayer()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        reader_alive_ = false;
+    }
+    queue_not_full_.notify_all();
+    reader_.join();
+}
+
+void LogPlayer::read()
+{
+    while (reader_alive_)
+    {
+        try
+        {
+            LogEntry log_entry;
+            log_entry.parse(&in_);
+
+            if (filter_ && !filter_(log_entry))
+                continue;
+
+            Entry entry{log_entry.timestamp(), log_entry.scheme(), log_entry.type(),
+                        std::string(log_entry.group()), log_entry.data()};
+
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_not_full_.wait(lock, [this]() {
+                return queue_.size() < prefetch_entries_ || !reader_alive_;
+            });
+            queue_.push_back(std::move(entry));
+        }
+        catch (LogException& e)
+        {
+            glog.is_warn() && glog << "Exception processing input log (will attempt to continue): "
+                                   << e.what() << std::endl;
+        }
+        catch (std::exception& e)
+        {
+            if (!in_.eof())
+                glog.is_warn() && glog << "Error processing input log: " << e.what() << std::endl;
+
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    reader_done_ = true;
+}
+
+bool LogPlayer::play(const std::function<void(const Entry& entry)>& publish, int max_entries,
+                     std::chrono::steady_clock::duration max_wait)
+{
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    for (int i = 0; i < max_entries; ++i)
+    {
+        if (queue_.empty())
+        {
+            if (reader_done_)
+                return false;
+
+            // the reader is behind
+            lock.unlock();
+            std::this_thread::sleep_for(
+                std::min<std::chrono::steady_clock::duration>(std::chrono::milliseconds(1),
+                                                              max_wait));
+            return true;
+        }
+
+        const Entry& next = queue_.front();
+        if (warp_factor_ > 0)
+        {
+            if (next.timestamp == time::SystemClock::time_point())
+            {
+                if (!warned_no_timestamp_)
+                    glog.is_warn() && glog << "Log entries have no timestamp (log version < 3), "
+                                              "playing back as fast as possible"
+                                           << std::endl;
+                warned_no_timestamp_ = true;
+            }
+            else
+            {
+                auto now = std::chrono::steady_clock::now();
+                if (!clock_started_)
+                {
+                    clock_started_ = true;
+                    log_start_ = next.timestamp;
+                    playback_start_ = now;
+                }
+
+                auto due = playback_start_ +
+                           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double>(next.timestamp - log_start_) /
+                               warp_factor_);
+
+                if (due > now)
+                {
+                    lock.unlock();
+                    std::this_thread::sleep_until(
+                        std::min<std::chrono::steady_clock::time_point>(due, now + max_wait));
+                    return true;
+                }
+            }
+        }
+
+        Entry entry = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        queue_not_full_.notify_one();
+
+        publish(entry);
+        ++entries_played_;
+        bytes_played_ += entry.data.size();
+
+        lock.lock();
+    }
+    return true;
+}
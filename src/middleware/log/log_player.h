@@ -0,0 +1,108 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef LogPlayer20201019H
+#define LogPlayer20201019H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <thread>
+
+#include "goby/middleware/log/log_entry.h"
+
+namespace goby
+{
+namespace middleware
+{
+namespace log
+{
+/// \brief Reads a .goby log on a background thread and releases its entries at the pace they were logged (optionally warped), for replay (e.g. by goby_playback)
+class LogPlayer
+{
+  public:
+    struct Entry
+    {
+        time::SystemClock::time_point timestamp;
+        int scheme;
+        std::string type;
+        std::string group;
+        std::vector<unsigned char> data;
+    };
+
+    /// \brief Start the reader thread
+    ///
+    /// \param in Log to play back (must outlive the LogPlayer)
+    /// \param warp_factor Speed-up over real time, or 0 to play back as fast as possible
+    /// \param prefetch_entries Number of entries the reader thread reads ahead of playback
+    /// \param filter Called (on the reader thread) for each entry read; entries for which it returns false are skipped. May be empty to play back all entries.
+    LogPlayer(std::istream& in, double warp_factor, std::size_t prefetch_entries,
+              std::function<bool(LogEntry& entry)> filter =
+                  std::function<bool(LogEntry& entry)>());
+    ~LogPlayer();
+
+    /// \brief Pass up to \c max_entries entries that are due to \c publish, in log order
+    ///
+    /// Sleeps for at most \c max_wait if the next entry is not yet due (or the reader thread is behind).
+    /// \return false once every entry has been played
+    bool play(const std::function<void(const Entry& entry)>& publish, int max_entries,
+              std::chrono::steady_clock::duration max_wait);
+
+    /// \brief Number of entries passed to publish so far
+    std::uint64_t entries_played() const { return entries_played_; }
+    /// \brief Number of data bytes passed to publish so far
+    std::uint64_t bytes_played() const { return bytes_played_; }
+
+  private:
+    void read();
+
+  private:
+    std::istream& in_;
+    double warp_factor_;
+    std::size_t prefetch_entries_;
+    std::function<bool(LogEntry& entry)> filter_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_not_full_;
+    std::deque<Entry> queue_;
+    bool reader_done_{false};
+    std::atomic<bool> reader_alive_{true};
+    std::thread reader_;
+
+    // log time of the first timestamped entry and when it was played
+    bool clock_started_{false};
+    time::SystemClock::time_point log_start_;
+    std::chrono::steady_clock::time_point playback_start_;
+    bool warned_no_timestamp_{false};
+
+    std::uint64_t entries_played_{0};
+    std::uint64_t bytes_played_{0};
+};
+} // namespace log
+} // namespace middleware
+} // namespace goby
+
+#endif
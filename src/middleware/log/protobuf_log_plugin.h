@@ -47,14 +47,19 @@ template <int scheme> class ProtobufPluginBase : public LogPlugin
   public:
     std::string debug_text_message(LogEntry& log_entry) override
     {
-        auto msgs = parse_message(log_entry);
+        // the messages are only needed until they are printed, so reuse one message per type
+        std::vector<std::string> msgs;
+        for_each_message(log_entry, [&](const TypeEntry& type) { return type.reusable.get(); },
+                         [&](google::protobuf::Message* msg) {
+                             msgs.push_back(msg->ShortDebugString());
+                         });
 
         std::stringstream ss;
         for (typename decltype(msgs)::size_type i = 0, n = msgs.size(); i < n; ++i)
         {
             if (n > 1)
                 ss << "[" << i << "]";
-            ss << msgs[i]->ShortDebugString();
+            ss << msgs[i];
         }
         return ss.str();
     }
@@ -76,6 +81,9 @@ template <int scheme> class ProtobufPluginBase : public LogPlugin
 
     void register_read_hooks(const std::ifstream& in_log_file) override
     {
+        // type indices are only unique within a file
+        types_.clear();
+
         LogEntry::filter_hook[{static_cast<int>(scheme), static_cast<std::string>(file_desc_group),
                                google::protobuf::FileDescriptorProto::descriptor()->full_name()}] =
             [](const std::vector<unsigned char>& data) {
@@ -94,33 +102,73 @@ template <int scheme> class ProtobufPluginBase : public LogPlugin
         };
     }
 
+    /// \brief Parses the message(s) in log_entry, allocated on pooled Arenas if ProtobufArenaPool is enabled (e.g. protobuf_arena { enable: true } in the application configuration)
     std::vector<std::shared_ptr<google::protobuf::Message>> parse_message(LogEntry& log_entry)
     {
         std::vector<std::shared_ptr<google::protobuf::Message>> msgs;
+        for_each_message(log_entry,
+                         [&](const TypeEntry& type) {
+                             msgs.push_back(ProtobufArenaPool::make_message(*type.prototype));
+                             return msgs.back().get();
+                         },
+                         [](google::protobuf::Message* msg) {});
+        return msgs;
+    }
 
+  private:
+    struct TypeEntry
+    {
+        std::string type;
+        // empty message used to create new messages of this type without looking it up by name
+        std::shared_ptr<google::protobuf::Message> prototype;
+        // message reused for each entry of this type when the parsed message isn't kept
+        std::unique_ptr<google::protobuf::Message> reusable;
+    };
+
+    const TypeEntry& type_entry(const LogEntry& log_entry)
+    {
+        auto index = log_entry.type_index();
+        if (index >= types_.size())
+            types_.resize(index + 1);
+
+        auto& type = types_[index];
+        if (!type.prototype || type.type != log_entry.type())
+        {
+            type.prototype = SerializerParserHelper<google::protobuf::Message, scheme>::new_message(
+                log_entry.type());
+            type.reusable.reset(type.prototype->New());
+            type.type = log_entry.type();
+        }
+        return type;
+    }
+
+    // parses each of the (possibly concatenated) messages in log_entry into the message
+    // returned by new_msg, and then calls handle_msg with it
+    template <typename NewMessage, typename HandleMessage>
+    void for_each_message(const LogEntry& log_entry, NewMessage new_msg, HandleMessage handle_msg)
+    {
         const auto& data = log_entry.data();
         auto bytes_begin = data.begin(), bytes_end = data.end(), actual_end = data.begin();
 
         while (actual_end != bytes_end)
         {
+            google::protobuf::Message* msg;
             try
             {
-                auto msg = SerializerParserHelper<google::protobuf::Message, scheme>::parse(
-                    bytes_begin, bytes_end, actual_end, log_entry.type());
-                msgs.push_back(msg);
+                msg = new_msg(type_entry(log_entry));
+                SerializerParserHelper<google::protobuf::Message, scheme>::parse(
+                    bytes_begin, bytes_end, actual_end, msg);
             }
             catch (std::exception& e)
             {
                 throw(log::LogException("Failed to create Protobuf message of type: " +
                                         log_entry.type() + ", reason: " + e.what()));
             }
+            handle_msg(msg);
             bytes_begin = actual_end;
         }
-
-        return msgs;
     }
 
-  private:
     void insert_protobuf_file_desc(const google::protobuf::FileDescriptor* file_desc,
                                    std::ofstream& out_log_file)
     {
@@ -137,9 +185,10 @@ template <int scheme> class ProtobufPluginBase : public LogPlugin
 
             google::protobuf::FileDescriptorProto file_desc_proto;
             file_desc->CopyTo(&file_desc_proto);
-            std::vector<unsigned char> data(file_desc_proto.ByteSize());
-            file_desc_proto.SerializeToArray(&data[0], data.size());
-            LogEntry entry(data, goby::middleware::MarshallingScheme::PROTOBUF,
+            std::vector<unsigned char> data;
+            serialize_into<google::protobuf::FileDescriptorProto, MarshallingScheme::PROTOBUF>(
+                file_desc_proto, &data);
+            LogEntry entry(std::move(data), goby::middleware::MarshallingScheme::PROTOBUF,
                            google::protobuf::FileDescriptorProto::descriptor()->full_name(),
                            file_desc_group);
             entry.serialize(&out_log_file);
@@ -168,6 +217,9 @@ template <int scheme> class ProtobufPluginBase : public LogPlugin
 
   private:
     std::set<const google::protobuf::FileDescriptor*> written_file_desc_;
+
+    // indexed on LogEntry::type_index() for the file being read
+    std::vector<TypeEntry> types_;
 };
 
 class ProtobufPlugin : public ProtobufPluginBase<goby::middleware::MarshallingScheme::PROTOBUF>
@@ -24,6 +24,7 @@
 #ifndef SerializeParseString20190717H
 #define SerializeParseString20190717H
 
+#include <cstring>
 #include <vector>
 
 #include "interface.h"
@@ -42,6 +43,12 @@ template <> struct SerializerParserHelper<std::string, MarshallingScheme::CSTR>
         return bytes;
     }
 
+    template <typename Sink> static void serialize(const std::string& msg, Sink* sink)
+    {
+        // includes the terminating null character
+        std::memcpy(sink_grow(sink, msg.size() + 1), msg.c_str(), msg.size() + 1);
+    }
+
     static std::string type_name(const std::string& d = std::string()) { return "CSTR"; }
 
     template <typename CharIterator>
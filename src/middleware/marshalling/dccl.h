@@ -47,12 +47,18 @@ struct SerializerParserHelper<DataType, MarshallingScheme::DCCL>
   public:
     /// \brief Serialize message using DCCL encoding
     static std::vector<char> serialize(const DataType& msg)
+    {
+        std::vector<char> bytes;
+        serialize(msg, &bytes);
+        return bytes;
+    }
+
+    /// \brief Serialize message using DCCL encoding, appending to sink
+    template <typename Sink> static void serialize(const DataType& msg, Sink* sink)
     {
         std::lock_guard<std::mutex> lock(dccl_mutex_);
         check_load<DataType>();
-        std::vector<char> bytes(codec().size(msg), 0);
-        codec().encode(bytes.data(), bytes.size(), msg);
-        return bytes;
+        encode(msg, sink);
     }
 
     /// \brief Full protobuf Message name (identical to Protobuf specialization)
@@ -70,14 +76,16 @@ struct SerializerParserHelper<DataType, MarshallingScheme::DCCL>
     /// \brief Parse one DCCL message.
     ///
     /// If DCCL messages are concatentated, you can pass "actual_end" back into parse() as the new "bytes_begin" until it reaches "bytes_end"
+    ///
+    /// The message is allocated on a pooled Arena if ProtobufArenaPool is enabled
     template <typename CharIterator>
     static std::shared_ptr<DataType> parse(CharIterator bytes_begin, CharIterator bytes_end,
                                            CharIterator& actual_end,
                                            const std::string& type = type_name())
     {
+        auto msg = ProtobufArenaPool::make_message<DataType>();
         std::lock_guard<std::mutex> lock(dccl_mutex_);
         check_load<DataType>();
-        auto msg = std::make_shared<DataType>();
         actual_end = codec().decode(bytes_begin, bytes_end, msg.get());
         return msg;
     }
@@ -111,12 +119,18 @@ struct SerializerParserHelper<google::protobuf::Message, MarshallingScheme::DCCL
   public:
     /// Serialize DCCL/Protobuf message (using DCCL encoding)
     static std::vector<char> serialize(const google::protobuf::Message& msg)
+    {
+        std::vector<char> bytes;
+        serialize(msg, &bytes);
+        return bytes;
+    }
+
+    /// Serialize DCCL/Protobuf message (using DCCL encoding), appending to sink
+    template <typename Sink> static void serialize(const google::protobuf::Message& msg, Sink* sink)
     {
         std::lock_guard<std::mutex> lock(dccl_mutex_);
         check_load(msg.GetDescriptor());
-        std::vector<char> bytes(codec().size(msg), 0);
-        codec().encode(bytes.data(), bytes.size(), msg);
-        return bytes;
+        encode(msg, sink);
     }
 
     /// \brief Full protobuf name from message instantiation, including package (if one is defined).
@@ -146,15 +160,31 @@ struct SerializerParserHelper<google::protobuf::Message, MarshallingScheme::DCCL
     static std::shared_ptr<google::protobuf::Message>
     parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
           const std::string& type)
+    {
+        auto msg = new_message(type);
+        parse(bytes_begin, bytes_end, actual_end, msg.get());
+        return msg;
+    }
+
+    /// \brief Parse DCCL/Protobuf message into an existing message (e.g. one reused between calls, or created from a cached prototype), avoiding the lookup of the type by name
+    ///
+    /// \param msg Message to parse into (existing contents are cleared)
+    template <typename CharIterator>
+    static void parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
+                      google::protobuf::Message* msg)
     {
         std::lock_guard<std::mutex> lock(dccl_mutex_);
+        check_load(msg->GetDescriptor());
+        msg->Clear();
+        actual_end = codec().decode(bytes_begin, bytes_end, msg);
+    }
 
-        auto msg = dccl::DynamicProtobufManager::new_protobuf_message<
+    /// \brief Create an empty message given the Protobuf type name, assuming the message descriptor is loaded into dccl::DynamicProtobufManager
+    static std::shared_ptr<google::protobuf::Message> new_message(const std::string& type)
+    {
+        std::lock_guard<std::mutex> lock(dccl_mutex_);
+        return dccl::DynamicProtobufManager::new_protobuf_message<
             std::shared_ptr<google::protobuf::Message>>(type);
-
-        check_load(msg->GetDescriptor());
-        actual_end = codec().decode(bytes_begin, bytes_end, msg.get());
-        return msg;
     }
 
     /// \brief Returns the DCCL ID given a Protobuf Descriptor
@@ -66,45 +66,88 @@ void goby::middleware::detail::DCCLSerializerParserHelperBase::load_metadata(
     }
 }
 
-goby::middleware::intervehicle::protobuf::DCCLForwardedData
-goby::middleware::detail::DCCLSerializerParserHelperBase::unpack(const std::string& frame)
+template <typename Function>
+void goby::middleware::detail::DCCLSerializerParserHelperBase::decode_frame(
+    const std::string& frame, bool reuse_messages, Function f)
 {
-    std::lock_guard<std::mutex> lock(dccl_mutex_);
-
-    goby::middleware::intervehicle::protobuf::DCCLForwardedData packets;
+    std::unordered_map<const google::protobuf::Descriptor*,
+                       std::shared_ptr<google::protobuf::Message>>
+        reusable_msgs;
 
     std::string::const_iterator frame_it = frame.begin(), frame_end = frame.end();
     while (frame_it < frame_end)
     {
         auto dccl_id = codec().id(frame_it, frame_end);
 
-        goby::middleware::intervehicle::protobuf::DCCLPacket& packet = *packets.add_frame();
-        packet.set_dccl_id(dccl_id);
-
-        std::string::const_iterator next_frame_it;
-
-        if (codec().loaded().count(dccl_id) == INVALID_DCCL_ID)
+        auto loaded_it = codec().loaded().find(dccl_id);
+        if (loaded_it == codec().loaded().end())
         {
             goby::glog.is_debug1() &&
                 goby::glog << "DCCL ID " << dccl_id
                            << " is not loaded. Discarding remainder of the message." << std::endl;
-            packets.mutable_frame()->RemoveLast();
-            return packets;
+            return;
         }
 
-        const auto* desc = codec().loaded().at(dccl_id);
-        auto msg = dccl::DynamicProtobufManager::new_protobuf_message<
-            std::unique_ptr<google::protobuf::Message>>(desc);
-
-        next_frame_it = codec().decode(frame_it, frame_end, msg.get());
-        packet.set_data(std::string(frame_it, next_frame_it));
+        const auto* desc = loaded_it->second;
+        std::shared_ptr<google::protobuf::Message> msg;
+        if (reuse_messages)
+        {
+            auto& reusable_msg = reusable_msgs[desc];
+            if (reusable_msg)
+                reusable_msg->Clear();
+            else
+                reusable_msg = dccl::DynamicProtobufManager::new_protobuf_message<
+                    std::shared_ptr<google::protobuf::Message>>(desc);
+            msg = reusable_msg;
+        }
+        else
+        {
+            msg = dccl::DynamicProtobufManager::new_protobuf_message<
+                std::shared_ptr<google::protobuf::Message>>(desc);
+        }
 
+        std::string::const_iterator next_frame_it = codec().decode(frame_it, frame_end, msg.get());
+        f(dccl_id, frame_it, next_frame_it, msg);
         frame_it = next_frame_it;
     }
+}
+
+goby::middleware::intervehicle::protobuf::DCCLForwardedData
+goby::middleware::detail::DCCLSerializerParserHelperBase::unpack(const std::string& frame)
+{
+    std::lock_guard<std::mutex> lock(dccl_mutex_);
+
+    goby::middleware::intervehicle::protobuf::DCCLForwardedData packets;
+
+    // the decoded messages are only used to find the end of each packet
+    decode_frame(frame, true,
+                 [&](unsigned dccl_id, std::string::const_iterator begin,
+                     std::string::const_iterator end,
+                     const std::shared_ptr<google::protobuf::Message>& /*msg*/) {
+                     goby::middleware::intervehicle::protobuf::DCCLPacket& packet =
+                         *packets.add_frame();
+                     packet.set_dccl_id(dccl_id);
+                     packet.mutable_data()->assign(begin, end);
+                 });
 
     return packets;
 }
 
+std::vector<std::shared_ptr<google::protobuf::Message>>
+goby::middleware::detail::DCCLSerializerParserHelperBase::decode_batch(const std::string& frame)
+{
+    std::lock_guard<std::mutex> lock(dccl_mutex_);
+
+    std::vector<std::shared_ptr<google::protobuf::Message>> msgs;
+    decode_frame(frame, false,
+                 [&](unsigned /*dccl_id*/, std::string::const_iterator /*begin*/,
+                     std::string::const_iterator /*end*/,
+                     const std::shared_ptr<google::protobuf::Message>& msg) {
+                     msgs.push_back(msg);
+                 });
+    return msgs;
+}
+
 void goby::middleware::detail::DCCLSerializerParserHelperBase::setup_dlog()
 {
     static bool setup_complete = false;
@@ -29,6 +29,7 @@
 
 #include <dccl/codec.h>
 
+#include "goby/middleware/marshalling/serialize_buffer.h"
 #include "goby/middleware/protobuf/intervehicle.pb.h"
 #include "goby/util/debug_logger.h"
 
@@ -100,6 +101,14 @@ struct DCCLSerializerParserHelperBase
     }
 
 
+    // appends the DCCL encoding of msg to sink (call with dccl_mutex_ locked, after check_load)
+    template <typename Sink> static void encode(const google::protobuf::Message& msg, Sink* sink)
+    {
+        const auto size = codec().size(msg);
+        if (size > 0)
+            codec().encode(sink_grow(sink, size), size, msg);
+    }
+
     static dccl::Codec& codec()
     {
         if (!codec_)
@@ -143,9 +152,38 @@ struct DCCLSerializerParserHelperBase
     }
 
     static void load_metadata(const goby::middleware::protobuf::SerializerProtobufMetadata& meta);
+
+    /// \brief Split a frame of concatenated DCCL messages into its packets (DCCL ID and encoded bytes), decoding the whole frame with a single lock acquisition
     static goby::middleware::intervehicle::protobuf::DCCLForwardedData
     unpack(const std::string& bytes);
 
+    /// \brief Encode a batch of messages (e.g. a frame's worth) with a single lock acquisition, concatenating the encoded messages in sink
+    ///
+    /// \param msgs Container of pointers (raw or smart) to the messages to encode. The types are loaded into the codec as needed.
+    /// \param sink SerializeBuffer or contiguous byte container (std::string, std::vector<char>) to append to. Reusing the same sink for each batch avoids reallocating.
+    /// \param sizes If not null, the encoded size of each message is appended
+    template <typename MessagePtrContainer, typename Sink>
+    static void encode_batch(const MessagePtrContainer& msgs, Sink* sink,
+                             std::vector<std::size_t>* sizes = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(dccl_mutex_);
+        for (const auto& msg : msgs)
+        {
+            check_load(msg->GetDescriptor());
+            auto size_before = sink->size();
+            encode(*msg, sink);
+            if (sizes)
+                sizes->push_back(sink->size() - size_before);
+        }
+    }
+
+    /// \brief Decode all the messages in a frame of concatenated DCCL messages with a single lock acquisition
+    ///
+    /// Decoding stops at the first DCCL ID that is not loaded (the remainder of the frame is discarded)
+    /// \return Decoded messages, in the order they appear in the frame
+    static std::vector<std::shared_ptr<google::protobuf::Message>>
+    decode_batch(const std::string& frame);
+
     static void load_library(const std::string& library)
     {
         std::lock_guard<std::mutex> lock(dccl_mutex_);
@@ -154,6 +192,13 @@ struct DCCLSerializerParserHelperBase
 
     /// \brief Enable dlog output to glog using same verbosity settings as glog.
     static void setup_dlog();
+
+  private:
+    // decodes each message in frame (call with dccl_mutex_ locked), calling
+    // f(dccl_id, begin, end, msg) for each one. If reuse_messages is true, msg is reused for all
+    // the messages of the same type within the frame
+    template <typename Function>
+    static void decode_frame(const std::string& frame, bool reuse_messages, Function f);
 };
 } // namespace detail
 
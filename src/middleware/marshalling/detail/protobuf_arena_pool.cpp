@@ -0,0 +1,105 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <vector>
+
+#include "protobuf_arena_pool.h"
+
+using goby::middleware::ProtobufArenaPool;
+
+std::atomic<bool> ProtobufArenaPool::enabled_{false};
+std::atomic<std::size_t> ProtobufArenaPool::block_size_{4096};
+std::atomic<std::size_t> ProtobufArenaPool::max_arenas_per_thread_{256};
+
+void ProtobufArenaPool::set_enabled(bool enable, std::size_t block_size,
+                                    std::size_t max_arenas_per_thread)
+{
+    block_size_ = block_size;
+    max_arenas_per_thread_ = max_arenas_per_thread;
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+    enabled_ = enable;
+#endif
+}
+
+ProtobufArenaPool::Stats& ProtobufArenaPool::stats()
+{
+    thread_local Stats stats;
+    return stats;
+}
+
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+namespace
+{
+google::protobuf::ArenaOptions arena_options(char* initial_block, std::size_t block_size)
+{
+    google::protobuf::ArenaOptions options;
+    options.initial_block = initial_block;
+    options.initial_block_size = block_size;
+    // later blocks (for messages larger than the initial block) are freed by Reset()
+    options.start_block_size = block_size;
+    return options;
+}
+} // namespace
+
+ProtobufArenaPool::PooledArena::PooledArena(std::size_t block_size)
+    : initial_block(new char[block_size]), arena(arena_options(initial_block.get(), block_size))
+{
+}
+
+std::shared_ptr<ProtobufArenaPool::PooledArena> ProtobufArenaPool::acquire()
+{
+    struct Pool
+    {
+        std::vector<std::shared_ptr<PooledArena>> arenas;
+        // where to start the search for an unused Arena (the least recently acquired)
+        std::size_t next{0};
+    };
+    thread_local Pool pool;
+
+    for (std::size_t i = 0, n = pool.arenas.size(); i < n; ++i)
+    {
+        auto index = (pool.next + i) % n;
+        auto& pooled = pool.arenas[index];
+        // only the pool can create new references, so once all the messages are released
+        // (by any thread) this cannot increase again
+        if (pooled.use_count() == 1)
+        {
+            // synchronize with the release of the last message
+            std::atomic_thread_fence(std::memory_order_acquire);
+            pooled->arena.Reset();
+            pool.next = index + 1;
+            return pooled;
+        }
+    }
+
+    if (pool.arenas.size() < max_arenas_per_thread_)
+    {
+        pool.arenas.push_back(std::make_shared<PooledArena>(block_size_));
+        stats().arenas = pool.arenas.size();
+        pool.next = 0;
+        return pool.arenas.back();
+    }
+
+    return nullptr;
+}
+#endif
@@ -0,0 +1,135 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ProtobufArenaPool20201019H
+#define ProtobufArenaPool20201019H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <google/protobuf/message.h>
+
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+#include <google/protobuf/arena.h>
+#endif
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Opt-in pools of google::protobuf::Arena used by SerializerParserHelper to create the Protobuf and DCCL messages it parses
+///
+/// When enabled, each parsed message is created on its own Arena, taken from a pool owned by the parsing thread. The returned shared_ptr shares ownership of the Arena (without any additional allocation), which is reset and reused by the parsing thread once all copies of the shared_ptr have been destroyed (in any thread). Each Arena starts with a preallocated block, so once the pool is warm, messages that fit in this block are parsed without any heap allocations.
+///
+/// Arenas require Protobuf 3.0 or newer; with older versions messages are always created with std::make_shared.
+class ProtobufArenaPool
+{
+  public:
+    /// \brief Enable (or disable) arena allocation of parsed messages for all threads
+    ///
+    /// \param enable True to enable
+    /// \param block_size Size of the preallocated block for each Arena (bytes)
+    /// \param max_arenas_per_thread Maximum number of Arenas in each thread's pool. When all of these are still in use by previously parsed messages, new messages are created with std::make_shared.
+    static void set_enabled(bool enable, std::size_t block_size = 4096,
+                            std::size_t max_arenas_per_thread = 256);
+
+    /// \brief Returns whether arena allocation is enabled
+    static bool enabled() { return enabled_; }
+
+    /// \brief Counters for the calling thread
+    struct Stats
+    {
+        /// Messages created on a pooled Arena
+        std::uint64_t arena_messages{0};
+        /// Messages created with std::make_shared (disabled or pool exhausted)
+        std::uint64_t heap_messages{0};
+        /// Arenas in this thread's pool
+        std::uint64_t arenas{0};
+    };
+    static const Stats& thread_stats() { return stats(); }
+
+    /// \brief Create an empty message, on a pooled Arena if enabled, otherwise with std::make_shared
+    template <typename DataType> static std::shared_ptr<DataType> make_message()
+    {
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+        if (enabled_)
+        {
+            if (auto pooled = acquire())
+            {
+                ++stats().arena_messages;
+                auto* msg = google::protobuf::Arena::CreateMessage<DataType>(&pooled->arena);
+                // aliasing constructor: msg shares ownership of its Arena
+                return std::shared_ptr<DataType>(std::move(pooled), msg);
+            }
+        }
+#endif
+        ++stats().heap_messages;
+        return std::make_shared<DataType>();
+    }
+
+    /// \brief Create an empty message of the same type as prototype (for types only known at runtime), on a pooled Arena if enabled, otherwise on the heap
+    static std::shared_ptr<google::protobuf::Message>
+    make_message(const google::protobuf::Message& prototype)
+    {
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+        if (enabled_)
+        {
+            if (auto pooled = acquire())
+            {
+                ++stats().arena_messages;
+                auto* msg = prototype.New(&pooled->arena);
+                return std::shared_ptr<google::protobuf::Message>(std::move(pooled), msg);
+            }
+        }
+#endif
+        ++stats().heap_messages;
+        return std::shared_ptr<google::protobuf::Message>(prototype.New());
+    }
+
+  private:
+    static Stats& stats();
+
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+    struct PooledArena
+    {
+        PooledArena(std::size_t block_size);
+
+        std::unique_ptr<char[]> initial_block;
+        google::protobuf::Arena arena;
+    };
+
+    // returns an unused Arena from the calling thread's pool, or nullptr if the pool is exhausted
+    static std::shared_ptr<PooledArena> acquire();
+#endif
+
+  private:
+    static std::atomic<bool> enabled_;
+    static std::atomic<std::size_t> block_size_;
+    static std::atomic<std::size_t> max_arenas_per_thread_;
+};
+
+} // namespace middleware
+} // namespace goby
+
+#endif
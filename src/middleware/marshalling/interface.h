@@ -32,6 +32,7 @@
 #include <vector>
 
 #include "goby/middleware/marshalling/detail/primitive_type.h"
+#include "goby/middleware/marshalling/serialize_buffer.h"
 
 namespace goby
 {
@@ -101,6 +102,14 @@ template <typename DataType, int scheme, class Enable = void> struct SerializerP
         return std::vector<char>();
     }
 
+    /// \brief Given data, append its bytes to a sink (optional: if not provided by a specialization, serialize_into() copies from the result of serialize(msg))
+    ///
+    /// \tparam Sink SerializeBuffer or a contiguous byte container (std::string, std::vector<char>); use sink_grow() to extend it
+    template <typename Sink> static void serialize(const DataType& msg, Sink* sink)
+    {
+        static_assert(std::is_void<Enable>::value, "SerializerParserHelper must be specialized");
+    }
+
     /// \brief The marshalling scheme specific string name for this type
     static std::string type_name()
     {
@@ -131,9 +140,52 @@ template <typename DataType, int scheme, class Enable = void> struct SerializerP
         static_assert(std::is_void<Enable>::value, "SerializerParserHelper must be specialized");
         return std::shared_ptr<DataType>();
     }
+};
 
+namespace detail
+{
+template <typename Helper, typename DataType, typename Sink, typename Enable = void>
+struct has_serialize_into : std::false_type
+{
+};
+
+template <typename Helper, typename DataType, typename Sink>
+struct has_serialize_into<Helper, DataType, Sink,
+                          decltype(Helper::serialize(std::declval<const DataType&>(),
+                                                     std::declval<Sink*>()))> : std::true_type
+{
 };
 
+template <typename Helper, typename DataType, typename Sink>
+void serialize_into(const DataType& msg, Sink* sink, std::true_type)
+{
+    Helper::serialize(msg, sink);
+}
+
+template <typename Helper, typename DataType, typename Sink>
+void serialize_into(const DataType& msg, Sink* sink, std::false_type)
+{
+    std::vector<char> bytes(Helper::serialize(msg));
+    if (!bytes.empty())
+        std::memcpy(sink_grow(sink, bytes.size()), bytes.data(), bytes.size());
+}
+} // namespace detail
+
+/// \brief Serialize data by appending its bytes to a (typically reused) sink, avoiding the temporary std::vector<char> returned by SerializerParserHelper::serialize(msg)
+///
+/// Uses SerializerParserHelper<DataType, scheme>::serialize(msg, sink) if the specialization provides it, otherwise copies the result of serialize(msg).
+/// \tparam DataType data type to serialize
+/// \tparam scheme marshalling scheme to use
+/// \param msg data to serialize
+/// \param sink SerializeBuffer or contiguous byte container (std::string, std::vector<char>) to append to (existing contents are kept)
+template <typename DataType, int scheme, typename Sink>
+void serialize_into(const DataType& msg, Sink* sink)
+{
+    using Helper = SerializerParserHelper<DataType, scheme>;
+    detail::serialize_into<Helper>(msg, sink,
+                                   detail::has_serialize_into<Helper, DataType, Sink>());
+}
+
 //
 // scheme
 //
@@ -24,8 +24,10 @@
 
 #include "mavlink.h"
 
-std::unordered_map<uint32_t, mavlink::mavlink_msg_entry_t>
-    goby::middleware::MAVLinkRegistry::entries_;
+std::atomic<const goby::middleware::MAVLinkRegistry::EntryMap*>
+    goby::middleware::MAVLinkRegistry::entries_{nullptr};
+std::vector<std::unique_ptr<const goby::middleware::MAVLinkRegistry::EntryMap>>
+    goby::middleware::MAVLinkRegistry::tables_;
 std::mutex goby::middleware::MAVLinkRegistry::mavlink_registry_mutex_;
 
 void goby::middleware::MAVLinkRegistry::register_default_dialects()
@@ -33,6 +35,28 @@ void goby::middleware::MAVLinkRegistry::register_default_dialects()
     register_dialect_entries(mavlink::common::MESSAGE_ENTRIES);
 }
 
+void goby::middleware::MAVLinkRegistry::insert_entries(const mavlink::mavlink_msg_entry_t* begin,
+                                                       const mavlink::mavlink_msg_entry_t* end)
+{
+    std::lock_guard<std::mutex> lock(mavlink_registry_mutex_);
+
+    // copy-on-write: readers continue to use the previous table until the new one is published
+    const EntryMap* current = entries_.load(std::memory_order_acquire);
+    std::unique_ptr<EntryMap> next(current ? new EntryMap(*current) : new EntryMap);
+
+    // the default dialects are always loaded, regardless of which dialect is registered first
+    if (!current)
+    {
+        for (const auto& entry : mavlink::common::MESSAGE_ENTRIES)
+            next->insert(std::make_pair(entry.msgid, entry));
+    }
+
+    for (auto it = begin; it != end; ++it) next->insert(std::make_pair(it->msgid, *it));
+
+    entries_.store(next.get(), std::memory_order_release);
+    tables_.push_back(std::move(next));
+}
+
 namespace mavlink
 {
 const mavlink_msg_entry_t* mavlink_get_msg_entry(uint32_t msgid);
@@ -24,6 +24,9 @@
 #ifndef MarshallingMAVLink20190718H
 #define MarshallingMAVLink20190718H
 
+#include <atomic>
+#include <memory>
+
 #include "interface.h"
 
 #include "goby/exception.h"
@@ -38,6 +41,8 @@ namespace middleware
 /// \brief A registry of mavlink types used for decoding
 ///
 /// You should register the MESSAGE_ENTRIES for the dialect(s) you're using with this registry, if other than common and minimal. Parsing and serialization will still work if you don't, but you will get CRC errors for the unknown types.
+///
+/// The registry is intended to be populated at startup and is read-mostly thereafter: each call to register_dialect_entries publishes a new immutable table, so get_msg_entry (called for every CRC check) never takes a lock.
 struct MAVLinkRegistry
 {
     /// \brief Register a new Mavlink dialect
@@ -46,8 +51,7 @@ struct MAVLinkRegistry
     template <std::size_t Size>
     static void register_dialect_entries(std::array<mavlink::mavlink_msg_entry_t, Size> entries)
     {
-        std::lock_guard<std::mutex> lock(mavlink_registry_mutex_);
-        for (const auto& entry : entries) entries_.insert(std::make_pair(entry.msgid, entry));
+        insert_entries(entries.data(), entries.data() + entries.size());
     }
 
     /// \brief Retrieve a entry given a message id
@@ -56,12 +60,15 @@ struct MAVLinkRegistry
     /// \return The mavlink_msg_entry_t for the given msgid or nullptr if the msgid isn't loaded.
     static const mavlink::mavlink_msg_entry_t* get_msg_entry(uint32_t msgid)
     {
-        if (entries_.empty())
+        const EntryMap* entries = entries_.load(std::memory_order_acquire);
+        if (!entries)
+        {
             register_default_dialects();
+            entries = entries_.load(std::memory_order_acquire);
+        }
 
-        std::lock_guard<std::mutex> lock(mavlink_registry_mutex_);
-        auto it = entries_.find(msgid);
-        if (it != entries_.end())
+        auto it = entries->find(msgid);
+        if (it != entries->end())
             return &it->second;
         else
             return nullptr;
@@ -70,10 +77,168 @@ struct MAVLinkRegistry
     static void register_default_dialects();
 
   private:
-    static std::unordered_map<uint32_t, mavlink::mavlink_msg_entry_t> entries_;
+    using EntryMap = std::unordered_map<uint32_t, mavlink::mavlink_msg_entry_t>;
+
+    static void insert_entries(const mavlink::mavlink_msg_entry_t* begin,
+                               const mavlink::mavlink_msg_entry_t* end);
+
+  private:
+    // current (immutable) table
+    static std::atomic<const EntryMap*> entries_;
+    // every table ever published, retained so that pointers returned by get_msg_entry() remain valid
+    static std::vector<std::unique_ptr<const EntryMap>> tables_;
+    // serializes writers only
     static std::mutex mavlink_registry_mutex_;
 };
 
+/// \brief Thread-safe pool of mavlink_message_t objects, handed out as shared_ptr that return themselves to the pool when the last reference is released
+class MAVLinkMessagePool
+{
+  public:
+    /// \param max_size Maximum number of unused messages retained by the pool
+    MAVLinkMessagePool(std::size_t max_size = 64) : store_(std::make_shared<Store>(max_size)) {}
+
+    /// \brief Retrieve a message from the pool (or allocate a new one if the pool is empty), initialized as a copy of msg
+    std::shared_ptr<mavlink::mavlink_message_t> make(const mavlink::mavlink_message_t& msg)
+    {
+        std::unique_ptr<mavlink::mavlink_message_t> pooled;
+        {
+            std::lock_guard<std::mutex> lock(store_->mutex);
+            if (!store_->free.empty())
+            {
+                pooled = std::move(store_->free.back());
+                store_->free.pop_back();
+            }
+        }
+
+        if (pooled)
+            *pooled = msg;
+        else
+            pooled.reset(new mavlink::mavlink_message_t(msg));
+
+        // deleter holds a reference to the store, so messages may safely outlive the pool itself
+        std::shared_ptr<Store> store = store_;
+        return std::shared_ptr<mavlink::mavlink_message_t>(
+            pooled.release(), [store](mavlink::mavlink_message_t* released) {
+                std::unique_ptr<mavlink::mavlink_message_t> returned(released);
+                std::lock_guard<std::mutex> lock(store->mutex);
+                if (store->free.size() < store->max_size)
+                    store->free.push_back(std::move(returned));
+            });
+    }
+
+  private:
+    struct Store
+    {
+        Store(std::size_t max) : max_size(max) { free.reserve(max_size); }
+        const std::size_t max_size;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<mavlink::mavlink_message_t>> free;
+    };
+    std::shared_ptr<Store> store_;
+};
+
+/// \brief Streaming MAVLink parser that extracts every complete frame from a sequence of bytes (e.g. a UDP datagram or a serial read) in a single call
+///
+/// Framing state is retained between calls to parse(), so frames may be split across reads. Decoded messages are drawn from a MAVLinkMessagePool.
+class MAVLinkStreamParser
+{
+  public:
+    /// \param forward_unknown_crc If true, frames that fail the CRC check because their msgid is not in the MAVLinkRegistry are passed to the handler anyway (they may be valid messages of an unregistered dialect)
+    /// \param pool_size Maximum number of unused messages retained by the message pool
+    MAVLinkStreamParser(bool forward_unknown_crc = true, std::size_t pool_size = 64)
+        : forward_unknown_crc_(forward_unknown_crc), pool_(pool_size)
+    {
+    }
+
+    /// \brief Parse all the bytes given, calling handler for each complete frame
+    ///
+    /// \param bytes_begin Iterator to the first byte to parse
+    /// \param bytes_end Iterator to one past the last byte to parse
+    /// \param handler Function called with each decoded message: void(std::shared_ptr<mavlink::mavlink_message_t>)
+    /// \return Number of messages passed to handler
+    template <typename CharIterator, typename Handler>
+    std::size_t parse(CharIterator bytes_begin, CharIterator bytes_end, Handler handler)
+    {
+        std::size_t frames = 0;
+        for (auto c = bytes_begin; c != bytes_end; ++c)
+        {
+            try
+            {
+                auto res = mavlink::mavlink_frame_char_buffer(&msg_buffer_, &status_buffer_, *c,
+                                                              &msg_, &status_);
+                switch (res)
+                {
+                    case mavlink::MAVLINK_FRAMING_INCOMPLETE: break;
+
+                    case mavlink::MAVLINK_FRAMING_BAD_CRC:
+                        if (status_.parse_state != mavlink::MAVLINK_PARSE_STATE_IDLE)
+                        {
+                            break; // keep parsing
+                        }
+                        else if (forward_unknown_crc_ &&
+                                 MAVLinkRegistry::get_msg_entry(msg_.msgid) == nullptr)
+                        {
+                            goby::glog.is_debug3() &&
+                                goby::glog << "BAD CRC decoding MAVLink msg, but "
+                                              "forwarding because we don't know this msgid"
+                                           << std::endl;
+                            // forward anyway as it might be a msgid we don't know
+                            ++frames;
+                            handler(pool_.make(msg_));
+                        }
+                        else
+                        {
+                            goby::glog.is_warn() && goby::glog << "BAD CRC decoding MAVLink msg"
+                                                               << std::endl;
+                        }
+                        break;
+
+                    case mavlink::MAVLINK_FRAMING_OK:
+                        goby::glog.is_debug3() &&
+                            goby::glog << "Parsed message of id: " << msg_.msgid << std::endl;
+                        ++frames;
+                        handler(pool_.make(msg_));
+                        break;
+
+                    case mavlink::MAVLINK_FRAMING_BAD_SIGNATURE:
+                        goby::glog.is_warn() && goby::glog << "BAD SIGNATURE decoding MAVLink msg"
+                                                           << std::endl;
+                        break;
+
+                    default:
+                        goby::glog.is_warn() &&
+                            goby::glog << "Unknown value " << res
+                                       << " returned while decoding MAVLink msg" << std::endl;
+                        break;
+                }
+            }
+            catch (goby::Exception& e)
+            {
+                goby::glog.is_warn() && goby::glog << "Exception decoding MAVLink msg: "
+                                                   << e.what() << std::endl;
+                reset();
+            }
+        }
+        return frames;
+    }
+
+    /// \brief Discard any partially parsed frame
+    void reset()
+    {
+        msg_ = {};
+        status_ = {};
+        msg_buffer_ = {};
+        status_buffer_ = {};
+    }
+
+  private:
+    bool forward_unknown_crc_;
+    MAVLinkMessagePool pool_;
+    mavlink::mavlink_message_t msg_{}, msg_buffer_{};
+    mavlink::mavlink_status_t status_{}, status_buffer_{};
+};
+
 /// \brief Specialization for Mavlink message using runtime introspection (publish and subscribe_type_regex only)
 template <> struct SerializerParserHelper<mavlink::mavlink_message_t, MarshallingScheme::MAVLINK>
 {
@@ -94,14 +259,26 @@ template <> struct SerializerParserHelper<mavlink::mavlink_message_t, Marshallin
     parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
           const std::string& type)
     {
-        CharIterator c = bytes_begin;
         auto msg = std::make_shared<mavlink::mavlink_message_t>();
+        parse_frame(bytes_begin, bytes_end, actual_end, type, *msg);
+        return msg;
+    }
+
+    /// \brief Parse a single frame into an existing message (avoids allocating)
+    ///
+    /// \return true if a complete frame was decoded, false otherwise
+    template <typename CharIterator>
+    static bool parse_frame(CharIterator bytes_begin, CharIterator bytes_end,
+                            CharIterator& actual_end, const std::string& type,
+                            mavlink::mavlink_message_t& msg)
+    {
+        CharIterator c = bytes_begin;
         mavlink::mavlink_message_t msg_buffer{};
         mavlink::mavlink_status_t status{}, status_buffer{};
         while (c != bytes_end)
         {
-            auto res = mavlink::mavlink_frame_char_buffer(&msg_buffer, &status_buffer, *c,
-                                                          msg.get(), &status);
+            auto res = mavlink::mavlink_frame_char_buffer(&msg_buffer, &status_buffer, *c, &msg,
+                                                          &status);
 
             switch (res)
             {
@@ -110,11 +287,11 @@ template <> struct SerializerParserHelper<mavlink::mavlink_message_t, Marshallin
                 case mavlink::MAVLINK_FRAMING_OK:
                 {
                     actual_end = c;
-                    return msg;
+                    return true;
                 }
 
                 case mavlink::MAVLINK_FRAMING_BAD_CRC:
-                    if (!MAVLinkRegistry::get_msg_entry(msg->msgid))
+                    if (!MAVLinkRegistry::get_msg_entry(msg.msgid))
                     {
                         goby::glog.is_debug2() &&
                             goby::glog << "MAVLink msg type: " << type
@@ -145,7 +322,7 @@ template <> struct SerializerParserHelper<mavlink::mavlink_message_t, Marshallin
         }
     fail:
         actual_end = bytes_end;
-        return msg;
+        return false;
     }
 };
 
@@ -190,15 +367,15 @@ struct SerializerParserHelper<std::tuple<Integer, Integer, DataType>, Marshallin
     parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
           const std::string& type = type_name())
     {
-        auto msg =
-            SerializerParserHelper<mavlink::mavlink_message_t, MarshallingScheme::MAVLINK>::parse(
-                bytes_begin, bytes_end, actual_end, type_name());
+        mavlink::mavlink_message_t msg{};
+        SerializerParserHelper<mavlink::mavlink_message_t, MarshallingScheme::MAVLINK>::parse_frame(
+            bytes_begin, bytes_end, actual_end, type_name(), msg);
         auto packet_with_metadata = std::make_shared<std::tuple<Integer, Integer, DataType>>();
         DataType* packet = &std::get<MAVLinkTupleIndices::PACKET_INDEX>(*packet_with_metadata);
-        mavlink::MsgMap map(msg.get());
+        mavlink::MsgMap map(&msg);
         packet->deserialize(map);
-        std::get<MAVLinkTupleIndices::SYSTEM_ID_INDEX>(*packet_with_metadata) = msg->sysid;
-        std::get<MAVLinkTupleIndices::COMPONENT_ID_INDEX>(*packet_with_metadata) = msg->compid;
+        std::get<MAVLinkTupleIndices::SYSTEM_ID_INDEX>(*packet_with_metadata) = msg.sysid;
+        std::get<MAVLinkTupleIndices::COMPONENT_ID_INDEX>(*packet_with_metadata) = msg.compid;
         return packet_with_metadata;
     }
 };
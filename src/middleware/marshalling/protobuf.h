@@ -26,16 +26,29 @@
 
 #include "interface.h"
 
+#include <cstdint>
+
 #include <google/protobuf/message.h>
 
 #include <dccl/dynamic_protobuf_manager.h>
 
 #include "goby/middleware/protobuf/intervehicle.pb.h"
 
+#include "detail/protobuf_arena_pool.h"
+
 namespace goby
 {
 namespace middleware
 {
+/// \brief Serialize a Protobuf message (standard Protobuf encoding) by appending it to sink, computing its size only once
+template <typename Sink>
+void serialize_protobuf(const google::protobuf::MessageLite& msg, Sink* sink)
+{
+    const auto size = msg.ByteSize();
+    if (size > 0)
+        msg.SerializeWithCachedSizesToArray(reinterpret_cast<std::uint8_t*>(sink_grow(sink, size)));
+}
+
 /// \brief Specialization for fully qualified Protobuf message types (static), e.g. DataType == Foo for "message Foo"
 template <typename DataType>
 struct SerializerParserHelper<
@@ -45,11 +58,19 @@ struct SerializerParserHelper<
     /// Serialize Protobuf message (standard Protobuf encoding)
     static std::vector<char> serialize(const DataType& msg)
     {
-        std::vector<char> bytes(msg.ByteSize(), 0);
-        msg.SerializeToArray(bytes.data(), bytes.size());
+        std::vector<char> bytes;
+        serialize(msg, &bytes);
         return bytes;
     }
 
+    /// \brief Serialize Protobuf message (standard Protobuf encoding), appending to sink
+    ///
+    /// The message size is only computed once (by ByteSize(), which caches it for serialization)
+    template <typename Sink> static void serialize(const DataType& msg, Sink* sink)
+    {
+        serialize_protobuf(msg, sink);
+    }
+
     /// \brief Full protobuf Message name, including package (if one is defined).
     ///
     /// For example, returns "foo.Bar" for the following .proto:
@@ -63,12 +84,14 @@ struct SerializerParserHelper<
     }
 
     /// \brief Parse Protobuf message (using standard Protobuf decoding)
+    ///
+    /// The message is allocated on a pooled Arena if ProtobufArenaPool is enabled
     template <typename CharIterator>
     static std::shared_ptr<DataType> parse(CharIterator bytes_begin, CharIterator bytes_end,
                                            CharIterator& actual_end,
                                            const std::string& type = type_name())
     {
-        auto msg = std::make_shared<DataType>();
+        auto msg = ProtobufArenaPool::make_message<DataType>();
         msg->ParseFromArray(&*bytes_begin, bytes_end - bytes_begin);
         actual_end = bytes_begin + msg->ByteSize();
         return msg;
@@ -81,11 +104,17 @@ template <> struct SerializerParserHelper<google::protobuf::Message, Marshalling
     /// Serialize Protobuf message (standard Protobuf encoding)
     static std::vector<char> serialize(const google::protobuf::Message& msg)
     {
-        std::vector<char> bytes(msg.ByteSize(), 0);
-        msg.SerializeToArray(bytes.data(), bytes.size());
+        std::vector<char> bytes;
+        serialize(msg, &bytes);
         return bytes;
     }
 
+    /// Serialize Protobuf message (standard Protobuf encoding), appending to sink
+    template <typename Sink> static void serialize(const google::protobuf::Message& msg, Sink* sink)
+    {
+        serialize_protobuf(msg, sink);
+    }
+
     /// \brief Full protobuf name from message instantiation, including package (if one is defined).
     ///
     /// \param d Protobuf message
@@ -114,18 +143,29 @@ template <> struct SerializerParserHelper<google::protobuf::Message, Marshalling
     parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
           const std::string& type)
     {
-        std::shared_ptr<google::protobuf::Message> msg;
-
-        {
-            static std::mutex dynamic_protobuf_manager_mutex;
-            std::lock_guard<std::mutex> lock(dynamic_protobuf_manager_mutex);
-            msg = dccl::DynamicProtobufManager::new_protobuf_message<
-                std::shared_ptr<google::protobuf::Message>>(type);
-        }
+        auto msg = new_message(type);
+        parse(bytes_begin, bytes_end, actual_end, msg.get());
+        return msg;
+    }
 
+    /// \brief Parse Protobuf message into an existing message (e.g. one reused between calls, or created from a cached prototype), avoiding the lookup of the type by name
+    ///
+    /// \param msg Message to parse into (existing contents are cleared)
+    template <typename CharIterator>
+    static void parse(CharIterator bytes_begin, CharIterator bytes_end, CharIterator& actual_end,
+                      google::protobuf::Message* msg)
+    {
         msg->ParseFromArray(&*bytes_begin, bytes_end - bytes_begin);
         actual_end = bytes_begin + msg->ByteSize();
-        return msg;
+    }
+
+    /// \brief Create an empty message given the Protobuf type name, assuming the message descriptor is loaded into dccl::DynamicProtobufManager
+    static std::shared_ptr<google::protobuf::Message> new_message(const std::string& type)
+    {
+        static std::mutex dynamic_protobuf_manager_mutex;
+        std::lock_guard<std::mutex> lock(dynamic_protobuf_manager_mutex);
+        return dccl::DynamicProtobufManager::new_protobuf_message<
+            std::shared_ptr<google::protobuf::Message>>(type);
     }
 };
 
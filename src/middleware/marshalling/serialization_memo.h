@@ -0,0 +1,147 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SerializationMemo20201019H
+#define SerializationMemo20201019H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "goby/middleware/marshalling/interface.h"
+#include "goby/middleware/marshalling/serialize_buffer.h"
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Remembers the serialized bytes (for each marshalling scheme) of one datum while it is published, so that a datum that passes through several layers (e.g. intervehicle and interprocess, or an interprocess forwarder) is encoded at most once per scheme
+///
+/// A SerializationMemo is created on the stack by the outermost publish of a datum (InterVehicleTransporterBase does this), and lasts until that publish returns. While it exists, serialize_memoized() calls on the same thread for the same object (by address) reuse the bytes from the first call for each scheme. Memos nest, and the memo storage is kept (per thread) between publications so that memoizing does not allocate once it has reached the size of the largest message.
+class SerializationMemo
+{
+  public:
+    /// \param data The datum being published (must remain unchanged for the lifetime of the memo)
+    explicit SerializationMemo(const void* data)
+    {
+        auto& s = stack();
+        if (s.depth == s.entries.size())
+            s.entries.emplace_back();
+        auto& entry = s.entries[s.depth++];
+        entry.data = data;
+        entry.used = 0;
+    }
+    ~SerializationMemo() { --stack().depth; }
+
+    SerializationMemo(const SerializationMemo&) = delete;
+    SerializationMemo& operator=(const SerializationMemo&) = delete;
+
+    /// \brief Number of serializations avoided on this thread (for testing and diagnostics)
+    static std::uint64_t hits() { return stack().hits; }
+
+  private:
+    template <typename DataType, int scheme, typename Sink>
+    friend void serialize_memoized(const DataType& msg, Sink* sink);
+
+    struct Slot
+    {
+        int scheme;
+        SerializeBuffer bytes;
+    };
+
+    struct Entry
+    {
+        const void* data{nullptr};
+        std::vector<Slot> slots;
+        // number of slots in use by the current memo
+        std::size_t used{0};
+    };
+
+    struct Stack
+    {
+        std::vector<Entry> entries;
+        std::size_t depth{0};
+        std::uint64_t hits{0};
+    };
+
+    static Stack& stack()
+    {
+        static thread_local Stack s;
+        return s;
+    }
+
+    // innermost open memo for data, or nullptr
+    static Entry* find(const void* data)
+    {
+        auto& s = stack();
+        for (auto i = s.depth; i > 0; --i)
+        {
+            if (s.entries[i - 1].data == data)
+                return &s.entries[i - 1];
+        }
+        return nullptr;
+    }
+};
+
+/// \brief serialize_into(), reusing (or remembering) the bytes for this scheme if a SerializationMemo is open for msg on this thread
+template <typename DataType, int scheme, typename Sink>
+void serialize_memoized(const DataType& msg, Sink* sink)
+{
+    SerializationMemo::Entry* entry = SerializationMemo::find(&msg);
+    if (!entry)
+    {
+        serialize_into<DataType, scheme>(msg, sink);
+        return;
+    }
+
+    for (std::size_t i = 0; i < entry->used; ++i)
+    {
+        const auto& slot = entry->slots[i];
+        if (slot.scheme == scheme)
+        {
+            if (!slot.bytes.empty())
+                std::memcpy(sink_grow(sink, slot.bytes.size()), slot.bytes.data(),
+                            slot.bytes.size());
+            ++SerializationMemo::stack().hits;
+            return;
+        }
+    }
+
+    auto begin = sink->size();
+    serialize_into<DataType, scheme>(msg, sink);
+
+    if (entry->used == entry->slots.size())
+        entry->slots.emplace_back();
+    auto& slot = entry->slots[entry->used++];
+    slot.scheme = scheme;
+    slot.bytes.clear();
+    auto size = sink->size() - begin;
+    if (size)
+        std::memcpy(slot.bytes.grow(size), sink->data() + begin, size);
+}
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SerializeBuffer20201019H
+#define SerializeBuffer20201019H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Growable byte buffer that serialize_into() appends to, intended to be kept and reused between calls
+///
+/// Unlike std::vector<char>, growing the buffer does not zero-fill the new bytes, and clear() retains the allocated storage, so once the buffer has reached the size of the largest message serializing does not allocate.
+class SerializeBuffer
+{
+  public:
+    SerializeBuffer() = default;
+    explicit SerializeBuffer(std::size_t capacity) { reserve(capacity); }
+
+    /// \brief Extend the buffer by n uninitialized bytes and return a pointer to the first of them
+    char* grow(std::size_t n)
+    {
+        reserve(size_ + n);
+        char* begin = data_.get() + size_;
+        size_ += n;
+        return begin;
+    }
+
+    /// \brief Ensure that the buffer can hold capacity bytes without reallocating
+    void reserve(std::size_t capacity)
+    {
+        if (capacity <= capacity_)
+            return;
+
+        capacity = std::max(capacity, 2 * capacity_);
+        std::unique_ptr<char[]> data(new char[capacity]);
+        if (size_)
+            std::memcpy(data.get(), data_.get(), size_);
+        data_ = std::move(data);
+        capacity_ = capacity;
+    }
+
+    /// \brief Remove all bytes (keeping the allocated storage)
+    void clear() { size_ = 0; }
+
+    char* data() { return data_.get(); }
+    const char* data() const { return data_.get(); }
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    const char* begin() const { return data_.get(); }
+    const char* end() const { return data_.get() + size_; }
+
+  private:
+    std::unique_ptr<char[]> data_;
+    std::size_t size_{0};
+    std::size_t capacity_{0};
+};
+
+/// \brief Extend a serialization sink by n (uninitialized) bytes and return a pointer to them
+inline char* sink_grow(SerializeBuffer* sink, std::size_t n) { return sink->grow(n); }
+
+/// \brief Extend a serialization sink by n bytes and return a pointer to them, for contiguous byte containers such as std::string, std::vector<char> or std::vector<unsigned char>
+template <typename Container> char* sink_grow(Container* sink, std::size_t n)
+{
+    auto size = sink->size();
+    sink->resize(size + n);
+    if (sink->empty())
+        return nullptr;
+    return reinterpret_cast<char*>(&(*sink)[0]) + size;
+}
+
+} // namespace middleware
+} // namespace goby
+
+#endif
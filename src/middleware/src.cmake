@@ -20,15 +20,23 @@ protobuf_generate_cpp(MIDDLEWARE_PROTO_SRCS MIDDLEWARE_PROTO_HDRS
   middleware/protobuf/tcp_config.proto
   middleware/protobuf/intermodule.proto
   middleware/protobuf/pty_config.proto
+  middleware/protobuf/transport_stats.proto
+  middleware/protobuf/thread_scheduling.proto
   )
 
 set(MIDDLEWARE_SRC
   middleware/marshalling/interface.cpp
   middleware/marshalling/detail/dccl_serializer_parser.cpp 
+  middleware/marshalling/detail/protobuf_arena_pool.cpp
   middleware/transport/interthread.cpp
+  middleware/transport/stats.cpp
+  middleware/transport/poll_scheduler.cpp
   middleware/transport/intervehicle/driver_thread.cpp
   middleware/application/configuration_reader.cpp
+  middleware/application/thread_executor.cpp
+  middleware/application/thread_scheduling.cpp
   middleware/log/log_entry.cpp
+  middleware/log/log_player.cpp
   middleware/frontseat/interface.cpp
   ${MIDDLEWARE_PROTO_SRCS} ${MIDDLEWARE_PROTO_HDRS} 
   )
@@ -24,7 +24,11 @@
 #ifndef SubscriptionStore20191105H
 #define SubscriptionStore20191105H
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <algorithm>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -35,7 +39,11 @@
 #include <unordered_map>
 #include <vector>
 
+#include "goby/middleware/common.h"
+#include "goby/middleware/transport/poll_scheduler.h"
 #include "goby/middleware/transport/publisher.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/middleware/transport/subscriber.h"
 
 namespace goby
 {
@@ -49,42 +57,92 @@ class SubscriptionStoreBase
   private:
     // for each thread, stores a map of Datas to SubscriptionStores so that can call poll() on all the stores
     using StoresMap = std::unordered_map<std::type_index, std::shared_ptr<SubscriptionStoreBase>>;
-    static std::unordered_map<std::thread::id, StoresMap> stores_;
+    static std::unordered_map<ThreadId, StoresMap> stores_;
     static std::shared_timed_mutex stores_mutex_;
+    // set once any subscription has a priority other than PRIORITY_NORMAL
+    static std::atomic<bool> prioritized_;
 
   public:
     SubscriptionStoreBase() = default;
     virtual ~SubscriptionStoreBase() = default;
 
-    // returns number of data items posted to callbacks
-    static int poll_all(std::thread::id thread_id,
-                        std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock)
+    // returns number of data items posted to callbacks; at most budget data are delivered (if
+    // not 0), shared between the priority classes by deficits
+    static int poll_all(ThreadId thread_id,
+                        std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock,
+                        std::size_t budget = 0, PriorityDeficits* deficits = nullptr)
     {
         // make a copy so that other threads can subscribe if
         // necessary in their callbacks
-        StoresMap stores;
+        std::vector<std::shared_ptr<SubscriptionStoreBase>> stores;
         {
             std::shared_lock<std::shared_timed_mutex> stores_lock(stores_mutex_);
-            if (stores_.count(thread_id))
-                stores = stores_.at(thread_id);
+            auto it = stores_.find(thread_id);
+            if (it != stores_.end())
+                for (const auto& p : it->second) stores.push_back(p.second);
         }
 
+        const auto unlimited = PriorityDeficits::unlimited;
         int poll_items = 0;
-        for (auto const& s : stores) poll_items += s.second->poll(thread_id, lock);
+        std::size_t delivered = 0;
+        if (!prioritized_ && budget == 0)
+        {
+            for (auto const& s : stores)
+                poll_items += s->poll(thread_id, lock, 0, unlimited, &delivered);
+            return poll_items;
+        }
+
+        // deliver the groups of each priority class in turn, across all data types (starting
+        // with a different one each time, so that none is always served first within a budget)
+        PriorityDeficits local_deficits;
+        std::size_t first_store = deficits ? deficits->next_queue() : 0;
+        auto deliver = [&](int priority, std::size_t max, bool& stop) -> std::size_t {
+            std::size_t class_delivered = 0;
+            for (std::size_t i = 0, n = stores.size(); i < n && class_delivered < max; ++i)
+            {
+                const auto& s = stores[(first_store + i) % n];
+                poll_items += s->poll(thread_id, lock, priority,
+                                      max == unlimited ? unlimited : max - class_delivered,
+                                      &class_delivered);
+            }
+            return class_delivered;
+        };
+        auto queued = [&](int priority) {
+            return std::any_of(stores.begin(), stores.end(), [&](const auto& s) {
+                return s->queued(thread_id, priority);
+            });
+        };
+        (deficits ? *deficits : local_deficits)
+            .schedule(budget, protobuf::LAYER_INTERTHREAD, deliver, queued);
         return poll_items;
     }
 
-    static void unsubscribe_all(std::thread::id thread_id)
+    // removes all the state for the thread (called when its transporter is destroyed, e.g. when a ThreadExecutor task finishes)
+    static void unsubscribe_all(ThreadId thread_id)
     {
-        std::shared_lock<std::shared_timed_mutex> stores_lock(stores_mutex_);
-        if (stores_.count(thread_id))
+        StoresMap stores;
         {
-            for (auto const& s : stores_.at(thread_id)) s.second->unsubscribe_all_groups(thread_id);
+            std::lock_guard<std::shared_timed_mutex> stores_lock(stores_mutex_);
+            auto it = stores_.find(thread_id);
+            if (it == stores_.end())
+                return;
+            stores = std::move(it->second);
+            stores_.erase(it);
         }
+        for (auto const& s : stores) s.second->unsubscribe_all_groups(thread_id);
+    }
+
+    /// \brief Number of threads (including ThreadExecutor tasks) that currently have interthread subscription state
+    static std::size_t thread_count()
+    {
+        std::shared_lock<std::shared_timed_mutex> stores_lock(stores_mutex_);
+        return stores_.size();
     }
 
   protected:
-    template <typename StoreType> static void insert(std::thread::id thread_id)
+    static void set_prioritized() { prioritized_ = true; }
+
+    template <typename StoreType> static void insert(ThreadId thread_id)
     {
         // check the store, and if there isn't one for this type, create one
         std::lock_guard<decltype(stores_mutex_)> lock(stores_mutex_);
@@ -99,22 +157,29 @@ class SubscriptionStoreBase
     }
 
   protected:
-    virtual int poll(std::thread::id thread_id,
-                     std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock) = 0;
-    virtual void unsubscribe_all_groups(std::thread::id thread_id) = 0;
+    // delivers at most max of the data queued for groups of the given priority (or all groups if
+    // 0), adding the number of data to delivered, and returns the number of callbacks made
+    virtual int poll(ThreadId thread_id, std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock,
+                     int priority, std::size_t max, std::size_t* delivered) = 0;
+    // are any data queued for groups of the given priority?
+    virtual bool queued(ThreadId thread_id, int priority) = 0;
+    virtual void unsubscribe_all_groups(ThreadId thread_id) = 0;
 };
 
 struct DataProtection
 {
     DataProtection(std::shared_ptr<std::mutex> dm, std::shared_ptr<std::condition_variable_any> pcv,
-                   std::shared_ptr<std::timed_mutex> pm)
-        : data_mutex(dm), poller_cv(pcv), poller_mutex(pm)
+                   std::shared_ptr<std::timed_mutex> pm,
+                   std::shared_ptr<const std::function<void()>> w = nullptr)
+        : data_mutex(dm), poller_cv(pcv), poller_mutex(pm), wake(w)
     {
     }
 
     std::shared_ptr<std::mutex> data_mutex;
     std::shared_ptr<std::condition_variable_any> poller_cv;
     std::shared_ptr<std::timed_mutex> poller_mutex;
+    // set for ThreadExecutor tasks, which don't wait on poller_cv
+    std::shared_ptr<const std::function<void()>> wake;
 };
 
 /// \brief Storage class for a specific interthread subscription (and related data). Used by InterThreadTransporter
@@ -122,16 +187,21 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
 {
   public:
     static void subscribe(std::function<void(std::shared_ptr<const Data>)> func, const Group& group,
-                          std::thread::id thread_id, std::shared_ptr<std::mutex> data_mutex,
+                          ThreadId thread_id, std::shared_ptr<std::mutex> data_mutex,
                           std::shared_ptr<std::condition_variable_any> cv,
-                          std::shared_ptr<std::timed_mutex> poller_mutex)
+                          std::shared_ptr<std::timed_mutex> poller_mutex,
+                          const SubscriptionQueuePolicy& policy = SubscriptionQueuePolicy(),
+                          std::shared_ptr<const std::function<void()>> wake = nullptr)
     {
+        // looked up once here so that publish() and poll() don't need to per message
+        TransportStats::GroupStats* stats =
+            &TransportStats::group(protobuf::LAYER_INTERTHREAD, group);
         {
             std::lock_guard<std::shared_timed_mutex> lock(subscription_mutex_);
 
             // insert callback
-            auto it =
-                subscription_callbacks_.insert(std::make_pair(thread_id, Callback(group, func)));
+            auto it = subscription_callbacks_.insert(
+                std::make_pair(thread_id, Callback(group, func, stats)));
             // insert group with iterator to callback
             subscription_groups_.insert(std::make_pair(group, it));
 
@@ -142,19 +212,25 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
                 auto bool_it_pair = data_.insert(std::make_pair(thread_id, DataQueue()));
                 queue_it = bool_it_pair.first;
             }
-            queue_it->second.create(group);
 
             // if we don't have a condition variable already for this thread, store it
             if (!data_protection_.count(thread_id))
                 data_protection_.insert(std::make_pair(
-                    thread_id, detail::DataProtection(data_mutex, cv, poller_mutex)));
+                    thread_id, detail::DataProtection(data_mutex, cv, poller_mutex, wake)));
+
+            // the most recent subscription from this thread sets the queue limits for the group
+            std::lock_guard<std::mutex> data_lock(*(data_protection_.at(thread_id).data_mutex));
+            queue_it->second.create(group, policy, stats);
         }
 
+        if (policy.priority != protobuf::TransporterConfig::QoS::PRIORITY_NORMAL)
+            SubscriptionStoreBase::set_prioritized();
+
         // try inserting a copy of this templated class via the base class for SubscriptionStoreBase::poll_all to use
         SubscriptionStoreBase::insert<SubscriptionStore<Data>>(thread_id);
     }
 
-    static void unsubscribe(const Group& group, std::thread::id thread_id)
+    static void unsubscribe(const Group& group, ThreadId thread_id)
     {
         {
             std::lock_guard<std::shared_timed_mutex> lock(subscription_mutex_);
@@ -182,28 +258,61 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
         }
     }
 
+    /// \brief Number of messages on the given group discarded (due to the subscription's SubscriptionQueuePolicy) before being delivered to thread_id
+    static std::uint64_t drops(const Group& group, ThreadId thread_id)
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(subscription_mutex_);
+        auto queue_it = data_.find(thread_id);
+        if (queue_it == data_.end())
+            return 0;
+        std::lock_guard<std::mutex> data_lock(
+            *(data_protection_.find(thread_id)->second.data_mutex));
+        return queue_it->second.drops(group);
+    }
+
     static void publish(std::shared_ptr<const Data> data, const Group& group,
                         const Publisher<Data>& publisher)
     {
         // push new data
         // build up local vector of relevant condition variables while locked
         std::vector<detail::DataProtection> cv_to_notify;
+        // threads with more than one subscription to this group get one copy (for all their callbacks)
+        std::vector<ThreadId> queued_threads;
+        bool stats_enabled = TransportStats::enabled();
+        auto publish_time = stats_enabled ? TransportStats::Clock::now()
+                                          : TransportStats::Clock::time_point();
         {
             std::shared_lock<std::shared_timed_mutex> lock(subscription_mutex_);
 
             auto range = subscription_groups_.equal_range(group);
+            if (stats_enabled)
+            {
+                // use the handle cached by subscribe(), so only groups without subscribers need a lookup
+                if (range.first != range.second)
+                    range.first->second->second.stats->publish();
+                else
+                    TransportStats::group(protobuf::LAYER_INTERTHREAD, group).publish();
+            }
+
             for (auto it = range.first; it != range.second; ++it)
             {
-                std::thread::id thread_id = it->second->first;
+                ThreadId thread_id = it->second->first;
+
+                // one copy per thread, shared by all its subscriptions to this group
+                if (std::find(queued_threads.begin(), queued_threads.end(), thread_id) !=
+                    queued_threads.end())
+                    continue;
 
                 // don't store a copy if publisher == subscriber, and echo is false
-                if (thread_id != std::this_thread::get_id() || publisher.cfg().echo())
+                if (thread_id != this_thread_id() || publisher.cfg().echo())
                 {
+                    queued_threads.push_back(thread_id);
                     // protect the DataQueue we are writing to
                     std::unique_lock<std::mutex> lock(
                         *(data_protection_.find(thread_id)->second.data_mutex));
                     auto queue_it = data_.find(thread_id);
-                    queue_it->second.insert(group, data);
+                    if (!queue_it->second.insert(group, data, publish_time) && stats_enabled)
+                        it->second->second.stats->drop();
                     cv_to_notify.push_back(data_protection_.at(thread_id));
                 }
             }
@@ -220,17 +329,27 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
                 std::lock_guard<std::timed_mutex>(*data_protection.poller_mutex);
             }
             data_protection.poller_cv->notify_all();
+            if (data_protection.wake)
+                (*data_protection.wake)();
         }
     }
 
   private:
-    int poll(std::thread::id thread_id,
-             std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock) override
+    int poll(ThreadId thread_id, std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock,
+             int priority, std::size_t max, std::size_t* delivered) override
     {
         std::vector<std::pair<std::shared_ptr<typename Callback::CallbackType>,
                               std::shared_ptr<const Data>>>
             data_callbacks;
+        // parallel to data_callbacks, only filled when TransportStats are enabled
+        std::vector<TransportStats::GroupStats*> data_stats;
+        bool stats_enabled = TransportStats::enabled();
+        auto poll_time = stats_enabled ? TransportStats::Clock::now()
+                                       : TransportStats::Clock::time_point();
         int poll_items_count = 0;
+        // set when data remain queued (max_batch or max) for a ThreadExecutor task
+        std::shared_ptr<const std::function<void()>> wake;
+        std::size_t data_count = 0;
 
         {
             std::shared_lock<std::shared_timed_mutex> sub_lock(subscription_mutex_);
@@ -239,44 +358,131 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
             if (queue_it == data_.end())
                 return 0; // no subscriptions
 
-            std::unique_lock<std::mutex> data_lock(
-                *(data_protection_.find(thread_id)->second.data_mutex));
-
-            // loop over all Groups stored in this DataQueue
-            for (auto data_it = queue_it->second.cbegin(), end = queue_it->second.cend();
-                 data_it != end; ++data_it)
+            const auto& data_protection = data_protection_.find(thread_id)->second;
+            std::unique_lock<std::mutex> data_lock(*(data_protection.data_mutex));
+
+            // loop over all Groups stored in this DataQueue, starting with a different one each
+            // time that max may be reached
+            auto& data_queue = queue_it->second;
+            auto begin = data_queue.cbegin();
+            std::size_t num_groups = data_queue.size();
+            if (max != PriorityDeficits::unlimited && num_groups > 1)
+                std::advance(begin, data_queue.next_first_group() % num_groups);
+            auto data_it = begin;
+            for (std::size_t g = 0; g < num_groups; ++g, ++data_it)
             {
+                if (data_it == data_queue.cend())
+                    data_it = data_queue.cbegin();
+
                 const Group& group = data_it->first;
+                const auto& queue = data_it->second;
+                if (queue.data.empty() || (priority && queue.policy.priority != priority))
+                    continue;
+
+                if (data_count == max)
+                {
+                    // left for the next poll
+                    wake = data_protection.wake;
+                    break;
+                }
+
+                // deliver at most max_batch of the queued data (oldest first)
+                std::size_t batch = std::min(queue.data.size(), max - data_count);
+                if (queue.policy.max_batch && queue.policy.max_batch < batch)
+                    batch = queue.policy.max_batch;
+                if (batch < queue.data.size())
+                    wake = data_protection.wake;
+                data_count += batch;
+
                 auto group_range = subscription_groups_.equal_range(group);
+                TransportStats::GroupStats* group_stats = stats_enabled ? queue.stats : nullptr;
+                if (group_stats && batch < queue.data.size())
+                    group_stats->defer();
+                if (stats_enabled)
+                {
+                    for (auto datum_it = queue.data.begin(), datum_end = datum_it + batch;
+                         datum_it != datum_end; ++datum_it)
+                    {
+                        queue.class_stats->receive();
+                        if (datum_it->publish_time != TransportStats::Clock::time_point())
+                            queue.class_stats->queue_time.record(poll_time -
+                                                                 datum_it->publish_time);
+                    }
+                }
                 // For a given Group, loop over all subscriptions to this Group
                 for (auto group_it = group_range.first; group_it != group_range.second; ++group_it)
                 {
                     if (group_it->second->first != thread_id)
                         continue;
 
-                    // store the callback function and datum for all the elements queued
-                    for (auto& datum : data_it->second)
+                    // store the callback function and datum for all the elements in this batch
+                    for (auto datum_it = queue.data.begin(), datum_end = datum_it + batch;
+                         datum_it != datum_end; ++datum_it)
                     {
+                        const auto& datum = *datum_it;
                         ++poll_items_count;
                         // we have data, no need to keep this lock any longer
                         if (lock)
                             lock.reset();
                         data_callbacks.push_back(
-                            std::make_pair(group_it->second->second.callback, datum));
+                            std::make_pair(group_it->second->second.callback, datum.data));
+
+                        if (group_stats)
+                        {
+                            group_stats->receive();
+                            // publish_time is not set if stats were enabled after publication
+                            if (datum.publish_time != TransportStats::Clock::time_point())
+                                group_stats->queue_time.record(poll_time - datum.publish_time);
+                            data_stats.push_back(group_stats);
+                        }
                     }
                 }
-                queue_it->second.clear(group);
+                data_queue.pop(group, batch);
             }
         }
+        *delivered += data_count;
+
+        // a ThreadExecutor task must run again to deliver the remaining data (a blocking poll()
+        // returns immediately as this one has delivered data)
+        if (wake)
+            (*wake)();
 
         // now that we're no longer blocking the subscription or data mutex, actually run the callbacks
-        for (const auto& callback_datum_pair : data_callbacks)
-            (*callback_datum_pair.first)(std::move(callback_datum_pair.second));
+        if (data_stats.empty())
+        {
+            for (const auto& callback_datum_pair : data_callbacks)
+                (*callback_datum_pair.first)(std::move(callback_datum_pair.second));
+        }
+        else
+        {
+            for (std::size_t i = 0, n = data_callbacks.size(); i < n; ++i)
+            {
+                TransportStats::HandlerTimer timer(data_stats[i]);
+                (*data_callbacks[i].first)(std::move(data_callbacks[i].second));
+            }
+        }
 
         return poll_items_count;
     }
 
-    void unsubscribe_all_groups(std::thread::id thread_id) override
+    bool queued(ThreadId thread_id, int priority) override
+    {
+        std::shared_lock<std::shared_timed_mutex> sub_lock(subscription_mutex_);
+        auto queue_it = data_.find(thread_id);
+        if (queue_it == data_.end())
+            return false;
+
+        std::lock_guard<std::mutex> data_lock(
+            *(data_protection_.find(thread_id)->second.data_mutex));
+        for (auto it = queue_it->second.cbegin(), end = queue_it->second.cend(); it != end; ++it)
+        {
+            if (!it->second.data.empty() && it->second.policy.priority == priority)
+                return true;
+        }
+        return false;
+    }
+
+    void unsubscribe_all_groups(ThreadId thread_id) override
     {
         {
             std::lock_guard<std::shared_timed_mutex> lock(subscription_mutex_);
@@ -297,6 +503,9 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
             }
 
             data_.erase(thread_id);
+            // the transporter that provided these is being destroyed (and ThreadExecutor task
+            // ids are never reused)
+            data_protection_.erase(thread_id);
         }
     }
 
@@ -304,59 +513,113 @@ template <typename Data> class SubscriptionStore : public SubscriptionStoreBase
     struct Callback
     {
         using CallbackType = std::function<void(std::shared_ptr<const Data>)>;
-        Callback(const Group& g, const std::function<void(std::shared_ptr<const Data>)>& c)
-            : group(g), callback(new CallbackType(c))
+        Callback(const Group& g, const std::function<void(std::shared_ptr<const Data>)>& c,
+                 TransportStats::GroupStats* s)
+            : group(g), callback(new CallbackType(c)), stats(s)
         {
         }
         Group group;
         std::shared_ptr<CallbackType> callback;
+        // valid for the life of the process
+        TransportStats::GroupStats* stats;
+    };
+
+    struct Datum
+    {
+        std::shared_ptr<const Data> data;
+        // only set when TransportStats are enabled
+        TransportStats::Clock::time_point publish_time;
+    };
+
+    struct GroupQueue
+    {
+        std::deque<Datum> data;
+        SubscriptionQueuePolicy policy;
+        std::uint64_t drops{0};
+        TransportStats::GroupStats* stats{nullptr};
+        // for policy.priority
+        TransportStats::ClassStats* class_stats{nullptr};
     };
 
     class DataQueue
     {
       private:
-        std::unordered_map<Group, std::vector<std::shared_ptr<const Data>>> data_;
+        std::unordered_map<Group, GroupQueue> data_;
+        std::size_t next_first_group_{0};
 
       public:
-        void create(const Group& g)
+        void create(const Group& g, const SubscriptionQueuePolicy& policy,
+                    TransportStats::GroupStats* stats)
         {
             auto it = data_.find(g);
             if (it == data_.end())
-                data_.insert(std::make_pair(g, std::vector<std::shared_ptr<const Data>>()));
+                it = data_.insert(std::make_pair(g, GroupQueue())).first;
+            it->second.policy = policy;
+            it->second.stats = stats;
+            it->second.class_stats =
+                &TransportStats::priority_class(protobuf::LAYER_INTERTHREAD, policy.priority);
         }
         void remove(const Group& g) { data_.erase(g); }
 
-        void insert(const Group& g, std::shared_ptr<const Data> datum)
+        // returns false if a datum (this one or an older one) was discarded to respect the policy
+        bool insert(const Group& g, std::shared_ptr<const Data> datum,
+                    TransportStats::Clock::time_point publish_time)
         {
-            data_.find(g)->second.push_back(datum);
+            auto& queue = data_.find(g)->second;
+            bool full = queue.policy.bounded() && queue.data.size() >= queue.policy.max_depth;
+            if (full)
+            {
+                ++queue.drops;
+                if (queue.policy.drop_newest)
+                    return false;
+                queue.data.pop_front();
+            }
+            queue.data.push_back({datum, publish_time});
+            return !full;
+        }
+        // removes the first n data
+        void pop(const Group& g, std::size_t n)
+        {
+            auto& data = data_.find(g)->second.data;
+            if (n == data.size())
+                data.clear();
+            else
+                data.erase(data.begin(), data.begin() + n);
+        }
+        std::uint64_t drops(const Group& g)
+        {
+            auto it = data_.find(g);
+            return it == data_.end() ? 0 : it->second.drops;
         }
-        void clear(const Group& g) { data_.find(g)->second.clear(); }
         bool empty() { return data_.empty(); }
+        std::size_t size() { return data_.size(); }
+        // where poll() starts when it may not deliver all the groups
+        std::size_t next_first_group() { return next_first_group_++; }
         typename decltype(data_)::const_iterator cbegin() { return data_.begin(); }
         typename decltype(data_)::const_iterator cend() { return data_.end(); }
     };
 
     // subscriptions for a given thread
-    static std::unordered_multimap<std::thread::id, Callback> subscription_callbacks_;
+    static std::unordered_multimap<ThreadId, Callback> subscription_callbacks_;
     // threads that are subscribed to a given group
     static std::unordered_multimap<Group,
                                    typename decltype(subscription_callbacks_)::const_iterator>
         subscription_groups_;
     // condition variable to use for data
-    static std::unordered_map<std::thread::id, detail::DataProtection> data_protection_;
+    static std::unordered_map<ThreadId, detail::DataProtection> data_protection_;
 
     static std::shared_timed_mutex
         subscription_mutex_; // protects subscription_callbacks, subscription_groups, data_protection, and the overarching data_ map (but not the DataQueues within it, which are protected by the mutexes stored in data_protection_))
 
     // data for a given thread
-    static std::unordered_map<std::thread::id, DataQueue> data_;
+    static std::unordered_map<ThreadId, DataQueue> data_;
 };
 
 template <typename Data>
-std::unordered_multimap<std::thread::id, typename SubscriptionStore<Data>::Callback>
+std::unordered_multimap<ThreadId, typename SubscriptionStore<Data>::Callback>
     SubscriptionStore<Data>::subscription_callbacks_;
 template <typename Data>
-std::unordered_map<std::thread::id, typename SubscriptionStore<Data>::DataQueue>
+std::unordered_map<ThreadId, typename SubscriptionStore<Data>::DataQueue>
     SubscriptionStore<Data>::data_;
 template <typename Data>
 std::unordered_multimap<goby::middleware::Group,
@@ -364,7 +627,7 @@ std::unordered_multimap<goby::middleware::Group,
                             SubscriptionStore<Data>::subscription_callbacks_)::const_iterator>
     SubscriptionStore<Data>::subscription_groups_;
 template <typename Data>
-std::unordered_map<std::thread::id, detail::DataProtection>
+std::unordered_map<ThreadId, detail::DataProtection>
     SubscriptionStore<Data>::data_protection_;
 
 template <typename Data> std::shared_timed_mutex SubscriptionStore<Data>::subscription_mutex_;
@@ -38,6 +38,7 @@
 #include "goby/middleware/protobuf/transporter_config.pb.h"
 #include "goby/middleware/transport/detail/type_helpers.h"
 #include "goby/middleware/transport/publisher.h"
+#include "goby/middleware/transport/receiver.h"
 #include "goby/middleware/transport/subscriber.h"
 #include "goby/util/debug_logger.h"
 
@@ -215,6 +216,8 @@ class StaticTransporterInterface : public InnerTransporterInterface<Transporter,
     void publish(const Data& data, const Publisher<Data>& publisher = Publisher<Data>())
     {
         static_cast<Transporter*>(this)->template check_validity<group>();
+        if (!static_cast<Transporter*>(this)->template static_route_enabled<group>())
+            return;
         static_cast<Transporter*>(this)->template publish_dynamic<Data, scheme>(data, group,
                                                                                 publisher);
     }
@@ -235,6 +238,8 @@ class StaticTransporterInterface : public InnerTransporterInterface<Transporter,
                  const Publisher<Data>& publisher = Publisher<Data>())
     {
         static_cast<Transporter*>(this)->template check_validity<group>();
+        if (!static_cast<Transporter*>(this)->template static_route_enabled<group>())
+            return;
         static_cast<Transporter*>(this)->template publish_dynamic<Data, scheme>(data, group,
                                                                                 publisher);
     }
@@ -313,6 +318,25 @@ class StaticTransporterInterface : public InnerTransporterInterface<Transporter,
         subscribe<group, Data, transporter_scheme<Data, Transporter>(), necessity>(f);
     }
 
+    /// \brief Subscribe to a specific group and data type, returning a Receiver that queues the data for receive() (rather than calling back)
+    ///
+    /// \tparam group group to subscribe to (reference to constexpr Group)
+    /// \tparam Data data type to subscribe to.
+    /// \tparam scheme Marshalling scheme id (typically MarshallingScheme::MarshallingSchemeEnum). Can usually be inferred from the Data type.
+    /// \param subscriber Optional metadata that controls the subscription or sets callbacks to monitor the subscription result. Typically unnecessary for interprocess and inner layers.
+    /// \param max_queue Maximum number of data to keep until received (the oldest are discarded first), or 0 for no limit
+    template <const Group& group, typename Data,
+              int scheme = transporter_scheme<Data, Transporter>()>
+    Receiver<Data> receiver(const Subscriber<Data>& subscriber = Subscriber<Data>(),
+                            std::size_t max_queue = 0)
+    {
+        Receiver<Data> receiver(max_queue, [this](typename Receiver<Data>::Clock::time_point t) {
+            return static_cast<Transporter*>(this)->poll(t);
+        });
+        subscribe<group, Data, scheme>(receiver.callback(), subscriber);
+        return receiver;
+    }
+
     /// \brief Unsubscribe to a specific group and data type
     ///
     /// \tparam group group to unsubscribe from (reference to constexpr Group)
@@ -330,6 +354,9 @@ class StaticTransporterInterface : public InnerTransporterInterface<Transporter,
     /// \brief Unsubscribe to all messages that this transporter has subscribed to
     void unsubscribe_all() { static_cast<Transporter*>(this)->template unsubscribe_all(); }
 
+    /// \brief Returns false if publications to this group can be skipped entirely (e.g. based on a precomputed StaticTopology). Transporters that support this hide this method with their own implementation.
+    template <const Group& group> bool static_route_enabled() { return true; }
+
   protected:
     StaticTransporterInterface(InnerTransporter& inner)
         : InnerTransporterInterface<Transporter, InnerTransporter>(inner)
@@ -86,15 +86,13 @@ class InterModuleForwarder
     {
         //create and forward publication to edge
 
-        std::vector<char> bytes(SerializerParserHelper<Data, scheme>::serialize(d));
-        std::string* sbytes = new std::string(bytes.begin(), bytes.end());
         goby::middleware::protobuf::SerializerTransporterMessage msg;
         auto* key = msg.mutable_key();
 
         key->set_marshalling_scheme(scheme);
         key->set_type(SerializerParserHelper<Data, scheme>::type_name(d));
         key->set_group(std::string(group));
-        msg.set_allocated_data(sbytes);
+        serialize_memoized<Data, scheme>(d, msg.mutable_data());
 
         *key->mutable_cfg() = publisher.cfg();
         this->inner().template publish<Base::to_portal_group_>(msg);
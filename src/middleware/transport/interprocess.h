@@ -27,12 +27,15 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
+#include <mutex>
 #include <sys/types.h>
 #include <thread>
 #include <tuple>
 #include <unistd.h>
 
 #include "goby/middleware/group.h"
+#include "goby/middleware/marshalling/serialization_memo.h"
 
 #include "goby/middleware/transport/null.h"
 #include "goby/middleware/transport/poller.h"
@@ -257,6 +260,8 @@ class InterProcessTransporterBase
     static constexpr Group to_portal_group_{"goby::middleware::interprocess::to_portal"};
     static constexpr Group regex_group_{"goby::middleware::interprocess::regex"};
     static const std::string from_portal_group_prefix_;
+    // append the subscribing thread's SerializationHandlerBase::subscriber_id()
+    static const std::string last_value_group_prefix_;
 
   private:
     friend PollerType;
@@ -276,6 +281,9 @@ constexpr goby::middleware::Group
 template <typename Derived, typename InnerTransporter>
 const std::string InterProcessTransporterBase<Derived, InnerTransporter>::from_portal_group_prefix_{
     "goby::middleware::interprocess::from_portal::"};
+template <typename Derived, typename InnerTransporter>
+const std::string InterProcessTransporterBase<Derived, InnerTransporter>::last_value_group_prefix_{
+    "goby::middleware::interprocess::last_value::"};
 
 /// \brief Implements the forwarder concept for the interprocess layer
 ///
@@ -300,6 +308,12 @@ class InterProcessForwarder
                 [this](
                     std::shared_ptr<const goby::middleware::protobuf::SerializerTransporterMessage>
                         msg) { _receive_regex_data_forwarded(msg); });
+
+        this->inner().template subscribe_dynamic<protobuf::SerializerTransporterMessage>(
+            [this](const protobuf::SerializerTransporterMessage& msg) {
+                _receive_last_value_forwarded(msg);
+            },
+            last_value_group());
     }
     virtual ~InterProcessForwarder() { this->unsubscribe_all(); }
 
@@ -310,15 +324,13 @@ class InterProcessForwarder
     void _publish(const Data& d, const Group& group, const Publisher<Data>& publisher)
     {
         // create and forward publication to edge
-        std::vector<char> bytes(SerializerParserHelper<Data, scheme>::serialize(d));
-        std::string* sbytes = new std::string(bytes.begin(), bytes.end());
         auto msg = std::make_shared<goby::middleware::protobuf::SerializerTransporterMessage>();
         auto* key = msg->mutable_key();
 
         key->set_marshalling_scheme(scheme);
         key->set_type(SerializerParserHelper<Data, scheme>::type_name(d));
         key->set_group(std::string(group));
-        msg->set_allocated_data(sbytes);
+        serialize_memoized<Data, scheme>(d, msg->mutable_data());
 
         *key->mutable_cfg() = publisher.cfg();
 
@@ -329,7 +341,8 @@ class InterProcessForwarder
     void _subscribe(std::function<void(std::shared_ptr<const Data> d)> f, const Group& group,
                     const Subscriber<Data>& subscriber)
     {
-        this->inner().template subscribe_dynamic<Data, scheme>(f, group);
+        // queue limits (if any) are enforced on the interthread delivery to this thread
+        this->inner().template subscribe_dynamic<Data, scheme>(f, group, subscriber);
 
         // forward subscription to edge
         auto inner_publication_lambda = [=](std::shared_ptr<const Data> d) {
@@ -341,14 +354,34 @@ class InterProcessForwarder
             middleware::Subscriber<Data>(goby::middleware::protobuf::TransporterConfig(),
                                          [=](const Data& d) { return group; }));
 
+        // the portal sends its cached last value (if any) only to this thread when it was
+        // already subscribed to this group (by another thread), as then no other thread should
+        // receive it again
+        last_value_subscriptions_.insert(std::make_pair(
+            std::make_tuple(scheme, subscription->type_name(), std::string(group)),
+            std::make_shared<SerializationSubscription<Data, scheme>>(
+                f, group,
+                middleware::Subscriber<Data>(subscriber.cfg(),
+                                             [=](const Data& d) { return group; }))));
+
         this->inner().template publish<Base::to_portal_group_, SerializationHandlerBase<>>(
             subscription);
     }
 
+    void _receive_last_value_forwarded(const protobuf::SerializerTransporterMessage& msg)
+    {
+        auto range = last_value_subscriptions_.equal_range(
+            std::make_tuple(msg.key().marshalling_scheme(), msg.key().type(), msg.key().group()));
+        for (auto it = range.first; it != range.second; ++it)
+            it->second->post(msg.data().begin(), msg.data().end());
+    }
+
     template <typename Data, int scheme>
     void _unsubscribe(const Group& group, const Subscriber<Data>& subscriber)
     {
         this->inner().template unsubscribe_dynamic<Data, scheme>(group, subscriber);
+        last_value_subscriptions_.erase(std::make_tuple(
+            scheme, SerializerParserHelper<Data, scheme>::type_name(), std::string(group)));
 
         auto unsubscription = std::shared_ptr<SerializationHandlerBase<>>(
             new SerializationUnSubscription<Data, scheme>(group));
@@ -359,6 +392,8 @@ class InterProcessForwarder
 
     void _unsubscribe_all()
     {
+        last_value_subscriptions_.clear();
+
         auto all = std::make_shared<SerializationUnSubscribeAll>();
         this->inner().template publish<Base::to_portal_group_, SerializationUnSubscribeAll>(all);
     }
@@ -406,6 +441,24 @@ class InterProcessForwarder
 
   private:
     std::set<std::shared_ptr<const SerializationSubscriptionRegex>> regex_subscriptions_;
+
+    // this thread's subscriptions (scheme, type, group), for values sent on last_value_group()
+    std::multimap<std::tuple<int, std::string, std::string>,
+                  std::shared_ptr<const SerializationHandlerBase<>>>
+        last_value_subscriptions_;
+
+    // the calling thread's group for last values from the portal; kept for the life of the
+    // program (like regex_group_) as the interthread layer refers to the group's string
+    static const Group& last_value_group()
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::unique_ptr<const DynamicGroup>> groups;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& group = groups[thread_id()];
+        if (!group)
+            group.reset(new DynamicGroup(Base::last_value_group_prefix_ + thread_id()));
+        return *group;
+    }
 };
 
 template <typename Derived, typename InnerTransporter>
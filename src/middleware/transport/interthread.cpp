@@ -23,6 +23,8 @@
 
 #include "interthread.h"
 
-std::unordered_map<std::thread::id, goby::middleware::detail::SubscriptionStoreBase::StoresMap>
+std::unordered_map<goby::middleware::ThreadId,
+                   goby::middleware::detail::SubscriptionStoreBase::StoresMap>
     goby::middleware::detail::SubscriptionStoreBase::stores_;
 std::shared_timed_mutex goby::middleware::detail::SubscriptionStoreBase::stores_mutex_;
+std::atomic<bool> goby::middleware::detail::SubscriptionStoreBase::prioritized_{false};
@@ -28,6 +28,7 @@
 #include "goby/middleware/transport/detail/subscription_store.h"
 #include "goby/middleware/transport/null.h"
 #include "goby/middleware/transport/poller.h"
+#include "goby/middleware/transport/static_topology.h"
 
 namespace goby
 {
@@ -53,11 +54,15 @@ class InterThreadTransporter
     };
 
   public:
-    InterThreadTransporter() : data_mutex_(std::make_shared<std::mutex>()) {}
+    InterThreadTransporter()
+        : data_mutex_(std::make_shared<std::mutex>()),
+          wake_(detail::this_task_context().wake)
+    {
+    }
 
     virtual ~InterThreadTransporter()
     {
-        detail::SubscriptionStoreBase::unsubscribe_all(std::this_thread::get_id());
+        detail::SubscriptionStoreBase::unsubscribe_all(this_thread_id());
     }
 
     /// \brief Scheme for interthread is always MarshallingScheme::CXX_OBJECT as the data are not serialized, but rather passed around using shared pointers
@@ -78,6 +83,12 @@ class InterThreadTransporter
             throw(goby::Exception("Group must have a non-empty string for use on InterThread"));
     }
 
+    /// \brief Returns false if the loaded StaticTopology has no subscribers for this group, in which case publications to it are skipped
+    template <const Group& group> bool static_route_enabled()
+    {
+        return detail::static_route_enabled<group>();
+    }
+
     /// \brief Publish a message using a run-time defined DynamicGroup (const reference variant). Where possible, prefer the static variant in StaticTransporterInterface::publish()
     ///
     /// \tparam Data data type to publish. Can usually be inferred from the \c data parameter.
@@ -142,10 +153,12 @@ class InterThreadTransporter
                            const Subscriber<Data>& subscriber = Subscriber<Data>())
     {
         check_validity_runtime(group);
+        StaticTopology::subscribed(group);
         detail::SubscriptionStore<Data>::subscribe([=](std::shared_ptr<const Data> pd) { f(*pd); },
-                                                   group, std::this_thread::get_id(), data_mutex_,
+                                                   group, this_thread_id(), data_mutex_,
                                                    Poller<InterThreadTransporter>::cv(),
-                                                   Poller<InterThreadTransporter>::poll_mutex());
+                                                   Poller<InterThreadTransporter>::poll_mutex(),
+                                                   subscriber.queue_policy(), wake_);
     }
 
     /// \brief Subscribe to a specific run-time defined group and data type (shared pointer variant). Where possible, prefer the static variant in StaticTransporterInterface::subscribe()
@@ -160,9 +173,10 @@ class InterThreadTransporter
                            const Subscriber<Data>& subscriber = Subscriber<Data>())
     {
         check_validity_runtime(group);
+        StaticTopology::subscribed(group);
         detail::SubscriptionStore<Data>::subscribe(
-            f, group, std::this_thread::get_id(), data_mutex_, Poller<InterThreadTransporter>::cv(),
-            Poller<InterThreadTransporter>::poll_mutex());
+            f, group, this_thread_id(), data_mutex_, Poller<InterThreadTransporter>::cv(),
+            Poller<InterThreadTransporter>::poll_mutex(), subscriber.queue_policy(), wake_);
     }
 
     /// \brief Subscribe with no data (used to receive a signal from another thread)
@@ -181,25 +195,34 @@ class InterThreadTransporter
                              const Subscriber<Data>& subscriber = Subscriber<Data>())
     {
         check_validity_runtime(group);
-        detail::SubscriptionStore<Data>::unsubscribe(group, std::this_thread::get_id());
+        detail::SubscriptionStore<Data>::unsubscribe(group, this_thread_id());
+    }
+
+    /// \brief Number of messages of the given data type and group discarded before delivery to this thread due to the subscription's queue limits (Subscriber::cfg().qos())
+    template <typename Data> std::uint64_t subscription_drops(const Group& group) const
+    {
+        return detail::SubscriptionStore<Data>::drops(group, this_thread_id());
     }
 
     /// \brief Unsubscribe from all current subscriptions
     void unsubscribe_all()
     {
-        detail::SubscriptionStoreBase::unsubscribe_all(std::this_thread::get_id());
+        detail::SubscriptionStoreBase::unsubscribe_all(this_thread_id());
     }
 
   private:
     friend Poller<InterThreadTransporter>;
     int _poll(std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock)
     {
-        return detail::SubscriptionStoreBase::poll_all(std::this_thread::get_id(), lock);
+        return detail::SubscriptionStoreBase::poll_all(this_thread_id(), lock, this->layer_budget(),
+                                                       &this->priority_deficits());
     }
 
   private:
     // protects this thread's DataQueue
     std::shared_ptr<std::mutex> data_mutex_;
+    // set when constructed within a ThreadExecutor task: schedules the task when data are queued
+    std::shared_ptr<const std::function<void()>> wake_;
 };
 
 } // namespace middleware
@@ -30,11 +30,13 @@
 #include <thread>
 #include <unistd.h>
 
+#include "goby/middleware/marshalling/serialization_memo.h"
 #include "goby/middleware/protobuf/intervehicle.pb.h"
 
 #include "goby/middleware/transport/interthread.h" // used for InterVehiclePortal implementation
 #include "goby/middleware/transport/intervehicle/driver_thread.h"
 #include "goby/middleware/transport/serialization_handlers.h"
+#include "goby/middleware/transport/stats.h"
 
 namespace goby
 {
@@ -131,6 +133,8 @@ class InterVehicleTransporterBase
         Data data_with_group = data;
         publisher.set_group(data_with_group, group);
 
+        // encode DCCL once for this layer and the interprocess DCCL publication
+        SerializationMemo memo(&data_with_group);
         static_cast<Derived*>(this)->template _publish<Data>(data_with_group, group, publisher);
         // publish to interprocess as both DCCL and Protobuf
         this->inner().template publish_dynamic<Data, MarshallingScheme::DCCL>(data_with_group,
@@ -160,6 +164,8 @@ class InterVehicleTransporterBase
 
             publisher.set_group(*data_with_group, group);
 
+            // encode DCCL once for this layer and the interprocess DCCL publication
+            SerializationMemo memo(data_with_group.get());
             static_cast<Derived*>(this)->template _publish<Data>(*data_with_group, group,
                                                                  publisher);
 
@@ -245,6 +251,10 @@ class InterVehicleTransporterBase
     {
         auto data = intervehicle::serialize_publication(d, group, publisher);
 
+        if (TransportStats::enabled())
+            TransportStats::group(protobuf::LAYER_INTERVEHICLE, group)
+                .publish(data->data().size());
+
         if (publisher.cfg().intervehicle().buffer().ack_required())
         {
             auto ack_handler = std::make_shared<
@@ -356,9 +366,8 @@ class InterVehicleTransporterBase
             auto subscription = Helper::parse(bytes_begin, bytes_end, actual_end);
             subscription->mutable_header()->set_src(0);
 
-            std::vector<char> bytes(Helper::serialize(*subscription));
-            std::string* sbytes = new std::string(bytes.begin(), bytes.end());
-            original.set_allocated_data(sbytes);
+            original.clear_data();
+            Helper::serialize(*subscription, original.mutable_data());
         }
 
         auto it = pending_ack_.find(original);
@@ -382,10 +391,20 @@ class InterVehicleTransporterBase
 
     void _receive(const intervehicle::protobuf::DCCLForwardedData& packets)
     {
+        bool stats_enabled = TransportStats::enabled();
         for (const auto& packet : packets.frame())
         {
             for (auto p : this->subscriptions_[packet.dccl_id()])
+            {
+                TransportStats::GroupStats* stats = nullptr;
+                if (stats_enabled)
+                {
+                    stats = &TransportStats::group(protobuf::LAYER_INTERVEHICLE, p.first);
+                    stats->receive(packet.data().size());
+                }
+                TransportStats::HandlerTimer handler_timer(stats);
                 p.second->post(packet.data().begin(), packet.data().end());
+            }
         }
     }
 
@@ -21,8 +21,12 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+
 #include "goby/acomms/bind.h"
 #include "goby/acomms/modem_driver.h"
+#include "goby/middleware/transport/stats.h"
 
 #include "driver_thread.h"
 
@@ -88,10 +92,18 @@ goby::middleware::intervehicle::ModemDriverThread::ModemDriverThread(
                 driver_.reset(new goby::acomms::IridiumShoreDriver);
                 break;
 
+            case goby::acomms::protobuf::DRIVER_IRIDIUM_SHORE_SHARDED:
+                driver_.reset(new goby::acomms::IridiumShoreShardedDriver);
+                break;
+
             case goby::acomms::protobuf::DRIVER_BENTHOS_ATM900:
                 driver_.reset(new goby::acomms::BenthosATM900Driver);
                 break;
 
+            case goby::acomms::protobuf::DRIVER_ACOUSTIC_SIM:
+                driver_.reset(new goby::acomms::AcousticSimDriver);
+                break;
+
             case goby::acomms::protobuf::DRIVER_NONE:
             case goby::acomms::protobuf::DRIVER_ABC_EXAMPLE_MODEM:
             case goby::acomms::protobuf::DRIVER_UFIELD_SIM_DRIVER:
@@ -111,6 +123,12 @@ goby::middleware::intervehicle::ModemDriverThread::ModemDriverThread(
 
     goby::acomms::bind(mac_, *driver_);
 
+    // demand advertised to the other nodes by MAC_ADAPTIVE_DECENTRALIZED
+    mac_.signal_queue_depth_request.connect([&](std::uint32_t* queue_depth) {
+        *queue_depth =
+            std::min<std::size_t>(buffer_.bytes(), std::numeric_limits<std::uint32_t>::max());
+    });
+
     mac_.startup(cfg().mac());
     driver_->startup(cfg().driver());
 
@@ -222,6 +240,12 @@ void goby::middleware::intervehicle::ModemDriverThread::_data_request(
                 dest = buffer_value.modem_id;
                 *frame += buffer_value.data.data();
 
+                if (TransportStats::enabled())
+                    TransportStats::group(goby::middleware::protobuf::LAYER_INTERVEHICLE,
+                                          buffer_value.data.key().group())
+                        .queue_time.record(goby::time::SteadyClock::now() -
+                                           buffer_value.push_time);
+
                 bool ack_required = buffer_.sub(buffer_value.modem_id, buffer_value.subbuffer_id)
                                         .cfg()
                                         .ack_required();
@@ -28,6 +28,7 @@
 #include "goby/acomms/buffer/dynamic_buffer.h"
 
 #include "goby/middleware/marshalling/dccl.h"
+#include "goby/middleware/marshalling/serialization_memo.h"
 
 #include "goby/middleware/application/thread.h"
 #include "goby/middleware/group.h"
@@ -88,8 +89,6 @@ template <typename Data>
 std::shared_ptr<goby::middleware::protobuf::SerializerTransporterMessage>
 serialize_publication(const Data& d, const Group& group, const Publisher<Data>& publisher)
 {
-    std::vector<char> bytes(SerializerParserHelper<Data, MarshallingScheme::DCCL>::serialize(d));
-    std::string* sbytes = new std::string(bytes.begin(), bytes.end());
     auto msg = std::make_shared<goby::middleware::protobuf::SerializerTransporterMessage>();
 
     auto* key = msg->mutable_key();
@@ -100,7 +99,7 @@ serialize_publication(const Data& d, const Group& group, const Publisher<Data>&
     auto now = goby::time::SystemClock::now<goby::time::MicroTime>();
     key->set_serialize_time_with_units(now);
     *key->mutable_cfg() = publisher.cfg();
-    msg->set_allocated_data(sbytes);
+    serialize_memoized<Data, MarshallingScheme::DCCL>(d, msg->mutable_data());
     return msg;
 }
 
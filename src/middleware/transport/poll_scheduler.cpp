@@ -0,0 +1,40 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "poll_scheduler.h"
+
+constexpr int goby::middleware::PollScheduler::num_priorities;
+constexpr std::size_t goby::middleware::PriorityDeficits::unlimited;
+
+std::atomic<std::size_t> goby::middleware::PollScheduler::layer_budget_{0};
+std::array<std::atomic<unsigned>, goby::middleware::PollScheduler::num_priorities>
+    goby::middleware::PollScheduler::weights_{{{4}, {2}, {1}}};
+
+void goby::middleware::PollScheduler::configure(std::size_t layer_budget,
+                                                const std::array<unsigned, num_priorities>& weights)
+{
+    layer_budget_.store(layer_budget);
+    for (int i = 0; i < num_priorities; ++i) weights_[i].store(std::max(1u, weights[i]));
+}
@@ -0,0 +1,186 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PollScheduler20201019H
+#define PollScheduler20201019H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+#include "goby/middleware/protobuf/layer.pb.h"
+#include "goby/middleware/protobuf/transporter_config.pb.h"
+#include "goby/middleware/transport/stats.h"
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Process-wide settings for sharing each poll() between the transport layers and the subscription priority classes (protobuf::TransporterConfig::QoS::Priority)
+///
+/// Typically set from the "poll_scheduling" section of AppConfig. By default there is no budget: each layer delivers everything queued for the polling thread on every poll, highest priority class first.
+class PollScheduler
+{
+  public:
+    using Priority = protobuf::TransporterConfig::QoS::Priority;
+    static constexpr int num_priorities{3};
+
+    /// \brief Set the maximum number of messages each layer delivers per poll (0 = unlimited), and the relative share of each priority class (HIGH, NORMAL, LOW; at least 1) when the budget is shared between several of them
+    static void configure(std::size_t layer_budget,
+                          const std::array<unsigned, num_priorities>& weights);
+
+    /// \brief Maximum number of messages each layer delivers per poll, or 0 if unlimited
+    static std::size_t layer_budget() { return layer_budget_.load(std::memory_order_relaxed); }
+
+    /// \brief Share of the layer budget for the given priority class (relative to the others)
+    static unsigned weight(int priority)
+    {
+        return weights_[index(priority)].load(std::memory_order_relaxed);
+    }
+
+    /// \brief Priority classes in order of precedence (0 to num_priorities - 1)
+    static Priority priority(int index) { return static_cast<Priority>(index + 1); }
+    static int index(int priority) { return priority - 1; }
+
+  private:
+    static std::atomic<std::size_t> layer_budget_;
+    static std::array<std::atomic<unsigned>, num_priorities> weights_;
+};
+
+/// \brief Deficit round-robin between the priority classes of one queue (such as one thread's subscriptions on one layer), carried over from one poll to the next
+class PriorityDeficits
+{
+  public:
+    static constexpr std::size_t unlimited{std::numeric_limits<std::size_t>::max()};
+
+    /// \brief Deliver at most budget queued messages, sharing them between the priority classes in proportion to their PollScheduler::weight(). With no budget (0), everything is delivered, highest priority class first.
+    ///
+    /// \param budget Maximum number of messages to deliver, 0 for all (strict priority order), or unlimited to share between the classes until deliver sets stop
+    /// \param layer Layer whose per-class TransportStats are updated
+    /// \param deliver Function (int priority, std::size_t max, bool& stop) that delivers at most max of the messages queued for the given priority class (oldest first) and returns how many it delivered. It returns fewer than max only if none remain, or if it set stop because no more can be delivered for now.
+    /// \param queued Function (int priority) that returns whether messages remain queued for the given priority class; only called if TransportStats are enabled and the budget (or stop) ended the delivery
+    /// \return number of messages delivered
+    template <typename Deliver, typename Queued>
+    std::size_t schedule(std::size_t budget, protobuf::Layer layer, Deliver deliver,
+                         Queued queued)
+    {
+        std::array<std::size_t, PollScheduler::num_priorities> delivered{};
+        std::size_t total = 0;
+        bool stop = false;
+
+        if (budget == 0)
+        {
+            for (int i = 0; i < PollScheduler::num_priorities && !stop; ++i)
+            {
+                delivered[i] = deliver(PollScheduler::priority(i), unlimited, stop);
+                total += delivered[i];
+            }
+        }
+        else
+        {
+            // classes that may still have messages queued (until they deliver fewer than asked)
+            std::array<bool, PollScheduler::num_priorities> active;
+            active.fill(true);
+            int num_active = PollScheduler::num_priorities;
+
+            while (num_active > 0 && total < budget && !stop)
+            {
+                if (!active[current_])
+                {
+                    next();
+                    continue;
+                }
+
+                // each turn of a class adds its weight (once) to what it may deliver
+                if (!quantum_added_)
+                {
+                    deficits_[current_] += PollScheduler::weight(PollScheduler::priority(current_));
+                    quantum_added_ = true;
+                }
+
+                std::size_t max = std::min<std::size_t>(deficits_[current_], budget - total);
+                std::size_t n = deliver(PollScheduler::priority(current_), max, stop);
+                delivered[current_] += n;
+                total += n;
+                deficits_[current_] -= n;
+
+                if (stop)
+                    break;
+
+                if (n < max)
+                {
+                    // emptied: no credit is kept while there is nothing to deliver
+                    active[current_] = false;
+                    --num_active;
+                    deficits_[current_] = 0;
+                    next();
+                }
+                else if (deficits_[current_] == 0)
+                {
+                    next();
+                }
+                // else the budget ended within this turn, which resumes on the next poll
+            }
+        }
+
+        if (TransportStats::enabled() && (stop || (budget != 0 && total == budget)))
+        {
+            for (int i = 0; i < PollScheduler::num_priorities; ++i)
+            {
+                auto priority = PollScheduler::priority(i);
+                if (!queued(priority))
+                    continue;
+                auto& stats = TransportStats::priority_class(layer, priority);
+                stats.defer();
+                if (delivered[i] == 0)
+                    stats.starve();
+            }
+        }
+
+        return total;
+    }
+
+    /// \brief Increasing count, for rotating where delivery within a class starts when a class is shared by several queues (so that none is always served first)
+    std::size_t next_queue() { return next_queue_++; }
+
+  private:
+    void next()
+    {
+        current_ = (current_ + 1) % PollScheduler::num_priorities;
+        quantum_added_ = false;
+    }
+
+  private:
+    std::array<std::size_t, PollScheduler::num_priorities> deficits_{};
+    // class whose turn it is
+    int current_{0};
+    // has the current class been given its weight for this turn?
+    bool quantum_added_{false};
+    std::size_t next_queue_{0};
+};
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -26,6 +26,7 @@
 #define Poller20171107H
 
 #include "interface.h"
+#include "poll_scheduler.h"
 
 namespace goby
 {
@@ -50,6 +51,12 @@ template <typename Transporter> class Poller : public PollerInterface
     /// \return Pointer to the inner Poller
     PollerInterface* inner_poller() { return inner_poller_; }
 
+    /// \return Maximum number of messages this layer's _poll() delivers per call, or 0 if unlimited (see PollScheduler)
+    std::size_t layer_budget() const { return PollScheduler::layer_budget(); }
+
+    /// \return Deficit round-robin state for sharing this layer's budget between the priority classes of its subscriptions
+    PriorityDeficits& priority_deficits() { return priority_deficits_; }
+
   private:
     int _transporter_poll(std::unique_ptr<std::unique_lock<std::timed_mutex> >& lock) override
     {
@@ -59,9 +66,10 @@ template <typename Transporter> class Poller : public PollerInterface
             inner_poll_items +=
                 static_cast<PollerInterface*>(inner_poller_)->_transporter_poll(lock);
 
-        int poll_items = 0;
-        if (!inner_poll_items)
-            poll_items += static_cast<Transporter*>(this)->_poll(lock);
+        // always poll this layer too, so that a busy inner layer cannot starve it (the time
+        // spent on each layer is bounded by its layer_budget(), and for each group by
+        // TransporterConfig.qos.max_batch)
+        int poll_items = static_cast<Transporter*>(this)->_poll(lock);
 
         //            goby::glog.is(goby::util::logger::DEBUG3) && goby::glog << "Poller::transporter_poll(): " << typeid(*this).name() << " this: " << this << " (" << poll_items << " items) "<< " inner_poller_: " << inner_poller_ << " (" << inner_poll_items << " items) " << std::endl;
 
@@ -70,6 +78,7 @@ template <typename Transporter> class Poller : public PollerInterface
 
   private:
     PollerInterface* inner_poller_;
+    PriorityDeficits priority_deficits_;
 };
 } // namespace goby
 } // namespace goby
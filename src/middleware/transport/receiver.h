@@ -0,0 +1,282 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef Receiver20201019H
+#define Receiver20201019H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+#endif
+
+#include "goby/exception.h"
+
+namespace goby
+{
+namespace middleware
+{
+template <typename Transporter, typename InnerTransporter> class StaticTransporterInterface;
+
+/// \brief Receives data of one group and type in sequential (e.g. request/response) code, as an alternative to handling them in a subscription callback. Created by a transporter's receiver() method.
+///
+/// The Receiver subscribes when it is created, and queues the data delivered to it (by the transporter's poll(), on the subscribing thread) until they are taken with receive(). receive() polls the transporter itself while waiting, so other subscriptions continue to be handled. A Receiver must only be used by the thread that created it.
+///
+/// \code
+/// // in initialize()
+/// ack_receiver_ = interprocess().receiver<groups::ack, Ack>();
+/// // later, e.g. in loop()
+/// interprocess().publish<groups::command>(command);
+/// if (auto ack = ack_receiver_.receive(std::chrono::seconds(1)))
+///     // use *ack
+/// \endcode
+///
+/// When compiled as C++20 (or newer), async_receive() can also be awaited from a Coroutine, which is resumed from within poll() when the data arrive.
+template <typename Data> class Receiver
+{
+  public:
+    using Clock = std::chrono::system_clock;
+
+    /// \brief Empty Receiver (assign the result of a transporter's receiver() to use it)
+    Receiver() = default;
+    ~Receiver()
+    {
+        // the subscription remains (unsubscribing would also remove any others the thread has
+        // to the same group), but its data are no longer kept
+        if (state_)
+            state_->active = false;
+    }
+    Receiver(Receiver&&) = default;
+    Receiver& operator=(Receiver&& other)
+    {
+        if (state_)
+            state_->active = false;
+        state_ = std::move(other.state_);
+        poll_ = std::move(other.poll_);
+        return *this;
+    }
+
+    /// \brief Wait (polling the transporter) for the next datum
+    ///
+    /// \param timeout Maximum time to wait
+    /// \return the datum, or nullptr if none was received before the timeout
+    std::shared_ptr<const Data> receive(Clock::duration timeout = Clock::duration::max())
+    {
+        return receive(timeout, [](const Data&) { return true; });
+    }
+
+    /// \brief Wait (polling the transporter) for the next datum for which match returns true. Data that do not match are discarded.
+    ///
+    /// \param timeout Maximum time to wait
+    /// \param match Predicate (bool(const Data&)), e.g. to match a response to its request
+    /// \return the datum, or nullptr if none matched before the timeout
+    template <typename Predicate>
+    std::shared_ptr<const Data> receive(Clock::duration timeout, Predicate match)
+    {
+        check_state();
+        auto deadline = (timeout == Clock::duration::max()) ? Clock::time_point::max()
+                                                            : Clock::now() + timeout;
+        while (true)
+        {
+            while (!state_->queue.empty())
+            {
+                auto datum = std::move(state_->queue.front());
+                state_->queue.pop_front();
+                if (match(*datum))
+                    return datum;
+            }
+
+            if (deadline != Clock::time_point::max() && Clock::now() >= deadline)
+                return nullptr;
+            poll_(deadline);
+        }
+    }
+
+    /// \brief Return the next datum if one has already been received (after polling the transporter without blocking), otherwise nullptr
+    std::shared_ptr<const Data> try_receive()
+    {
+        check_state();
+        if (state_->queue.empty())
+            poll_(Clock::now());
+        return pop();
+    }
+
+    /// \brief Number of data received but not yet taken
+    std::size_t size() const { return state_ ? state_->queue.size() : 0; }
+
+    /// \brief Provide timers (e.g. from Thread::add_timer() / Thread::cancel_timer()) for the timeouts of async_receive()
+    void set_timers(std::function<std::uint64_t(Clock::duration, std::function<void()>)> add_timer,
+                    std::function<bool(std::uint64_t)> cancel_timer)
+    {
+        check_state();
+        state_->add_timer = std::move(add_timer);
+        state_->cancel_timer = std::move(cancel_timer);
+    }
+
+#if defined(__cpp_impl_coroutine)
+    /// \brief Awaitable (C++20) for the next datum: co_await resumes with the datum, or nullptr after the timeout (which requires set_timers())
+    class Awaiter
+    {
+      public:
+        bool await_ready() const { return !state_->queue.empty(); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            state_->waiter = handle;
+            if (timeout_ != Clock::duration::max())
+            {
+                if (!state_->add_timer)
+                    throw(goby::Exception(
+                        "Receiver::async_receive() with a timeout requires set_timers()"));
+
+                auto state = state_.get();
+                timer_id_ = state_->add_timer(timeout_, [state]() { state->resume(); });
+                has_timer_ = true;
+            }
+        }
+
+        std::shared_ptr<const Data> await_resume()
+        {
+            if (has_timer_)
+                state_->cancel_timer(timer_id_);
+            if (state_->queue.empty())
+                return nullptr;
+            auto datum = std::move(state_->queue.front());
+            state_->queue.pop_front();
+            return datum;
+        }
+
+      private:
+        friend class Receiver;
+        Awaiter(std::shared_ptr<typename Receiver::State> state, Clock::duration timeout)
+            : state_(std::move(state)), timeout_(timeout)
+        {
+        }
+
+        std::shared_ptr<typename Receiver::State> state_;
+        Clock::duration timeout_;
+        std::uint64_t timer_id_{0};
+        bool has_timer_{false};
+    };
+
+    /// \brief co_await async_receive(timeout) from a Coroutine running on the subscribing thread. The Coroutine is resumed by the transporter's poll() when data are received (or by a timer, see set_timers())
+    Awaiter async_receive(Clock::duration timeout = Clock::duration::max())
+    {
+        check_state();
+        return Awaiter(state_, timeout);
+    }
+#endif
+
+  private:
+    template <typename Transporter, typename InnerTransporter>
+    friend class StaticTransporterInterface;
+
+    struct State
+    {
+        std::deque<std::shared_ptr<const Data>> queue;
+        std::size_t max_queue{0};
+        bool active{true};
+        std::function<std::uint64_t(Clock::duration, std::function<void()>)> add_timer;
+        std::function<bool(std::uint64_t)> cancel_timer;
+
+#if defined(__cpp_impl_coroutine)
+        std::coroutine_handle<> waiter;
+        void resume()
+        {
+            if (waiter)
+            {
+                auto handle = waiter;
+                waiter = nullptr;
+                handle.resume();
+            }
+        }
+#else
+        void resume() {}
+#endif
+    };
+
+    Receiver(std::size_t max_queue, std::function<int(Clock::time_point)> poll)
+        : state_(std::make_shared<State>()), poll_(std::move(poll))
+    {
+        state_->max_queue = max_queue;
+    }
+
+    // subscription callback
+    std::function<void(std::shared_ptr<const Data>)> callback()
+    {
+        auto state = state_;
+        return [state](std::shared_ptr<const Data> datum) {
+            if (!state->active)
+                return;
+            state->queue.push_back(std::move(datum));
+            if (state->max_queue && state->queue.size() > state->max_queue)
+                state->queue.pop_front();
+            state->resume();
+        };
+    }
+
+    std::shared_ptr<const Data> pop()
+    {
+        if (state_->queue.empty())
+            return nullptr;
+        auto datum = std::move(state_->queue.front());
+        state_->queue.pop_front();
+        return datum;
+    }
+
+    void check_state() const
+    {
+        if (!state_)
+            throw(goby::Exception("Receiver was not created by a transporter's receiver()"));
+    }
+
+  private:
+    std::shared_ptr<State> state_;
+    // polls the transporter until data are received or the given time is reached
+    std::function<int(Clock::time_point)> poll_;
+};
+
+#if defined(__cpp_impl_coroutine)
+/// \brief Return type for a C++20 coroutine that awaits Receiver::async_receive(). The coroutine starts when called and runs (on the calling thread) until its first co_await; it is then resumed from within the transporter's poll(). Exceptions propagate out of poll().
+struct Coroutine
+{
+    struct promise_type
+    {
+        Coroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+};
+#endif
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -106,11 +106,19 @@ class SerializationHandlerBase : public SerializationHandlerPostSelector<Metadat
     };
     virtual SubscriptionAction action() const = 0;
 
-    std::thread::id thread_id() const { return thread_id_; }
+    ThreadId thread_id() const { return thread_id_; }
     virtual std::string subscriber_id() const { return subscriber_id_; }
 
+    /// \brief Limits on the data queued for this subscription (unlimited unless overridden)
+    virtual SubscriptionQueuePolicy queue_policy() const { return SubscriptionQueuePolicy(); }
+
+    /// \brief Number of messages discarded due to queue_policy(). Only accessed by the thread that polls the subscribing transporter.
+    std::uint64_t drops() const { return drops_; }
+    void add_drops(std::uint64_t n) const { drops_ += n; }
+
   private:
-    const std::thread::id thread_id_{std::this_thread::get_id()};
+    mutable std::uint64_t drops_{0};
+    const ThreadId thread_id_{this_thread_id()};
     const std::string subscriber_id_{goby::middleware::thread_id(thread_id_)};
 };
 
@@ -167,6 +175,8 @@ class SerializationSubscription : public SerializationHandlerBase<>
     const Group& subscribed_group() const override { return group_; }
     int scheme() const override { return scheme_id; }
 
+    SubscriptionQueuePolicy queue_policy() const override { return subscriber_.queue_policy(); }
+
   private:
     template <typename CharIterator>
     CharIterator _post(CharIterator bytes_begin, CharIterator bytes_end) const
@@ -333,7 +343,7 @@ class SerializationSubscriptionRegex
         }
     }
 
-    std::thread::id thread_id() const { return thread_id_; }
+    ThreadId thread_id() const { return thread_id_; }
     std::string subscriber_id() const { return subscriber_id_; }
 
   private:
@@ -341,7 +351,7 @@ class SerializationSubscriptionRegex
     const std::set<int> schemes_;
     std::regex type_regex_;
     std::regex group_regex_;
-    const std::thread::id thread_id_{std::this_thread::get_id()};
+    const ThreadId thread_id_{this_thread_id()};
     const std::string subscriber_id_{goby::middleware::thread_id(thread_id_)};
 };
 
@@ -349,11 +359,11 @@ class SerializationSubscriptionRegex
 class SerializationUnSubscribeAll
 {
   public:
-    std::thread::id thread_id() const { return thread_id_; }
+    ThreadId thread_id() const { return thread_id_; }
     std::string subscriber_id() const { return subscriber_id_; }
 
   private:
-    const std::thread::id thread_id_{std::this_thread::get_id()};
+    const ThreadId thread_id_{this_thread_id()};
     const std::string subscriber_id_{goby::middleware::thread_id(thread_id_)};
 };
 
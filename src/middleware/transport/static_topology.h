@@ -0,0 +1,131 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef StaticTopology20201019H
+#define StaticTopology20201019H
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "goby/middleware/group.h"
+#include "goby/util/debug_logger.h"
+
+namespace goby
+{
+namespace middleware
+{
+/// \brief Whole-system publish/subscribe topology known ahead of time, typically generated from the interface YAML files by "goby_clang_tool -topology" and loaded once at startup
+///
+/// The generated code calls StaticTopology::load() with the number of static subscribers within the application for each interthread Group the application publishes. Publications to a Group with no subscribers are then dropped by InterThreadTransporter before reaching the SubscriptionStore (dead-publication elimination). Publications to Groups with subscribers are still dispatched by the SubscriptionStore as usual; the subscriber counts are only used to find the dead publications. As the clang tool cannot see DynamicGroup or other run-time subscriptions, any interthread subscription to a Group at run time re-enables publication to that Group.
+///
+/// load() must be called before any threads are launched (e.g. at the start of main() or in the application constructor). If it is never called, all publications are delivered as usual.
+class StaticTopology
+{
+  public:
+    /// \brief A single interthread route in the generated topology
+    struct Route
+    {
+        /// Group string
+        const char* group;
+        /// number of static subscriptions to this group within the application (zero for a dead publication)
+        int subscribers;
+    };
+
+    /// \brief Load the routes for this application
+    static void load(std::initializer_list<Route> routes) { load(routes.begin(), routes.end()); }
+
+    /// \brief Load the routes for this application
+    static void load(const Route* begin, const Route* end)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (auto it = begin; it != end; ++it)
+        {
+            auto& flag = flags()[it->group];
+            if (!flag)
+                flag.reset(new std::atomic<bool>(it->subscribers > 0));
+            else if (it->subscribers > 0)
+                flag->store(true);
+        }
+    }
+
+    /// \brief Returns the (persistent) flag that is true if the given group has (or may have) interthread subscribers, or nullptr if the group is not part of the loaded topology
+    static const std::atomic<bool>* route_flag(const Group& group)
+    {
+        if (group.c_str() == nullptr)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex());
+        auto it = flags().find(std::string(group));
+        return it == flags().end() ? nullptr : it->second.get();
+    }
+
+    /// \brief Called by InterThreadTransporter on every subscription, to re-enable any Group that the loaded topology thought had no subscribers
+    static void subscribed(const Group& group)
+    {
+        if (group.c_str() == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex());
+        auto it = flags().find(std::string(group));
+        if (it != flags().end() && !it->second->load())
+        {
+            goby::glog.is_debug1() &&
+                goby::glog << "StaticTopology: run-time subscription to group " << group
+                           << " (no static subscribers); enabling publications" << std::endl;
+            it->second->store(true);
+        }
+    }
+
+  private:
+    // flags are never erased, so pointers returned by route_flag() remain valid
+    static std::unordered_map<std::string, std::unique_ptr<std::atomic<bool>>>& flags()
+    {
+        static std::unordered_map<std::string, std::unique_ptr<std::atomic<bool>>> flags_;
+        return flags_;
+    }
+
+    static std::mutex& mutex()
+    {
+        static std::mutex mutex_;
+        return mutex_;
+    }
+};
+
+namespace detail
+{
+/// \brief Returns true unless the loaded StaticTopology says that \c group has no subscribers. The flag for each Group is looked up once and cached.
+template <const Group& group> bool static_route_enabled()
+{
+    static const std::atomic<bool>* flag = StaticTopology::route_flag(group);
+    return !flag || flag->load(std::memory_order_relaxed);
+}
+} // namespace detail
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <mutex>
+
+#include "stats.h"
+
+std::atomic<bool> goby::middleware::TransportStats::enabled_{false};
+std::shared_timed_mutex goby::middleware::TransportStats::mutex_;
+std::map<std::pair<int, std::string>,
+         std::unique_ptr<goby::middleware::TransportStats::GroupStats>>
+    goby::middleware::TransportStats::stats_;
+std::map<std::pair<int, int>, std::unique_ptr<goby::middleware::TransportStats::ClassStats>>
+    goby::middleware::TransportStats::class_stats_;
+goby::middleware::TransportStats::Clock::time_point
+    goby::middleware::TransportStats::last_summary_{
+        goby::middleware::TransportStats::Clock::now()};
+
+constexpr int goby::middleware::LatencyHistogram::sub_bucket_bits;
+constexpr int goby::middleware::LatencyHistogram::max_value_bits;
+constexpr int goby::middleware::LatencyHistogram::sub_bucket_count;
+constexpr int goby::middleware::LatencyHistogram::half_sub_bucket_count;
+constexpr int goby::middleware::LatencyHistogram::bucket_count;
+
+std::uint64_t goby::middleware::LatencyHistogram::value_at_percentile(double percentile) const
+{
+    std::array<std::uint64_t, bucket_count> counts;
+    std::uint64_t total = 0;
+    for (int i = 0; i < bucket_count; ++i)
+    {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    // smallest value that at least percentile% of the recorded values are less than or equal to
+    auto target = static_cast<std::uint64_t>(percentile / 100.0 * total + 0.5);
+    if (target < 1)
+        target = 1;
+
+    std::uint64_t cumulative = 0;
+    for (int i = 0; i < bucket_count; ++i)
+    {
+        cumulative += counts[i];
+        if (cumulative >= target)
+            return std::min(bucket_upper_bound(i), max());
+    }
+    return max();
+}
+
+void goby::middleware::LatencyHistogram::summarize(protobuf::LatencySummary* summary) const
+{
+    summary->set_count(count());
+    if (summary->count() == 0)
+        return;
+    summary->set_p50(value_at_percentile(50));
+    summary->set_p90(value_at_percentile(90));
+    summary->set_p99(value_at_percentile(99));
+    summary->set_max(max());
+}
+
+goby::middleware::TransportStats::GroupStats&
+goby::middleware::TransportStats::group(protobuf::Layer layer, const std::string& group)
+{
+    auto key = std::make_pair(static_cast<int>(layer), group);
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        auto it = stats_.find(key);
+        if (it != stats_.end())
+            return *it->second;
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    auto& stats = stats_[key];
+    if (!stats)
+        stats.reset(new GroupStats);
+    return *stats;
+}
+
+goby::middleware::TransportStats::ClassStats&
+goby::middleware::TransportStats::priority_class(protobuf::Layer layer, int priority)
+{
+    auto key = std::make_pair(static_cast<int>(layer), priority);
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        auto it = class_stats_.find(key);
+        if (it != class_stats_.end())
+            return *it->second;
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    auto& stats = class_stats_[key];
+    if (!stats)
+        stats.reset(new ClassStats);
+    return *stats;
+}
+
+void goby::middleware::TransportStats::summarize(protobuf::TransportStats* report)
+{
+    auto now = Clock::now();
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+
+    double interval = std::chrono::duration<double>(now - last_summary_).count();
+    last_summary_ = now;
+    report->set_interval(interval);
+
+    for (auto& p : stats_)
+    {
+        GroupStats& stats = *p.second;
+        auto published = stats.published.exchange(0);
+        auto published_bytes = stats.published_bytes.exchange(0);
+        auto received = stats.received.exchange(0);
+        auto received_bytes = stats.received_bytes.exchange(0);
+        auto dropped = stats.dropped.exchange(0);
+        auto deferred = stats.deferred.exchange(0);
+
+        // omit idle groups
+        if (published == 0 && received == 0 && dropped == 0 && deferred == 0 &&
+            stats.queue_time.count() == 0)
+            continue;
+
+        auto& group = *report->add_group();
+        group.set_layer(static_cast<protobuf::Layer>(p.first.first));
+        group.set_group(p.first.second);
+        group.set_published(published);
+        group.set_published_bytes(published_bytes);
+        group.set_received(received);
+        group.set_received_bytes(received_bytes);
+        if (dropped > 0)
+            group.set_dropped(dropped);
+        if (deferred > 0)
+            group.set_deferred(deferred);
+        if (interval > 0)
+        {
+            group.set_publish_rate(published / interval);
+            group.set_receive_rate(received / interval);
+        }
+
+        if (stats.queue_time.count() > 0)
+            stats.queue_time.summarize(group.mutable_queue_time());
+        if (stats.handler_time.count() > 0)
+            stats.handler_time.summarize(group.mutable_handler_time());
+
+        stats.queue_time.reset();
+        stats.handler_time.reset();
+    }
+
+    for (auto& p : class_stats_)
+    {
+        ClassStats& stats = *p.second;
+        auto received = stats.received.exchange(0);
+        auto deferred = stats.deferred.exchange(0);
+        auto starved = stats.starved.exchange(0);
+
+        // omit idle classes
+        if (received == 0 && deferred == 0 && stats.queue_time.count() == 0)
+            continue;
+
+        auto& priority_class = *report->add_priority_class();
+        priority_class.set_layer(static_cast<protobuf::Layer>(p.first.first));
+        priority_class.set_priority(
+            static_cast<protobuf::TransporterConfig::QoS::Priority>(p.first.second));
+        priority_class.set_received(received);
+        if (deferred > 0)
+            priority_class.set_deferred(deferred);
+        if (starved > 0)
+            priority_class.set_starved(starved);
+        if (stats.queue_time.count() > 0)
+            stats.queue_time.summarize(priority_class.mutable_queue_time());
+
+        stats.queue_time.reset();
+    }
+}
@@ -0,0 +1,293 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TRANSPORT_STATS_20201019H
+#define TRANSPORT_STATS_20201019H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+
+#include <unistd.h>
+
+#include "goby/middleware/group.h"
+#include "goby/middleware/protobuf/app_config.pb.h"
+#include "goby/middleware/protobuf/layer.pb.h"
+#include "goby/middleware/protobuf/transport_stats.pb.h"
+#include "goby/time/convert.h"
+#include "goby/time/system_clock.h"
+
+namespace goby
+{
+namespace middleware
+{
+namespace groups
+{
+/// \brief Group on which applications publish protobuf::TransportStats (interprocess) when transport instrumentation is enabled
+constexpr goby::middleware::Group transport_stats{"goby::middleware::transport::stats"};
+} // namespace groups
+
+/// \brief Lock-free log-linear ("HDR-style") histogram of durations in microseconds
+///
+/// Values are stored with a relative error of at most 1/16 (values below 32 us are exact), up to 2^36 us (~19 hours); larger values are clamped. record() is wait-free and safe to call from any thread.
+class LatencyHistogram
+{
+  public:
+    /// \brief Record a single value (microseconds)
+    void record(std::uint64_t value)
+    {
+        counts_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        auto prev_max = max_.load(std::memory_order_relaxed);
+        while (value > prev_max &&
+               !max_.compare_exchange_weak(prev_max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// \brief Record a duration
+    template <typename Rep, typename Period> void record(std::chrono::duration<Rep, Period> d)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        record(static_cast<std::uint64_t>(us > 0 ? us : 0));
+    }
+
+    /// \brief Total number of recorded values
+    std::uint64_t count() const
+    {
+        std::uint64_t total = 0;
+        for (const auto& c : counts_) total += c.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /// \brief Largest recorded value (exact, not clamped)
+    std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    /// \brief Returns the (upper bound of the bucket containing the) value at the given percentile [0, 100]
+    std::uint64_t value_at_percentile(double percentile) const;
+
+    /// \brief Fill a protobuf summary of this histogram
+    void summarize(protobuf::LatencySummary* summary) const;
+
+    /// \brief Zero all counts. Not atomic with respect to concurrent record() calls, which may be lost or counted in the next interval
+    void reset()
+    {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    static constexpr int sub_bucket_bits{5};
+    static constexpr int max_value_bits{36};
+
+  private:
+    static constexpr int sub_bucket_count{1 << sub_bucket_bits};
+    static constexpr int half_sub_bucket_count{sub_bucket_count / 2};
+    static constexpr int bucket_count{sub_bucket_count + (max_value_bits - sub_bucket_bits) *
+                                                             half_sub_bucket_count};
+
+    static int bucket_index(std::uint64_t value)
+    {
+        if (value < static_cast<std::uint64_t>(sub_bucket_count))
+            return static_cast<int>(value);
+
+        int msb = 63 - __builtin_clzll(value);
+        if (msb >= max_value_bits)
+            return bucket_count - 1;
+
+        // keep the top sub_bucket_bits bits of the value (including the leading one)
+        int shift = msb - sub_bucket_bits + 1;
+        int sub = static_cast<int>(value >> shift) - half_sub_bucket_count;
+        return sub_bucket_count + (shift - 1) * half_sub_bucket_count + sub;
+    }
+
+    static std::uint64_t bucket_upper_bound(int index)
+    {
+        if (index < sub_bucket_count)
+            return index;
+        int shift = (index - sub_bucket_count) / half_sub_bucket_count + 1;
+        std::uint64_t sub =
+            (index - sub_bucket_count) % half_sub_bucket_count + half_sub_bucket_count;
+        return ((sub + 1) << shift) - 1;
+    }
+
+  private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> counts_{};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+/// \brief Process-wide, per layer and Group transport instrumentation
+///
+/// Disabled by default, in which case the transporters only pay for a relaxed atomic load per message. When enabled (typically via the "transport_stats" section of AppConfig), the transporters count messages and bytes and record queue and handler times; the application then periodically publishes a protobuf::TransportStats on groups::transport_stats.
+class TransportStats
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct GroupStats
+    {
+        std::atomic<std::uint64_t> published{0};
+        std::atomic<std::uint64_t> published_bytes{0};
+        std::atomic<std::uint64_t> received{0};
+        std::atomic<std::uint64_t> received_bytes{0};
+        // discarded by subscription queue limits
+        std::atomic<std::uint64_t> dropped{0};
+        // polls that left messages queued (subscription batch limit)
+        std::atomic<std::uint64_t> deferred{0};
+        LatencyHistogram queue_time;
+        LatencyHistogram handler_time;
+
+        void publish(std::size_t bytes = 0)
+        {
+            published.fetch_add(1, std::memory_order_relaxed);
+            published_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void receive(std::size_t bytes = 0)
+        {
+            received.fetch_add(1, std::memory_order_relaxed);
+            received_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void drop(std::uint64_t n = 1) { dropped.fetch_add(n, std::memory_order_relaxed); }
+        void defer() { deferred.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    /// \brief Delivery of all the groups subscribed to with one priority (TransporterConfig::QoS::priority), as scheduled by poll() (see PollScheduler)
+    struct ClassStats
+    {
+        std::atomic<std::uint64_t> received{0};
+        // polls ended by the layer budget with messages of this class still queued ...
+        std::atomic<std::uint64_t> deferred{0};
+        // ... of which delivered none of them
+        std::atomic<std::uint64_t> starved{0};
+        LatencyHistogram queue_time;
+
+        void receive() { received.fetch_add(1, std::memory_order_relaxed); }
+        void defer() { deferred.fetch_add(1, std::memory_order_relaxed); }
+        void starve() { starved.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    /// \brief Is instrumentation enabled?
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /// \brief Enable or disable instrumentation for this process
+    static void set_enabled(bool enable) { enabled_.store(enable); }
+
+    /// \brief Returns the statistics for the given layer and group (created if necessary). The returned reference remains valid for the life of the process.
+    static GroupStats& group(protobuf::Layer layer, const std::string& group);
+
+    /// \brief Returns the statistics for the given layer and group (Group overload)
+    static GroupStats& group(protobuf::Layer layer, const Group& g)
+    {
+        return group(layer, std::string(g));
+    }
+
+    /// \brief Returns the statistics for the given layer and subscription priority class (created if necessary). The returned reference remains valid for the life of the process.
+    static ClassStats& priority_class(protobuf::Layer layer, int priority);
+
+    /// \brief Write all statistics recorded since the last call to \c stats (which must have "name" and "pid" set by the caller if desired) and reset them
+    static void summarize(protobuf::TransportStats* stats);
+
+    /// \brief Helper for measuring handler (callback) time
+    class HandlerTimer
+    {
+      public:
+        HandlerTimer(GroupStats* stats)
+            : stats_(stats), start_(stats_ ? Clock::now() : Clock::time_point())
+        {
+        }
+        ~HandlerTimer()
+        {
+            if (stats_)
+                stats_->handler_time.record(Clock::now() - start_);
+        }
+
+      private:
+        GroupStats* stats_;
+        Clock::time_point start_;
+    };
+
+  private:
+    static std::atomic<bool> enabled_;
+    static std::shared_timed_mutex mutex_;
+    static std::map<std::pair<int, std::string>, std::unique_ptr<GroupStats>> stats_;
+    static std::map<std::pair<int, int>, std::unique_ptr<ClassStats>> class_stats_;
+    static Clock::time_point last_summary_;
+};
+
+/// \brief Periodically publishes the process's TransportStats; used from the main thread of SingleThreadApplication and MultiThreadApplication
+class TransportStatsPublisher
+{
+  public:
+    using WakeupClock = std::chrono::system_clock;
+
+    /// \param name Application name to include in each report
+    /// \param cfg Instrumentation configuration
+    TransportStatsPublisher(const std::string& name,
+                            const protobuf::AppConfig::TransportInstrumentation& cfg)
+        : interval_(time::convert_duration<WakeupClock::duration>(cfg.report_interval_with_units())),
+          next_report_(WakeupClock::now() + interval_)
+    {
+        report_.set_name(name);
+        report_.set_pid(getpid());
+    }
+
+    /// \brief Time at which publish() next needs to be called, or WakeupClock::time_point::max() if instrumentation is disabled
+    WakeupClock::time_point next_report() const
+    {
+        return (TransportStats::enabled() && interval_ > WakeupClock::duration::zero())
+                   ? next_report_
+                   : WakeupClock::time_point::max();
+    }
+
+    /// \brief Publish a protobuf::TransportStats on groups::transport_stats if it is due
+    template <typename Transporter> void publish(Transporter& transporter)
+    {
+        auto now = WakeupClock::now();
+        if (now < next_report())
+            return;
+
+        next_report_ += interval_;
+        if (next_report_ < now)
+            next_report_ = now + interval_;
+
+        report_.clear_group();
+        report_.set_time_with_units(time::SystemClock::now<time::MicroTime>());
+        TransportStats::summarize(&report_);
+        transporter.template publish<groups::transport_stats>(report_);
+    }
+
+  private:
+    WakeupClock::duration interval_;
+    WakeupClock::time_point next_report_;
+    protobuf::TransportStats report_;
+};
+
+} // namespace middleware
+} // namespace goby
+
+#endif
@@ -32,6 +32,33 @@ namespace goby
 {
 namespace middleware
 {
+/// \brief Queue limits and delivery scheduling for a subscription, as given by protobuf::TransporterConfig::QoS
+struct SubscriptionQueuePolicy
+{
+    SubscriptionQueuePolicy() = default;
+    SubscriptionQueuePolicy(const goby::middleware::protobuf::TransporterConfig::QoS& qos)
+        : max_depth(qos.conflate() ? 1 : qos.max_depth()),
+          drop_newest(!qos.conflate() &&
+                      qos.overflow() ==
+                          goby::middleware::protobuf::TransporterConfig::QoS::DROP_NEWEST),
+          priority(qos.priority()),
+          max_batch(qos.max_batch())
+    {
+    }
+
+    /// Maximum number of messages queued, or 0 if unlimited
+    std::size_t max_depth{0};
+    /// Discard new messages (rather than the oldest queued message) when the queue is full
+    bool drop_newest{false};
+    /// Delivery order relative to other groups
+    goby::middleware::protobuf::TransporterConfig::QoS::Priority priority{
+        goby::middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL};
+    /// Maximum number of messages delivered per poll, or 0 if unlimited
+    std::size_t max_batch{0};
+
+    bool bounded() const { return max_depth > 0; }
+};
+
 /// \brief Class that holds additional metadata and callback functions related to a subscription (and is optionally provided as a parameter to StaticTransporterInterface::subscribe). Use of this class is generally unnecessary on interprocess and inner layers.
 template <typename Data> class Subscriber
 {
@@ -73,6 +100,9 @@ template <typename Data> class Subscriber
     /// \return the metadata configuration
     const goby::middleware::protobuf::TransporterConfig& cfg() const { return cfg_; }
 
+    /// \return the queue limits for this subscription (from cfg().qos())
+    SubscriptionQueuePolicy queue_policy() const { return SubscriptionQueuePolicy(cfg_.qos()); }
+
     /// \return the group for this subscribe call using the group_func. Only intended to be called by the various transporters.
     Group group(const Data& data) const
     {
@@ -0,0 +1,172 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// tests the AcousticChannelSimulator propagation, range, collision, half-duplex and loss models
+
+#include <cassert>
+#include <iostream>
+
+#include "goby/acomms/modemdriver/acoustic_sim_channel.h"
+#include "goby/util/debug_logger.h"
+
+using goby::acomms::AcousticChannelSimulator;
+using Clock = AcousticChannelSimulator::Clock;
+using Status = AcousticChannelSimulator::Reception::Status;
+
+Clock::time_point t(double seconds)
+{
+    return Clock::time_point(
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+Clock::duration d(double seconds)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::acomms::acoustic_sim::protobuf::ChannelConfig cfg;
+    cfg.set_sound_speed(1500);
+    cfg.set_max_range(3000);
+
+    AcousticChannelSimulator channel(cfg);
+    // 1 -- 1500 m -- 2 -- 2500 m -- 3 (1 and 3 are out of range of each other)
+    channel.add_node(1, {0, 0, 0});
+    channel.add_node(2, {1500, 0, 0});
+    channel.add_node(3, {4000, 0, 0});
+
+    // propagation delay and range
+    {
+        assert(channel.propagation_delay(1, 2) == d(1));
+        channel.transmit(1, "hello", t(100), d(1));
+        assert(channel.next_event_time() == t(102));
+        assert(channel.receive(2, t(101.9)).empty());
+        auto rx = channel.receive(2, t(102));
+        assert(rx.size() == 1);
+        assert(rx[0].src == 1);
+        assert(rx[0].bytes == "hello");
+        assert(rx[0].rx_start == t(101));
+        assert(channel.receive(3, t(1000)).empty());
+        assert(channel.next_event_time() == Clock::time_point::max());
+
+        auto stats = channel.statistics();
+        assert(stats.transmissions == 1);
+        assert(stats.received == 1);
+        assert(stats.out_of_range == 1);
+    }
+
+    // collision at node 2: arrivals [201, 202] and [201.667, 202.667] overlap
+    {
+        channel.transmit(1, "a", t(200), d(1));
+        channel.transmit(3, "b", t(200), d(1));
+        assert(channel.receive(2, t(300)).empty());
+        assert(channel.statistics().collisions == 2);
+    }
+
+    // same transmissions, separated in time
+    {
+        channel.transmit(1, "a", t(300), d(1));
+        channel.transmit(3, "b", t(302), d(1));
+        auto rx = channel.receive(2, t(400));
+        assert(rx.size() == 2);
+        assert(rx[0].src == 1 && rx[1].src == 3);
+        assert(channel.statistics().collisions == 2);
+    }
+
+    // half-duplex: node 2 is transmitting when the packet from 1 arrives
+    {
+        channel.transmit(2, "c", t(400), d(2));
+        channel.transmit(1, "a", t(400), d(1));
+        assert(channel.receive(2, t(500)).empty());
+        assert(channel.statistics().half_duplex == 1);
+        // but node 1 finished transmitting before node 2's packet arrived
+        assert(channel.receive(1, t(500)).size() == 1);
+    }
+
+    // half-duplex: node 2 starts transmitting while receiving
+    {
+        channel.transmit(1, "a", t(500), d(1));
+        channel.transmit(2, "c", t(501.5), d(0.1));
+        assert(channel.receive(2, t(600)).empty());
+        assert(channel.statistics().half_duplex == 2);
+    }
+
+    // moving node 3 into range of node 1
+    {
+        channel.receive(3, t(600));
+        channel.set_position(3, {3000, 0, 0});
+        channel.transmit(1, "a", t(600), d(1));
+        assert(channel.receive(3, t(603)).size() == 1);
+    }
+
+    // random loss and bit errors
+    {
+        goby::acomms::acoustic_sim::protobuf::ChannelConfig lossy_cfg;
+        lossy_cfg.set_packet_loss_probability(0.5);
+        AcousticChannelSimulator lossy(lossy_cfg);
+        lossy.add_node(1, {0, 0, 0});
+        lossy.add_node(2, {100, 0, 0});
+
+        const int n = 1000;
+        for (int i = 0; i < n; ++i) lossy.transmit(1, "x", t(10 * i), d(1));
+        auto received = lossy.receive(2, t(10 * n)).size();
+        std::cout << "With 50% loss, received " << received << "/" << n << std::endl;
+        assert(received > 400 && received < 600);
+        assert(lossy.statistics().lost == n - received);
+
+        goby::acomms::acoustic_sim::protobuf::ChannelConfig ber_cfg;
+        ber_cfg.set_bit_error_rate(1e-3);
+        AcousticChannelSimulator ber(ber_cfg);
+        ber.add_node(1, {0, 0, 0});
+        ber.add_node(2, {100, 0, 0});
+        // P(no errors) = (1-1e-3)^8 ~= 0.992 for one byte; ~= 3e-4 for 1000 bytes
+        for (int i = 0; i < n; ++i)
+        {
+            ber.transmit(1, "x", t(10 * i), d(1));
+            ber.transmit(1, std::string(1000, 'x'), t(10 * i + 5), d(1));
+        }
+        auto ber_rx = ber.receive(2, t(10 * n));
+        int small = 0, large = 0;
+        for (const auto& rx : ber_rx) (rx.bytes.size() == 1 ? small : large)++;
+        std::cout << "With BER 1e-3, received " << small << "/" << n << " 1 byte and " << large
+                  << "/" << n << " 1000 byte packets" << std::endl;
+        assert(small > 970);
+        assert(large < 10);
+    }
+
+    // channels are shared by name
+    {
+        auto a = AcousticChannelSimulator::channel("test", cfg);
+        auto b = AcousticChannelSimulator::channel("test", cfg);
+        auto c = AcousticChannelSimulator::channel("other", cfg);
+        assert(a == b);
+        assert(a != c);
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// benchmarks a 20 node TDMA network (MACManager + AcousticSimDriver) on a simulated acoustic channel, faster than real time
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/acomms/amac.h"
+#include "goby/acomms/bind.h"
+#include "goby/acomms/modemdriver/acoustic_sim_driver.h"
+#include "goby/util/debug_logger.h"
+
+using goby::acomms::protobuf::ModemTransmission;
+using goby::time::SystemClock;
+
+constexpr int num_nodes = 20;
+constexpr int num_cycles = 3;
+constexpr int frame_size = 64;
+constexpr double slot_seconds = 2.5;
+constexpr int warp = 25;
+
+struct Node
+{
+    goby::acomms::AcousticSimDriver driver;
+    goby::acomms::MACManager mac;
+};
+
+int transmissions = 0;
+int receptions = 0;
+double total_latency = 0;
+double max_latency = 0;
+
+void data_request(int id, ModemTransmission* msg)
+{
+    // timestamp the frame so the receivers can compute the latency
+    std::string frame = std::to_string(SystemClock::now().time_since_epoch().count()) + ":";
+    frame.resize(frame_size, 'a' + id);
+    msg->set_dest(goby::acomms::BROADCAST_ID);
+    msg->add_frame(frame);
+    ++transmissions;
+}
+
+void receive(int id, const ModemTransmission& msg)
+{
+    assert(msg.frame_size() == 1);
+    assert(msg.frame(0).size() == frame_size);
+    assert(msg.frame(0).back() == 'a' + msg.src());
+
+    SystemClock::duration sent(std::stoll(msg.frame(0).substr(0, msg.frame(0).find(':'))));
+    double latency =
+        std::chrono::duration<double>(SystemClock::now().time_since_epoch() - sent).count();
+    total_latency += latency;
+    max_latency = std::max(max_latency, latency);
+    ++receptions;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::time::SimulatorSettings::using_sim_time = true;
+    goby::time::SimulatorSettings::warp_factor = warp;
+    goby::time::SimulatorSettings::reference_time = std::chrono::system_clock::now();
+
+    goby::acomms::protobuf::MACConfig mac_cfg;
+    mac_cfg.set_type(goby::acomms::protobuf::MAC_FIXED_DECENTRALIZED);
+    for (int id = 1; id <= num_nodes; ++id)
+    {
+        ModemTransmission* slot = mac_cfg.add_slot();
+        slot->set_src(id);
+        slot->set_type(ModemTransmission::DATA);
+        slot->set_slot_seconds(slot_seconds);
+    }
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (int id = 1; id <= num_nodes; ++id)
+    {
+        nodes.emplace_back(new Node);
+        Node& node = *nodes.back();
+
+        // 5 x 4 grid with 500 m spacing: the longest path is 2500 m (1.67 s)
+        goby::acomms::protobuf::DriverConfig driver_cfg;
+        driver_cfg.set_driver_type(goby::acomms::protobuf::DRIVER_ACOUSTIC_SIM);
+        driver_cfg.set_modem_id(id);
+        auto* sim_cfg = driver_cfg.MutableExtension(goby::acomms::acoustic_sim::protobuf::config);
+        sim_cfg->set_channel("acoustic_sim2");
+        sim_cfg->mutable_channel_cfg()->set_max_range(3000);
+        sim_cfg->mutable_position()->set_x(500 * ((id - 1) % 5));
+        sim_cfg->mutable_position()->set_y(500 * ((id - 1) / 5));
+        sim_cfg->set_max_frame_size(frame_size);
+        // 0.5 s overhead + 0.1 s of data
+        sim_cfg->set_bit_rate(5120);
+
+        node.driver.signal_data_request.connect(
+            [id](ModemTransmission* msg) { data_request(id, msg); });
+        node.driver.signal_receive.connect(
+            [id](const ModemTransmission& msg) { receive(id, msg); });
+        goby::acomms::bind(node.mac, node.driver);
+
+        node.driver.startup(driver_cfg);
+        mac_cfg.set_modem_id(id);
+        node.mac.startup(mac_cfg);
+    }
+
+    auto channel = nodes.front()->driver.channel();
+
+    auto start = SystemClock::now();
+    while (transmissions < num_cycles * num_nodes)
+    {
+        for (auto& node : nodes)
+        {
+            node->mac.do_work();
+            node->driver.do_work();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // let the last packets arrive
+    for (auto& node : nodes) node->mac.shutdown();
+    while (channel->next_event_time() != SystemClock::time_point::max())
+    {
+        for (auto& node : nodes) node->driver.do_work();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto end = SystemClock::now();
+
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    auto stats = channel->statistics();
+    std::cout << "Transmissions: " << transmissions << ", receptions: " << receptions
+              << ", collisions: " << stats.collisions << ", half-duplex: " << stats.half_duplex
+              << std::endl;
+    std::cout << "Simulated " << elapsed << " s (" << elapsed / warp << " s real time)"
+              << std::endl;
+    std::cout << "Aggregate goodput: " << receptions * frame_size * 8 / elapsed << " bits/s, latency: mean "
+              << total_latency / receptions << " s, max " << max_latency << " s" << std::endl;
+
+    assert(stats.transmissions == static_cast<std::uint64_t>(transmissions));
+    assert(stats.collisions == 0);
+    assert(stats.half_duplex == 0);
+    assert(receptions == transmissions * (num_nodes - 1));
+    // airtime (0.6 s) + propagation (at most 1.67 s), plus loop jitter
+    assert(max_latency < 2.5);
+
+    for (auto& node : nodes) node->driver.shutdown();
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// benchmarks MAC_ADAPTIVE_DECENTRALIZED against MAC_FIXED_DECENTRALIZED on a simulated acoustic channel (AcousticSimDriver) when only a few nodes have a backlog
+
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#include "goby/acomms/amac.h"
+#include "goby/acomms/bind.h"
+#include "goby/acomms/modemdriver/acoustic_sim_driver.h"
+#include "goby/util/debug_logger.h"
+
+using goby::acomms::protobuf::ModemTransmission;
+using goby::time::SystemClock;
+
+constexpr int num_nodes = 10;
+// the topside node: sends a status message every slot it has, and coordinates the adaptive MAC
+constexpr int topside_id = 1;
+// nodes with a backlog of backlog_size messages at the start; all others are idle
+const std::set<int> busy_ids{4, 8};
+constexpr int backlog_size = 48;
+constexpr int frame_size = 64;
+constexpr double slot_seconds = 2;
+constexpr int warp = 100;
+
+struct Node
+{
+    goby::acomms::AcousticSimDriver driver;
+    goby::acomms::MACManager mac;
+    int backlog{0};
+    int next_seq{0};
+};
+
+struct Result
+{
+    double makespan{0};
+    double mean_latency{0};
+    goby::acomms::AcousticChannelSimulator::Statistics stats;
+};
+
+Result run(goby::acomms::protobuf::MACType type)
+{
+    goby::acomms::protobuf::MACConfig mac_cfg;
+    mac_cfg.set_type(type);
+    for (int id = 1; id <= num_nodes; ++id)
+    {
+        ModemTransmission* slot = mac_cfg.add_slot();
+        slot->set_src(id);
+        slot->set_type(ModemTransmission::DATA);
+        slot->set_slot_seconds(slot_seconds);
+    }
+    // fixed: each node gets one slot per 20 s cycle; adaptive: each node gets at least one slot per 40 s cycle, and the other 20 s goes to the nodes with a backlog
+    mac_cfg.mutable_adaptive()->set_cycle_seconds(2 * num_nodes * slot_seconds);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    // (src, seq) of the backlog messages received by the topside
+    std::set<std::pair<int, int>> received;
+    double total_latency = 0;
+
+    auto start = SystemClock::now();
+    for (int id = 1; id <= num_nodes; ++id)
+    {
+        nodes.emplace_back(new Node);
+        Node& node = *nodes.back();
+        if (busy_ids.count(id))
+            node.backlog = backlog_size;
+
+        // 100 m spacing in a line: the longest path is 900 m (0.6 s)
+        goby::acomms::protobuf::DriverConfig driver_cfg;
+        driver_cfg.set_driver_type(goby::acomms::protobuf::DRIVER_ACOUSTIC_SIM);
+        driver_cfg.set_modem_id(id);
+        auto* sim_cfg = driver_cfg.MutableExtension(goby::acomms::acoustic_sim::protobuf::config);
+        sim_cfg->set_channel(goby::acomms::protobuf::MACType_Name(type));
+        sim_cfg->mutable_position()->set_x(100 * (id - 1));
+        sim_cfg->set_max_frame_size(frame_size);
+        // 0.5 s overhead + 0.1 s of data
+        sim_cfg->set_bit_rate(5120);
+
+        node.driver.signal_data_request.connect([id, &node](ModemTransmission* msg) {
+            if (id != topside_id && node.backlog == 0)
+                return;
+
+            std::string frame = std::to_string(id) + ":" + std::to_string(node.next_seq++) + ":";
+            frame.resize(frame_size, ' ');
+            msg->set_dest(goby::acomms::BROADCAST_ID);
+            msg->add_frame(frame);
+            if (id != topside_id)
+                --node.backlog;
+        });
+        node.mac.signal_queue_depth_request.connect([id, &node](std::uint32_t* queue_depth) {
+            *queue_depth = (id == topside_id ? 1 : node.backlog) * frame_size;
+        });
+
+        if (id == topside_id)
+        {
+            node.driver.signal_receive.connect([&](const ModemTransmission& msg) {
+                if (!busy_ids.count(msg.src()))
+                    return;
+                int seq = std::stoi(msg.frame(0).substr(msg.frame(0).find(':') + 1));
+                bool inserted = received.insert(std::make_pair(msg.src(), seq)).second;
+                assert(inserted);
+                total_latency += std::chrono::duration<double>(SystemClock::now() - start).count();
+            });
+        }
+
+        goby::acomms::bind(node.mac, node.driver);
+
+        node.driver.startup(driver_cfg);
+        mac_cfg.set_modem_id(id);
+        node.mac.startup(mac_cfg);
+    }
+
+    auto channel = nodes.front()->driver.channel();
+
+    const std::size_t total = busy_ids.size() * backlog_size;
+    while (received.size() < total)
+    {
+        for (auto& node : nodes)
+        {
+            node->mac.do_work();
+            node->driver.do_work();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Result result;
+    result.makespan = std::chrono::duration<double>(SystemClock::now() - start).count();
+    result.mean_latency = total_latency / total;
+    result.stats = channel->statistics();
+
+    for (auto& node : nodes)
+    {
+        node->mac.shutdown();
+        node->driver.shutdown();
+    }
+
+    std::cout << goby::acomms::protobuf::MACType_Name(type) << ": delivered " << total
+              << " backlog messages in " << result.makespan << " s (goodput "
+              << total * frame_size * 8 / result.makespan << " bits/s), mean latency "
+              << result.mean_latency << " s. Transmissions: " << result.stats.transmissions
+              << ", collisions: " << result.stats.collisions
+              << ", half-duplex: " << result.stats.half_duplex << std::endl;
+
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::time::SimulatorSettings::using_sim_time = true;
+    goby::time::SimulatorSettings::warp_factor = warp;
+    goby::time::SimulatorSettings::reference_time = std::chrono::system_clock::now();
+
+    Result fixed = run(goby::acomms::protobuf::MAC_FIXED_DECENTRALIZED);
+    Result adaptive = run(goby::acomms::protobuf::MAC_ADAPTIVE_DECENTRALIZED);
+
+    // every node must agree on the adaptive cycle
+    for (const Result& r : {fixed, adaptive})
+    {
+        assert(r.stats.collisions == 0);
+        assert(r.stats.half_duplex == 0);
+    }
+
+    // the backlog drains at one message per 20 s with the fixed cycle, and (after the first few cycles) at about six per 40 s with the adaptive one
+    assert(adaptive.makespan < 0.6 * fixed.makespan);
+    assert(adaptive.mean_latency < 0.75 * fixed.mean_latency);
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,348 @@
+// Copyright 2011-2020:
+//   GobySoft, LLC (2013-)
+//   Massachusetts Institute of Technology (2007-2014)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// load test for IridiumShoreShardedDriver: many concurrent RUDICS calls (including misbehaving clients and a reconnect wave), plus MO and MT SBD through local DirectIP stand-ins
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "goby/acomms/modemdriver/iridium_shore_sharded_driver.h"
+#include "goby/acomms/modemdriver/rudics_packet.h"
+#include "goby/util/debug_logger.h"
+
+using boost::asio::ip::tcp;
+using goby::acomms::protobuf::ModemTransmission;
+
+// the IridiumHeader allows modem ids 0-30
+constexpr int shore_id = 30;
+constexpr int num_vehicles = 29;
+constexpr int calls_per_vehicle = 2;
+constexpr int messages_per_call = 20;
+constexpr int sbd_messages_per_vehicle = 2;
+
+int rudics_port, mo_port, mt_port;
+
+// only used by the main thread (before the client threads start) as the Iridium header DCCL codec is not thread-safe
+std::string make_packet(int src, int frame_start, bool ack_requested, int rate)
+{
+    ModemTransmission msg;
+    msg.set_src(src);
+    msg.set_dest(shore_id);
+    msg.set_type(ModemTransmission::DATA);
+    msg.set_rate(rate);
+    msg.set_frame_start(frame_start);
+    msg.set_ack_requested(ack_requested);
+    msg.add_frame(std::string(64, 'a' + src % 26));
+
+    std::string bytes, packet;
+    goby::acomms::serialize_iridium_modem_message(&bytes, msg);
+    goby::acomms::serialize_rudics_packet(bytes, &packet);
+    return packet;
+}
+
+std::string imei(int modem_id) { return std::to_string(300000000000000ull + modem_id); }
+
+void append_uint16(std::string& s, unsigned u)
+{
+    s += static_cast<char>((u >> 8) & 0xff);
+    s += static_cast<char>(u & 0xff);
+}
+
+void append_uint32(std::string& s, unsigned u)
+{
+    for (int i = 3; i >= 0; --i) s += static_cast<char>((u >> (8 * i)) & 0xff);
+}
+
+std::atomic<int> acks_received(0);
+std::atomic<int> calls_completed(0);
+std::atomic<int> mt_received(0);
+std::atomic<bool> done(false);
+
+void vehicle(int id, std::vector<std::string> packets)
+{
+    try
+    {
+        boost::asio::io_context io;
+        for (int call = 0; call < calls_per_vehicle; ++call)
+        {
+            tcp::socket socket(io);
+            socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), rudics_port));
+            boost::asio::write(socket, boost::asio::buffer(std::string("goby\r")));
+
+            int acks_expected = 0;
+            for (int i = 0; i < messages_per_call; ++i)
+            {
+                boost::asio::write(socket,
+                                   boost::asio::buffer(packets[call * messages_per_call + i]));
+                if (i % 2 == 0)
+                    ++acks_expected;
+            }
+
+            boost::asio::streambuf buffer;
+            while (acks_expected > 0)
+            {
+                boost::asio::read_until(socket, buffer, '\r');
+                std::istream is(&buffer);
+                std::string line;
+                std::getline(is, line, '\r');
+                if (line != "bye")
+                {
+                    --acks_expected;
+                    ++acks_received;
+                }
+            }
+            socket.close();
+            ++calls_completed;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Vehicle " << id << " failed: " << e.what() << std::endl;
+    }
+}
+
+// sends undecodable packets, which should get it disconnected
+void garbage_client()
+{
+    boost::asio::io_context io;
+    tcp::socket socket(io);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), rudics_port));
+    boost::asio::write(socket, boost::asio::buffer(std::string("xyz\rxyz\rxyz\r")));
+
+    boost::system::error_code ec;
+    char c;
+    while (!ec) socket.read_some(boost::asio::buffer(&c, 1), ec);
+    std::cout << "Garbage client disconnected: " << ec.message() << std::endl;
+}
+
+// connects and says nothing until the end of the test
+void stalled_client()
+{
+    boost::asio::io_context io;
+    tcp::socket socket(io);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), rudics_port));
+    boost::asio::write(socket, boost::asio::buffer(std::string("goby\r")));
+    while (!done) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+// Iridium gateway: DirectIP MO (vehicle to shore)
+void mo_sbd(int id, const std::string& packet)
+{
+    std::string body;
+    body += static_cast<char>(0x01); // MO header
+    append_uint16(body, 28);
+    append_uint32(body, id);      // CDR reference
+    body += imei(id);             // IMEI
+    body += static_cast<char>(0); // session status
+    append_uint16(body, 1);       // MOMSN
+    append_uint16(body, 0);       // MTMSN
+    append_uint32(body, 0);       // time of session
+
+    body += static_cast<char>(0x02); // MO payload
+    append_uint16(body, packet.size());
+    body += packet;
+
+    std::string message;
+    message += static_cast<char>(1); // protocol revision
+    append_uint16(message, body.size());
+    message += body;
+
+    boost::asio::io_context io;
+    tcp::socket socket(io);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), mo_port));
+    boost::asio::write(socket, boost::asio::buffer(message));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+// Iridium gateway: DirectIP MT (shore to vehicle)
+void mt_gateway(boost::asio::io_context& io, tcp::acceptor& acceptor)
+{
+    for (;;)
+    {
+        tcp::socket socket(io);
+        boost::system::error_code ec;
+        acceptor.accept(socket, ec);
+        if (done)
+            break;
+        if (ec)
+            continue;
+
+        std::vector<char> pre_header(3);
+        boost::asio::read(socket, boost::asio::buffer(pre_header));
+        unsigned length = ((pre_header[1] & 0xff) << 8) | (pre_header[2] & 0xff);
+        std::vector<char> body(length);
+        boost::asio::read(socket, boost::asio::buffer(body));
+
+        // MT header IE: iei (1), length (2), client id (4), imei (15)
+        assert(body.at(0) == 0x41);
+        std::string rx_imei(body.begin() + 7, body.begin() + 22);
+
+        std::string confirm;
+        confirm += static_cast<char>(0x44);
+        append_uint16(confirm, 25);
+        confirm.append(body.begin() + 3, body.begin() + 7); // client id
+        confirm += rx_imei;
+        append_uint32(confirm, mt_received + 1); // auto reference id
+        append_uint16(confirm, 1);               // status: success (queue position 1)
+
+        std::string message;
+        message += static_cast<char>(1);
+        append_uint16(message, confirm.size());
+        message += confirm;
+        boost::asio::write(socket, boost::asio::buffer(message));
+
+        ++mt_received;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::WARN, &std::clog);
+    goby::glog.set_name(argv[0]);
+
+    srand(time(NULL));
+    rudics_port = rand() % 1000 + 50000;
+    mo_port = rudics_port + 1;
+    mt_port = rudics_port + 2;
+
+    goby::acomms::IridiumShoreShardedDriver driver;
+
+    goby::acomms::protobuf::DriverConfig cfg;
+    cfg.set_modem_id(shore_id);
+    cfg.set_driver_type(goby::acomms::protobuf::DRIVER_IRIDIUM_SHORE_SHARDED);
+    auto* shore_cfg = cfg.MutableExtension(goby::acomms::iridium::protobuf::shore_config);
+    shore_cfg->set_rudics_server_port(rudics_port);
+    shore_cfg->set_mo_sbd_server_port(mo_port);
+    shore_cfg->set_mt_sbd_server_address("127.0.0.1");
+    shore_cfg->set_mt_sbd_server_port(mt_port);
+    shore_cfg->set_worker_threads(4);
+    for (int id = 1; id <= num_vehicles; ++id)
+    {
+        auto* pair = shore_cfg->add_modem_id_to_imei();
+        pair->set_modem_id(id);
+        pair->set_imei(imei(id));
+    }
+
+    std::atomic<int> rudics_data_received(0);
+    int sbd_data_received = 0;
+    driver.signal_receive.connect([&](const ModemTransmission& msg) {
+        if (msg.type() != ModemTransmission::DATA)
+            return;
+        assert(msg.dest() == shore_id);
+        assert(msg.frame(0) == std::string(64, 'a' + msg.src() % 26));
+        if (msg.rate() == goby::acomms::RATE_RUDICS)
+            ++rudics_data_received;
+        else
+            ++sbd_data_received;
+    });
+
+    driver.startup(cfg);
+
+    boost::asio::io_context mt_io;
+    tcp::acceptor mt_acceptor(mt_io, tcp::endpoint(tcp::v4(), mt_port));
+    std::thread mt_thread(mt_gateway, std::ref(mt_io), std::ref(mt_acceptor));
+
+    // phase 1: RUDICS
+    std::vector<std::thread> clients;
+    for (int id = 1; id <= num_vehicles; ++id)
+    {
+        std::vector<std::string> packets;
+        for (int i = 0; i < calls_per_vehicle * messages_per_call; ++i)
+            packets.push_back(make_packet(id, i, i % 2 == 0, goby::acomms::RATE_RUDICS));
+        clients.emplace_back(vehicle, id, packets);
+    }
+    std::thread garbage_thread(garbage_client);
+    std::thread stalled_thread(stalled_client);
+
+    const int expected_rudics = num_vehicles * calls_per_vehicle * messages_per_call;
+    auto deadline = std::chrono::system_clock::now() + std::chrono::seconds(60);
+    while ((rudics_data_received < expected_rudics ||
+            calls_completed < num_vehicles * calls_per_vehicle) &&
+           std::chrono::system_clock::now() < deadline)
+    {
+        driver.do_work();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto& t : clients) t.join();
+    garbage_thread.join();
+
+    std::cout << "RUDICS: " << calls_completed << " calls, " << rudics_data_received
+              << " messages, " << acks_received << " acks" << std::endl;
+    assert(calls_completed == num_vehicles * calls_per_vehicle);
+    assert(rudics_data_received == expected_rudics);
+    assert(acks_received == expected_rudics / 2);
+
+    // wait for the completed calls to be torn down (the stalled client never identifies itself, so is never mapped)
+    while (driver.rudics_clients() > 0 && std::chrono::system_clock::now() < deadline)
+    {
+        driver.do_work();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(driver.rudics_clients() == 0);
+
+    // phase 2: SBD (acks are returned as MT SBD since no vehicle is on a call)
+    std::vector<std::string> sbd_packets;
+    for (int id = 1; id <= num_vehicles; ++id)
+        for (int i = 0; i < sbd_messages_per_vehicle; ++i)
+            sbd_packets.push_back(make_packet(id, i, true, goby::acomms::RATE_SBD));
+
+    const int expected_sbd = num_vehicles * sbd_messages_per_vehicle;
+    std::thread mo_thread([&]() {
+        for (int i = 0; i < expected_sbd; ++i)
+            mo_sbd(i / sbd_messages_per_vehicle + 1, sbd_packets[i]);
+    });
+
+    while ((sbd_data_received < expected_sbd || mt_received < expected_sbd) &&
+           std::chrono::system_clock::now() < deadline)
+    {
+        driver.do_work();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    mo_thread.join();
+
+    std::cout << "SBD: " << sbd_data_received << " MO messages, " << mt_received
+              << " MT messages" << std::endl;
+    assert(sbd_data_received == expected_sbd);
+    assert(mt_received == expected_sbd);
+    assert(driver.receive_queue_drops() == 0);
+
+    done = true;
+    stalled_thread.join();
+    driver.shutdown();
+
+    // unblock the MT gateway
+    {
+        boost::asio::io_context io;
+        tcp::socket socket(io);
+        socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), mt_port));
+    }
+    mt_thread.join();
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "goby/middleware/coroner/liveness.h"
+
+// manually advanced clock so the test is deterministic
+struct TestClock
+{
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<TestClock> time_point;
+    static const bool is_steady = true;
+    static time_point now() noexcept { return time_point(duration(0)); }
+};
+
+using namespace std::chrono;
+
+int main(int /*argc*/, char* argv[])
+{
+    // goby_coroner PUSH mode defaults: 0.25 s heartbeats, 3 missed; 5 s requests, 1 s response timeout
+    const milliseconds heartbeat_interval(250), request_interval(5000);
+    const milliseconds heartbeat_timeout(3 * heartbeat_interval);
+    const milliseconds response_timeout(request_interval + milliseconds(1000));
+
+    TestClock::time_point start;
+    goby::middleware::coroner::LivenessMonitor<TestClock> liveness(
+        heartbeat_timeout, response_timeout, heartbeat_interval / 2, start);
+
+    // "heartbeat" heartbeats and answers requests; "response" only answers requests (no push mode support); "dies" heartbeats then exits
+    for (auto name : {"heartbeat", "response", "dies"}) liveness.expect(name, start);
+
+    const milliseconds dies_at(2000);
+    std::map<std::string, TestClock::time_point> died;
+
+    for (milliseconds t(0); t <= milliseconds(30000); t += milliseconds(50))
+    {
+        auto now = start + t;
+        liveness.advance(now, [&](const std::string& name) {
+            std::cout << t.count() << " ms: " << name << " died" << std::endl;
+            assert(!died.count(name));
+            died[name] = now;
+        });
+
+        if (t % heartbeat_interval == milliseconds(0))
+        {
+            liveness.heartbeat("heartbeat", now);
+            if (t < dies_at)
+                liveness.heartbeat("dies", now);
+        }
+
+        // responses arrive a little after each request
+        if (t % request_interval == milliseconds(100))
+        {
+            liveness.response("heartbeat", now);
+            liveness.response("response", now);
+            if (t < dies_at)
+                liveness.response("dies", now);
+        }
+    }
+
+    // response-only processes must not be held to the heartbeat deadline
+    assert(!died.count("response"));
+    assert(!liveness.dead("response"));
+    assert(!liveness.heartbeating("response"));
+
+    assert(!died.count("heartbeat"));
+    assert(liveness.heartbeating("heartbeat"));
+
+    // last heartbeat at 1750 ms, so declared dead within one tick of 2500 ms
+    assert(died.count("dies"));
+    auto last_heartbeat = start + dies_at - heartbeat_interval;
+    assert(died["dies"] >= last_heartbeat + heartbeat_timeout);
+    assert(died["dies"] <= last_heartbeat + heartbeat_timeout + heartbeat_interval);
+    assert(liveness.dead("dies"));
+    assert(!liveness.heartbeating("dies"));
+
+    // returns without push mode support: back to the response deadline
+    auto now = start + milliseconds(30100);
+    assert(liveness.response("dies", now));
+    assert(!liveness.dead("dies"));
+    int deaths = 0;
+    liveness.advance(now + heartbeat_timeout + heartbeat_interval, [&](const std::string& name) {
+        if (name == "dies")
+            ++deaths;
+    });
+    assert(deaths == 0);
+    liveness.advance(now + response_timeout + heartbeat_interval, [&](const std::string& name) {
+        if (name == "dies")
+            ++deaths;
+    });
+    assert(deaths == 1);
+
+    // an expected process that never reports is dead after the response timeout
+    goby::middleware::coroner::LivenessMonitor<TestClock> silent(
+        heartbeat_timeout, response_timeout, heartbeat_interval / 2, start);
+    silent.expect("silent", start);
+    auto ignore = [](const std::string&) {};
+    assert(silent.advance(start + response_timeout - heartbeat_interval, ignore) == 0);
+    assert(silent.advance(start + response_timeout + heartbeat_interval, ignore) == 1);
+    assert(silent.dead("silent"));
+
+    std::cout << argv[0] << ": all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "goby/middleware/marshalling/dccl.h"
+#include "goby/util/debug_logger.h"
+
+#include "test.pb.h"
+
+using goby::middleware::MarshallingScheme;
+using goby::middleware::SerializeBuffer;
+using goby::middleware::SerializerParserHelper;
+using goby::middleware::detail::DCCLSerializerParserHelperBase;
+using goby::test::middleware::protobuf::HealthReport;
+using goby::test::middleware::protobuf::NavReport;
+
+using NavHelper = SerializerParserHelper<NavReport, MarshallingScheme::DCCL>;
+using HealthHelper = SerializerParserHelper<HealthReport, MarshallingScheme::DCCL>;
+
+// messages encoded in each benchmark
+const int nmsgs = 200000;
+
+struct Link
+{
+    std::string name;
+    std::size_t frame_bytes;
+};
+
+// returns a frame's worth of alternating NavReport and HealthReport messages
+std::vector<std::shared_ptr<google::protobuf::Message>> make_frame(std::size_t frame_bytes)
+{
+    std::vector<std::shared_ptr<google::protobuf::Message>> msgs;
+    std::size_t bytes = 0;
+    for (int i = 0;; ++i)
+    {
+        std::shared_ptr<google::protobuf::Message> msg;
+        std::size_t size = 0;
+        if (i % 2 == 0)
+        {
+            auto nav = std::make_shared<NavReport>();
+            nav->set_vehicle(i % 32);
+            nav->set_x(100 + i);
+            nav->set_y(-200 - i);
+            nav->set_z(-(i % 100));
+            size = NavHelper::serialize(*nav).size();
+            msg = nav;
+        }
+        else
+        {
+            auto health = std::make_shared<HealthReport>();
+            health->set_vehicle(i % 32);
+            health->set_battery(i % 100);
+            health->set_ok(i % 3);
+            size = HealthHelper::serialize(*health).size();
+            msg = health;
+        }
+
+        if (bytes + size > frame_bytes)
+            return msgs;
+        bytes += size;
+        msgs.push_back(msg);
+    }
+}
+
+double msgs_per_sec(std::chrono::steady_clock::duration d, int n)
+{
+    return n / std::chrono::duration<double>(d).count();
+}
+
+void benchmark(const Link& link)
+{
+    auto msgs = make_frame(link.frame_bytes);
+    assert(!msgs.empty());
+    const int nframes = nmsgs / msgs.size() + 1;
+    const int n = nframes * msgs.size();
+
+    // one message (and lock) at a time
+    std::string individual_frame;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < nframes; ++f)
+    {
+        individual_frame.clear();
+        for (const auto& msg : msgs)
+        {
+            std::vector<char> bytes;
+            if (msg->GetDescriptor() == NavReport::descriptor())
+                bytes = NavHelper::serialize(dynamic_cast<NavReport&>(*msg));
+            else
+                bytes = HealthHelper::serialize(dynamic_cast<HealthReport&>(*msg));
+            individual_frame.append(bytes.begin(), bytes.end());
+        }
+    }
+    auto individual_encode = std::chrono::steady_clock::now() - start;
+
+    SerializeBuffer batch_frame;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < nframes; ++f)
+    {
+        batch_frame.clear();
+        DCCLSerializerParserHelperBase::encode_batch(msgs, &batch_frame);
+    }
+    auto batch_encode = std::chrono::steady_clock::now() - start;
+
+    const std::string frame(batch_frame.begin(), batch_frame.end());
+    assert(frame == individual_frame);
+    assert(frame.size() <= link.frame_bytes);
+
+    // one message (and lock) at a time
+    const auto nav_id = NavHelper::id();
+    auto individual_decode_frame = [&]() {
+        std::vector<std::shared_ptr<google::protobuf::Message>> decoded;
+        auto it = frame.cbegin(), end = frame.cend();
+        while (it != end)
+        {
+            if (DCCLSerializerParserHelperBase::id(it, end) == nav_id)
+                decoded.push_back(NavHelper::parse(it, end, it));
+            else
+                decoded.push_back(HealthHelper::parse(it, end, it));
+        }
+        return decoded;
+    };
+
+    for (const auto& decoded :
+         {individual_decode_frame(), DCCLSerializerParserHelperBase::decode_batch(frame)})
+    {
+        assert(decoded.size() == msgs.size());
+        for (std::size_t i = 0; i < decoded.size(); ++i)
+            assert(decoded[i]->SerializeAsString() == msgs[i]->SerializeAsString());
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < nframes; ++f) individual_decode_frame();
+    auto individual_decode = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < nframes; ++f) DCCLSerializerParserHelperBase::decode_batch(frame);
+    auto batch_decode = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < nframes; ++f) DCCLSerializerParserHelperBase::unpack(frame);
+    auto unpack = std::chrono::steady_clock::now() - start;
+    assert(DCCLSerializerParserHelperBase::unpack(frame).frame_size() ==
+           static_cast<int>(msgs.size()));
+
+    std::cout << std::fixed << std::setprecision(0) << link.name << " (" << link.frame_bytes
+              << " bytes, " << msgs.size() << " messages/frame) messages/sec: encode "
+              << msgs_per_sec(individual_encode, n) << " -> " << msgs_per_sec(batch_encode, n)
+              << " (batch), decode " << msgs_per_sec(individual_decode, n) << " -> "
+              << msgs_per_sec(batch_decode, n) << " (batch), unpack "
+              << msgs_per_sec(unpack, n) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    // unpack of a frame with a DCCL ID that is not loaded keeps the packets before it
+    {
+        NavReport nav;
+        nav.set_vehicle(1);
+        nav.set_x(10);
+        nav.set_y(20);
+        nav.set_z(-30);
+        std::vector<const google::protobuf::Message*> msgs{&nav, &nav};
+        std::string frame;
+        std::vector<std::size_t> sizes;
+        DCCLSerializerParserHelperBase::encode_batch(msgs, &frame, &sizes);
+        assert(sizes.size() == 2 && sizes[0] + sizes[1] == frame.size());
+
+        auto packets = DCCLSerializerParserHelperBase::unpack(frame + std::string(8, '\xff'));
+        assert(packets.frame_size() == 2);
+        assert(packets.frame(0).dccl_id() == NavHelper::id());
+        assert(packets.frame(1).data() == frame.substr(sizes[0]));
+        assert(DCCLSerializerParserHelperBase::decode_batch(frame).size() == 2);
+    }
+
+    for (const auto& link : {Link{"Acoustic (Micro-Modem rate 0)", 32},
+                             Link{"Acoustic (Micro-Modem rate 1)", 64},
+                             Link{"Acoustic (Micro-Modem rate 5)", 256},
+                             Link{"Iridium SBD (mobile originated)", 340},
+                             Link{"Iridium RUDICS", 1500}})
+        benchmark(link);
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -36,6 +36,7 @@ using goby::middleware::log::LogEntry;
 constexpr goby::middleware::Group tempgroup("groups::temp");
 constexpr goby::middleware::Group ctdgroup("groups::ctd");
 int nctd = 6;
+const goby::time::SystemClock::time_point temp_timestamp(std::chrono::microseconds(1580818394000005));
 
 dccl::Codec codec;
 goby::middleware::log::ProtobufPlugin pb_plugin;
@@ -70,6 +71,7 @@ void read_log(int test)
         assert(entry.scheme() == goby::middleware::MarshallingScheme::PROTOBUF);
         assert(entry.group() == tempgroup);
         assert(entry.type() == TempSample::descriptor()->full_name());
+        assert(entry.timestamp() == temp_timestamp);
 
         auto temp_samples = pb_plugin.parse_message(entry);
         assert(temp_samples.size() == 1 && temp_samples[0]);
@@ -106,6 +108,11 @@ void read_log(int test)
 
         CTDSample& ctd1 = dynamic_cast<CTDSample&>(*ctd_samples[0]);
         CTDSample& ctd2 = dynamic_cast<CTDSample&>(*ctd_samples[1]);
+
+        // debug text reuses a message per type, which must not affect the messages returned above
+        assert(dccl_plugin.debug_text_message(entry) ==
+               "[0]" + ctd1.ShortDebugString() + "[1]" + ctd2.ShortDebugString());
+
         assert(ctd1.temperature() == i * 2 + 5);
         assert(ctd2.temperature() == (i * 2 + 1) + 5);
     }
@@ -146,7 +153,8 @@ void write_log(int test)
         std::vector<unsigned char> data(t.ByteSize());
         t.SerializeToArray(&data[0], data.size());
         LogEntry entry(data, goby::middleware::MarshallingScheme::PROTOBUF,
-                                         TempSample::descriptor()->full_name(), tempgroup);
+                                         TempSample::descriptor()->full_name(), tempgroup,
+                                         temp_timestamp);
         entry.serialize(&out_log_file);
     }
 
@@ -190,6 +198,7 @@ void write_log(int test)
 
             out_log_file.seekp(
                 pos - std::ios::streamoff(LogEntry::crc_bytes_ + t.ByteSize() +
+                                          LogEntry::timestamp_bytes_ +
                                           LogEntry::type_bytes_ +
                                           LogEntry::group_bytes_ +
                                           LogEntry::scheme_bytes_ +
@@ -205,10 +214,11 @@ void write_log(int test)
 
             out_log_file.seekp(
                 pos - std::ios::streamoff(LogEntry::crc_bytes_ + t.ByteSize() +
+                                          LogEntry::timestamp_bytes_ +
                                           LogEntry::type_bytes_ +
                                           LogEntry::group_bytes_ +
                                           LogEntry::scheme_bytes_ + 1));
-            out_log_file.put(0x14);
+            out_log_file.put(0x14 + LogEntry::timestamp_bytes_);
             out_log_file.seekp(pos);
         }
     }
@@ -252,5 +262,19 @@ int main(int argc, char* argv[])
         read_log(test);
     }
 
+    // parse_message() with arena allocation
+    {
+        goby::middleware::ProtobufArenaPool::set_enabled(true);
+        auto arena_messages = goby::middleware::ProtobufArenaPool::thread_stats().arena_messages;
+        write_log(0);
+        read_log(0);
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+        // one TempSample and two CTDSample per DCCL entry
+        assert(goby::middleware::ProtobufArenaPool::thread_stats().arena_messages ==
+               arena_messages + 1 + nctd);
+#endif
+        goby::middleware::ProtobufArenaPool::set_enabled(false);
+    }
+
     std::cout << "all tests passed" << std::endl;
 }
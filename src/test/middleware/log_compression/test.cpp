@@ -0,0 +1,285 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "goby/middleware/log.h"
+#include "goby/middleware/marshalling/interface.h"
+#include "goby/util/debug_logger.h"
+
+using goby::middleware::log::LogEntry;
+
+constexpr goby::middleware::Group navgroup("groups::nav");
+constexpr goby::middleware::Group ctdgroup("groups::ctd");
+
+const std::string uncompressed_file("/tmp/goby3_test_log_uncompressed.goby");
+const std::string compressed_file("/tmp/goby3_test_log_compressed.goby");
+const std::string truncated_file("/tmp/goby3_test_log_compressed_truncated.goby");
+const std::string corrupted_file("/tmp/goby3_test_log_compressed_corrupted.goby");
+
+const int nentries = 200000;
+const std::uint32_t block_bytes = 1 << 16;
+const goby::time::SystemClock::time_point start_time(std::chrono::microseconds(1580818394000005));
+
+// representative telemetry: a navigation message at 10 Hz and a CTD sample at 1 Hz
+std::unique_ptr<LogEntry> make_entry(int i)
+{
+    auto timestamp = start_time + std::chrono::milliseconds(100 * i);
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(6);
+    if (i % 10 == 0)
+    {
+        ss << "time: " << (timestamp.time_since_epoch() / std::chrono::microseconds(1))
+           << " conductivity: " << 3.2 + 0.001 * (i % 37)
+           << " temperature: " << 11 + 0.01 * (i % 101) << " pressure: " << 50 + 0.1 * (i % 17) << " salinity: 35.1";
+        std::string data = ss.str();
+        return std::make_unique<LogEntry>(std::vector<unsigned char>(data.begin(), data.end()),
+                        goby::middleware::MarshallingScheme::CSTR, "CTDSample", ctdgroup,
+                        timestamp);
+    }
+    else
+    {
+        ss << "time: " << (timestamp.time_since_epoch() / std::chrono::microseconds(1))
+           << " lat: " << 41.5 + 1e-6 * i << " lon: " << -70.7 - 2e-6 * i
+           << " depth: " << 10 + 0.01 * (i % 200) << " heading: " << (i / 10) % 360
+           << " speed: 1.5";
+        std::string data = ss.str();
+        return std::make_unique<LogEntry>(std::vector<unsigned char>(data.begin(), data.end()),
+                        goby::middleware::MarshallingScheme::CSTR, "NavigationReport", navgroup,
+                        timestamp);
+    }
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<std::unique_ptr<LogEntry>> entries;
+
+double write_log(const std::string& file, std::uint32_t block_bytes)
+{
+    LogEntry::reset();
+    LogEntry::set_block_compression(block_bytes);
+
+    std::ofstream out(file.c_str());
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& entry : entries) entry->serialize(&out);
+    LogEntry::finish(&out);
+    out.flush();
+    return seconds_since(start);
+}
+
+// counts seeks that move the read position (each of which discards the buffer), ignoring tellg()
+class SeekCountingFilebuf : public std::filebuf
+{
+  public:
+    int seeks{0};
+
+  protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override
+    {
+        if (off != 0 || dir != std::ios_base::cur)
+            ++seeks;
+        return std::filebuf::seekoff(off, dir, which);
+    }
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        ++seeks;
+        return std::filebuf::seekpos(pos, which);
+    }
+};
+
+// returns the number of entries read, checking each against the entries written
+int read_log(const std::string& file, int* exceptions, double* seconds, int* seeks = nullptr)
+{
+    LogEntry::reset();
+    SeekCountingFilebuf buf;
+    buf.open(file.c_str(), std::ios::in | std::ios::binary);
+    std::istream in(&buf);
+
+    std::vector<std::unique_ptr<LogEntry>> read_entries;
+    *exceptions = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        try
+        {
+            auto entry = std::make_unique<LogEntry>();
+            entry->parse(&in);
+            read_entries.push_back(std::move(entry));
+        }
+        catch (goby::middleware::log::LogException& e)
+        {
+            std::cout << "Exception processing input log (will attempt to continue): " << e.what()
+                      << std::endl;
+            ++(*exceptions);
+        }
+        catch (std::exception& e)
+        {
+            break;
+        }
+    }
+    *seconds = seconds_since(start);
+    if (seeks)
+        *seeks = buf.seeks;
+
+    int i = 0;
+    for (const auto& entry : read_entries)
+    {
+        // skip entries in blocks that could not be read
+        while (i < nentries && entries[i]->timestamp() != entry->timestamp()) ++i;
+        assert(i < nentries);
+
+        const auto& expected = entries[i++];
+        assert(entry->data() == expected->data());
+        assert(entry->type() == expected->type());
+        assert(entry->group() == expected->group());
+        assert(entry->scheme() == expected->scheme());
+    }
+    return read_entries.size();
+}
+
+std::string file_contents(const std::string& file)
+{
+    std::ifstream in(file.c_str());
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& file, const std::string& contents)
+{
+    std::ofstream out(file.c_str());
+    out << contents;
+}
+
+void check_index(const std::vector<LogEntry::BlockIndexEntry>& index, const std::string& file)
+{
+    auto contents = file_contents(file);
+    int nblock_entries = 0;
+    for (const auto& block : index)
+    {
+        // all but the last block are written when they reach block_bytes
+        bool last_block = (&block == &index.back());
+        assert(contents.substr(block.offset, 4) == "GBYB");
+        assert(block.first_timestamp == entries[nblock_entries]->timestamp());
+        nblock_entries += block.entries;
+        assert(block.last_timestamp == entries[nblock_entries - 1]->timestamp());
+        assert(last_block || block.uncompressed_bytes >= block_bytes);
+        assert(block.compressed_bytes < block.uncompressed_bytes);
+    }
+    assert(nblock_entries == nentries);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    for (int i = 0; i < nentries; ++i) entries.push_back(make_entry(i));
+
+    auto uncompressed_write_seconds = write_log(uncompressed_file, 0);
+    auto compressed_write_seconds = write_log(compressed_file, block_bytes);
+
+    int exceptions, seeks;
+    double uncompressed_read_seconds, compressed_read_seconds;
+    assert(read_log(uncompressed_file, &exceptions, &uncompressed_read_seconds, &seeks) ==
+           nentries);
+    assert(exceptions == 0);
+    // no seeking between valid entries
+    assert(seeks == 0);
+    assert(read_log(compressed_file, &exceptions, &compressed_read_seconds, &seeks) == nentries);
+    assert(exceptions == 0);
+    // only to skip the block index at the end
+    assert(seeks == 1);
+
+    // only compressed files need version 4
+    auto file_version = [](const std::string& file) {
+        std::ifstream in(file.c_str());
+        int version = 0;
+        for (int i = 0; i < LogEntry::version_bytes_; ++i) version = (version << 8) | in.get();
+        return version;
+    };
+    assert(file_version(uncompressed_file) == LogEntry::uncompressed_version);
+    assert(file_version(compressed_file) == LogEntry::compressed_version);
+
+    // no blocks in uncompressed file
+    {
+        std::ifstream in(uncompressed_file.c_str());
+        assert(LogEntry::read_block_index(&in).empty());
+    }
+
+    // index written by finish()
+    std::vector<LogEntry::BlockIndexEntry> index;
+    {
+        std::ifstream in(compressed_file.c_str());
+        index = LogEntry::read_block_index(&in);
+        assert(index.size() > 2);
+        check_index(index, compressed_file);
+    }
+
+    // index recovered by scanning the file if the trailer is missing
+    auto contents = file_contents(compressed_file);
+    write_file(truncated_file, contents.substr(0, contents.size() - 10));
+    {
+        std::ifstream in(truncated_file.c_str());
+        auto scanned_index = LogEntry::read_block_index(&in);
+        assert(scanned_index.size() == index.size());
+        for (int i = 0, n = index.size(); i < n; ++i)
+        {
+            assert(scanned_index[i].offset == index[i].offset);
+            assert(scanned_index[i].entries == index[i].entries);
+            assert(scanned_index[i].compressed_bytes == index[i].compressed_bytes);
+        }
+        check_index(scanned_index, truncated_file);
+    }
+    double seconds;
+    assert(read_log(truncated_file, &exceptions, &seconds) == nentries);
+
+    // a corrupted block is skipped and reading continues with the next block
+    contents[index[1].offset + 100] ^= 0xFF;
+    write_file(corrupted_file, contents);
+    assert(read_log(corrupted_file, &exceptions, &seconds) == nentries - index[1].entries);
+    assert(exceptions == 1);
+
+    auto uncompressed_size = file_contents(uncompressed_file).size();
+    auto compressed_size = file_contents(compressed_file).size();
+    auto mb = [](std::size_t bytes) { return bytes / 1.0e6; };
+    std::cout << std::fixed << std::setprecision(1) << "Uncompressed: " << mb(uncompressed_size)
+              << " MB, written at " << mb(uncompressed_size) / uncompressed_write_seconds
+              << " MB/s, read at " << mb(uncompressed_size) / uncompressed_read_seconds
+              << " MB/s" << std::endl;
+    std::cout << "Compressed (" << index.size() << " blocks): " << mb(compressed_size)
+              << " MB, written at " << mb(uncompressed_size) / compressed_write_seconds
+              << " MB/s, read at " << mb(uncompressed_size) / compressed_read_seconds
+              << " MB/s (uncompressed equivalent)" << std::endl;
+    std::cout << "Compression ratio: " << std::setprecision(2)
+              << static_cast<double>(uncompressed_size) / compressed_size << std::endl;
+
+    std::cout << "all tests passed" << std::endl;
+}
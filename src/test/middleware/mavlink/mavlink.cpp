@@ -24,6 +24,8 @@
 #define BOOST_TEST_MODULE mavlink_test
 #include <boost/test/included/unit_test.hpp>
 
+#include <set>
+
 #include "goby/middleware/marshalling/mavlink.h"
 #include "goby/util/binary.h"
 
@@ -183,3 +185,60 @@ BOOST_AUTO_TEST_CASE(mavlink_ardupilot_mega)
     BOOST_CHECK_EQUAL(packet_in.rpm1, packet_out.rpm1);
     BOOST_CHECK_EQUAL(packet_in.rpm2, packet_out.rpm2);
 }
+
+BOOST_AUTO_TEST_CASE(mavlink_stream_parser)
+{
+    mavlink::common::msg::HEARTBEAT hb{};
+    hb.type = 17;
+    hb.custom_mode = 963497464;
+
+    mavlink::common::msg::SYS_STATUS status{};
+    status.load = 17859;
+
+    // three complete frames in one buffer, followed by the first half of a fourth
+    std::vector<char> bytes;
+    for (int sysid : {1, 2, 3})
+    {
+        auto frame = SerializerParserHelper<mavlink::common::msg::HEARTBEAT,
+                                            goby::middleware::MarshallingScheme::MAVLINK>::
+            serialize(hb, sysid);
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+    }
+    auto status_frame = SerializerParserHelper<mavlink::common::msg::SYS_STATUS,
+                                               goby::middleware::MarshallingScheme::MAVLINK>::
+        serialize(status, 4);
+    auto split = status_frame.begin() + status_frame.size() / 2;
+    bytes.insert(bytes.end(), status_frame.begin(), split);
+
+    goby::middleware::MAVLinkStreamParser parser;
+    std::vector<std::shared_ptr<const mavlink::mavlink_message_t>> msgs;
+    auto handler = [&](std::shared_ptr<mavlink::mavlink_message_t> msg) { msgs.push_back(msg); };
+
+    BOOST_CHECK_EQUAL(parser.parse(bytes.begin(), bytes.end(), handler), 3);
+    BOOST_REQUIRE_EQUAL(msgs.size(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(msgs[i]->msgid, mavlink::common::msg::HEARTBEAT::MSG_ID);
+        BOOST_CHECK_EQUAL(msgs[i]->sysid, i + 1);
+    }
+
+    // remainder of the split frame
+    BOOST_CHECK_EQUAL(parser.parse(split, status_frame.end(), handler), 1);
+    BOOST_REQUIRE_EQUAL(msgs.size(), 4);
+    BOOST_CHECK_EQUAL(msgs[3]->msgid, mavlink::common::msg::SYS_STATUS::MSG_ID);
+    BOOST_CHECK_EQUAL(msgs[3]->sysid, 4);
+
+    mavlink::common::msg::SYS_STATUS status_out{};
+    mavlink::MsgMap map(msgs[3].get());
+    status_out.deserialize(map);
+    BOOST_CHECK_EQUAL(status_out.load, status.load);
+
+    // released messages are reused by the pool
+    std::set<const mavlink::mavlink_message_t*> released;
+    for (const auto& msg : msgs) released.insert(msg.get());
+    msgs.clear();
+    parser.parse(bytes.begin(), bytes.begin() + bytes.size() / 3, handler);
+    BOOST_REQUIRE_EQUAL(msgs.size(), 1);
+    BOOST_CHECK(released.count(msgs[0].get()));
+    BOOST_CHECK_EQUAL(msgs[0]->sysid, 1);
+}
@@ -79,12 +79,15 @@ class Subscriber
     {
         inproc2.subscribe<sample1, Sample>(
             [this](std::shared_ptr<const Sample> s) { handle_sample1(s); });
+        // second subscription to the same group from this thread: each callback must still be called exactly once per publication
+        inproc2.subscribe<sample1, Sample>(
+            [this](std::shared_ptr<const Sample> s) { handle_sample1_again(s); });
         inproc2.subscribe<sample2, Sample>(
             [this](std::shared_ptr<const Sample> s) { handle_sample2(s); });
         inproc2.subscribe<widget, Widget>(
             [this](std::shared_ptr<const Widget> w) { handle_widget1(w); });
-        while (receive_count1 < max_publish || receive_count2 < max_publish ||
-               receive_count3 < max_publish)
+        while (receive_count1 < max_publish || receive_count1_again < max_publish ||
+               receive_count2 < max_publish || receive_count3 < max_publish)
         {
             ++ready;
             inproc2.poll();
@@ -92,6 +95,14 @@ class Subscriber
         }
     }
 
+    void check_counts() const
+    {
+        assert(receive_count1 == max_publish);
+        assert(receive_count1_again == max_publish);
+        assert(receive_count2 == max_publish);
+        assert(receive_count3 == max_publish);
+    }
+
   private:
     void handle_sample1(std::shared_ptr<const Sample> sample)
     {
@@ -100,6 +111,11 @@ class Subscriber
         assert(sample->a() == receive_count1);
         ++receive_count1;
     }
+    void handle_sample1_again(std::shared_ptr<const Sample> sample)
+    {
+        assert(sample->a() == receive_count1_again);
+        ++receive_count1_again;
+    }
     void handle_sample2(std::shared_ptr<const Sample> sample)
     {
         //std::thread::id this_id = std::this_thread::get_id();
@@ -118,6 +134,7 @@ class Subscriber
 
   private:
     int receive_count1 = {0};
+    int receive_count1_again = {0};
     int receive_count2 = {0};
     int receive_count3 = {0};
 };
@@ -151,5 +168,7 @@ int main(int argc, char* argv[])
 
     for (int i = 0; i < max_subs; ++i) threads.at(i).join();
 
+    for (const auto& subscriber : subscribers) subscriber.check_counts();
+
     std::cout << "all tests passed" << std::endl;
 }
@@ -0,0 +1,287 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "goby/middleware/transport/interthread.h"
+#include "goby/middleware/transport/poll_scheduler.h"
+#include "goby/middleware/transport/poller.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/util/debug_logger.h"
+
+// tests the subscription priorities and batch limits (TransporterConfig.qos), that a busy inner
+// layer does not starve an outer layer, and the sharing of a layer budget between the priorities
+// (PollScheduler)
+
+using goby::middleware::protobuf::TransporterConfig;
+
+extern constexpr goby::middleware::Group bulk{"PriorityBulk"};
+extern constexpr goby::middleware::Group status{"PriorityStatus"};
+extern constexpr goby::middleware::Group abort_group{"PriorityAbort"};
+extern constexpr goby::middleware::Group flood_high{"PriorityFloodHigh"};
+extern constexpr goby::middleware::Group flood_normal{"PriorityFloodNormal"};
+extern constexpr goby::middleware::Group flood_low{"PriorityFloodLow"};
+
+const int bulk_publish = 1000;
+const int bulk_batch = 10;
+const int flood_publish = 100;
+
+std::atomic<int> subscribed(0);
+std::atomic<int> published(0);
+
+// minimal outer layer with a fixed number of items to deliver
+class OuterLayer : public goby::middleware::Poller<OuterLayer>
+{
+  public:
+    OuterLayer(goby::middleware::InterThreadTransporter& inner)
+        : goby::middleware::Poller<OuterLayer>(&inner)
+    {
+    }
+
+    int pending{0};
+    int delivered{0};
+
+  private:
+    friend goby::middleware::Poller<OuterLayer>;
+    int _poll(std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock)
+    {
+        if (pending == 0)
+            return 0;
+        --pending;
+        ++delivered;
+        if (lock)
+            lock.reset();
+        return 1;
+    }
+};
+
+template <typename Data>
+goby::middleware::Subscriber<Data> make_subscriber(TransporterConfig::QoS::Priority priority,
+                                                   int max_batch = 0)
+{
+    TransporterConfig cfg;
+    cfg.mutable_qos()->set_priority(priority);
+    cfg.mutable_qos()->set_max_batch(max_batch);
+    return goby::middleware::Subscriber<Data>(cfg);
+}
+
+void subscriber()
+{
+    goby::middleware::InterThreadTransporter interthread;
+    OuterLayer outer(interthread);
+
+    // order of delivery
+    std::vector<std::string> rx;
+    int bulk_rx = 0;
+
+    interthread.subscribe<bulk, int>(
+        [&](const int& i) {
+            assert(i == bulk_rx);
+            ++bulk_rx;
+            rx.push_back("bulk");
+        },
+        make_subscriber<int>(TransporterConfig::QoS::PRIORITY_LOW, bulk_batch));
+    interthread.subscribe<status, std::string>([&](const std::string& s) { rx.push_back(s); });
+    interthread.subscribe<abort_group, double>(
+        [&](const double& d) { rx.push_back("abort"); },
+        make_subscriber<double>(TransporterConfig::QoS::PRIORITY_HIGH));
+    ++subscribed;
+
+    while (published < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // first poll: the high priority group first (though published last), then normal, then a
+    // batch of the low priority group
+    outer.pending = 1;
+    int items = outer.poll(std::chrono::seconds(0));
+    assert(items == 2 + bulk_batch + 1);
+    assert(rx.size() == 2 + bulk_batch);
+    assert(rx[0] == "abort");
+    assert(rx[1] == "status");
+    assert(rx[2] == "bulk");
+    assert(bulk_rx == bulk_batch);
+
+    // the outer layer is polled even though the inner layer had (and still has) data
+    assert(outer.delivered == 1);
+
+    // a new high priority message is delivered on the next poll, ahead of the bulk backlog
+    published = 0;
+    ++subscribed;
+    while (published < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    rx.clear();
+    outer.poll(std::chrono::seconds(0));
+    assert(rx.size() == 1 + bulk_batch);
+    assert(rx[0] == "abort");
+    assert(bulk_rx == 2 * bulk_batch);
+
+    // the rest of the backlog is delivered in batches
+    int polls = 2;
+    while (bulk_rx < bulk_publish)
+    {
+        int n = bulk_rx;
+        outer.poll(std::chrono::seconds(0));
+        assert(bulk_rx - n == bulk_batch);
+        ++polls;
+    }
+    assert(polls == bulk_publish / bulk_batch);
+    assert(outer.poll(std::chrono::seconds(0)) == 0);
+
+    // polls that left data queued
+    goby::middleware::protobuf::TransportStats stats;
+    goby::middleware::TransportStats::summarize(&stats);
+    bool found_bulk = false;
+    for (const auto& group : stats.group())
+    {
+        if (group.layer() == goby::middleware::protobuf::LAYER_INTERTHREAD &&
+            group.group() == std::string(bulk) && group.received() > 0)
+        {
+            found_bulk = true;
+            assert(group.deferred() == bulk_publish / bulk_batch - 1);
+            assert(group.queue_time().count() == bulk_publish);
+        }
+    }
+    assert(found_bulk);
+
+    // with a budget, each poll shares it between the priorities in proportion to their weights
+    // (deficit round-robin)
+    std::string flood_rx;
+    interthread.subscribe<flood_high, int>(
+        [&](const int& i) { flood_rx += 'H'; },
+        make_subscriber<int>(TransporterConfig::QoS::PRIORITY_HIGH));
+    interthread.subscribe<flood_normal, int>(
+        [&](const int& i) { flood_rx += 'N'; },
+        make_subscriber<int>(TransporterConfig::QoS::PRIORITY_NORMAL));
+    interthread.subscribe<flood_low, int>(
+        [&](const int& i) { flood_rx += 'L'; },
+        make_subscriber<int>(TransporterConfig::QoS::PRIORITY_LOW));
+    published = 0;
+    ++subscribed;
+    while (published < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // too small for all the priorities: the others wait while the high priority class uses its
+    // share of 4 ...
+    goby::middleware::PollScheduler::configure(2, {4, 2, 1});
+    outer.pending = 2;
+    assert(outer.poll(std::chrono::seconds(0)) == 2 + 1);
+    assert(outer.poll(std::chrono::seconds(0)) == 2 + 1);
+    assert(flood_rx == "HHHH");
+    // ... but each gets its turn
+    outer.poll(std::chrono::seconds(0));
+    outer.poll(std::chrono::seconds(0));
+    assert(flood_rx == "HHHHNNLH");
+    // the outer layer is still polled every time
+    assert(outer.delivered == 3);
+
+    stats.Clear();
+    goby::middleware::TransportStats::summarize(&stats);
+    int classes_found = 0;
+    for (const auto& priority_class : stats.priority_class())
+    {
+        if (priority_class.layer() != goby::middleware::protobuf::LAYER_INTERTHREAD)
+            continue;
+        ++classes_found;
+        switch (priority_class.priority())
+        {
+            case TransporterConfig::QoS::PRIORITY_HIGH:
+                assert(priority_class.received() == 5);
+                assert(priority_class.deferred() == 4);
+                assert(priority_class.starved() == 1);
+                break;
+            case TransporterConfig::QoS::PRIORITY_NORMAL:
+                assert(priority_class.received() == 2);
+                assert(priority_class.deferred() == 4);
+                assert(priority_class.starved() == 3);
+                break;
+            case TransporterConfig::QoS::PRIORITY_LOW:
+                assert(priority_class.received() == 1);
+                assert(priority_class.deferred() == 4);
+                assert(priority_class.starved() == 3);
+                break;
+            default: assert(false);
+        }
+        assert(priority_class.queue_time().count() == priority_class.received());
+    }
+    assert(classes_found == 3);
+
+    // each round of a larger budget: 4 high, 2 normal, 1 low
+    goby::middleware::PollScheduler::configure(7, {4, 2, 1});
+    flood_rx.clear();
+    outer.poll(std::chrono::seconds(0));
+    // (the high priority class finishes the turn it started in the previous poll)
+    assert(flood_rx == "HHHNNLH");
+    flood_rx.clear();
+    outer.poll(std::chrono::seconds(0));
+    assert(flood_rx == "HHHNNLH");
+
+    // once the high priority class is emptied, the others share the budget
+    while (flood_rx.find('H') != std::string::npos)
+    {
+        flood_rx.clear();
+        outer.poll(std::chrono::seconds(0));
+    }
+    assert(flood_rx.size() == 7);
+    assert(flood_rx.find('N') != std::string::npos && flood_rx.find('L') != std::string::npos);
+
+    // all are delivered
+    goby::middleware::PollScheduler::configure(0, {4, 2, 1});
+    outer.poll(std::chrono::seconds(0));
+    assert(outer.poll(std::chrono::seconds(0)) == 0);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::middleware::TransportStats::set_enabled(true);
+
+    std::thread sub_thread(subscriber);
+    while (subscribed < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    goby::middleware::InterThreadTransporter interthread;
+    for (int i = 0; i < bulk_publish; ++i) interthread.publish<bulk>(i);
+    interthread.publish<status>(std::string("status"));
+    interthread.publish<abort_group>(1.0);
+    ++published;
+
+    while (subscribed < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    interthread.publish<abort_group>(2.0);
+    ++published;
+
+    while (subscribed < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    for (int i = 0; i < flood_publish; ++i)
+    {
+        interthread.publish<flood_low>(i);
+        interthread.publish<flood_normal>(i);
+        interthread.publish<flood_high>(i);
+    }
+    ++published;
+
+    sub_thread.join();
+    std::cout << "all tests passed" << std::endl;
+}
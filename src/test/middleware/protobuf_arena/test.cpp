@@ -0,0 +1,170 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "goby/middleware/marshalling/protobuf.h"
+#include "goby/util/debug_logger.h"
+
+#include "test.pb.h"
+
+using goby::middleware::MarshallingScheme;
+using goby::middleware::ProtobufArenaPool;
+using goby::middleware::SerializerParserHelper;
+using goby::test::middleware::protobuf::Scan;
+
+// count all heap allocations made by this program
+std::atomic<std::uint64_t> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+const int nparse = 20000;
+std::vector<char> bytes;
+Scan scan;
+
+std::shared_ptr<Scan> parse()
+{
+    auto actual_end = bytes.cbegin();
+    auto msg = SerializerParserHelper<Scan, MarshallingScheme::PROTOBUF>::parse(
+        bytes.cbegin(), bytes.cend(), actual_end);
+    assert(actual_end == bytes.cend());
+    return msg;
+}
+
+// returns allocations per message
+double benchmark(const std::string& name)
+{
+    std::uint64_t start_allocations = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nparse; ++i) parse();
+    auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+    double allocations_per_msg = static_cast<double>(allocations - start_allocations) / nparse;
+    std::cout << name << ": " << allocations_per_msg << " allocations/message, "
+              << ns.count() / nparse << " ns/message" << std::endl;
+    return allocations_per_msg;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG1, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    scan.set_time(1580818394000005);
+    scan.set_vehicle("autonomous_underwater_vehicle_1");
+    for (int i = 0; i < 20; ++i)
+    {
+        auto* sample = scan.add_sample();
+        sample->set_sensor("conductivity_temperature_depth_" + std::to_string(i));
+        sample->set_value(i * 1.5);
+    }
+    for (int i = 0; i < 64; ++i) scan.add_beam(i * 0.25);
+    bytes = SerializerParserHelper<Scan, MarshallingScheme::PROTOBUF>::serialize(scan);
+
+    assert(!ProtobufArenaPool::enabled());
+    assert(parse()->SerializeAsString() == scan.SerializeAsString());
+    double heap_allocations = benchmark("std::make_shared");
+    assert(ProtobufArenaPool::thread_stats().arena_messages == 0);
+
+    ProtobufArenaPool::set_enabled(true, 16384, 16);
+    assert(ProtobufArenaPool::enabled());
+    {
+        auto msg = parse();
+        assert(msg->GetArena() != nullptr);
+        assert(msg->SerializeAsString() == scan.SerializeAsString());
+    }
+    double arena_allocations = benchmark("arena");
+    // a single arena is reused for each message
+    assert(ProtobufArenaPool::thread_stats().arenas == 1);
+    assert(ProtobufArenaPool::thread_stats().heap_messages == nparse + 1);
+    // the messages, submessages and repeated fields are allocated on the arena, but the Protobuf
+    // library still allocates the contents of strings longer than the small string buffer
+    // (21 per message here) on the heap
+    const int long_strings = 1 + scan.sample_size();
+    assert(heap_allocations > 3 * long_strings);
+    assert(arena_allocations <= long_strings + 1);
+
+    // arenas are only reused once all references to the message are released
+    {
+        std::vector<std::shared_ptr<const Scan>> msgs;
+        for (int i = 0; i < 10; ++i) msgs.push_back(parse());
+        assert(ProtobufArenaPool::thread_stats().arenas == 10);
+        for (const auto& msg : msgs)
+            assert(msg->SerializeAsString() == scan.SerializeAsString());
+    }
+
+    // messages released by another thread
+    {
+        std::vector<std::shared_ptr<const Scan>> msgs;
+        for (int i = 0; i < 10; ++i) msgs.push_back(parse());
+        assert(ProtobufArenaPool::thread_stats().arenas == 10);
+
+        std::thread t([&msgs]() {
+            for (auto& msg : msgs)
+            {
+                assert(msg->sample_size() == 20);
+                msg.reset();
+            }
+        });
+        t.join();
+
+        for (int i = 0; i < 10; ++i) msgs.push_back(parse());
+        assert(ProtobufArenaPool::thread_stats().arenas == 10);
+    }
+
+    // once the pool is exhausted, messages are allocated on the heap
+    {
+        auto heap_messages = ProtobufArenaPool::thread_stats().heap_messages;
+        std::vector<std::shared_ptr<const Scan>> msgs;
+        for (int i = 0; i < 20; ++i) msgs.push_back(parse());
+        assert(ProtobufArenaPool::thread_stats().arenas == 16);
+        assert(ProtobufArenaPool::thread_stats().heap_messages == heap_messages + 4);
+        assert(msgs.back()->GetArena() == nullptr);
+        assert(msgs.back()->SerializeAsString() == scan.SerializeAsString());
+    }
+
+    // each thread has its own pool
+    std::thread t([]() {
+        assert(ProtobufArenaPool::thread_stats().arenas == 0);
+        assert(parse()->SerializeAsString() == scan.SerializeAsString());
+        assert(ProtobufArenaPool::thread_stats().arenas == 1);
+    });
+    t.join();
+
+    ProtobufArenaPool::set_enabled(false);
+    assert(parse()->GetArena() == nullptr);
+
+    std::cout << "all tests passed" << std::endl;
+}
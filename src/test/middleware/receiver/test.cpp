@@ -0,0 +1,217 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/middleware/application/thread.h"
+#include "goby/middleware/transport/interthread.h"
+#include "goby/util/debug_logger.h"
+
+// tests Receiver (transporter.receiver<group, Data>()) for command -> ack -> status exchanges
+// written as sequential code, and (when compiled as C++20) the coroutine async_receive()
+
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group command_group{"ReceiverCommand"};
+extern constexpr goby::middleware::Group ack_group{"ReceiverAck"};
+extern constexpr goby::middleware::Group status_group{"ReceiverStatus"};
+extern constexpr goby::middleware::Group unused_group{"ReceiverUnused"};
+
+struct Command
+{
+    int id;
+    int statuses; // number of Status messages to send in response
+};
+
+struct Ack
+{
+    int id;
+};
+
+struct Status
+{
+    int id;
+    int index;
+};
+
+std::atomic<bool> responder_ready(false);
+std::atomic<bool> responder_alive(true);
+
+// acks each command (with an ack for another id first), then sends the requested statuses
+void responder()
+{
+    goby::middleware::InterThreadTransporter interthread;
+    interthread.subscribe<command_group>([&](const Command& command) {
+        interthread.publish<ack_group>(Ack{-command.id});
+        interthread.publish<ack_group>(Ack{command.id});
+        for (int i = 0; i < command.statuses; ++i)
+            interthread.publish<status_group>(Status{command.id, i});
+    });
+    responder_ready = true;
+    while (responder_alive) interthread.poll(milliseconds(10));
+}
+
+void test_receive()
+{
+    goby::middleware::InterThreadTransporter interthread;
+    auto acks = interthread.receiver<ack_group, Ack>();
+    auto statuses = interthread.receiver<status_group, Status>();
+    auto unused = interthread.receiver<unused_group, Status>();
+
+    // other subscriptions continue to be handled while receive() waits
+    int unused_callbacks = 0;
+    interthread.subscribe<unused_group>([&](const Status&) { ++unused_callbacks; });
+
+    for (int id = 1; id <= 10; ++id)
+    {
+        interthread.publish<command_group>(Command{id, 1});
+
+        auto ack = acks.receive(seconds(5), [&](const Ack& a) { return a.id == id; });
+        assert(ack);
+        assert(ack->id == id);
+
+        auto status = statuses.receive(seconds(5));
+        assert(status);
+        assert(status->id == id);
+        assert(status->index == 0);
+    }
+    // the ack for the other id was discarded by the matching receive()
+    assert(acks.size() == 0);
+
+    // timeout
+    auto start = system_clock::now();
+    auto none = unused.receive(milliseconds(50));
+    auto elapsed = system_clock::now() - start;
+    assert(!none);
+    assert(elapsed >= milliseconds(50));
+    assert(!unused.try_receive());
+    assert(unused_callbacks == 0);
+
+    // data published before receive() is called are kept
+    interthread.publish<command_group>(Command{20, 3});
+    auto first = acks.receive(seconds(5));
+    assert(first && first->id == -20);
+    while (statuses.size() < 3) interthread.poll(seconds(5));
+    for (int i = 0; i < 3; ++i)
+    {
+        auto status = statuses.try_receive();
+        assert(status && status->index == i);
+    }
+
+    // max_queue discards the oldest
+    auto limited = interthread.receiver<status_group, Status>(
+        goby::middleware::Subscriber<Status>(), 2);
+    interthread.publish<command_group>(Command{30, 5});
+    while (statuses.size() < 5) interthread.poll(seconds(5));
+    assert(limited.size() == 2);
+    assert(limited.receive()->index == 3);
+    assert(limited.receive()->index == 4);
+
+    std::cout << "receive() tests passed" << std::endl;
+}
+
+#if defined(__cpp_impl_coroutine)
+using ThreadBase = goby::middleware::Thread<int, goby::middleware::InterThreadTransporter>;
+
+class CoroutineThread : public ThreadBase
+{
+  public:
+    CoroutineThread() : ThreadBase(0, &interthread_, 0.0) {}
+    bool done{false};
+
+  private:
+    void initialize() override
+    {
+        acks_ = interthread_.receiver<ack_group, Ack>();
+        statuses_ = interthread_.receiver<status_group, Status>();
+        unused_ = interthread_.receiver<unused_group, Status>();
+        use_timers(unused_);
+        exchange();
+    }
+
+    goby::middleware::Coroutine exchange()
+    {
+        for (int id = 100; id < 110; ++id)
+        {
+            interthread_.publish<command_group>(Command{id, 2});
+            auto ack = co_await acks_.async_receive();
+            assert(ack && ack->id == -id);
+            ack = co_await acks_.async_receive();
+            assert(ack && ack->id == id);
+            for (int i = 0; i < 2; ++i)
+            {
+                auto status = co_await statuses_.async_receive();
+                assert(status && status->id == id && status->index == i);
+            }
+        }
+
+        auto start = system_clock::now();
+        auto none = co_await unused_.async_receive(milliseconds(50));
+        assert(!none);
+        assert(system_clock::now() - start >= milliseconds(50));
+
+        done = true;
+        thread_quit();
+    }
+
+    goby::middleware::InterThreadTransporter interthread_;
+    goby::middleware::Receiver<Ack> acks_;
+    goby::middleware::Receiver<Status> statuses_;
+    goby::middleware::Receiver<Status> unused_;
+};
+
+void test_coroutine()
+{
+    CoroutineThread thread;
+    std::atomic<bool> alive{true};
+    std::thread t([&]() { thread.run(alive); });
+    t.join();
+    assert(thread.done);
+    std::cout << "async_receive() tests passed" << std::endl;
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG1, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    std::thread r(responder);
+    while (!responder_ready) std::this_thread::sleep_for(milliseconds(1));
+
+    test_receive();
+#if defined(__cpp_impl_coroutine)
+    test_coroutine();
+#endif
+
+    responder_alive = false;
+    r.join();
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
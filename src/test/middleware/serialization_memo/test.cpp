@@ -0,0 +1,149 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "goby/middleware/marshalling/serialization_memo.h"
+#include "goby/middleware/transport/interprocess.h"
+#include "goby/middleware/transport/interthread.h"
+
+// tests that SerializationMemo / serialize_memoized() encode each scheme at most once per datum
+
+using goby::middleware::SerializationMemo;
+using goby::middleware::SerializeBuffer;
+using goby::middleware::serialize_memoized;
+
+struct Counted
+{
+    std::string value;
+};
+
+constexpr int SCHEME_A{100};
+constexpr int SCHEME_B{101};
+
+int encodes_a = 0;
+int encodes_b = 0;
+
+namespace goby
+{
+namespace middleware
+{
+template <> struct SerializerParserHelper<Counted, SCHEME_A>
+{
+    template <typename Sink> static void serialize(const Counted& msg, Sink* sink)
+    {
+        ++encodes_a;
+        std::memcpy(sink_grow(sink, msg.value.size()), msg.value.data(), msg.value.size());
+    }
+    static std::string type_name(const Counted& d = Counted()) { return "Counted"; }
+};
+
+template <> struct SerializerParserHelper<Counted, SCHEME_B>
+{
+    static std::vector<char> serialize(const Counted& msg)
+    {
+        ++encodes_b;
+        std::vector<char> bytes(msg.value.rbegin(), msg.value.rend());
+        return bytes;
+    }
+    static std::string type_name(const Counted& d = Counted()) { return "Counted"; }
+};
+} // namespace middleware
+} // namespace goby
+
+extern constexpr goby::middleware::Group counted_group{"Counted"};
+
+int main()
+{
+    Counted d{"abcdef"};
+
+    // no memo: each call encodes
+    {
+        std::string s1, s2;
+        serialize_memoized<Counted, SCHEME_A>(d, &s1);
+        serialize_memoized<Counted, SCHEME_A>(d, &s2);
+        assert(encodes_a == 2);
+        assert(s1 == "abcdef" && s2 == s1);
+    }
+
+    encodes_a = 0;
+    // memo: each scheme is encoded once, into any kind of sink, appending to existing contents
+    {
+        SerializationMemo memo(&d);
+        SerializeBuffer buffer;
+        std::string s("prefix:");
+        std::vector<char> v;
+        serialize_memoized<Counted, SCHEME_A>(d, &buffer);
+        serialize_memoized<Counted, SCHEME_A>(d, &s);
+        serialize_memoized<Counted, SCHEME_A>(d, &v);
+        assert(encodes_a == 1);
+        assert(std::string(buffer.begin(), buffer.end()) == "abcdef");
+        assert(s == "prefix:abcdef");
+        assert(std::string(v.begin(), v.end()) == "abcdef");
+
+        std::string b1, b2;
+        serialize_memoized<Counted, SCHEME_B>(d, &b1);
+        serialize_memoized<Counted, SCHEME_B>(d, &b2);
+        assert(encodes_b == 1);
+        assert(b1 == "fedcba" && b2 == b1);
+
+        // other data are not affected, and nested memos do not disturb the outer one
+        Counted other{"xyz"};
+        std::string o1, o2;
+        serialize_memoized<Counted, SCHEME_A>(other, &o1);
+        {
+            SerializationMemo inner(&other);
+            serialize_memoized<Counted, SCHEME_A>(other, &o2);
+            serialize_memoized<Counted, SCHEME_A>(other, &o2);
+            std::string again;
+            serialize_memoized<Counted, SCHEME_A>(d, &again);
+            assert(again == "abcdef");
+        }
+        assert(o1 == "xyz" && o2 == "xyzxyz");
+        assert(encodes_a == 3);
+
+        // an interprocess forwarder reuses the bytes
+        goby::middleware::InterThreadTransporter interthread;
+        goby::middleware::InterProcessForwarder<goby::middleware::InterThreadTransporter>
+            forwarder(interthread);
+        forwarder.publish_dynamic<Counted, SCHEME_A>(d, counted_group);
+        assert(encodes_a == 3);
+    }
+
+    // memo closed: encodes again (storage is reused between memos)
+    {
+        SerializationMemo memo(&d);
+        std::string s;
+        serialize_memoized<Counted, SCHEME_A>(d, &s);
+        assert(encodes_a == 4);
+        assert(s == "abcdef");
+    }
+
+    std::cout << "memo hits: " << SerializationMemo::hits() << std::endl;
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <iostream>
+
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/middleware/marshalling/protobuf.h"
+#include "goby/middleware/protobuf/serializer_transporter.pb.h"
+
+using goby::middleware::MarshallingScheme;
+using goby::middleware::SerializeBuffer;
+using goby::middleware::serialize_into;
+using goby::middleware::SerializerParserHelper;
+using goby::middleware::protobuf::SerializerTransporterMessage;
+
+// a scheme that only provides the std::vector<char> serialize
+struct Legacy
+{
+    std::string value;
+};
+
+constexpr int LEGACY_SCHEME{100};
+
+namespace goby
+{
+namespace middleware
+{
+template <> struct SerializerParserHelper<Legacy, LEGACY_SCHEME>
+{
+    static std::vector<char> serialize(const Legacy& msg)
+    {
+        return std::vector<char>(msg.value.begin(), msg.value.end());
+    }
+};
+} // namespace middleware
+} // namespace goby
+
+template <typename Data, int scheme> void check(const Data& d)
+{
+    auto bytes = SerializerParserHelper<Data, scheme>::serialize(d);
+
+    SerializeBuffer buffer;
+    serialize_into<Data, scheme>(d, &buffer);
+    assert(std::vector<char>(buffer.begin(), buffer.end()) == bytes);
+
+    // appends
+    serialize_into<Data, scheme>(d, &buffer);
+    assert(buffer.size() == 2 * bytes.size());
+    assert(std::equal(bytes.begin(), bytes.end(), buffer.begin() + bytes.size()));
+
+    // reuses storage
+    const char* data = buffer.data();
+    auto capacity = buffer.capacity();
+    for (int i = 0; i < 10; ++i)
+    {
+        buffer.clear();
+        serialize_into<Data, scheme>(d, &buffer);
+        assert(buffer.data() == data && buffer.capacity() == capacity);
+        assert(std::vector<char>(buffer.begin(), buffer.end()) == bytes);
+    }
+
+    // other sinks
+    std::string str("prefix");
+    serialize_into<Data, scheme>(d, &str);
+    assert(str == "prefix" + std::string(bytes.begin(), bytes.end()));
+
+    std::vector<unsigned char> vec;
+    serialize_into<Data, scheme>(d, &vec);
+    assert(vec == std::vector<unsigned char>(bytes.begin(), bytes.end()));
+}
+
+int main(int argc, char* argv[])
+{
+    SerializerTransporterMessage msg;
+    msg.mutable_key()->set_marshalling_scheme(MarshallingScheme::PROTOBUF);
+    msg.mutable_key()->set_type("goby.middleware.protobuf.SerializerTransporterMessage");
+    msg.mutable_key()->set_group("goby::test::serialize_into");
+    msg.set_data(std::string(1000, 'x'));
+
+    check<SerializerTransporterMessage, MarshallingScheme::PROTOBUF>(msg);
+    check<google::protobuf::Message, MarshallingScheme::PROTOBUF>(msg);
+
+    {
+        SerializeBuffer buffer;
+        serialize_into<SerializerTransporterMessage, MarshallingScheme::PROTOBUF>(msg, &buffer);
+        SerializerTransporterMessage parsed;
+        assert(parsed.ParseFromArray(buffer.data(), buffer.size()));
+        assert(parsed.SerializeAsString() == msg.SerializeAsString());
+    }
+
+    // empty message
+    check<SerializerTransporterMessage, MarshallingScheme::PROTOBUF>(
+        SerializerTransporterMessage());
+
+    check<std::string, MarshallingScheme::CSTR>("goby3");
+    check<std::string, MarshallingScheme::CSTR>("");
+
+    // falls back to copying from serialize(msg)
+    check<Legacy, LEGACY_SCHEME>(Legacy{"legacy"});
+
+    std::cout << "all tests passed" << std::endl;
+}
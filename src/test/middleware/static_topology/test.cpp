@@ -0,0 +1,128 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/middleware/transport/interthread.h"
+#include "goby/middleware/transport/static_topology.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/util/debug_logger.h"
+
+// tests that publications to a Group without subscribers in the loaded StaticTopology are dropped,
+// and delivered again once a thread subscribes at run time
+
+extern constexpr goby::middleware::Group dead{"TopologyDead"};
+extern constexpr goby::middleware::Group live{"TopologyLive"};
+extern constexpr goby::middleware::Group unlisted{"TopologyUnlisted"};
+
+std::atomic<int> subscribed(0);
+std::atomic<int> received(0);
+
+std::uint64_t published(const goby::middleware::Group& group)
+{
+    return goby::middleware::TransportStats::group(goby::middleware::protobuf::LAYER_INTERTHREAD,
+                                                   group)
+        .published;
+}
+
+void wait_for(std::atomic<int>& value, int expected)
+{
+    while (value < expected) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    // as generated by goby_clang_tool -topology
+    goby::middleware::StaticTopology::load({{"TopologyDead", 0}, {"TopologyLive", 1}});
+
+    goby::middleware::TransportStats::set_enabled(true);
+
+    std::atomic<bool> subscribe_dead{false};
+    std::atomic<bool> done{false};
+    int live_rx = 0, unlisted_rx = 0, dead_rx = 0;
+
+    std::thread subscriber([&]() {
+        goby::middleware::InterThreadTransporter interthread;
+        interthread.subscribe<live, int>([&](const int&) {
+            ++live_rx;
+            ++received;
+        });
+        interthread.subscribe<unlisted, int>([&](const int&) {
+            ++unlisted_rx;
+            ++received;
+        });
+        ++subscribed;
+
+        while (!done)
+        {
+            if (subscribe_dead && subscribed == 1)
+            {
+                // not in the static topology (e.g. a DynamicGroup subscription)
+                interthread.subscribe<dead, int>([&](const int&) {
+                    ++dead_rx;
+                    ++received;
+                });
+                ++subscribed;
+            }
+            interthread.poll(std::chrono::milliseconds(10));
+        }
+    });
+
+    goby::middleware::InterThreadTransporter interthread;
+    wait_for(subscribed, 1);
+
+    interthread.publish<dead>(1);
+    interthread.publish<live>(1);
+    // groups absent from the topology are always published
+    interthread.publish<unlisted>(1);
+    wait_for(received, 2);
+
+    // the dead publication never reached the SubscriptionStore
+    assert(published(dead) == 0);
+    assert(published(live) == 1);
+    assert(published(unlisted) == 1);
+
+    // a run-time subscription re-enables the group
+    subscribe_dead = true;
+    wait_for(subscribed, 2);
+    interthread.publish<dead>(2);
+    wait_for(received, 3);
+    assert(published(dead) == 1);
+
+    done = true;
+    subscriber.join();
+
+    assert(live_rx == 1);
+    assert(unlisted_rx == 1);
+    assert(dead_rx == 1);
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,151 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "goby/middleware/transport/interthread.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/util/debug_logger.h"
+
+// tests the subscription queue limits (TransporterConfig.qos) of the InterThreadTransporter
+
+using goby::middleware::protobuf::TransporterConfig;
+
+extern constexpr goby::middleware::Group unbounded{"QoSUnbounded"};
+extern constexpr goby::middleware::Group drop_oldest{"QoSDropOldest"};
+extern constexpr goby::middleware::Group drop_newest{"QoSDropNewest"};
+extern constexpr goby::middleware::Group conflate{"QoSConflate"};
+
+const int max_publish = 10;
+const int depth = 3;
+
+std::atomic<int> subscribed(0);
+std::atomic<int> published(0);
+std::atomic<bool> polled(false);
+
+goby::middleware::Subscriber<int> make_subscriber(int max_depth,
+                                                  TransporterConfig::QoS::Overflow overflow,
+                                                  bool conflate = false)
+{
+    TransporterConfig cfg;
+    cfg.mutable_qos()->set_max_depth(max_depth);
+    cfg.mutable_qos()->set_overflow(overflow);
+    cfg.mutable_qos()->set_conflate(conflate);
+    return goby::middleware::Subscriber<int>(cfg);
+}
+
+void subscriber()
+{
+    goby::middleware::InterThreadTransporter interthread;
+    std::vector<int> unbounded_rx, oldest_rx, newest_rx, conflate_rx;
+
+    interthread.subscribe<unbounded, int>([&](const int& i) { unbounded_rx.push_back(i); });
+    auto oldest_sub = make_subscriber(depth, TransporterConfig::QoS::DROP_OLDEST);
+    interthread.subscribe<drop_oldest, int>([&](const int& i) { oldest_rx.push_back(i); },
+                                            oldest_sub);
+    auto newest_sub = make_subscriber(depth, TransporterConfig::QoS::DROP_NEWEST);
+    interthread.subscribe<drop_newest, int>([&](const int& i) { newest_rx.push_back(i); },
+                                            newest_sub);
+    // conflate overrides max_depth and overflow
+    auto conflate_sub = make_subscriber(100, TransporterConfig::QoS::DROP_NEWEST, true);
+    interthread.subscribe<conflate, int>([&](const int& i) { conflate_rx.push_back(i); },
+                                         conflate_sub);
+    ++subscribed;
+
+    // let the publisher fill the queues before polling
+    while (published < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    interthread.poll(std::chrono::seconds(0));
+
+    assert(unbounded_rx.size() == max_publish);
+    assert(interthread.subscription_drops<int>(unbounded) == 0);
+
+    // newest data are kept
+    assert((oldest_rx == std::vector<int>{7, 8, 9}));
+    assert(interthread.subscription_drops<int>(drop_oldest) == max_publish - depth);
+
+    // oldest data are kept
+    assert((newest_rx == std::vector<int>{0, 1, 2}));
+    assert(interthread.subscription_drops<int>(drop_newest) == max_publish - depth);
+
+    assert((conflate_rx == std::vector<int>{9}));
+    assert(interthread.subscription_drops<int>(conflate) == max_publish - 1);
+
+    polled = true;
+
+    // limits apply to each poll: a queue that doesn't fill up loses nothing
+    while (published < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    interthread.poll(std::chrono::seconds(0));
+    assert((oldest_rx == std::vector<int>{7, 8, 9, 100, 101}));
+    assert(interthread.subscription_drops<int>(drop_oldest) == max_publish - depth);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    goby::middleware::TransportStats::set_enabled(true);
+
+    std::thread sub_thread(subscriber);
+    while (subscribed < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    goby::middleware::InterThreadTransporter interthread;
+    for (int i = 0; i < max_publish; ++i)
+    {
+        interthread.publish<unbounded>(i);
+        interthread.publish<drop_oldest>(i);
+        interthread.publish<drop_newest>(i);
+        interthread.publish<conflate>(i);
+    }
+    ++published;
+
+    while (!polled) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    interthread.publish<drop_oldest>(100);
+    interthread.publish<drop_oldest>(101);
+    ++published;
+
+    sub_thread.join();
+
+    goby::middleware::protobuf::TransportStats report;
+    goby::middleware::TransportStats::summarize(&report);
+    std::cout << report.DebugString() << std::endl;
+    int groups_found = 0;
+    for (const auto& group : report.group())
+    {
+        if (group.group() == "QoSUnbounded")
+            assert(group.dropped() == 0);
+        else if (group.group() == "QoSConflate")
+            assert(group.dropped() == max_publish - 1);
+        else
+            assert(group.dropped() == max_publish - depth);
+        ++groups_found;
+    }
+    assert(groups_found == 4);
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
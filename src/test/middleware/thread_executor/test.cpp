@@ -0,0 +1,342 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <iostream>
+#include <sys/resource.h>
+#include <thread>
+#include <unordered_set>
+
+#include "goby/middleware/application/thread.h"
+#include "goby/middleware/application/thread_executor.h"
+#include "goby/middleware/transport/interthread.h"
+#include "goby/util/debug_logger.h"
+
+// tests running Threads as tasks on a ThreadExecutor, and compares a ring of threads passing a
+// token using one std::thread per Thread and using the ThreadExecutor
+
+using namespace std::chrono;
+using goby::middleware::ThreadExecutor;
+using goby::middleware::ThreadId;
+
+extern constexpr goby::middleware::Group echo_group{"ThreadExecutorEcho"};
+extern constexpr goby::middleware::Group done_group{"ThreadExecutorDone"};
+
+using ThreadBase = goby::middleware::Thread<int, goby::middleware::InterThreadTransporter>;
+
+std::vector<std::unique_ptr<goby::middleware::DynamicGroup>> ring_groups;
+std::atomic<int> ready(0);
+
+// kept outside the threads, which are destroyed by the task (or std::thread) running them
+struct RingStats
+{
+    ThreadId id;
+    std::unordered_set<ThreadId> callback_ids;
+    std::vector<int> hops;
+    std::vector<int> echoed_hops;
+};
+
+// receives the token (hop count) from the previous thread in the ring and passes it on
+class RingThread : public ThreadBase
+{
+  public:
+    RingThread(int index, int hops, RingStats* stats)
+        : ThreadBase(0, &interthread_, 0, index), hops_(hops), stats_(*stats)
+    {
+    }
+
+  private:
+    void initialize() override
+    {
+        stats_.id = goby::middleware::this_thread_id();
+        interthread_.subscribe_dynamic<int>([this](const int& hop) { handle(hop); },
+                                            *ring_groups[index()]);
+        // receives the hops published by the other threads, but not its own, as echo is false
+        interthread_.subscribe<echo_group, int>(
+            [this](const int& hop) { stats_.echoed_hops.push_back(hop); });
+        interthread_.subscribe<done_group, int>([this](const int&) { thread_quit(); });
+        ++ready;
+    }
+
+    void handle(int hop)
+    {
+        stats_.callback_ids.insert(goby::middleware::this_thread_id());
+        // hops arrive in order
+        assert(hop > last_hop_);
+        last_hop_ = hop;
+        stats_.hops.push_back(hop);
+
+        // only on the first lap, so the benchmark measures passing the token
+        if (hop <= static_cast<int>(ring_groups.size()))
+            interthread_.publish<echo_group>(hop);
+        if (hop == hops_)
+        {
+            interthread_.publish<done_group>(hop);
+            thread_quit();
+        }
+        else
+        {
+            const auto& next_group = *ring_groups[(index() + 1) % ring_groups.size()];
+            interthread_.publish_dynamic(hop + 1, next_group);
+        }
+    }
+
+  private:
+    goby::middleware::InterThreadTransporter interthread_;
+    int hops_;
+    RingStats& stats_;
+    int last_hop_{0};
+};
+
+struct TimedStats
+{
+    int loops{0};
+    int timers{0};
+    system_clock::time_point start_time;
+    system_clock::time_point end_time;
+};
+
+// quits itself using a timer and loop()
+class TimedThread : public ThreadBase
+{
+  public:
+    TimedThread(TimedStats* stats) : ThreadBase(0, &interthread_, 100.0), stats_(*stats) {}
+
+  private:
+    void initialize() override
+    {
+        stats_.start_time = system_clock::now();
+        add_periodic_timer(milliseconds(5), [this]() { ++stats_.timers; });
+        add_timer(milliseconds(100), [this]() {
+            stats_.end_time = system_clock::now();
+            thread_quit();
+        });
+    }
+    void loop() override { ++stats_.loops; }
+
+    goby::middleware::InterThreadTransporter interthread_;
+    TimedStats& stats_;
+};
+
+struct RingResult
+{
+    double seconds;
+    long context_switches;
+};
+
+long context_switches()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// passes the token around a ring of n threads for the given number of hops, either with one
+// std::thread per RingThread (executor == nullptr) or as tasks on the executor
+RingResult run_ring(int n, int hops, ThreadExecutor* executor, bool check)
+{
+    ring_groups.clear();
+    for (int i = 0; i < n; ++i)
+        ring_groups.emplace_back(new goby::middleware::DynamicGroup("ring" + std::to_string(i)));
+    ready = 0;
+
+    std::deque<std::atomic<bool>> alive(n);
+    std::vector<RingStats> stats(n);
+    std::vector<std::thread> os_threads;
+    std::vector<std::shared_ptr<ThreadExecutor::Task>> tasks;
+    std::atomic<int> finished(0);
+
+    for (int i = 0; i < n; ++i)
+    {
+        alive[i] = true;
+        auto make_thread = [&stats, i, hops]() {
+            return std::make_shared<RingThread>(i, hops, &stats[i]);
+        };
+
+        if (executor)
+        {
+            tasks.push_back(executor->launch<RingThread>(
+                make_thread, alive[i], [&finished](std::exception_ptr e) {
+                    assert(!e);
+                    ++finished;
+                }));
+        }
+        else
+        {
+            os_threads.emplace_back([&alive, &finished, make_thread, i]() {
+                make_thread()->run(alive[i]);
+                ++finished;
+            });
+        }
+    }
+
+    goby::middleware::InterThreadTransporter interthread;
+    std::atomic<bool> done(false);
+    interthread.subscribe<done_group, int>([&](const int&) { done = true; });
+
+    while (ready < n) std::this_thread::sleep_for(milliseconds(1));
+
+    auto cs_start = context_switches();
+    auto start = steady_clock::now();
+    interthread.publish_dynamic(1, *ring_groups[0]);
+    while (!done) interthread.poll();
+    RingResult result{duration<double>(steady_clock::now() - start).count(),
+                      context_switches() - cs_start};
+
+    for (auto& t : os_threads) t.join();
+    for (auto& task : tasks)
+    {
+        task->wait();
+        assert(task->finished());
+    }
+    assert(finished == n);
+
+    if (check)
+    {
+        std::unordered_set<ThreadId> ids;
+        for (int i = 0; i < n; ++i)
+        {
+            const auto& thread = stats[i];
+            // each thread is visited once per lap
+            assert(static_cast<int>(thread.hops.size()) == hops / n + (i < hops % n ? 1 : 0));
+            for (auto hop : thread.echoed_hops) assert((hop - 1) % n != i);
+            // callbacks always run as the thread (task) that subscribed, whichever worker runs it
+            assert(thread.callback_ids.size() == 1);
+            assert(*thread.callback_ids.begin() == thread.id);
+            assert(thread.id.is_task() == (executor != nullptr));
+            if (executor)
+                assert(thread.id == tasks[i]->id());
+            ids.insert(thread.id);
+        }
+        assert(static_cast<int>(ids.size()) == n);
+    }
+
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG1, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    // correctness: more tasks than workers
+    {
+        using goby::middleware::detail::SubscriptionStoreBase;
+        auto thread_count = SubscriptionStoreBase::thread_count();
+
+        ThreadExecutor executor(2);
+        assert(executor.workers() == 2);
+        run_ring(8, 1000, &executor, true);
+        // the subscription state of finished tasks (whose ids are never reused) is removed
+        assert(SubscriptionStoreBase::thread_count() == thread_count);
+        run_ring(8, 1000, nullptr, true);
+        assert(SubscriptionStoreBase::thread_count() == thread_count);
+    }
+
+    // loop() and timers; several at once on one worker
+    {
+        ThreadExecutor executor(1);
+        const int n = 4;
+        std::deque<std::atomic<bool>> alive(n);
+        std::vector<TimedStats> stats(n);
+        std::vector<std::shared_ptr<ThreadExecutor::Task>> tasks;
+        for (int i = 0; i < n; ++i)
+        {
+            alive[i] = true;
+            tasks.push_back(executor.launch<TimedThread>(
+                [&stats, i]() { return std::make_shared<TimedThread>(&stats[i]); }, alive[i],
+                [](std::exception_ptr e) { assert(!e); }));
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            tasks[i]->wait();
+            const auto& thread = stats[i];
+            std::cout << "loops: " << thread.loops << ", timers: " << thread.timers << std::endl;
+            assert(!alive[i]);
+            assert(thread.end_time - thread.start_time >= milliseconds(100));
+            // ~10 loops and ~20 timers in 100 ms, allowing for a slow machine
+            assert(thread.loops >= 5 && thread.loops <= 11);
+            assert(thread.timers >= 10 && thread.timers <= 20);
+        }
+    }
+
+    // shutdown from outside the task, and exceptions
+    {
+        struct ThrowingThread : public ThreadBase
+        {
+            ThrowingThread() : ThreadBase(0, &interthread_, 0) {}
+            void initialize() override { throw(std::runtime_error("initialize")); }
+            goby::middleware::InterThreadTransporter interthread_;
+        };
+
+        struct IdleThread : public ThreadBase
+        {
+            IdleThread() : ThreadBase(0, &interthread_, 0) {}
+            goby::middleware::InterThreadTransporter interthread_;
+        };
+
+        ThreadExecutor executor(2);
+        std::atomic<bool> alive_idle{true}, alive_throw{true};
+        std::exception_ptr idle_exception, throw_exception;
+        auto idle = executor.launch<IdleThread>([]() { return std::make_shared<IdleThread>(); },
+                                                alive_idle,
+                                                [&](std::exception_ptr e) { idle_exception = e; });
+        auto throwing = executor.launch<ThrowingThread>(
+            []() { return std::make_shared<ThrowingThread>(); }, alive_throw,
+            [&](std::exception_ptr e) { throw_exception = e; });
+
+        throwing->wait();
+        assert(throw_exception);
+
+        std::this_thread::sleep_for(milliseconds(10));
+        bool idle_finished = idle->finished();
+        assert(!idle_finished);
+        alive_idle = false;
+        idle->wake();
+        idle->wait();
+        assert(!idle_exception);
+    }
+
+    // benchmark: many threads each doing very little work per message
+    {
+        const int n = 32;
+        const int hops = 20000;
+        auto os = run_ring(n, hops, nullptr, false);
+        ThreadExecutor executor(2);
+        auto ex = run_ring(n, hops, &executor, false);
+
+        std::cout << "ring of " << n << " threads, " << hops << " hops:" << std::endl;
+        std::cout << "  std::thread per Thread: " << os.seconds / hops * 1e6 << " us/hop, "
+                  << os.context_switches << " context switches" << std::endl;
+        std::cout << "  ThreadExecutor (" << executor.workers()
+                  << " workers): " << ex.seconds / hops * 1e6 << " us/hop, "
+                  << ex.context_switches << " context switches" << std::endl;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
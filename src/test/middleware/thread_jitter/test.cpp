@@ -0,0 +1,137 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/exception.h"
+#include "goby/middleware/application/thread.h"
+#include "goby/middleware/application/thread_scheduling.h"
+#include "goby/middleware/transport/interthread.h"
+#include "goby/util/debug_logger.h"
+
+// measures the loop() jitter of a Thread running at 1 kHz, with and without competing load and
+// real-time scheduling (which is only applied if the process has the privileges to do so)
+
+using namespace std::chrono;
+using goby::middleware::protobuf::ThreadScheduling;
+
+constexpr int loops = 1000;
+
+using ThreadBase = goby::middleware::Thread<int, goby::middleware::InterThreadTransporter>;
+
+class ControlThread : public ThreadBase
+{
+  public:
+    ControlThread() : ThreadBase(0, &interthread_, 1000.0) {}
+    int loop_count{0};
+
+  private:
+    void loop() override
+    {
+        if (++loop_count == loops)
+            thread_quit();
+    }
+
+    goby::middleware::InterThreadTransporter interthread_;
+};
+
+void run(const std::string& name, const ThreadScheduling* scheduling, int load_threads)
+{
+    std::atomic<bool> load_alive{true};
+    std::vector<std::thread> load;
+    for (int i = 0; i < load_threads; ++i)
+        load.emplace_back([&]() {
+            volatile unsigned long long x = 0;
+            while (load_alive) ++x;
+        });
+
+    ControlThread thread;
+    std::atomic<bool> alive{true};
+    std::thread t([&]() {
+        if (scheduling)
+            goby::middleware::apply_thread_scheduling(*scheduling, name);
+        thread.run(alive);
+    });
+    t.join();
+    load_alive = false;
+    for (auto& l : load) l.join();
+
+    const auto& jitter = thread.loop_jitter();
+    std::cout << name << " (" << load_threads << " load threads): lateness (us) p50: "
+              << jitter.value_at_percentile(50) << ", p99: " << jitter.value_at_percentile(99)
+              << ", p99.9: " << jitter.value_at_percentile(99.9) << ", max: " << jitter.max()
+              << std::endl;
+
+    assert(thread.loop_count == loops);
+    assert(jitter.count() == static_cast<std::uint64_t>(loops));
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG1, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    // errors are thrown only if required
+    {
+        ThreadScheduling bad_cpu;
+        bad_cpu.add_cpu(1023);
+        goby::middleware::apply_thread_scheduling(bad_cpu, "bad_cpu_not_required");
+
+        bad_cpu.set_required(true);
+        bool threw = false;
+        try
+        {
+            goby::middleware::apply_thread_scheduling(bad_cpu, "bad_cpu_required");
+        }
+        catch (goby::Exception& e)
+        {
+            std::cout << "Expected exception: " << e.what() << std::endl;
+            threw = true;
+        }
+        assert(threw);
+
+        ThreadScheduling cpu0;
+        cpu0.add_cpu(0);
+        cpu0.set_policy(ThreadScheduling::POLICY_DEFAULT);
+        cpu0.set_required(true);
+        std::thread t([&]() { goby::middleware::apply_thread_scheduling(cpu0, "cpu0"); });
+        t.join();
+    }
+
+    int load_threads = std::thread::hardware_concurrency();
+
+    ThreadScheduling fifo;
+    fifo.set_policy(ThreadScheduling::POLICY_FIFO);
+    fifo.set_priority(80);
+
+    run("default", nullptr, 0);
+    run("default", nullptr, load_threads);
+    run("fifo", &fifo, load_threads);
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/middleware/application/thread.h"
+#include "goby/middleware/transport/interthread.h"
+#include "goby/util/debug_logger.h"
+
+// tests the timers run by Thread (add_timer(), add_periodic_timer(), cancel_timer())
+
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group data_group{"ThreadTimerData"};
+
+std::atomic<bool> subscribed(false);
+
+using ThreadBase = goby::middleware::Thread<int, goby::middleware::InterThreadTransporter>;
+
+class TimerTestThread : public ThreadBase
+{
+  public:
+    TimerTestThread(double loop_freq_hertz) : ThreadBase(0, &interthread_, loop_freq_hertz) {}
+
+    int loops{0};
+    int received{0};
+    int one_shot{0};
+    int periodic{0};
+    int self_cancelled{0};
+    int cancelled{0};
+    int chained{0};
+    int many{0};
+    system_clock::time_point start;
+    system_clock::time_point one_shot_time;
+
+  private:
+    void initialize() override
+    {
+        interthread_.subscribe<data_group, int>([this](const int&) { ++received; });
+        subscribed = true;
+
+        start = system_clock::now();
+        add_timer(milliseconds(20), [this]() {
+            ++one_shot;
+            one_shot_time = system_clock::now();
+        });
+        add_periodic_timer(milliseconds(10), [this]() { ++periodic; });
+
+        self_id_ = add_periodic_timer(milliseconds(5), [this]() {
+            if (++self_cancelled == 3)
+            {
+                bool was_pending = cancel_timer(self_id_);
+                assert(was_pending);
+            }
+        });
+
+        TimerId cancelled_id = add_timer(milliseconds(30), [this]() { ++cancelled; });
+        bool was_pending = cancel_timer(cancelled_id);
+        assert(was_pending);
+        was_pending = cancel_timer(cancelled_id);
+        assert(!was_pending);
+
+        // timers added from within a timer callback
+        add_timer(milliseconds(10), [this]() {
+            ++chained;
+            add_timer(milliseconds(10), [this]() { ++chained; });
+        });
+
+        // many timers don't need any more threads
+        for (int i = 0; i < 1000; ++i)
+            add_timer(milliseconds(1 + i % 50), [this]() { ++many; });
+
+        add_timer(milliseconds(200), [this]() { thread_quit(); });
+    }
+
+    void loop() override { ++loops; }
+
+  private:
+    goby::middleware::InterThreadTransporter interthread_;
+    TimerId self_id_;
+};
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    // without loop()
+    {
+        std::atomic<bool> alive{true};
+        TimerTestThread thread(0);
+        std::thread t([&]() { thread.run(alive); });
+
+        // data is still received between timers
+        while (!subscribed) std::this_thread::sleep_for(milliseconds(1));
+        goby::middleware::InterThreadTransporter interthread;
+        for (int i = 0; i < 10; ++i) interthread.publish<data_group>(i);
+        t.join();
+
+        std::cout << "periodic: " << thread.periodic << ", one_shot delay: "
+                  << duration_cast<microseconds>(thread.one_shot_time - thread.start).count()
+                  << " us" << std::endl;
+
+        assert(thread.loops == 0);
+        assert(thread.received == 10);
+        assert(thread.one_shot == 1);
+        // never early
+        assert(thread.one_shot_time - thread.start >= milliseconds(20));
+        // ~20 in 200 ms, allowing for a slow machine
+        assert(thread.periodic >= 10 && thread.periodic <= 20);
+        assert(thread.self_cancelled == 3);
+        assert(thread.cancelled == 0);
+        assert(thread.chained == 2);
+        assert(thread.many == 1000);
+    }
+
+    // timers interleaved with loop()
+    {
+        subscribed = false;
+        std::atomic<bool> alive{true};
+        TimerTestThread thread(50);
+        std::thread t([&]() { thread.run(alive); });
+        t.join();
+
+        std::cout << "loops: " << thread.loops << ", periodic: " << thread.periodic << std::endl;
+        assert(thread.loops >= 5 && thread.loops <= 11);
+        assert(thread.periodic >= 10 && thread.periodic <= 20);
+        assert(thread.many == 1000);
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright 2018-2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "goby/middleware/transport/interthread.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/util/debug_logger.h"
+
+// tests LatencyHistogram and the InterThreadTransporter instrumentation
+
+using goby::middleware::LatencyHistogram;
+using goby::middleware::TransportStats;
+
+extern constexpr goby::middleware::Group stats_test{"StatsTest"};
+
+std::atomic<int> ready(0);
+const int max_publish = 1000;
+
+void test_histogram()
+{
+    LatencyHistogram hist;
+    assert(hist.count() == 0);
+    assert(hist.value_at_percentile(50) == 0);
+
+    for (std::uint64_t v = 1; v <= 10000; ++v) hist.record(v);
+    assert(hist.count() == 10000);
+    assert(hist.max() == 10000);
+
+    // within the 1/16 relative resolution of the histogram, never below the true value
+    for (double pct : {50.0, 90.0, 99.0})
+    {
+        auto expected = static_cast<std::uint64_t>(pct * 100);
+        auto value = hist.value_at_percentile(pct);
+        std::cout << "p" << pct << ": " << value << " (expected " << expected << ")" << std::endl;
+        assert(value >= expected);
+        assert(value <= expected + expected / 16);
+    }
+    assert(hist.value_at_percentile(100) == 10000);
+
+    // exact for small values
+    LatencyHistogram small;
+    for (int i = 0; i < 10; ++i) small.record(std::chrono::microseconds(7));
+    assert(small.value_at_percentile(50) == 7);
+
+    // very large values are clamped to the top bucket, but max is exact
+    LatencyHistogram large;
+    large.record(std::numeric_limits<std::uint64_t>::max());
+    assert(large.count() == 1);
+    assert(large.max() == std::numeric_limits<std::uint64_t>::max());
+
+    hist.reset();
+    assert(hist.count() == 0);
+    assert(hist.max() == 0);
+}
+
+void subscriber()
+{
+    goby::middleware::InterThreadTransporter interthread;
+    int received = 0;
+    interthread.subscribe<stats_test, int>([&](const int& i) {
+        ++received;
+        // give the handler some measurable duration
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    });
+    ++ready;
+    while (received < max_publish) interthread.poll();
+}
+
+void test_interthread()
+{
+    TransportStats::set_enabled(true);
+
+    // clear anything recorded before this test
+    goby::middleware::protobuf::TransportStats discard;
+    TransportStats::summarize(&discard);
+
+    std::thread sub_thread(subscriber);
+    while (ready < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    goby::middleware::InterThreadTransporter interthread;
+    for (int i = 0; i < max_publish; ++i) interthread.publish<stats_test>(i);
+    sub_thread.join();
+
+    goby::middleware::protobuf::TransportStats report;
+    TransportStats::summarize(&report);
+    std::cout << report.DebugString() << std::endl;
+
+    bool found = false;
+    for (const auto& group : report.group())
+    {
+        if (group.group() != "StatsTest")
+            continue;
+        found = true;
+        assert(group.layer() == goby::middleware::protobuf::LAYER_INTERTHREAD);
+        assert(group.published() == max_publish);
+        assert(group.received() == max_publish);
+        assert(group.queue_time().count() == max_publish);
+        assert(group.handler_time().count() == max_publish);
+        assert(group.handler_time().p50() >= 10);
+    }
+    assert(found);
+
+    // counters reset after each summary
+    goby::middleware::protobuf::TransportStats empty;
+    TransportStats::summarize(&empty);
+    assert(empty.group_size() == 0);
+
+    TransportStats::set_enabled(false);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &std::cerr);
+    goby::glog.set_name(argv[0]);
+
+    test_histogram();
+    test_interthread();
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -22,6 +22,8 @@
 // You should have received a copy of the GNU General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cmath>
+
 #include "goby/util/binary.h"
 #include "goby/util/linebasedcomms.h"
 
@@ -67,6 +69,73 @@ int main()
         assert(nmea.as<int>(2) == 1);
     }
 
+    {
+        std::string in("$YXXDR,A,0.3,D,PTCH,A,13.3,D,ROLL*6f ");
+        goby::util::NMEASentence nmea(in);
+        goby::util::NMEASentenceView view(in);
+        assert(view.size() == nmea.size());
+        for (std::size_t i = 0, n = nmea.size(); i < n; ++i) assert(view[i] == nmea[i]);
+        assert(view.talker_id() == "YX");
+        assert(view.sentence_id() == "XDR");
+        assert(view.as<double>(2) == nmea.as<double>(2));
+        assert(view.as<double>(6) == 13.3);
+        assert(view.as<std::string>(8) == "ROLL");
+        assert(view.message_no_cs() == nmea.message_no_cs());
+        assert(view.to_sentence().message() == nmea.message());
+    }
+
+    {
+        goby::util::NMEASentenceView view("$CCTXD,2,-1,,x,1e3*45",
+                                          goby::util::NMEASentence::IGNORE);
+        assert(view.as<int>(1) == 2);
+        assert(view.as<int>(2) == -1);
+        assert(view.as<unsigned>(2) == std::numeric_limits<unsigned>::max());
+        assert(view.as<int>(3) == std::numeric_limits<int>::max());
+        assert(std::isnan(view.as<double>(3)));
+        assert(std::isnan(view.as<double>(4)));
+        assert(view.as<double>(5) == 1000);
+        assert(view.as<bool>(1) == false);
+        assert(goby::util::NMEASentenceView::field_as<double>(view[5].substr(2)) == 3);
+
+        bool caught = false;
+        try
+        {
+            view.at(6);
+        }
+        catch (std::out_of_range&)
+        {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    for (const auto& bad : {"", "CCTXD,2,1,1*56", "$CCTXD,2,1,1*57", "$CCTX,2,1,1*12"})
+    {
+        bool caught = false;
+        try
+        {
+            goby::util::NMEASentenceView view(bad);
+        }
+        catch (goby::util::bad_nmea_sentence& e)
+        {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    {
+        bool caught = false;
+        try
+        {
+            goby::util::NMEASentenceView view("$CCTXD,2,1,1", goby::util::NMEASentence::REQUIRE);
+        }
+        catch (goby::util::bad_nmea_sentence& e)
+        {
+            caught = true;
+        }
+        assert(caught);
+    }
+
     std::cout << "all tests passed" << std::endl;
 
     return 0;
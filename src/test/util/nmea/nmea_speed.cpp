@@ -0,0 +1,106 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// parse throughput comparison of NMEASentence (one std::string per field) and NMEASentenceView (zero-copy)
+
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "goby/util/linebasedcomms/nmea_sentence.h"
+
+const int num_iterations = 20000;
+
+// representative high rate sentences (frontseat navigation, modem statistics, GPS)
+const std::vector<std::string> sentences{
+    "$BFNVG,143000.52,4140.6350,N,07040.0155,W,1,0.0,12.3,213.5,-0.6,1.3,143000.50*70",
+    "$CACST,6,0,20120522154401.0000,3,-95,71,160,0.13,0,6,1,1,-1,1,0,1,0,0,18.2,-1.0,-2.5,-4,1.2,"
+    "19.80,-0.2,-0.7,10000,2000*45",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"};
+
+template <typename Function> double sentences_per_second(Function f)
+{
+    auto start = std::chrono::steady_clock::now();
+    double sum = 0;
+    for (int i = 0; i < num_iterations; ++i)
+        for (const auto& s : sentences) sum += f(s);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // keep the compiler from eliding the parse
+    volatile double result = sum;
+    (void)result;
+
+    return num_iterations * sentences.size() / elapsed.count();
+}
+
+int main()
+{
+    // sum every numeric field so that both parse and conversion are timed
+    auto sentence_rate = sentences_per_second([](const std::string& s) {
+        goby::util::NMEASentence nmea(s, goby::util::NMEASentence::VALIDATE);
+        double sum = 0;
+        for (int i = 1, n = nmea.size(); i < n; ++i)
+        {
+            double value = nmea.as<double>(i);
+            if (value == value)
+                sum += value;
+        }
+        return sum;
+    });
+
+    auto view_rate = sentences_per_second([](const std::string& s) {
+        goby::util::NMEASentenceView nmea(s, goby::util::NMEASentence::VALIDATE);
+        double sum = 0;
+        for (int i = 1, n = nmea.size(); i < n; ++i)
+        {
+            double value = nmea.as<double>(i);
+            if (value == value)
+                sum += value;
+        }
+        return sum;
+    });
+
+    // both parsers must agree
+    for (const auto& s : sentences)
+    {
+        goby::util::NMEASentence nmea(s);
+        goby::util::NMEASentenceView view(s);
+        assert(nmea.size() == view.size());
+        for (int i = 1, n = nmea.size(); i < n; ++i)
+        {
+            double a = nmea.as<double>(i), b = view.as<double>(i);
+            assert((a != a && b != b) || a == b);
+        }
+    }
+
+    std::cout << std::scientific << std::setprecision(3) << "NMEASentence: " << sentence_rate
+              << " sentences/s, NMEASentenceView: " << view_rate << " sentences/s, speedup: "
+              << std::fixed << std::setprecision(1) << view_rate / sentence_rate << "x"
+              << std::endl;
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
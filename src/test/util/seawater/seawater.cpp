@@ -257,3 +257,61 @@ BOOST_AUTO_TEST_CASE(density_anomaly_check_value)
                              expected_density_anomaly / si::kilograms_per_cubic_meter,
                              expected_precision));
 }
+
+BOOST_AUTO_TEST_CASE(batch_matches_scalar)
+{
+    using boost::units::si::deci;
+    using goby::util::seawater::bar;
+    namespace batch = goby::util::seawater::batch;
+
+    const int n = 5;
+    double temperature[n] = {-1.0, 4.0, 12.5, 25.0, 40.0};
+    double salinity[n] = {34.0, 35.0, 30.0, 35.0, 35.0};
+    double depth[n] = {10.0, 500.0, 2000.0, 1000.0, 9000.0};
+    double soundspeed[n];
+    std::uint8_t out_of_range[n];
+
+    auto num_out_of_range =
+        batch::mackenzie_soundspeed(temperature, salinity, depth, soundspeed, n, out_of_range);
+
+    BOOST_CHECK_EQUAL(num_out_of_range, 1);
+    for (int i = 0; i < n - 1; ++i)
+    {
+        BOOST_CHECK_EQUAL(out_of_range[i], goby::util::seawater::IN_RANGE);
+        auto expected = goby::util::seawater::mackenzie_soundspeed(
+            temperature[i] * absolute<celsius::temperature>(),
+            quantity<si::dimensionless>(salinity[i]), depth[i] * si::meters);
+        BOOST_CHECK(close_enough(soundspeed[i], expected / si::meters_per_second, 9));
+    }
+    BOOST_CHECK_EQUAL(out_of_range[n - 1], goby::util::seawater::TEMPERATURE_OUT_OF_RANGE |
+                                               goby::util::seawater::DEPTH_OUT_OF_RANGE);
+
+    // same cast: pressure <-> depth
+    double pressure[n];
+    double latitude = 30.0;
+    batch::pressure(depth, latitude, pressure, n);
+    double depth_out[n];
+    batch::depth(pressure, latitude, depth_out, n);
+    for (int i = 0; i < n; ++i)
+    {
+        auto expected_pressure =
+            goby::util::seawater::pressure(depth[i] * si::meters, latitude * degree::degrees);
+        BOOST_CHECK(close_enough(pressure[i], expected_pressure.value(), 9));
+        auto expected_depth = goby::util::seawater::depth(pressure[i] * deci * bar,
+                                                          latitude * degree::degrees);
+        BOOST_CHECK(close_enough(depth_out[i], expected_depth / si::meters, 9));
+    }
+
+    // salinity, including the zero conductivity trap
+    double conductivity[n] = {0.0, 1.888091 * 42.914, 30.0, 42.914, 55.0};
+    double salinity_out[n];
+    batch::salinity(conductivity, temperature, pressure, salinity_out, n);
+    for (int i = 0; i < n; ++i)
+    {
+        double expected_salinity = goby::util::seawater::salinity(
+            conductivity[i] * goby::util::seawater::milli_siemens_per_cm,
+            temperature[i] * absolute<celsius::temperature>(), pressure[i] * deci * bar);
+        BOOST_CHECK(close_enough(salinity_out[i], expected_salinity, 9));
+    }
+    BOOST_CHECK_EQUAL(salinity_out[0], 0.0);
+}
@@ -0,0 +1,211 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+// throughput comparison of the scalar (boost::units) and batch (array) seawater functions
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <boost/units/systems/si/prefixes.hpp>
+
+#include "goby/util/seawater.h"
+
+using namespace boost::units;
+
+namespace batch = goby::util::seawater::batch;
+
+// simulated 10 kHz CTD cast
+const std::size_t num_samples = 1000000;
+
+template <typename Function> double samples_per_second(Function f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_samples / elapsed.count();
+}
+
+// batch results must match the scalar functions (to floating point rounding)
+bool agree(const std::string& name, const std::vector<double>& scalar,
+           const std::vector<double>& batch)
+{
+    for (std::size_t i = 0; i < num_samples; ++i)
+    {
+        if (std::abs(scalar[i] - batch[i]) > 1e-9 * std::max(1.0, std::abs(scalar[i])))
+        {
+            std::cerr << name << ": mismatch at sample " << i << ": " << std::setprecision(17)
+                      << scalar[i] << " != " << batch[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void report(const std::string& name, double scalar_rate, double batch_rate)
+{
+    std::cout << std::setw(12) << name << ": scalar: " << std::scientific << std::setprecision(3)
+              << scalar_rate << " samples/s, batch: " << batch_rate
+              << " samples/s, speedup: " << std::fixed << std::setprecision(1)
+              << batch_rate / scalar_rate << "x" << std::endl;
+}
+
+int main()
+{
+    std::vector<double> temperature(num_samples), salinity(num_samples), depth(num_samples),
+        conductivity(num_samples), pressure(num_samples), output(num_samples),
+        scalar_output(num_samples);
+    std::vector<std::uint8_t> out_of_range(num_samples), scalar_threw(num_samples);
+
+    for (std::size_t i = 0; i < num_samples; ++i)
+    {
+        double frac = static_cast<double>(i) / num_samples;
+        // 1% of samples above the surface (e.g. while the CTD is on deck), which are out of range for Mackenzie
+        depth[i] = (i % 100 == 0) ? -1 : 4000 * frac;
+        temperature[i] = 2 + 20 * std::exp(-depth[i] / 500);
+        salinity[i] = 34 + std::sin(frac * 50);
+        // and a few with out of range temperature and/or salinity (e.g. a fouled sensor)
+        if (i % 1000 == 1)
+            temperature[i] = 35;
+        if (i % 1000 == 1 || i % 1000 == 2)
+            salinity[i] = 20;
+        conductivity[i] = 30 + 10 * frac;
+        pressure[i] = std::abs(1.01 * depth[i]);
+    }
+
+    double latitude = 42.0;
+
+    {
+        auto scalar_rate = samples_per_second([&]() {
+            for (std::size_t i = 0; i < num_samples; ++i)
+            {
+                try
+                {
+                    scalar_output[i] = goby::util::seawater::mackenzie_soundspeed(
+                                           temperature[i] * absolute<celsius::temperature>(),
+                                           quantity<si::dimensionless>(salinity[i]),
+                                           depth[i] * si::meters) /
+                                       si::meters_per_second;
+                }
+                catch (std::out_of_range&)
+                {
+                    scalar_threw[i] = 1;
+                    scalar_output[i] =
+                        goby::util::seawater::mackenzie_soundspeed(
+                            temperature[i] * absolute<celsius::temperature>(),
+                            quantity<si::dimensionless>(salinity[i]), depth[i] * si::meters, true) /
+                        si::meters_per_second;
+                }
+            }
+        });
+        auto batch_rate = samples_per_second([&]() {
+            batch::mackenzie_soundspeed(&temperature[0], &salinity[0], &depth[0], &output[0],
+                                        num_samples, &out_of_range[0]);
+        });
+        report("soundspeed", scalar_rate, batch_rate);
+
+        if (!agree("soundspeed", scalar_output, output))
+            return 1;
+
+        // the mask flags exactly the samples for which the scalar function throws, with the
+        // flags for the inputs that are out of range
+        using namespace goby::util::seawater;
+        std::size_t num_depth = 0, num_temperature = 0, num_salinity = 0;
+        for (std::size_t i = 0; i < num_samples; ++i)
+        {
+            std::uint8_t expected = (depth[i] < 0 ? DEPTH_OUT_OF_RANGE : IN_RANGE) |
+                                    (temperature[i] > 30 ? TEMPERATURE_OUT_OF_RANGE : IN_RANGE) |
+                                    (salinity[i] < 25 ? SALINITY_OUT_OF_RANGE : IN_RANGE);
+            if (out_of_range[i] != expected || (out_of_range[i] != IN_RANGE) != scalar_threw[i])
+            {
+                std::cerr << "soundspeed: unexpected out of range mask " << int(out_of_range[i])
+                          << " at sample " << i << std::endl;
+                return 1;
+            }
+            num_depth += (out_of_range[i] & DEPTH_OUT_OF_RANGE) ? 1 : 0;
+            num_temperature += (out_of_range[i] & TEMPERATURE_OUT_OF_RANGE) ? 1 : 0;
+            num_salinity += (out_of_range[i] & SALINITY_OUT_OF_RANGE) ? 1 : 0;
+        }
+        if (num_depth != num_samples / 100 || num_temperature != num_samples / 1000 ||
+            num_salinity != 2 * num_samples / 1000)
+        {
+            std::cerr << "Unexpected out of range counts: depth: " << num_depth
+                      << ", temperature: " << num_temperature << ", salinity: " << num_salinity
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    {
+        auto scalar_rate = samples_per_second([&]() {
+            for (std::size_t i = 0; i < num_samples; ++i)
+                scalar_output[i] =
+                    goby::util::seawater::depth(pressure[i] * si::deci * goby::util::seawater::bar,
+                                                latitude * degree::degrees) /
+                    si::meters;
+        });
+        auto batch_rate = samples_per_second(
+            [&]() { batch::depth(&pressure[0], latitude, &output[0], num_samples); });
+        report("depth", scalar_rate, batch_rate);
+        // (UNESCO depth and Saunders pressure have no validity range, so no mask)
+        if (!agree("depth", scalar_output, output))
+            return 1;
+    }
+
+    {
+        auto scalar_rate = samples_per_second([&]() {
+            for (std::size_t i = 0; i < num_samples; ++i)
+                scalar_output[i] = goby::util::seawater::pressure(depth[i] * si::meters,
+                                                                  latitude * degree::degrees)
+                                       .value();
+        });
+        auto batch_rate = samples_per_second(
+            [&]() { batch::pressure(&depth[0], latitude, &output[0], num_samples); });
+        report("pressure", scalar_rate, batch_rate);
+        if (!agree("pressure", scalar_output, output))
+            return 1;
+    }
+
+    {
+        auto scalar_rate = samples_per_second([&]() {
+            for (std::size_t i = 0; i < num_samples; ++i)
+                scalar_output[i] = goby::util::seawater::salinity(
+                    conductivity[i] * goby::util::seawater::milli_siemens_per_cm,
+                    temperature[i] * absolute<celsius::temperature>(),
+                    pressure[i] * si::deci * goby::util::seawater::bar);
+        });
+        auto batch_rate = samples_per_second([&]() {
+            batch::salinity(&conductivity[0], &temperature[0], &pressure[0], &output[0],
+                            num_samples);
+        });
+        report("salinity", scalar_rate, batch_rate);
+        if (!agree("salinity", scalar_output, output))
+            return 1;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "goby/util/timer_wheel.h"
+
+// manually advanced clock so the test is deterministic
+struct TestClock
+{
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<TestClock> time_point;
+    static const bool is_steady = true;
+    static time_point now() noexcept { return time_point(duration(0)); }
+};
+
+using namespace std::chrono;
+using Wheel = goby::util::TimerWheel<std::string, TestClock>;
+
+int main()
+{
+    TestClock::time_point t0(milliseconds(0));
+
+    // basic expiry, never early
+    {
+        Wheel wheel(milliseconds(10), 8, t0);
+        std::set<std::string> expired;
+        auto on_expire = [&](const std::string& key) { expired.insert(key); };
+
+        wheel.schedule(std::string("a"), t0 + milliseconds(25));
+        wheel.schedule(std::string("b"), t0 + milliseconds(50));
+        assert(wheel.size() == 2);
+
+        assert(wheel.advance(t0 + milliseconds(20), on_expire) == 0);
+        assert(expired.empty());
+        assert(wheel.advance(t0 + milliseconds(30), on_expire) == 1);
+        assert(expired.count("a"));
+        assert(!wheel.contains("a"));
+        assert(wheel.advance(t0 + milliseconds(50), on_expire) == 1);
+        assert(expired.count("b"));
+        assert(wheel.size() == 0);
+    }
+
+    // rescheduling (heartbeats) pushes back expiry, cancel removes
+    {
+        Wheel wheel(milliseconds(10), 8, t0);
+        std::set<std::string> expired;
+        auto on_expire = [&](const std::string& key) { expired.insert(key); };
+
+        wheel.schedule_in("hb", milliseconds(30));
+        wheel.schedule_in("cancelled", milliseconds(30));
+        assert(wheel.cancel("cancelled"));
+        for (int t = 10; t <= 200; t += 10)
+        {
+            wheel.advance(t0 + milliseconds(t), on_expire);
+            wheel.schedule_in("hb", milliseconds(30));
+        }
+        assert(expired.empty());
+        assert(wheel.contains("hb"));
+
+        // stop the heartbeat
+        wheel.advance(t0 + milliseconds(230), on_expire);
+        assert(expired.count("hb"));
+        assert(!expired.count("cancelled"));
+    }
+
+    // deadlines beyond one revolution
+    {
+        Wheel wheel(milliseconds(10), 4, t0);
+        int count = 0;
+        auto on_expire = [&](const std::string&) { ++count; };
+        wheel.schedule("far", t0 + milliseconds(105));
+        wheel.advance(t0 + milliseconds(100), on_expire);
+        assert(count == 0);
+        wheel.advance(t0 + milliseconds(110), on_expire);
+        assert(count == 1);
+    }
+
+    // next_due is a lower bound on the next expiry
+    {
+        Wheel wheel(milliseconds(10), 4, t0);
+        int count = 0;
+        auto on_expire = [&](const std::string&) { ++count; };
+        assert(wheel.next_due() == TestClock::time_point::max());
+
+        wheel.schedule("a", t0 + milliseconds(25));
+        assert(wheel.next_due() == t0 + milliseconds(30));
+        wheel.advance(wheel.next_due(), on_expire);
+        assert(count == 1);
+        assert(wheel.next_due() == TestClock::time_point::max());
+
+        // carried around the wheel: wake at the end of each revolution until due
+        wheel.schedule("far", t0 + milliseconds(105));
+        while (wheel.size())
+        {
+            auto due = wheel.next_due();
+            assert(due <= t0 + milliseconds(110));
+            wheel.advance(due, on_expire);
+        }
+        assert(count == 2);
+        assert(wheel.current_time() == t0 + milliseconds(110));
+    }
+
+    // a long gap (e.g. forward clock step) is processed in one revolution, not tick by tick
+    {
+        Wheel wheel(milliseconds(1), 256, t0);
+        std::set<std::string> expired;
+        auto on_expire = [&](const std::string& key) { expired.insert(key); };
+        auto gap = hours(24 * 365);
+        wheel.schedule("soon", t0 + milliseconds(5));
+        wheel.schedule("before_now", t0 + gap - milliseconds(100));
+        wheel.schedule("after_now", t0 + gap + milliseconds(100));
+        // ~3e10 ticks if processed one by one
+        assert(wheel.advance(t0 + gap, on_expire) == 2);
+        assert(expired.count("soon") && expired.count("before_now"));
+        assert(wheel.contains("after_now"));
+        assert(wheel.current_time() == t0 + gap);
+
+        assert(wheel.advance(t0 + gap + milliseconds(99), on_expire) == 0);
+        assert(wheel.advance(t0 + gap + milliseconds(100), on_expire) == 1);
+        assert(expired.count("after_now"));
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cassert>
+#include <thread>
+
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/zeromq/transport/federation.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "goby/util/debug_logger.h"
+
+#include <zmq.hpp>
+
+// tests gobyd federation: two Router / Manager pairs (as two gobyd would run on different
+// hosts) peered over TCP; publications cross only to the gobyd whose portals subscribe to them
+
+using goby::glog;
+using namespace goby::util::logger;
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group telemetry_group{"Telemetry"};
+extern constexpr goby::middleware::Group unused_group{"Unused"};
+
+constexpr int num_messages = 100;
+
+struct Gobyd
+{
+    Gobyd(const goby::zeromq::protobuf::InterProcessPortalConfig& cfg)
+        : cfg(cfg),
+          manager_context(new zmq::context_t(1)),
+          router_context(new zmq::context_t(10)),
+          router(*router_context, this->cfg),
+          manager(*manager_context, this->cfg, router)
+    {
+        router_thread = std::thread([this] { router.run(); });
+        manager_thread = std::thread([this] { manager.run(); });
+    }
+
+    ~Gobyd()
+    {
+        router_context.reset();
+        manager_context.reset();
+        router_thread.join();
+        manager_thread.join();
+    }
+
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    std::unique_ptr<zmq::context_t> manager_context;
+    std::unique_ptr<zmq::context_t> router_context;
+    goby::zeromq::Router router;
+    goby::zeromq::Manager manager;
+    std::thread router_thread;
+    std::thread manager_thread;
+};
+
+goby::zeromq::protobuf::InterProcessPortalConfig gobyd_cfg(const std::string& platform,
+                                                          int port, int peer_port, bool compress)
+{
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    cfg.set_platform(platform);
+    auto& federation = *cfg.mutable_federation();
+    federation.set_bind_address("127.0.0.1");
+    federation.set_bind_port(port);
+    auto& peer = *federation.add_peer();
+    peer.set_address("127.0.0.1");
+    peer.set_port(peer_port);
+    federation.set_compress(compress);
+    return cfg;
+}
+
+void run_test(bool compress, int port_a, int port_b)
+{
+    std::string suffix = compress ? "_compressed" : "";
+    Gobyd gobyd_a(gobyd_cfg("test_federation_a" + suffix, port_a, port_b, compress));
+    Gobyd gobyd_b(gobyd_cfg("test_federation_b" + suffix, port_b, port_a, compress));
+
+    goby::zeromq::InterProcessPortal<> subscriber(gobyd_a.cfg);
+    goby::zeromq::InterProcessPortal<> publisher(gobyd_b.cfg);
+
+    std::vector<std::string> values;
+    subscriber.subscribe<telemetry_group, std::string>(
+        [&](const std::string& s) { values.push_back(s); });
+
+    // allow the subscription to propagate to the peer
+    for (int i = 0; i < 10; ++i) subscriber.poll(milliseconds(100));
+
+    for (int i = 0; i < num_messages; ++i)
+    {
+        publisher.publish<telemetry_group>(std::string("telemetry-") + std::to_string(i));
+        publisher.publish<unused_group>(std::string("unused-") + std::to_string(i));
+    }
+
+    auto end = system_clock::now() + seconds(10);
+    while (values.size() < num_messages && system_clock::now() < end)
+        subscriber.poll(milliseconds(10));
+
+    glog.is(VERBOSE) && glog << "compress: " << std::boolalpha << compress
+                             << ", received: " << values.size()
+                             << ", b sent: " << gobyd_b.router.federated_publications_sent
+                             << ", a received: " << gobyd_a.router.federated_publications_received
+                             << std::endl;
+
+    // all received, in order
+    assert(values.size() == num_messages);
+    for (int i = 0; i < num_messages; ++i)
+        assert(values[i] == std::string("telemetry-") + std::to_string(i));
+
+    // only the subscribed group crossed
+    assert(gobyd_b.router.federated_publications_sent == num_messages);
+    assert(gobyd_a.router.federated_publications_received == num_messages);
+
+    // nothing flows the other way
+    assert(gobyd_a.router.federated_publications_sent == 0);
+    assert(gobyd_b.router.federated_publications_received == 0);
+}
+
+// batches that are corrupt (or not from a goby peer) are dropped without stopping the Router
+void test_invalid_batches(int port)
+{
+    goby::zeromq::protobuf::FederationConfig cfg;
+    cfg.set_bind_address("127.0.0.1");
+    cfg.set_bind_port(port);
+    cfg.set_max_inflated_batch_bytes(1024);
+    zmq::context_t context(1);
+    goby::zeromq::Federation federation(context, cfg);
+
+    int delivered = 0;
+    auto deliver = [&](const char* data, std::size_t size) { ++delivered; };
+    auto batch = [](char flags, const std::string& body) {
+        std::string frame = std::string("#goby_federation") + flags + body;
+        return zmq::message_t(frame.data(), frame.size());
+    };
+    auto uint32 = [](std::uint32_t value) {
+        return std::string{static_cast<char>(value >> 24), static_cast<char>(value >> 16),
+                           static_cast<char>(value >> 8), static_cast<char>(value)};
+    };
+
+    // uncompressed (one publication)
+    assert(federation.receive(batch(0, uint32(3) + "abc"), deliver) == 1);
+    // unknown flags
+    assert(federation.receive(batch(2, uint32(3) + "abc"), deliver) == 0);
+    // claims to inflate to more than max_inflated_batch_bytes
+    assert(federation.receive(batch(1, uint32(1 << 30) + "xyz"), deliver) == 0);
+    // not zlib data
+    assert(federation.receive(batch(1, uint32(16) + "not compressed"), deliver) == 0);
+    // compressed header truncated
+    assert(federation.receive(batch(1, "ab"), deliver) == 0);
+    assert(delivered == 1);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::DEBUG2, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    run_test(false, 54330, 54331);
+    run_test(true, 54332, 54333);
+    test_invalid_batches(54334);
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,263 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <fstream>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/multicast.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include "goby/acomms/modemdriver/udp_multicast_driver.h"
+#include "goby/acomms/protobuf/amac.pb.h"
+#include "goby/middleware/marshalling/dccl.h"
+#include "goby/middleware/transport/intervehicle.h"
+#include "goby/util/debug_logger.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "test.pb.h"
+
+// tests MAC_ADAPTIVE_DECENTRALIZED through InterVehiclePortal / ModemDriverThread: the publishing vehicle advertises its DynamicBuffer backlog, and is allocated more than its configured share of the cycle while the backlog lasts
+
+using goby::glog;
+using namespace goby::util::logger;
+using goby::test::zeromq::protobuf::Reading;
+
+constexpr goby::middleware::Group readings{"readings", 1};
+
+constexpr int subscriber_id = 1;
+// also the MAC coordinator
+constexpr int publisher_id = 2;
+// index of the publisher's slot in MACConfig
+constexpr int publisher_slot = 1;
+constexpr int num_readings = 100;
+
+// listens to every transmission on the multicast "channel" (as a third node would, but without transmitting or acking)
+class ChannelListener
+{
+  public:
+    ChannelListener(const goby::acomms::udp_multicast::protobuf::Config& cfg)
+    {
+        boost::asio::ip::udp::endpoint listen_endpoint(
+            boost::asio::ip::address::from_string(cfg.listen_address()), cfg.multicast_port());
+        socket_.open(listen_endpoint.protocol());
+        socket_.set_option(boost::asio::ip::udp::socket::reuse_address(true));
+        socket_.bind(listen_endpoint);
+        socket_.set_option(boost::asio::ip::multicast::join_group(
+            boost::asio::ip::address::from_string(cfg.multicast_address())));
+    }
+
+    void poll()
+    {
+        while (socket_.available())
+        {
+            std::array<char, 2048> buffer;
+            auto length = socket_.receive(boost::asio::buffer(buffer));
+
+            goby::acomms::protobuf::ModemTransmission msg;
+            if (!msg.ParseFromArray(buffer.data(), length) || msg.src() != publisher_id ||
+                !msg.HasExtension(goby::acomms::protobuf::adaptive_mac))
+                continue;
+
+            const auto& status = msg.GetExtension(goby::acomms::protobuf::adaptive_mac);
+            glog.is(DEBUG1) && glog << "Adaptive MAC status from publisher: "
+                                    << status.ShortDebugString() << std::endl;
+            max_queue_depth = std::max(max_queue_depth, status.queue_depth());
+            max_publisher_slots = std::max<int>(
+                max_publisher_slots,
+                std::count(status.slot_index().begin(), status.slot_index().end(), publisher_slot));
+        }
+    }
+
+    // largest queue depth advertised by the publisher
+    std::uint32_t max_queue_depth{0};
+    // most slots allocated to the publisher in one cycle by the coordinator (the publisher)
+    int max_publisher_slots{0};
+
+  private:
+    boost::asio::io_context io_;
+    boost::asio::ip::udp::socket socket_{io_};
+};
+
+// process 0
+void subscriber(const goby::zeromq::protobuf::InterProcessPortalConfig& zmq_cfg,
+                const goby::middleware::intervehicle::protobuf::PortalConfig& slow_cfg)
+{
+    ChannelListener listener(slow_cfg.link(0).driver().GetExtension(
+        goby::acomms::udp_multicast::protobuf::config));
+
+    goby::zeromq::InterProcessPortal<goby::middleware::InterThreadTransporter> zmq(zmq_cfg);
+    goby::middleware::InterVehiclePortal<decltype(zmq)> intervehicle(zmq, slow_cfg);
+
+    goby::middleware::protobuf::TransporterConfig subscriber_cfg;
+    subscriber_cfg.mutable_intervehicle()->add_publisher_id(publisher_id);
+
+    int received = 0;
+    intervehicle.subscribe<readings, Reading>(
+        [&](const Reading& r) {
+            glog.is(DEBUG1) && glog << "Received: " << r.ShortDebugString() << std::endl;
+            assert(r.n() == received);
+            ++received;
+        },
+        goby::middleware::Subscriber<Reading>(subscriber_cfg));
+
+    auto timeout = std::chrono::system_clock::now() + std::chrono::seconds(60);
+    while (received < num_readings)
+    {
+        intervehicle.poll(std::chrono::milliseconds(10));
+        listener.poll();
+        if (std::chrono::system_clock::now() > timeout)
+            glog.is(DIE) && glog << "Timed out waiting for data" << std::endl;
+    }
+
+    glog.is(VERBOSE) && glog << "Publisher advertised up to " << listener.max_queue_depth
+                             << " bytes queued, and was allocated up to "
+                             << listener.max_publisher_slots << " slots per cycle" << std::endl;
+
+    // the backlog was advertised (from the ModemDriverThread's DynamicBuffer) ...
+    assert(listener.max_queue_depth > 0);
+    // ... and the publisher got more than its configured (min_slots) share of a cycle for it
+    assert(listener.max_publisher_slots > 1);
+}
+
+// process 1
+void publisher(const goby::zeromq::protobuf::InterProcessPortalConfig& zmq_cfg,
+               const goby::middleware::intervehicle::protobuf::PortalConfig& slow_cfg)
+{
+    goby::zeromq::InterProcessPortal<goby::middleware::InterThreadTransporter> zmq(zmq_cfg);
+    goby::middleware::InterVehiclePortal<decltype(zmq)> intervehicle(zmq, slow_cfg);
+
+    // give time for the subscription to come across: the subscriber has no allocation from the coordinator (this vehicle) until it transmits, so it sends the subscription once it falls back to the configured slots (after max_quiet_cycles)
+    for (int i = 0; i < 50; ++i) intervehicle.poll(std::chrono::milliseconds(100));
+
+    goby::middleware::protobuf::TransporterConfig publisher_cfg;
+    auto* buffer_cfg = publisher_cfg.mutable_intervehicle()->mutable_buffer();
+    buffer_cfg->set_newest_first(false);
+    buffer_cfg->set_ack_required(true);
+
+    int acks = 0;
+    goby::middleware::Publisher<Reading> reading_publisher(
+        publisher_cfg,
+        [&](const Reading& r, const goby::middleware::intervehicle::protobuf::AckData& ack) {
+            ++acks;
+        },
+        [&](const Reading& r, const goby::middleware::intervehicle::protobuf::ExpireData& expire) {
+            glog.is(DIE) && glog << "Expire for " << r.ShortDebugString() << ": "
+                                 << expire.ShortDebugString() << std::endl;
+        });
+
+    for (int n = 0; n < num_readings; ++n)
+    {
+        Reading r;
+        r.set_n(n);
+        intervehicle.publish<readings>(r, reading_publisher);
+    }
+
+    auto timeout = std::chrono::system_clock::now() + std::chrono::seconds(60);
+    while (acks < num_readings)
+    {
+        intervehicle.poll(std::chrono::milliseconds(100));
+        if (std::chrono::system_clock::now() > timeout)
+            glog.is(DIE) && glog << "Timed out waiting for acks" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int process_index = 0;
+    pid_t child_pid = fork();
+    if (child_pid == 0)
+        process_index = 1;
+
+    std::string process_suffix = (process_index == 0) ? "subscriber" : "publisher";
+    std::string os_name = std::string("/tmp/goby_test_intervehicle_adaptive_mac_") + process_suffix;
+    std::ofstream os(os_name.c_str());
+    goby::glog.add_stream(goby::util::logger::DEBUG3, &os);
+    goby::glog.set_name(std::string(argv[0]) + process_suffix);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    goby::middleware::intervehicle::protobuf::PortalConfig slow_cfg;
+    auto& link_cfg = *slow_cfg.add_link();
+    link_cfg.set_modem_id(process_index == 0 ? subscriber_id : publisher_id);
+
+    goby::acomms::protobuf::DriverConfig& driver_cfg = *link_cfg.mutable_driver();
+    driver_cfg.set_driver_type(goby::acomms::protobuf::DRIVER_UDP_MULTICAST);
+    auto* udp_multicast_driver_cfg =
+        driver_cfg.MutableExtension(goby::acomms::udp_multicast::protobuf::config);
+    udp_multicast_driver_cfg->set_max_frame_size(32);
+    udp_multicast_driver_cfg->set_multicast_port(60011);
+
+    // fixed: one 0.1 s slot each per 0.2 s; adaptive (default cycle_seconds): 0.4 s cycles, of which the publisher gets all the time not needed for the subscriber's one slot while it has a backlog
+    goby::acomms::protobuf::MACConfig& mac_cfg = *link_cfg.mutable_mac();
+    mac_cfg.set_type(goby::acomms::protobuf::MAC_ADAPTIVE_DECENTRALIZED);
+    mac_cfg.mutable_adaptive()->set_coordinator_id(publisher_id);
+    for (int id : {subscriber_id, publisher_id})
+    {
+        goby::acomms::protobuf::ModemTransmission& slot = *mac_cfg.add_slot();
+        slot.set_src(id);
+        slot.set_slot_seconds(0.1);
+    }
+
+    goby::zeromq::protobuf::InterProcessPortalConfig zmq_cfg;
+    zmq_cfg.set_platform(process_index == 0 ? "test-adaptive-mac-vehicle1"
+                                            : "test-adaptive-mac-vehicle2");
+
+    std::unique_ptr<zmq::context_t> manager_context(new zmq::context_t(1));
+    std::unique_ptr<zmq::context_t> router_context(new zmq::context_t(1));
+    goby::zeromq::Router router(*router_context, zmq_cfg);
+    std::thread t10([&] { router.run(); });
+    goby::zeromq::Manager manager(*manager_context, zmq_cfg, router);
+    std::thread t11([&] { manager.run(); });
+    sleep(1);
+
+    std::thread t1([&] {
+        if (process_index == 0)
+            subscriber(zmq_cfg, slow_cfg);
+        else
+            publisher(zmq_cfg, slow_cfg);
+    });
+    t1.join();
+
+    router_context.reset();
+    manager_context.reset();
+    t10.join();
+    t11.join();
+
+    if (process_index == 0)
+    {
+        int wstatus;
+        wait(&wstatus);
+        if (wstatus != 0)
+        {
+            std::cout << "Test failed (see logs in /tmp)" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::cout << "all tests passed" << std::endl;
+    }
+    return 0;
+}
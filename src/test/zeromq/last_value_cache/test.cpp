@@ -0,0 +1,179 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/middleware/transport/interthread.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "goby/util/debug_logger.h"
+
+#include <zmq.hpp>
+
+// tests the gobyd (Router / Manager) last-value cache: a portal that subscribes after the
+// publication receives the most recent value immediately, as does every later subscription
+// (portal or forwarded) in the same process
+
+using goby::glog;
+using namespace goby::util::logger;
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group state_group{"State"};
+extern constexpr goby::middleware::Group unused_group{"Unused"};
+
+// polls until n values are received or the timeout expires
+template <typename Portal>
+void poll_for(Portal& portal, const std::vector<std::string>& values, std::size_t n,
+              system_clock::duration timeout)
+{
+    auto end = system_clock::now() + timeout;
+    while (values.size() < n && system_clock::now() < end) portal.poll(milliseconds(10));
+}
+
+int main(int argc, char* argv[])
+{
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    cfg.set_platform("test_last_value_cache");
+    cfg.set_last_value_cache(true);
+
+    goby::glog.add_stream(goby::util::logger::DEBUG2, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    std::unique_ptr<zmq::context_t> manager_context(new zmq::context_t(1));
+    std::unique_ptr<zmq::context_t> router_context(new zmq::context_t(10));
+    goby::zeromq::Router router(*router_context, cfg);
+    std::thread router_thread([&] { router.run(); });
+    goby::zeromq::Manager manager(*manager_context, cfg, router);
+    std::thread manager_thread([&] { manager.run(); });
+
+    {
+        goby::zeromq::InterProcessPortal<> publisher(cfg);
+        publisher.publish<state_group>(std::string("state-1"));
+        publisher.publish<state_group>(std::string("state-2"));
+        // allow the publications to reach the Router
+        std::this_thread::sleep_for(milliseconds(500));
+
+        // late joiner receives only the most recent value
+        goby::zeromq::InterProcessPortal<> late(cfg);
+        std::vector<std::string> values, unused_values;
+        late.subscribe<state_group, std::string>(
+            [&](const std::string& s) { values.push_back(s); });
+        late.subscribe<unused_group, std::string>(
+            [&](const std::string& s) { unused_values.push_back(s); });
+        poll_for(late, values, 1, seconds(5));
+        assert(values.size() == 1);
+        assert(values[0] == "state-2");
+
+        // followed by new publications, without a repeat of the cached value
+        publisher.publish<state_group>(std::string("state-3"));
+        poll_for(late, values, 2, seconds(5));
+        poll_for(late, values, 3, milliseconds(200));
+        assert(values.size() == 2);
+        assert(values[1] == "state-3");
+
+        // nothing cached for a group that was never published
+        assert(unused_values.empty());
+
+        // a later subscription in the same process gets the process's copy (gobyd is only asked
+        // on the first), and the earlier subscription doesn't get it again
+        std::vector<std::string> second_values;
+        late.subscribe<state_group, std::string>(
+            [&](const std::string& s) { second_values.push_back(s); });
+        poll_for(late, second_values, 1, seconds(5));
+        poll_for(late, second_values, 2, milliseconds(200));
+        assert(second_values.size() == 1);
+        assert(second_values[0] == "state-3");
+        assert(values.size() == 2);
+
+        // likewise for each thread subscribing through a forwarder
+        {
+            goby::middleware::InterThreadTransporter interthread;
+            goby::zeromq::InterProcessPortal<goby::middleware::InterThreadTransporter> portal(
+                interthread, cfg);
+            std::vector<std::string> portal_values;
+            portal.subscribe<state_group, std::string>(
+                [&](const std::string& s) { portal_values.push_back(s); });
+            poll_for(portal, portal_values, 1, seconds(5));
+            assert(portal_values.size() == 1);
+
+            const int nthreads = 2;
+            std::vector<std::string> thread_values[nthreads];
+            std::atomic<int> threads_done{0};
+            auto forwarder_thread = [&](int i) {
+                goby::middleware::InterThreadTransporter inner;
+                goby::middleware::InterProcessForwarder<goby::middleware::InterThreadTransporter>
+                    forwarder(inner);
+                forwarder.subscribe<state_group, std::string>(
+                    [&, i](const std::string& s) { thread_values[i].push_back(s); });
+                // keep polling after the first value to catch any repeat
+                auto end = system_clock::now() + seconds(5);
+                auto first = system_clock::time_point::max();
+                while (system_clock::now() < end &&
+                       (thread_values[i].empty() || system_clock::now() < first))
+                {
+                    inner.poll(milliseconds(10));
+                    if (!thread_values[i].empty() && first == system_clock::time_point::max())
+                        first = system_clock::now() + milliseconds(500);
+                }
+                ++threads_done;
+            };
+
+            // one after another, so the second subscribes once the first has its value
+            for (int i = 0; i < nthreads; ++i)
+            {
+                std::thread t(forwarder_thread, i);
+                while (threads_done < i + 1) portal.poll(milliseconds(10));
+                t.join();
+            }
+
+            for (int i = 0; i < nthreads; ++i)
+            {
+                assert(thread_values[i].size() == 1);
+                assert(thread_values[i][0] == "state-3");
+            }
+            assert(portal_values.size() == 1);
+        }
+
+        // the cache is opt-in for subscribers
+        auto no_cache_cfg = cfg;
+        no_cache_cfg.set_last_value_cache(false);
+        goby::zeromq::InterProcessPortal<> no_cache(no_cache_cfg);
+        std::vector<std::string> no_cache_values;
+        no_cache.subscribe<state_group, std::string>(
+            [&](const std::string& s) { no_cache_values.push_back(s); });
+        poll_for(no_cache, no_cache_values, 1, milliseconds(500));
+        assert(no_cache_values.empty());
+    }
+
+    router_context.reset();
+    manager_context.reset();
+    router_thread.join();
+    manager_thread.join();
+
+    std::cout << "all tests passed" << std::endl;
+}
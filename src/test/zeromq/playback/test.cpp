@@ -0,0 +1,223 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <fstream>
+#include <thread>
+
+#include "goby/middleware/log.h"
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "goby/util/debug_logger.h"
+
+#include <zmq.hpp>
+
+// tests the goby_playback core: writes a small .goby log, then replays it with LogPlayer through
+// InterProcessPortal::publish_serialized() in each pacing mode, checking order and timing
+
+using goby::glog;
+using goby::middleware::log::LogEntry;
+using goby::middleware::log::LogPlayer;
+using namespace goby::util::logger;
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group nav_group{"PlaybackNav"};
+extern constexpr goby::middleware::Group ctd_group{"PlaybackCTD"};
+extern constexpr goby::middleware::Group excluded_group{"PlaybackExcluded"};
+
+const std::string log_file{"/tmp/goby3_test_playback.goby"};
+constexpr int num_entries = 60;
+// log time between consecutive entries
+constexpr milliseconds entry_interval(10);
+// log time from the first to the last played entry (the last entry is excluded)
+constexpr auto log_span = entry_interval * (num_entries - 2);
+
+std::string value(int i) { return std::to_string(i); }
+
+const goby::middleware::Group& entry_group(int i)
+{
+    switch (i % 3)
+    {
+        default:
+        case 0: return nav_group;
+        case 1: return ctd_group;
+        case 2: return excluded_group;
+    }
+}
+
+void write_log()
+{
+    LogEntry::reset();
+    std::ofstream out(log_file.c_str());
+    auto start = goby::time::SystemClock::now() - hours(1);
+    for (int i = 0; i < num_entries; ++i)
+    {
+        // as logged by goby_logger: the serialized bytes
+        auto data = goby::middleware::SerializerParserHelper<
+            std::string, goby::middleware::MarshallingScheme::CSTR>::serialize(value(i));
+        LogEntry entry(std::vector<unsigned char>(data.begin(), data.end()),
+                       goby::middleware::MarshallingScheme::CSTR, "CSTR", entry_group(i),
+                       start + i * entry_interval);
+        entry.serialize(&out);
+    }
+}
+
+struct Gobyd
+{
+    Gobyd(const goby::zeromq::protobuf::InterProcessPortalConfig& cfg)
+        : cfg(cfg),
+          manager_context(new zmq::context_t(1)),
+          router_context(new zmq::context_t(10)),
+          router(*router_context, this->cfg),
+          manager(*manager_context, this->cfg, router)
+    {
+        router_thread = std::thread([this] { router.run(); });
+        manager_thread = std::thread([this] { manager.run(); });
+    }
+
+    ~Gobyd()
+    {
+        router_context.reset();
+        manager_context.reset();
+        router_thread.join();
+        manager_thread.join();
+    }
+
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    std::unique_ptr<zmq::context_t> manager_context;
+    std::unique_ptr<zmq::context_t> router_context;
+    goby::zeromq::Router router;
+    goby::zeromq::Manager manager;
+    std::thread router_thread;
+    std::thread manager_thread;
+};
+
+struct Received
+{
+    std::string value;
+    steady_clock::time_point time;
+};
+
+// returns the time taken to play back the log
+steady_clock::duration play(double warp_factor, goby::zeromq::InterProcessPortal<>& publisher,
+                            goby::zeromq::InterProcessPortal<>& subscriber,
+                            std::vector<Received>& received)
+{
+    received.clear();
+    LogEntry::reset();
+    std::ifstream in(log_file.c_str());
+
+    // small prefetch so that the reader thread is held up by playback
+    int filtered = 0;
+    LogPlayer player(in, warp_factor, 4, [&](LogEntry& entry) {
+        bool passes = entry.group() != excluded_group;
+        filtered += passes ? 0 : 1;
+        return passes;
+    });
+
+    auto start = steady_clock::now();
+    bool more = true;
+    while (more)
+    {
+        more = player.play(
+            [&](const LogPlayer::Entry& entry) {
+                publisher.publish_serialized(entry.type, entry.scheme,
+                                             reinterpret_cast<const char*>(entry.data.data()),
+                                             entry.data.size(), entry.group);
+            },
+            10, milliseconds(2));
+        subscriber.poll(milliseconds(0));
+    }
+    auto elapsed = steady_clock::now() - start;
+
+    const std::size_t expected = num_entries - num_entries / 3;
+    assert(player.entries_played() == expected);
+    assert(filtered == num_entries / 3);
+
+    auto end = steady_clock::now() + seconds(10);
+    while (received.size() < expected && steady_clock::now() < end)
+        subscriber.poll(milliseconds(10));
+
+    // all played entries received, in log order
+    assert(received.size() == expected);
+    for (int i = 0, j = 0; i < num_entries; ++i)
+    {
+        if (entry_group(i) == excluded_group)
+            continue;
+        assert(received[j++].value == value(i));
+    }
+
+    return elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::glog.add_stream(goby::util::logger::VERBOSE, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    write_log();
+
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    cfg.set_platform("test_playback");
+    Gobyd gobyd(cfg);
+
+    goby::zeromq::InterProcessPortal<> subscriber(cfg);
+    goby::zeromq::InterProcessPortal<> publisher(cfg);
+
+    std::vector<Received> received;
+    auto on_receive = [&](const std::string& s) {
+        received.push_back({s, steady_clock::now()});
+    };
+    subscriber.subscribe<nav_group, std::string>(on_receive);
+    subscriber.subscribe<ctd_group, std::string>(on_receive);
+    subscriber.subscribe<excluded_group, std::string>(on_receive);
+
+    // allow the subscriptions to propagate
+    for (int i = 0; i < 10; ++i) subscriber.poll(milliseconds(100));
+
+    auto seconds_of = [](steady_clock::duration d) { return duration<double>(d).count(); };
+
+    // as fast as possible: the log spans 0.58 s, but is played in much less
+    auto afap = play(0, publisher, subscriber, received);
+    glog.is(VERBOSE) && glog << "AS_FAST_AS_POSSIBLE: " << seconds_of(afap) << " s" << std::endl;
+    assert(afap < log_span / 2);
+
+    // real time: each entry is played no earlier than its log time after the first
+    auto real_time = play(1, publisher, subscriber, received);
+    glog.is(VERBOSE) && glog << "REAL_TIME: " << seconds_of(real_time) << " s" << std::endl;
+    assert(real_time >= log_span);
+    assert(real_time < 4 * log_span);
+    // allow for the first entry's delivery taking longer than the last's
+    assert(received.back().time - received.front().time >= log_span - 5 * entry_interval);
+
+    // warped: ten times faster than real time
+    const double warp = 10;
+    auto warped = play(warp, publisher, subscriber, received);
+    glog.is(VERBOSE) && glog << "WARPED: " << seconds_of(warped) << " s" << std::endl;
+    assert(warped >= duration_cast<steady_clock::duration>(log_span / warp));
+    assert(warped < real_time / 2);
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,156 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cassert>
+#include <ctime>
+#include <thread>
+
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "goby/util/debug_logger.h"
+
+#include <zmq.hpp>
+
+// tests batching of interprocess publications (InterProcessPortalConfig.publication_batching):
+// all publications are received in the order they were published (also across groups), and
+// reports the rate and CPU use at ~20k small publications per second with and without batching
+
+using goby::glog;
+using namespace goby::util::logger;
+using namespace std::chrono;
+
+extern constexpr goby::middleware::Group imu_group{"IMU"};
+extern constexpr goby::middleware::Group status_group{"Status"};
+
+// publications per millisecond for each group
+constexpr int burst = 10;
+constexpr int duration_ms = 2000;
+constexpr int num_messages = burst * duration_ms;
+
+void run_test(const goby::zeromq::protobuf::InterProcessPortalConfig& cfg)
+{
+    std::atomic<bool> subscribed{false};
+    std::atomic<bool> done{false};
+    std::vector<std::string> imu, status, all;
+
+    std::thread subscriber_thread([&]() {
+        goby::zeromq::InterProcessPortal<> subscriber(cfg);
+        subscriber.subscribe<imu_group, std::string>(
+            [&](const std::string& s) {
+                imu.push_back(s);
+                all.push_back(s);
+            });
+        subscriber.subscribe<status_group, std::string>(
+            [&](const std::string& s) {
+                status.push_back(s);
+                all.push_back(s);
+            });
+        subscribed = true;
+
+        auto end = system_clock::now() + seconds(30);
+        while ((imu.size() < num_messages || status.size() < num_messages) &&
+               system_clock::now() < end)
+            subscriber.poll(milliseconds(10));
+        done = true;
+    });
+
+    goby::zeromq::InterProcessPortal<> publisher(cfg);
+    while (!subscribed) std::this_thread::sleep_for(milliseconds(10));
+    // allow the subscriptions to reach the publisher
+    std::this_thread::sleep_for(milliseconds(500));
+
+    std::vector<std::string> published;
+    auto start_cpu = std::clock();
+    auto start = steady_clock::now();
+    for (int ms = 0; ms < duration_ms; ++ms)
+    {
+        // a burst of each group, and one more interleaved pair that starts a new batch each
+        for (int i = 0; i < burst - 1; ++i)
+        {
+            published.push_back(std::string("imu-") + std::to_string(ms * burst + i));
+            publisher.publish<imu_group>(published.back());
+        }
+        for (int i = 0; i < burst - 1; ++i)
+        {
+            published.push_back(std::string("status-") + std::to_string(ms * burst + i));
+            publisher.publish<status_group>(published.back());
+        }
+        auto n = std::to_string(ms * burst + burst - 1);
+        published.push_back(std::string("status-") + n);
+        publisher.publish<status_group>(published.back());
+        published.push_back(std::string("imu-") + n);
+        publisher.publish<imu_group>(published.back());
+        // publishes any batches
+        publisher.poll(start + milliseconds(ms + 1));
+    }
+    while (!done) publisher.poll(milliseconds(10));
+    subscriber_thread.join();
+
+    double seconds = duration_cast<microseconds>(steady_clock::now() - start).count() / 1.0e6;
+    double cpu_seconds = double(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+    std::cout << (cfg.has_publication_batching() ? "batched" : "unbatched") << ": received "
+              << imu.size() + status.size() << " at " << (imu.size() + status.size()) / seconds
+              << " msgs/s, process CPU " << 100 * cpu_seconds / seconds << "%" << std::endl;
+
+    assert(imu.size() == num_messages);
+    assert(status.size() == num_messages);
+    for (int i = 0; i < num_messages; ++i)
+    {
+        assert(imu[i] == std::string("imu-") + std::to_string(i));
+        assert(status[i] == std::string("status-") + std::to_string(i));
+    }
+    assert(all == published);
+}
+
+int main(int argc, char* argv[])
+{
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    cfg.set_platform("test_publication_batching");
+
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    std::unique_ptr<zmq::context_t> manager_context(new zmq::context_t(1));
+    std::unique_ptr<zmq::context_t> router_context(new zmq::context_t(10));
+    goby::zeromq::Router router(*router_context, cfg);
+    std::thread router_thread([&] { router.run(); });
+    goby::zeromq::Manager manager(*manager_context, cfg, router);
+    std::thread manager_thread([&] { manager.run(); });
+
+    run_test(cfg);
+
+    auto batched_cfg = cfg;
+    batched_cfg.mutable_publication_batching();
+    run_test(batched_cfg);
+
+    router_context.reset();
+    manager_context.reset();
+    router_thread.join();
+    manager_thread.join();
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -0,0 +1,233 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Binaries
+// ("The Goby Binaries").
+//
+// The Goby Binaries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// The Goby Binaries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include "goby/middleware/marshalling/cstr.h"
+#include "goby/middleware/transport/poll_scheduler.h"
+#include "goby/middleware/transport/stats.h"
+#include "goby/zeromq/transport/interprocess.h"
+
+#include "goby/util/debug_logger.h"
+
+#include <zmq.hpp>
+
+// tests the subscription queue limits (TransporterConfig.qos) of the InterProcessPortal while its
+// thread is not polling: the read thread keeps reading from gobyd, holding everything for
+// unlimited subscriptions and discarding (and counting) what the limited ones would not deliver.
+// Then, with a layer budget, that the read thread hands a backlog to the main thread by
+// priority class weight
+
+using goby::glog;
+using namespace goby::util::logger;
+using namespace std::chrono;
+using goby::middleware::protobuf::TransporterConfig;
+
+extern constexpr goby::middleware::Group unbounded{"QoSUnbounded"};
+extern constexpr goby::middleware::Group drop_newest{"QoSDropNewest"};
+extern constexpr goby::middleware::Group conflate{"QoSConflate"};
+extern constexpr goby::middleware::Group high{"QoSHigh"};
+extern constexpr goby::middleware::Group low{"QoSLow"};
+
+constexpr int num_messages = 1000;
+constexpr int depth = 5;
+constexpr int num_prioritized = 200;
+
+std::atomic<bool> subscribed{false};
+std::atomic<bool> published{false};
+std::atomic<bool> prioritized_subscribed{false};
+std::atomic<bool> prioritized_published{false};
+
+goby::middleware::Subscriber<std::string>
+make_subscriber(int max_depth, TransporterConfig::QoS::Overflow overflow, bool conflate = false)
+{
+    TransporterConfig cfg;
+    cfg.mutable_qos()->set_max_depth(max_depth);
+    cfg.mutable_qos()->set_overflow(overflow);
+    cfg.mutable_qos()->set_conflate(conflate);
+    return goby::middleware::Subscriber<std::string>(cfg);
+}
+
+goby::middleware::Subscriber<std::string> make_subscriber(TransporterConfig::QoS::Priority priority)
+{
+    TransporterConfig cfg;
+    cfg.mutable_qos()->set_priority(priority);
+    return goby::middleware::Subscriber<std::string>(cfg);
+}
+
+void subscriber(const goby::zeromq::protobuf::InterProcessPortalConfig& cfg)
+{
+    goby::zeromq::InterProcessPortal<> portal(cfg);
+    std::vector<int> unbounded_rx, newest_rx, conflate_rx;
+
+    portal.subscribe<unbounded, std::string>(
+        [&](const std::string& s) { unbounded_rx.push_back(std::stoi(s)); });
+    portal.subscribe<drop_newest, std::string>(
+        [&](const std::string& s) { newest_rx.push_back(std::stoi(s)); },
+        make_subscriber(depth, TransporterConfig::QoS::DROP_NEWEST));
+    portal.subscribe<conflate, std::string>(
+        [&](const std::string& s) { conflate_rx.push_back(std::stoi(s)); },
+        make_subscriber(0, TransporterConfig::QoS::DROP_OLDEST, true));
+    subscribed = true;
+
+    // let the read thread receive everything before polling
+    while (!published) std::this_thread::sleep_for(milliseconds(10));
+    std::this_thread::sleep_for(milliseconds(500));
+
+    auto end = system_clock::now() + seconds(10);
+    while ((unbounded_rx.size() < num_messages || conflate_rx.empty() ||
+            conflate_rx.back() != num_messages - 1) &&
+           system_clock::now() < end)
+        portal.poll(milliseconds(10));
+    // anything else still held
+    portal.poll(milliseconds(100));
+
+    auto newest_drops = portal.subscription_drops<std::string>(drop_newest);
+    auto conflate_drops = portal.subscription_drops<std::string>(conflate);
+    glog.is(VERBOSE) && glog << "unbounded: " << unbounded_rx.size()
+                             << ", drop newest: " << newest_rx.size() << " (" << newest_drops
+                             << " dropped), conflate: " << conflate_rx.size() << " ("
+                             << conflate_drops << " dropped)" << std::endl;
+
+    // nothing is lost for unlimited subscriptions
+    assert(unbounded_rx.size() == num_messages);
+    for (int i = 0; i < num_messages; ++i) assert(unbounded_rx[i] == i);
+    assert(portal.subscription_drops<std::string>(unbounded) == 0);
+
+    // the oldest data are kept, and everything else is counted as dropped: far fewer than were
+    // published are delivered since the read thread only held depth messages
+    assert(!newest_rx.empty() && newest_rx.size() < num_messages / 2);
+    for (int i = 0, n = newest_rx.size(); i < n; ++i) assert(newest_rx[i] == i);
+    assert(newest_rx.size() + newest_drops == num_messages);
+
+    // the newest data are kept
+    assert(!conflate_rx.empty() && conflate_rx.size() < num_messages / 2);
+    for (int i = 1, n = conflate_rx.size(); i < n; ++i) assert(conflate_rx[i] > conflate_rx[i - 1]);
+    assert(conflate_rx.back() == num_messages - 1);
+    assert(conflate_rx.size() + conflate_drops == num_messages);
+
+    // priority classes: the low priority backlog arrives (and fills the handoff queue) first
+    goby::middleware::TransportStats::set_enabled(true);
+    goby::middleware::PollScheduler::configure(5, {4, 2, 1});
+    std::vector<int> high_rx, low_rx;
+    // low_rx.size() when the last high priority message was delivered
+    std::size_t low_at_high_done = 0;
+    portal.subscribe<high, std::string>(
+        [&](const std::string& s) {
+            high_rx.push_back(std::stoi(s));
+            if (high_rx.size() == num_prioritized)
+                low_at_high_done = low_rx.size();
+        },
+        make_subscriber(TransporterConfig::QoS::PRIORITY_HIGH));
+    portal.subscribe<low, std::string>(
+        [&](const std::string& s) { low_rx.push_back(std::stoi(s)); },
+        make_subscriber(TransporterConfig::QoS::PRIORITY_LOW));
+    prioritized_subscribed = true;
+
+    while (!prioritized_published) std::this_thread::sleep_for(milliseconds(10));
+    std::this_thread::sleep_for(milliseconds(500));
+
+    end = system_clock::now() + seconds(10);
+    while ((high_rx.size() < num_prioritized || low_rx.size() < num_prioritized) &&
+           system_clock::now() < end)
+        portal.poll(milliseconds(10));
+
+    glog.is(VERBOSE) && glog << "high priority done after " << low_at_high_done
+                             << " low priority" << std::endl;
+
+    // nothing is lost, and each class stays in order
+    assert(high_rx.size() == num_prioritized && low_rx.size() == num_prioritized);
+    for (int i = 0; i < num_prioritized; ++i) assert(high_rx[i] == i && low_rx[i] == i);
+
+    // the high priority messages overtook most of the low priority backlog (roughly one low for
+    // every four high, after those already in the handoff queue), without starving it entirely
+    assert(low_at_high_done > 0 && low_at_high_done < num_prioritized / 2);
+
+    using goby::middleware::TransportStats;
+    const auto& high_stats = TransportStats::priority_class(
+        goby::middleware::protobuf::LAYER_INTERPROCESS, TransporterConfig::QoS::PRIORITY_HIGH);
+    const auto& low_stats = TransportStats::priority_class(
+        goby::middleware::protobuf::LAYER_INTERPROCESS, TransporterConfig::QoS::PRIORITY_LOW);
+    assert(high_stats.received == num_prioritized && low_stats.received == num_prioritized);
+    assert(low_stats.deferred > 0);
+    assert(high_stats.queue_time.count() == num_prioritized);
+}
+
+void publisher(const goby::zeromq::protobuf::InterProcessPortalConfig& cfg)
+{
+    goby::zeromq::InterProcessPortal<> portal(cfg);
+    while (!subscribed) std::this_thread::sleep_for(milliseconds(10));
+    // allow the subscriptions to reach the publisher
+    std::this_thread::sleep_for(milliseconds(500));
+
+    for (int i = 0; i < num_messages; ++i)
+    {
+        std::string s = std::to_string(i);
+        portal.publish<unbounded>(s);
+        portal.publish<drop_newest>(s);
+        portal.publish<conflate>(s);
+        if (i % 100 == 99)
+            portal.poll(milliseconds(1));
+    }
+    portal.poll(milliseconds(10));
+    published = true;
+
+    while (!prioritized_subscribed) std::this_thread::sleep_for(milliseconds(10));
+    std::this_thread::sleep_for(milliseconds(500));
+    for (int i = 0; i < num_prioritized; ++i) portal.publish<low>(std::to_string(i));
+    for (int i = 0; i < num_prioritized; ++i) portal.publish<high>(std::to_string(i));
+    portal.poll(milliseconds(10));
+    prioritized_published = true;
+}
+
+int main(int argc, char* argv[])
+{
+    goby::zeromq::protobuf::InterProcessPortalConfig cfg;
+    cfg.set_platform("test_zeromq_subscription_qos");
+    cfg.set_handoff_queue_size(10);
+
+    goby::glog.add_stream(goby::util::logger::WARN, &std::cerr);
+    goby::glog.set_name(argv[0]);
+    goby::glog.set_lock_action(goby::util::logger_lock::lock);
+
+    std::unique_ptr<zmq::context_t> manager_context(new zmq::context_t(1));
+    std::unique_ptr<zmq::context_t> router_context(new zmq::context_t(10));
+    goby::zeromq::Router router(*router_context, cfg);
+    std::thread router_thread([&] { router.run(); });
+    goby::zeromq::Manager manager(*manager_context, cfg, router);
+    std::thread manager_thread([&] { manager.run(); });
+
+    std::thread subscriber_thread([&] { subscriber(cfg); });
+    publisher(cfg);
+    subscriber_thread.join();
+
+    router_context.reset();
+    manager_context.reset();
+    router_thread.join();
+    manager_thread.join();
+
+    std::cout << "all tests passed" << std::endl;
+}
@@ -50,13 +50,13 @@ goby::util::ais::Decoder::Decoder(std::vector<NMEASentence> nmeas)
     for (const auto& nmea : nmeas) push(nmea);
 }
 
-bool goby::util::ais::Decoder::push(goby::util::NMEASentence nmea)
+bool goby::util::ais::Decoder::push_line(const std::string& line)
 {
     if (complete())
         throw(DecoderException("Message already decoded, no more NMEA lines required."));
 
-    if (!ais_stream_decoder_.AddLine(nmea.message()))
-        throw(DecoderException("NMEA sentence unused: " + nmea.message()));
+    if (!ais_stream_decoder_.AddLine(line))
+        throw(DecoderException("NMEA sentence unused: " + line));
 
     if (ais_stream_decoder_.size() > 0)
     {
@@ -52,7 +52,8 @@ class Decoder
     Decoder(std::vector<NMEASentence> nmeas);
 
     // returns true if message is complete
-    bool push(NMEASentence nmea);
+    bool push(const NMEASentence& nmea) { return push_line(nmea.message()); }
+    bool push(const NMEASentenceView& nmea) { return push_line(nmea.message().to_string()); }
 
     bool complete() { return ais_msg_ != nullptr; }
 
@@ -155,6 +156,7 @@ class Decoder
                 static_cast<protobuf::Position::PositionAccuracy>(ais.position_accuracy));
     }
 
+    bool push_line(const std::string& line);
     void decode_position();
     void decode_voyage();
 
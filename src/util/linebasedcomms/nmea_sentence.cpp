@@ -68,6 +68,63 @@ goby::util::NMEASentence::NMEASentence(std::string s, strategy cs_strat /*= VALI
         throw bad_nmea_sentence("NMEASentence: bad talker length '" + s + "'.");
 }
 
+void goby::util::NMEASentenceView::parse(boost::string_view s,
+                                         strategy cs_strat /*= NMEASentence::VALIDATE*/)
+{
+    fields_.clear();
+
+    // Silently drop leading/trailing whitespace if present.
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    message_ = s;
+
+    if (s.empty())
+        throw bad_nmea_sentence("NMEASentence: no message provided.");
+    if (s[0] != '$' && s[0] != '!')
+        throw bad_nmea_sentence("NMEASentence: no $ or !: '" + s.to_string() + "'.");
+
+    bool found_csum = false;
+    unsigned cs = 0;
+    if (s.size() > 3 && s[s.size() - 3] == '*')
+    {
+        found_csum = true;
+        for (char c : s.substr(s.size() - 2))
+        {
+            cs <<= 4;
+            if (c >= '0' && c <= '9')
+                cs |= c - '0';
+            else if (c >= 'A' && c <= 'F')
+                cs |= c - 'A' + 10;
+            else if (c >= 'a' && c <= 'f')
+                cs |= c - 'a' + 10;
+            else
+                found_csum = false;
+        }
+        s.remove_suffix(3);
+    }
+    message_no_cs_ = s;
+
+    if (cs_strat == NMEASentence::REQUIRE && !found_csum)
+        throw bad_nmea_sentence("NMEASentence: no checksum: '" + s.to_string() + "'.");
+
+    if (found_csum && (cs_strat == NMEASentence::REQUIRE || cs_strat == NMEASentence::VALIDATE))
+    {
+        unsigned char calc_cs = 0;
+        for (auto it = s.begin() + 1, end = s.end(); it != end && *it != '*'; ++it) calc_cs ^= *it;
+        if (calc_cs != cs)
+            throw bad_nmea_sentence("NMEASentence: bad checksum: '" + s.to_string() + "'.");
+    }
+
+    for (boost::string_view::size_type comma; (comma = s.find(',')) != boost::string_view::npos;
+         s.remove_prefix(comma + 1))
+        fields_.emplace_back(s.substr(0, comma));
+    fields_.emplace_back(s);
+
+    if (NMEASentence::enforce_talker_length && fields_.front().size() != 6)
+        throw bad_nmea_sentence("NMEASentence: bad talker length '" + message_no_cs_.to_string() +
+                                "'.");
+}
+
 unsigned char goby::util::NMEASentence::checksum(const std::string& s)
 {
     unsigned char csum = 0;
@@ -25,12 +25,18 @@
 #ifndef NMEASentence20091211H
 #define NMEASentence20091211H
 
+#include <cctype>
+#include <cstdlib>
 #include <exception>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/container/small_vector.hpp>
+#include <boost/utility/string_view.hpp>
 
 #include "goby/util/as.h"
 
@@ -99,6 +105,169 @@ class NMEASentence : public std::vector<std::string>
 
     static bool enforce_talker_length;
 };
+
+/// \brief A single field of an NMEASentenceView: a boost::string_view that can also be implicitly converted to std::string (which allocates) for compatibility with code written for NMEASentence
+class NMEAField : public boost::string_view
+{
+  public:
+    NMEAField() = default;
+    NMEAField(boost::string_view sv) : boost::string_view(sv) {}
+    operator std::string() const { return to_string(); }
+};
+
+/// \brief Zero-copy, read-only alternative to NMEASentence
+///
+/// The sentence is tokenized into NMEAField (string_view) fields over the caller's buffer, the checksum is validated in place, and the numeric accessors parse without any heap allocation. The buffer passed to the constructor or parse() must outlive the view (and must not be modified). Sentences with up to 32 fields are tokenized without allocation; parse() may be called repeatedly on the same view to reuse its storage.
+///
+/// Conversions from as<T>() follow goby::util::as: a field that cannot be fully parsed returns NaN (floating point), the maximum value (integers), 0 (enumerations), or false (bool, which accepts "true" or "1").
+class NMEASentenceView
+{
+  public:
+    using strategy = NMEASentence::strategy;
+    using const_iterator = const NMEAField*;
+
+    NMEASentenceView() = default;
+    /// \brief Parse a sentence (see parse())
+    explicit NMEASentenceView(boost::string_view s, strategy cs_strat = NMEASentence::VALIDATE)
+    {
+        parse(s, cs_strat);
+    }
+
+    /// \brief Parse a sentence, with the same rules (and exceptions) as the NMEASentence constructor
+    void parse(boost::string_view s, strategy cs_strat = NMEASentence::VALIDATE);
+
+    std::size_t size() const { return fields_.size(); }
+    bool empty() const { return fields_.empty(); }
+    const NMEAField& operator[](std::size_t i) const { return fields_[i]; }
+    const NMEAField& at(std::size_t i) const
+    {
+        if (i >= fields_.size())
+            throw std::out_of_range("NMEASentenceView: field " + std::to_string(i) +
+                                    " out of range for: " + message_no_cs_.to_string());
+        return fields_[i];
+    }
+    const NMEAField& front() const { return fields_.front(); }
+    const NMEAField& back() const { return fields_.back(); }
+    const_iterator begin() const { return fields_.data(); }
+    const_iterator end() const { return fields_.data() + fields_.size(); }
+
+    /// \brief first two talker (CC)
+    boost::string_view talker_id() const
+    {
+        return empty() ? boost::string_view() : front().substr(1, 2);
+    }
+
+    /// \brief last three (CFG)
+    boost::string_view sentence_id() const
+    {
+        return empty() ? boost::string_view() : front().substr(3);
+    }
+
+    /// \brief Bare message, no checksum or \r\n
+    boost::string_view message_no_cs() const { return message_no_cs_; }
+
+    /// \brief Message as parsed (less any leading or trailing whitespace), including the checksum if it was present
+    boost::string_view message() const { return message_; }
+
+    /// \brief Copy into an (owning) NMEASentence
+    NMEASentence to_sentence() const
+    {
+        NMEASentence nmea;
+        for (const auto& field : fields_) nmea.std::vector<std::string>::push_back(field);
+        return nmea;
+    }
+
+    /// \brief Parse field \c i as type T
+    template <typename T> T as(std::size_t i) const { return field_as<T>(at(i)); }
+
+    /// \brief Parse any string_view (e.g. a substring of a field) as type T. Does not allocate for arithmetic, enumeration and bool types.
+    template <typename T> static T field_as(boost::string_view field)
+    {
+        return field_as_impl(field, static_cast<T*>(nullptr));
+    }
+
+  private:
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value, T>::type
+    field_as_impl(boost::string_view field, T*)
+    {
+        T value;
+        return parse_integer(field, value) ? value : std::numeric_limits<T>::max();
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, T>::type
+    field_as_impl(boost::string_view field, T*)
+    {
+        // strtod requires a null-terminated string, so copy to the stack
+        char buffer[64];
+        if (field.size() >= sizeof(buffer))
+            return goby::util::as<T>(field.to_string());
+        if (field.empty() || std::isspace(static_cast<unsigned char>(field.front())))
+            return std::numeric_limits<T>::quiet_NaN();
+
+        field.copy(buffer, field.size());
+        buffer[field.size()] = '\0';
+        char* end;
+        T value = static_cast<T>(std::strtod(buffer, &end));
+        return (end == buffer + field.size()) ? value : std::numeric_limits<T>::quiet_NaN();
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value, T>::type
+    field_as_impl(boost::string_view field, T*)
+    {
+        int value;
+        return parse_integer(field, value) ? static_cast<T>(value) : static_cast<T>(0);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_class<T>::value, T>::type
+    field_as_impl(boost::string_view field, T*)
+    {
+        return goby::util::as<T>(field.to_string());
+    }
+
+    static bool field_as_impl(boost::string_view field, bool*)
+    {
+        return field == "1" || boost::iequals(field, "true");
+    }
+
+    // parse an entire field as a base 10 integer, returning false on any invalid character or overflow
+    template <typename T> static bool parse_integer(boost::string_view field, T& value)
+    {
+        auto it = field.begin(), end = field.end();
+        bool negative = false;
+        if (it != end && (*it == '-' || *it == '+'))
+        {
+            negative = (*it == '-');
+            ++it;
+        }
+        if (it == end || (negative && !std::numeric_limits<T>::is_signed))
+            return false;
+
+        using U = typename std::make_unsigned<T>::type;
+        U limit = static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+        U result = 0;
+        for (; it != end; ++it)
+        {
+            if (*it < '0' || *it > '9')
+                return false;
+            U digit = *it - '0';
+            if (result > (limit - digit) / 10)
+                return false;
+            result = result * 10 + digit;
+        }
+        value = negative ? static_cast<T>(0 - result) : static_cast<T>(result);
+        return true;
+    }
+
+  private:
+    boost::string_view message_;
+    boost::string_view message_no_cs_;
+    boost::container::small_vector<NMEAField, 32> fields_;
+};
+
 } // namespace util
 } // namespace goby
 
@@ -109,4 +278,10 @@ inline std::ostream& operator<<(std::ostream& out, const goby::util::NMEASentenc
     return out;
 }
 
+inline std::ostream& operator<<(std::ostream& out, const goby::util::NMEASentenceView& nmea)
+{
+    out << nmea.message();
+    return out;
+}
+
 #endif
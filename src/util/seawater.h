@@ -25,6 +25,7 @@
 #ifndef SEAWATER_20190530H
 #define SEAWATER_20190530H
 
+#include "seawater/batch.h"
 #include "seawater/depth.h"
 #include "seawater/pressure.h"
 #include "seawater/salinity.h"
@@ -0,0 +1,137 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEAWATER_BATCH_20201019H
+#define SEAWATER_BATCH_20201019H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "goby/util/seawater/depth.h"
+#include "goby/util/seawater/pressure.h"
+#include "goby/util/seawater/salinity.h"
+#include "goby/util/seawater/soundspeed.h"
+
+namespace goby
+{
+namespace util
+{
+namespace seawater
+{
+/// \brief Batch (array) variants of the seawater functions for processing entire casts or high-rate sensor streams
+///
+/// Each function takes contiguous arrays (structure of arrays) of plain doubles in the canonical units noted below, and writes n results to the output array. The loops contain no calls or exceptions so that the compiler can vectorize them. Rather than throwing, values outside an algorithm's validity range are reported via an optional mask of OutOfRange flags (one byte per sample).
+namespace batch
+{
+/// \brief Mackenzie (1981) sound speed for n samples
+///
+/// \param temperature temperature in deg C
+/// \param salinity salinity (Practical Salinity Scale)
+/// \param depth depth in meters
+/// \param soundspeed (output) speed of sound in meters per second
+/// \param n number of samples in each array
+/// \param out_of_range (optional output) if not null, set to the bitwise OR of OutOfRange flags for each sample
+/// \return number of samples with at least one input outside the validity range
+inline std::size_t mackenzie_soundspeed(const double* temperature, const double* salinity,
+                                        const double* depth, double* soundspeed, std::size_t n,
+                                        std::uint8_t* out_of_range = nullptr)
+{
+    std::size_t num_out_of_range = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double T = temperature[i], S = salinity[i], D = depth[i];
+        soundspeed[i] = detail::mackenzie_soundspeed(T, S, D);
+        std::uint8_t bounds = detail::mackenzie_bounds(T, S, D);
+        if (out_of_range)
+            out_of_range[i] = bounds;
+        num_out_of_range += (bounds != IN_RANGE);
+    }
+    return num_out_of_range;
+}
+
+/// \brief UNESCO (1983) depth for n samples
+///
+/// \param pressure pressure in decibars
+/// \param latitude latitude in degrees
+/// \param depth (output) depth in meters
+/// \param n number of samples in each array
+inline void depth(const double* pressure, const double* latitude, double* depth, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) depth[i] = detail::depth(pressure[i], latitude[i]);
+}
+
+/// \brief UNESCO (1983) depth for n samples taken at a single latitude (e.g. a vertical cast)
+///
+/// \param pressure pressure in decibars
+/// \param latitude latitude in degrees
+/// \param depth (output) depth in meters
+/// \param n number of samples in the pressure and depth arrays
+inline void depth(const double* pressure, double latitude, double* depth, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) depth[i] = detail::depth(pressure[i], latitude);
+}
+
+/// \brief Saunders (1981) pressure for n samples
+///
+/// \param depth depth in meters
+/// \param latitude latitude in degrees
+/// \param pressure (output) pressure in decibars
+/// \param n number of samples in each array
+inline void pressure(const double* depth, const double* latitude, double* pressure, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) pressure[i] = detail::pressure(depth[i], latitude[i]);
+}
+
+/// \brief Saunders (1981) pressure for n samples taken at a single latitude (e.g. a vertical cast)
+///
+/// \param depth depth in meters
+/// \param latitude latitude in degrees
+/// \param pressure (output) pressure in decibars
+/// \param n number of samples in the depth and pressure arrays
+inline void pressure(const double* depth, double latitude, double* pressure, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) pressure[i] = detail::pressure(depth[i], latitude);
+}
+
+/// \brief UNESCO (1983) practical salinity for n samples
+///
+/// \param conductivity conductivity in mS/cm
+/// \param temperature temperature in deg C
+/// \param pressure pressure in decibars
+/// \param salinity (output) salinity (Practical Salinity Scale)
+/// \param n number of samples in each array
+inline void salinity(const double* conductivity, const double* temperature,
+                     const double* pressure, double* salinity, std::size_t n)
+{
+    const double conductivity_at_standard_value = conductivity_at_standard.value();
+    for (std::size_t i = 0; i < n; ++i)
+        salinity[i] = detail::SalinityCalculator::to_salinity(
+            conductivity[i] / conductivity_at_standard_value, temperature[i], pressure[i]);
+}
+
+} // namespace batch
+} // namespace seawater
+} // namespace util
+} // namespace goby
+
+#endif
@@ -45,6 +45,20 @@ namespace util
 {
 namespace seawater
 {
+namespace detail
+{
+/// UNESCO (1983) depth kernel: P in decibars, LAT in degrees, returns meters
+inline double depth(double P, double LAT)
+{
+    double X = std::sin(LAT / 57.29578);
+    X = X * X;
+    // GR= GRAVITY VARIATION WITH LATITUDE: ANON (1970) BULLETIN GEODESIQUE
+    double GR = 9.780318 * (1.0 + (5.2788E-3 + 2.36E-5 * X) * X) + 1.092E-6 * P;
+    double DEPTH = (((-1.82E-15 * P + 2.279E-10) * P - 2.2512E-5) * P + 9.72659) * P;
+    return DEPTH / GR;
+}
+} // namespace detail
+
 /// \brief Calculates depth from pressure and latitude
 /// Adapted from "Algorithms for computation of fundamental properties of seawater; UNESCO technical papers in marine science; Vol.:44; 1983"
 /// https://unesdoc.unesco.org/ark:/48223/pf0000059832
@@ -61,12 +75,7 @@ depth(boost::units::quantity<PressureUnit> pressure, boost::units::quantity<Lati
     double P = quantity<decltype(si::deci * bar)>(pressure).value();
     double LAT = quantity<degree::plane_angle>(latitude).value();
 
-    double X = std::sin(LAT / 57.29578);
-    X = X * X;
-    // GR= GRAVITY VARIATION WITH LATITUDE: ANON (1970) BULLETIN GEODESIQUE
-    double GR = 9.780318 * (1.0 + (5.2788E-3 + 2.36E-5 * X) * X) + 1.092E-6 * P;
-    double DEPTH = (((-1.82E-15 * P + 2.279E-10) * P - 2.2512E-5) * P + 9.72659) * P;
-    DEPTH = DEPTH / GR;
+    double DEPTH = detail::depth(P, LAT);
 
     return DEPTH * si::meters;
 }
@@ -57,6 +57,8 @@
 #ifndef SALINITY_IMPL_20190606H
 #define SALINITY_IMPL_20190606H
 
+#include <cmath>
+
 namespace goby
 {
 namespace util
@@ -87,12 +89,7 @@ class SalinityCalculator
         // SELECT BRANCH FOR SALINITY (M=0) OR CONDUCTIVITY (M=1)
         if (M == 0)
         {
-            // CONVERT CONDUCTIVITY TO SALINITY
-            double Res = CND;
-            double RT = Res / (RT35(T) * (1.0 + C(P) / (B(T) + A(T) * Res)));
-            RT = std::sqrt(std::abs(RT));
-            SAL78 = SAL(RT, DT);
-            return SAL78;
+            return to_salinity(CND, T, P);
         }
         else
         {
@@ -132,6 +129,18 @@ class SalinityCalculator
         }
     }
 
+    // CONVERT CONDUCTIVITY TO SALINITY (M=0) without branching on the
+    // input, so that loops over arrays of samples can be vectorized
+    static double to_salinity(double CND, double T, double P)
+    {
+        double Res = CND;
+        double RT = Res / (RT35(T) * (1.0 + C(P) / (B(T) + A(T) * Res)));
+        RT = std::sqrt(std::abs(RT));
+        double SAL78 = SAL(RT, T - 15);
+        // ZERO CONDUCTIVITY TRAP
+        return (CND <= 5e-4) ? 0.0 : SAL78;
+    }
+
   private:
     static double SAL(double XR, double XT)
     {
@@ -43,6 +43,20 @@ namespace util
 {
 namespace seawater
 {
+namespace detail
+{
+/// Saunders (1981) pressure kernel: DPTH in meters, XLAT in degrees, returns decibars
+inline double pressure(double DPTH, double XLAT)
+{
+    const double pi = goby::util::pi<double>;
+
+    double PLAT = std::abs(XLAT * pi / 180);
+    double D = std::sin(PLAT);
+    double C1 = (5.92E-3) + (D * D) * (5.25E-3);
+    return ((1 - C1) - std::sqrt(((1 - C1) * (1 - C1)) - ((8.84E-6) * DPTH))) / 4.42E-6;
+}
+} // namespace detail
+
 /// \brief Calculates pressure from depth and latitude
 ///
 /// Ref: Saunders, "Practical Conversion of Pressure to Depth", J. Phys. Oceanog., April 1981.
@@ -75,12 +89,7 @@ pressure(boost::units::quantity<DepthUnit> depth, boost::units::quantity<Latitud
     double DPTH = quantity<boost::units::si::length>(depth).value();
     double XLAT = quantity<degree::plane_angle>(latitude).value();
 
-    const double pi = goby::util::pi<double>;
-
-    double PLAT = std::abs(XLAT * pi / 180);
-    double D = std::sin(PLAT);
-    double C1 = (5.92E-3) + (D * D) * (5.25E-3);
-    double P80 = ((1 - C1) - sqrt(((1 - C1) * (1 - C1)) - ((8.84E-6) * DPTH))) / 4.42E-6;
+    double P80 = detail::pressure(DPTH, XLAT);
 
     return P80 * boost::units::si::deci * bar;
 }
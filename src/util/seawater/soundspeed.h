@@ -25,6 +25,7 @@
 #ifndef SOUNDSPEED_20190606H
 #define SOUNDSPEED_20190606H
 
+#include <cstdint>
 #include <stdexcept>
 
 #include <boost/units/quantity.hpp>
@@ -37,6 +38,33 @@ namespace util
 {
 namespace seawater
 {
+/// \brief Flags set in the out-of-range mask returned by the batch (array) seawater functions
+enum OutOfRange : std::uint8_t
+{
+    IN_RANGE = 0,
+    TEMPERATURE_OUT_OF_RANGE = 1 << 0,
+    SALINITY_OUT_OF_RANGE = 1 << 1,
+    DEPTH_OUT_OF_RANGE = 1 << 2
+};
+
+namespace detail
+{
+/// Mackenzie (1981) sound speed kernel: T in deg C, S unitless (PSS), D in meters, returns m/s
+inline double mackenzie_soundspeed(double T, double S, double D)
+{
+    return 1448.96 + 4.591 * T - 5.304e-2 * T * T + 2.374e-4 * T * T * T + 1.340 * (S - 35) +
+           1.630e-2 * D + 1.675e-7 * D * D - 1.025e-2 * T * (S - 35) - 7.139e-13 * T * D * D * D;
+}
+
+/// Mackenzie (1981) validity check, returns bitwise OR of OutOfRange flags
+inline std::uint8_t mackenzie_bounds(double T, double S, double D)
+{
+    return ((T < -2 || T > 30) ? TEMPERATURE_OUT_OF_RANGE : IN_RANGE) |
+           ((S < 25 || S > 40) ? SALINITY_OUT_OF_RANGE : IN_RANGE) |
+           ((D < 0 || D > 8000) ? DEPTH_OUT_OF_RANGE : IN_RANGE);
+}
+} // namespace detail
+
 /// K.V. Mackenzie, Nine-term equation for the sound speed in the oceans (1981) J. Acoust. Soc. Am. 70(3), pp 807-812
 /// https://doi.org/10.1121/1.386920
 /// Ranges of validity encompass: temperature -2 to 30 deg C, salinity 25 to 40, and depth 0 to 8000 m.
@@ -59,28 +87,18 @@ mackenzie_soundspeed(boost::units::quantity<boost::units::absolute<TemperatureUn
     double S = quantity<si::dimensionless>(salinity).value();
     double D = quantity<si::length>(depth).value();
 
-    double min_T(-2);
-    double max_T(30);
-
-    double min_S(25);
-    double max_S(40);
-
-    double min_D(0);
-    double max_D(8000);
-
     if (!ignore_bounds)
     {
-        if (T < min_T || T > max_T)
+        auto bounds = detail::mackenzie_bounds(T, S, D);
+        if (bounds & TEMPERATURE_OUT_OF_RANGE)
             throw std::out_of_range("Temperature not in valid range [-2, 30] deg C");
-        if (S < min_S || S > max_S)
+        if (bounds & SALINITY_OUT_OF_RANGE)
             throw std::out_of_range("Salinity not in valid range [25, 40]");
-        if (D < min_D || D > max_D)
+        if (bounds & DEPTH_OUT_OF_RANGE)
             throw std::out_of_range("Depth not in valid range [0, 8000] meters");
     }
 
-    return (1448.96 + 4.591 * T - 5.304e-2 * T * T + 2.374e-4 * T * T * T + 1.340 * (S - 35) +
-            1.630e-2 * D + 1.675e-7 * D * D - 1.025e-2 * T * (S - 35) - 7.139e-13 * T * D * D * D) *
-           si::meters_per_second;
+    return detail::mackenzie_soundspeed(T, S, D) * si::meters_per_second;
 }
 
 /// K.V. Mackenzie, Nine-term equation for the sound speed in the oceans (1981) J. Acoust. Soc. Am. 70(3), pp 807-812 (variant that accepts plain double for salinity)
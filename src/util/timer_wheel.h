@@ -0,0 +1,200 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef UTIL_TIMER_WHEEL_20201019H
+#define UTIL_TIMER_WHEEL_20201019H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace goby
+{
+namespace util
+{
+/// \brief Hashed timer wheel for tracking a large number of deadlines that are frequently pushed back (e.g. heartbeats, timeouts)
+///
+/// Scheduling, rescheduling and cancelling a key are O(1). Rescheduling does not search the wheel: the old slot entry is simply left behind and discarded when its slot comes around (it no longer matches the key's generation). Deadlines further away than one revolution of the wheel are carried around the wheel until due. Expiry is reported with a resolution of one tick.
+///
+/// \tparam Key Type used to identify each timer (must be hashable)
+/// \tparam Clock Clock type (e.g. goby::time::SteadyClock)
+template <typename Key, typename Clock> class TimerWheel
+{
+  public:
+    using time_point = typename Clock::time_point;
+    using duration = typename Clock::duration;
+
+    /// \brief Construct the wheel
+    ///
+    /// \param tick Resolution of the wheel
+    /// \param slots Number of slots in the wheel (tick*slots is one revolution)
+    /// \param start Time of the first tick
+    TimerWheel(duration tick, std::size_t slots = 64, time_point start = Clock::now())
+        : tick_(std::max(tick, duration(1))),
+          slots_(std::max<std::size_t>(slots, 2)),
+          current_time_(start)
+    {
+    }
+
+    /// \brief Schedule \c key to expire at \c expiry, replacing any existing deadline for \c key
+    void schedule(const Key& key, time_point expiry)
+    {
+        auto& entry = entries_[key];
+        entry.expiry = expiry;
+        ++entry.generation;
+        insert(key, entry);
+    }
+
+    /// \brief Schedule \c key to expire \c timeout after the wheel's current time
+    void schedule_in(const Key& key, duration timeout) { schedule(key, current_time_ + timeout); }
+
+    /// \brief Remove \c key from the wheel without calling the expiry function. Returns true if \c key was scheduled.
+    bool cancel(const Key& key) { return entries_.erase(key) > 0; }
+
+    /// \brief Returns true if \c key is scheduled (and has not yet expired)
+    bool contains(const Key& key) const { return entries_.count(key); }
+
+    /// \brief Number of keys currently scheduled
+    std::size_t size() const { return entries_.size(); }
+
+    /// \brief Time of the last processed tick
+    time_point current_time() const { return current_time_; }
+
+    /// \brief Time at which the next tick is due: calling advance() before this time is a no-op
+    time_point next_tick() const { return current_time_ + tick_; }
+
+    /// \brief Earliest time at which advance() may expire a key, or time_point::max() if no keys are scheduled
+    ///
+    /// This is a lower bound (the first occupied slot may only hold cancelled or rescheduled entries, or deadlines carried to a later revolution), so waiting until this time never misses an expiry. O(slots).
+    time_point next_due() const
+    {
+        if (entries_.empty())
+            return time_point::max();
+
+        // insert() never uses the current slot
+        for (std::size_t ticks = 1, n = slots_.size(); ticks < n; ++ticks)
+        {
+            if (!slots_[(current_slot_ + ticks) % n].empty())
+                return current_time_ + static_cast<typename duration::rep>(ticks) * tick_;
+        }
+        return next_tick();
+    }
+
+    /// \brief Process all ticks up to \c now, calling \c expired(key) for every key whose deadline has passed
+    ///
+    /// Takes at most one revolution of work however far \c now is from the last call. If \c now is earlier than current_time() (e.g. a non-steady clock stepped backwards), nothing expires until the clock passes current_time() again, so prefer a steady clock.
+    ///
+    /// \return number of keys expired
+    template <typename ExpiredFunc> std::size_t advance(time_point now, ExpiredFunc expired)
+    {
+        // after a long gap (e.g. the caller stalled, or a forward step of a non-steady clock), skip
+        // whole revolutions: every slot is still visited once below, so nothing is missed
+        const auto num_slots = static_cast<typename duration::rep>(slots_.size());
+        const auto revolution = tick_ * num_slots;
+        if (now > current_time_ && now - current_time_ > revolution)
+        {
+            auto skipped_ticks = (now - current_time_ - revolution) / tick_;
+            current_time_ += skipped_ticks * tick_;
+            auto skipped_slots = static_cast<std::size_t>(skipped_ticks % num_slots);
+            current_slot_ = (current_slot_ + skipped_slots) % slots_.size();
+        }
+
+        std::size_t count = 0;
+        while (current_time_ + tick_ <= now)
+        {
+            current_time_ += tick_;
+            current_slot_ = (current_slot_ + 1) % slots_.size();
+
+            // swap out, as we may reinsert into this slot (deadlines more than one revolution away)
+            std::vector<SlotEntry> slot;
+            slot.swap(slots_[current_slot_]);
+
+            for (const auto& slot_entry : slot)
+            {
+                auto it = entries_.find(slot_entry.key);
+                // cancelled or rescheduled since this slot entry was inserted
+                if (it == entries_.end() || it->second.generation != slot_entry.generation)
+                    continue;
+
+                if (it->second.expiry <= current_time_)
+                {
+                    entries_.erase(it);
+                    ++count;
+                    expired(slot_entry.key);
+                }
+                else
+                {
+                    insert(slot_entry.key, it->second);
+                }
+            }
+
+            // hand back the allocation if the slot is still empty
+            if (slots_[current_slot_].empty())
+            {
+                slot.clear();
+                slots_[current_slot_].swap(slot);
+            }
+        }
+        return count;
+    }
+
+  private:
+    struct Entry
+    {
+        time_point expiry;
+        std::uint64_t generation{0};
+    };
+
+    struct SlotEntry
+    {
+        Key key;
+        std::uint64_t generation;
+    };
+
+    void insert(const Key& key, const Entry& entry)
+    {
+        std::size_t ticks = 1;
+        if (entry.expiry > current_time_)
+        {
+            // round up, so we never expire early
+            ticks = (entry.expiry - current_time_ + tick_ - duration(1)) / tick_;
+            ticks = std::min(std::max<std::size_t>(ticks, 1), slots_.size() - 1);
+        }
+        slots_[(current_slot_ + ticks) % slots_.size()].push_back({key, entry.generation});
+    }
+
+  private:
+    duration tick_;
+    std::vector<std::vector<SlotEntry>> slots_;
+    std::size_t current_slot_{0};
+    time_point current_time_;
+    std::unordered_map<Key, Entry> entries_;
+};
+
+} // namespace util
+} // namespace goby
+
+#endif
@@ -0,0 +1,292 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <zlib.h>
+
+#include "goby/exception.h"
+#include "goby/util/debug_logger.h"
+
+#include "federation.h"
+#include "interprocess.h"
+
+using goby::glog;
+using namespace goby::util::logger;
+
+namespace
+{
+// topic of the batches (identifiers of publications always begin with '/')
+const std::string batch_topic{"#goby_federation"};
+
+enum BatchFlags : char
+{
+    BATCH_UNCOMPRESSED = 0,
+    BATCH_COMPRESSED = 1
+};
+
+void append_uint32(std::string* s, std::uint32_t v)
+{
+    char bytes[4] = {static_cast<char>(v >> 24), static_cast<char>(v >> 16),
+                     static_cast<char>(v >> 8), static_cast<char>(v)};
+    s->append(bytes, 4);
+}
+
+std::uint32_t read_uint32(const char* p)
+{
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    return (std::uint32_t(b[0]) << 24) | (std::uint32_t(b[1]) << 16) | (std::uint32_t(b[2]) << 8) |
+           std::uint32_t(b[3]);
+}
+} // namespace
+
+goby::zeromq::Federation::Federation(zmq::context_t& context,
+                                     const protobuf::FederationConfig& cfg)
+    : cfg_(cfg), publish_socket_(context, ZMQ_XPUB), subscribe_socket_(context, ZMQ_XSUB)
+{
+    std::string endpoint =
+        "tcp://" + cfg_.bind_address() + ":" + std::to_string(cfg_.bind_port());
+    publish_socket_.bind(endpoint.c_str());
+
+    for (const auto& peer : cfg_.peer())
+    {
+        std::string peer_endpoint = "tcp://" + peer.address() + ":" + std::to_string(peer.port());
+        subscribe_socket_.connect(peer_endpoint.c_str());
+        glog.is(DEBUG1) && glog << "Federation: connecting to peer " << peer_endpoint << std::endl;
+    }
+
+    send_subscription(true, batch_topic);
+}
+
+void goby::zeromq::Federation::send_subscription(bool subscribe, const std::string& topic)
+{
+    zmq::message_t msg(topic.size() + 1);
+    auto data = static_cast<char*>(msg.data());
+    data[0] = subscribe ? 1 : 0;
+    std::copy(topic.begin(), topic.end(), data + 1);
+    subscribe_socket_.send(msg, zmq::send_flags::none);
+}
+
+void goby::zeromq::Federation::local_subscription(const zmq::message_t& msg)
+{
+    zmq::message_t copy(msg.data(), msg.size());
+    subscribe_socket_.send(copy, zmq::send_flags::none);
+}
+
+bool goby::zeromq::Federation::peer_subscription(const zmq::message_t& msg)
+{
+    if (msg.size() < 1)
+        return false;
+
+    auto data = static_cast<const char*>(msg.data());
+    bool subscribe = (data[0] == 1);
+    std::string topic(data + 1, msg.size() - 1);
+
+    if (topic == batch_topic)
+        return false;
+
+    glog.is(DEBUG2) && glog << "Federation: peer " << (subscribe ? "subscribed" : "unsubscribed")
+                            << " [" << topic << "]" << std::endl;
+
+    if (subscription_identifier(topic.data(), topic.size()) == topic)
+    {
+        if (subscribe)
+            ++peer_identifiers_[topic];
+        else if (--peer_identifiers_[topic] <= 0)
+            peer_identifiers_.erase(topic);
+    }
+    else
+    {
+        if (subscribe)
+        {
+            peer_prefixes_.push_back(topic);
+        }
+        else
+        {
+            auto it = std::find(peer_prefixes_.begin(), peer_prefixes_.end(), topic);
+            if (it != peer_prefixes_.end())
+                peer_prefixes_.erase(it);
+        }
+    }
+    return true;
+}
+
+bool goby::zeromq::Federation::peer_subscribed(const char* data, std::size_t size) const
+{
+    if (!peer_identifiers_.empty() &&
+        peer_identifiers_.count(subscription_identifier(data, size)))
+        return true;
+
+    for (const auto& prefix : peer_prefixes_)
+    {
+        if (prefix.size() <= size && std::equal(prefix.begin(), prefix.end(), data))
+            return true;
+    }
+    return false;
+}
+
+bool goby::zeromq::Federation::publish(const char* data, std::size_t size)
+{
+    if (!peer_subscribed(data, size))
+        return false;
+
+    if (batch_.empty())
+        batch_start_ = std::chrono::steady_clock::now();
+
+    append_uint32(&batch_, size);
+    batch_.append(data, size);
+
+    if (cfg_.max_batch_delay_ms() == 0 || batch_.size() >= cfg_.max_batch_bytes())
+        flush();
+    return true;
+}
+
+long goby::zeromq::Federation::flush_timeout_ms() const
+{
+    if (batch_.empty())
+        return -1;
+
+    auto due = batch_start_ + std::chrono::milliseconds(cfg_.max_batch_delay_ms());
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         due - std::chrono::steady_clock::now())
+                         .count();
+    return std::max<long>(remaining, 0);
+}
+
+void goby::zeromq::Federation::flush_if_due()
+{
+    if (flush_timeout_ms() == 0)
+        flush();
+}
+
+void goby::zeromq::Federation::flush()
+{
+    if (batch_.empty())
+        return;
+
+    frame_.assign(batch_topic);
+    if (cfg_.compress())
+    {
+        frame_.push_back(BATCH_COMPRESSED);
+        append_uint32(&frame_, batch_.size());
+
+        auto header_size = frame_.size();
+        uLongf compressed_size = compressBound(batch_.size());
+        frame_.resize(header_size + compressed_size);
+        int result = compress2(reinterpret_cast<Bytef*>(&frame_[header_size]), &compressed_size,
+                               reinterpret_cast<const Bytef*>(batch_.data()), batch_.size(),
+                               cfg_.compression_level());
+        if (result != Z_OK)
+            throw(goby::Exception("Federation: failed to compress batch of " +
+                                  std::to_string(batch_.size()) +
+                                  " bytes, zlib error: " + std::to_string(result)));
+        frame_.resize(header_size + compressed_size);
+    }
+    else
+    {
+        frame_.push_back(BATCH_UNCOMPRESSED);
+        frame_.append(batch_);
+    }
+
+    glog.is(DEBUG3) && glog << "Federation: sending batch of " << batch_.size() << " bytes ("
+                            << frame_.size() << " on the wire)" << std::endl;
+
+    zmq::message_t msg(frame_.data(), frame_.size());
+    publish_socket_.send(msg, zmq::send_flags::none);
+    batch_.clear();
+}
+
+int goby::zeromq::Federation::receive(
+    const zmq::message_t& batch,
+    const std::function<void(const char* data, std::size_t size)>& deliver)
+{
+    auto data = static_cast<const char*>(batch.data());
+    std::size_t size = batch.size();
+    if (size < batch_topic.size() + 1 || !std::equal(batch_topic.begin(), batch_topic.end(), data))
+    {
+        glog.is(WARN) && glog << "Federation: ignoring invalid message from peer" << std::endl;
+        return 0;
+    }
+
+    char flags = data[batch_topic.size()];
+    const char* begin = data + batch_topic.size() + 1;
+    const char* end = data + size;
+
+    if (flags == BATCH_COMPRESSED)
+    {
+        if (end - begin < 4)
+        {
+            glog.is(WARN) && glog << "Federation: ignoring truncated batch from peer" << std::endl;
+            return 0;
+        }
+        uLongf inflated_size = read_uint32(begin);
+        begin += 4;
+        if (inflated_size > cfg_.max_inflated_batch_bytes())
+        {
+            glog.is(WARN) && glog << "Federation: ignoring batch from peer that inflates to "
+                                  << inflated_size << " bytes (max_inflated_batch_bytes: "
+                                  << cfg_.max_inflated_batch_bytes() << ")" << std::endl;
+            return 0;
+        }
+
+        // a bad batch from one peer must not stop the Router
+        try
+        {
+            inflated_.resize(inflated_size);
+            int result = uncompress(reinterpret_cast<Bytef*>(&inflated_[0]), &inflated_size,
+                                    reinterpret_cast<const Bytef*>(begin), end - begin);
+            if (result != Z_OK)
+                throw(goby::Exception("zlib error: " + std::to_string(result)));
+        }
+        catch (std::exception& e)
+        {
+            glog.is(WARN) && glog << "Federation: failed to decompress batch from peer: "
+                                  << e.what() << std::endl;
+            return 0;
+        }
+        begin = inflated_.data();
+        end = begin + inflated_size;
+    }
+    else if (flags != BATCH_UNCOMPRESSED)
+    {
+        glog.is(WARN) && glog << "Federation: ignoring batch from peer with unknown flags: "
+                              << static_cast<int>(flags) << std::endl;
+        return 0;
+    }
+
+    int count = 0;
+    while (end - begin >= 4)
+    {
+        std::uint32_t length = read_uint32(begin);
+        begin += 4;
+        if (static_cast<std::size_t>(end - begin) < length)
+        {
+            glog.is(WARN) && glog << "Federation: truncated batch from peer" << std::endl;
+            break;
+        }
+        deliver(begin, length);
+        begin += length;
+        ++count;
+    }
+    return count;
+}
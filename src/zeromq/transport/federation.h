@@ -0,0 +1,110 @@
+// Copyright 2020:
+//   GobySoft, LLC (2013-)
+//   Community contributors (see AUTHORS file)
+// File authors:
+//   Toby Schneider <toby@gobysoft.org>
+//
+//
+// This file is part of the Goby Underwater Autonomy Project Libraries
+// ("The Goby Libraries").
+//
+// The Goby Libraries are free software: you can redistribute them and/or modify
+// them under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// The Goby Libraries are distributed in the hope that they will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Goby.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ZeroMQFederation20201019H
+#define ZeroMQFederation20201019H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "goby/zeromq/protobuf/interprocess_config.pb.h"
+
+namespace goby
+{
+namespace zeromq
+{
+/// \brief gobyd-to-gobyd federation, run by the Router (see protobuf::FederationConfig)
+///
+/// Owns two TCP sockets: an XPUB (bound) on which the peers' subscriptions arrive and this gobyd's subscribed local publications leave in batches, and an XSUB (connected to each peer) that carries this gobyd's local subscriptions to the peers and receives their batches. Only local publications are sent to the peers, so traffic is never forwarded more than one hop.
+class Federation
+{
+  public:
+    Federation(zmq::context_t& context, const protobuf::FederationConfig& cfg);
+
+    Federation(Federation&) = delete;
+    Federation& operator=(Federation&) = delete;
+
+    /// \brief Socket to poll for subscriptions from the peers (pass messages to peer_subscription())
+    zmq::socket_t& peer_publish_socket() { return publish_socket_; }
+    /// \brief Socket to poll for batches from the peers (pass messages to receive())
+    zmq::socket_t& peer_subscribe_socket() { return subscribe_socket_; }
+
+    /// \brief Send a local (un)subscription message (as received by the Router's XPUB socket) to the peers
+    void local_subscription(const zmq::message_t& msg);
+
+    /// \brief Handle an (un)subscription message from a peer
+    ///
+    /// \return true if the message should be forwarded to the local publishers
+    bool peer_subscription(const zmq::message_t& msg);
+
+    /// \brief Queue a local publication for the peers, if any has subscribed to it
+    ///
+    /// \return true if the publication was queued
+    bool publish(const char* data, std::size_t size);
+
+    /// \brief Unpack a batch from a peer, calling deliver for each publication it contains
+    ///
+    /// \return number of publications delivered
+    int receive(const zmq::message_t& batch,
+                const std::function<void(const char* data, std::size_t size)>& deliver);
+
+    /// \brief Milliseconds until the pending batch is due to be sent (for the Router's poll timeout), or -1 if there is none
+    long flush_timeout_ms() const;
+
+    /// \brief Send the pending batch if it is due
+    void flush_if_due();
+
+  private:
+    void flush();
+    void send_subscription(bool subscribe, const std::string& topic);
+    bool peer_subscribed(const char* data, std::size_t size) const;
+
+  private:
+    const protobuf::FederationConfig& cfg_;
+    zmq::socket_t publish_socket_;
+    zmq::socket_t subscribe_socket_;
+
+    // the peers' subscriptions: full identifiers ("/group/scheme/type/") and other (shorter)
+    // prefixes, such as the "/" used by regex subscriptions
+    std::unordered_map<std::string, int> peer_identifiers_;
+    std::vector<std::string> peer_prefixes_;
+
+    // length-prefixed publications waiting to be sent
+    std::string batch_;
+    std::chrono::steady_clock::time_point batch_start_;
+    // reused for (de)compression
+    std::string frame_;
+    std::string inflated_;
+};
+
+} // namespace zeromq
+} // namespace goby
+
+#endif
@@ -21,8 +21,10 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Goby.  If not, see <http://www.gnu.org/licenses/>.
 
+#include "goby/middleware/application/thread_scheduling.h"
 #include "goby/time/system_clock.h"
 
+#include "federation.h"
 #include "interprocess.h"
 
 using goby::glog;
@@ -37,6 +39,14 @@ auto zmq_send_flags_none{zmq::send_flags::none};
 auto zmq_recv_flags_none{zmq::recv_flags::none};
 #endif
 
+#ifdef USE_OLD_ZMQ_CPP_API
+int zmq_send_flags_more{ZMQ_SNDMORE};
+int zmq_send_flags_dontwait{ZMQ_DONTWAIT};
+#else
+auto zmq_send_flags_more{zmq::send_flags::sndmore};
+auto zmq_send_flags_dontwait{zmq::send_flags::dontwait};
+#endif
+
 bool zmq_socket_recv(zmq::socket_t& socket, zmq::message_t& msg,
                      goby::zeromq::zmq_recv_flags_type flags = zmq_recv_flags_none)
 {
@@ -47,6 +57,36 @@ bool zmq_socket_recv(zmq::socket_t& socket, zmq::message_t& msg,
 #endif
 }
 
+// returns false if a non-blocking send would have blocked
+bool zmq_socket_send(zmq::socket_t& socket, zmq::message_t& msg,
+                     goby::zeromq::zmq_send_flags_type flags)
+{
+#ifdef USE_OLD_ZMQ_CPP_API
+    return socket.send(msg, flags);
+#else
+    return bool(socket.send(msg, flags));
+#endif
+}
+
+// serializes directly into the zmq message, computing the Protobuf message size only once
+void zmq_serialize(const google::protobuf::Message& pb_msg, zmq::message_t& msg)
+{
+    msg.rebuild(pb_msg.ByteSize());
+    if (msg.size() > 0)
+        pb_msg.SerializeWithCachedSizesToArray(static_cast<std::uint8_t*>(msg.data()));
+}
+
+std::string goby::zeromq::subscription_identifier(const char* data, std::size_t size)
+{
+    int slashes = 0;
+    for (std::size_t i = 0; i < size && data[i] != '\0'; ++i)
+    {
+        if (data[i] == '/' && ++slashes == 4)
+            return std::string(data, i + 1);
+    }
+    return std::string();
+}
+
 void goby::zeromq::setup_socket(zmq::socket_t& socket, const protobuf::Socket& cfg)
 {
     int send_hwm = cfg.send_queue_size();
@@ -80,15 +120,26 @@ void goby::zeromq::setup_socket(zmq::socket_t& socket, const protobuf::Socket& c
 // InterProcessPortalMainThread
 //
 
-goby::zeromq::InterProcessPortalMainThread::InterProcessPortalMainThread(zmq::context_t& context)
-    : control_socket_(context, ZMQ_PAIR), publish_socket_(context, ZMQ_PUB)
+goby::zeromq::InterProcessPortalMainThread::InterProcessPortalMainThread(
+    const protobuf::InterProcessPortalConfig& cfg, zmq::context_t& context)
+    : cfg_(cfg), control_socket_(context, ZMQ_PAIR), publish_socket_(context, ZMQ_PUB)
 {
+    // inproc queues up to the sender's SNDHWM plus the receiver's RCVHWM (0 would be unlimited)
+    int receive_hwm = std::max(1u, cfg_.handoff_queue_size() / 2);
+    control_socket_.setsockopt(ZMQ_RCVHWM, &receive_hwm, sizeof(receive_hwm));
     control_socket_.bind("inproc://control");
 }
 
 bool goby::zeromq::InterProcessPortalMainThread::recv(protobuf::InprocControl* control_msg,
                                                       zmq_recv_flags_type flags)
 {
+    if (!control_backlog_.empty())
+    {
+        control_msg->Swap(&control_backlog_.front());
+        control_backlog_.pop_front();
+        return true;
+    }
+
     zmq::message_t zmq_msg;
     bool message_received = false;
     if (zmq_socket_recv(control_socket_, zmq_msg, flags))
@@ -125,7 +176,10 @@ void goby::zeromq::InterProcessPortalMainThread::publish(const std::string& iden
         memcpy(msg.data(), identifier.data(), identifier.size());
         memcpy(static_cast<char*>(msg.data()) + identifier.size(), bytes, size);
 
-        publish_socket_.send(msg, zmq_send_flags_none);
+        if (cfg_.has_publication_batching())
+            batch_publication(identifier, msg);
+        else
+            publish_socket_.send(msg, zmq_send_flags_none);
 
         glog.is(DEBUG3) && glog << "Published " << size << " bytes to ["
                                 << identifier.substr(0, identifier.size() - 1) << "]" << std::endl;
@@ -137,19 +191,55 @@ void goby::zeromq::InterProcessPortalMainThread::publish(const std::string& iden
     }
 }
 
+void goby::zeromq::InterProcessPortalMainThread::batch_publication(const std::string& identifier,
+                                                                   zmq::message_t& msg)
+{
+    const auto& batching = cfg_.publication_batching();
+    auto now = std::chrono::steady_clock::now();
+    if (batches_.empty())
+        batch_start_ = now;
+
+    // only consecutive publications to the same identifier share a batch, so that the batches
+    // are sent in the same order as the publications were made
+    if (batches_.empty() || batches_.back().identifier != identifier)
+    {
+        batches_.emplace_back();
+        batches_.back().identifier = identifier;
+    }
+
+    batch_bytes_ += msg.size();
+    batches_.back().parts.emplace_back(std::move(msg));
+
+    if (batch_bytes_ >= batching.max_bytes() ||
+        now - batch_start_ >= std::chrono::microseconds(batching.max_delay_us()))
+        flush_publications();
+}
+
+void goby::zeromq::InterProcessPortalMainThread::flush_publications()
+{
+    // each batch is sent as a multipart message (one publication per part), which the router and
+    // subscribers handle atomically
+    for (auto& batch : batches_)
+    {
+        for (std::size_t i = 0, n = batch.parts.size(); i < n; ++i)
+            publish_socket_.send(batch.parts[i],
+                                 i + 1 < n ? zmq_send_flags_more : zmq_send_flags_none);
+
+        glog.is(DEBUG3) && glog << "Published batch of " << batch.parts.size() << " to ["
+                                << batch.identifier.substr(0, batch.identifier.size() - 1) << "]"
+                                << std::endl;
+    }
+    batches_.clear();
+    batch_bytes_ = 0;
+}
+
 void goby::zeromq::InterProcessPortalMainThread::subscribe(const std::string& identifier)
 {
     protobuf::InprocControl control;
     control.set_type(protobuf::InprocControl::SUBSCRIBE);
     control.set_subscription_identifier(identifier);
     send_control_msg(control);
-
-    // wait for ack
-    protobuf::InprocControl control_ack;
-    recv(&control_ack);
-    if (control_ack.type() != protobuf::InprocControl::SUBSCRIBE_ACK)
-        glog.is(WARN) && glog << "Received invalid ack from InterProcessPortalReadThread: "
-                              << control_ack.ShortDebugString() << std::endl;
+    wait_for_ack(protobuf::InprocControl::SUBSCRIBE_ACK);
 }
 
 void goby::zeromq::InterProcessPortalMainThread::unsubscribe(const std::string& identifier)
@@ -158,14 +248,41 @@ void goby::zeromq::InterProcessPortalMainThread::unsubscribe(const std::string&
     control.set_type(protobuf::InprocControl::UNSUBSCRIBE);
     control.set_subscription_identifier(identifier);
     send_control_msg(control);
+    wait_for_ack(protobuf::InprocControl::UNSUBSCRIBE_ACK);
+}
 
-    // wait for ack
-    protobuf::InprocControl control_ack;
-    recv(&control_ack);
-    if (control_ack.type() != protobuf::InprocControl::UNSUBSCRIBE_ACK)
-        glog.is(WARN) && glog << "Received invalid ack from InterProcessPortalReadThread: "
-                              << control_ack.ShortDebugString() << std::endl;
+void goby::zeromq::InterProcessPortalMainThread::set_queue_policy(const std::string& identifier,
+                                                                  std::size_t max_depth,
+                                                                  bool drop_newest, int priority)
+{
+    protobuf::InprocControl control;
+    control.set_type(protobuf::InprocControl::QUEUE_POLICY);
+    control.set_subscription_identifier(identifier);
+    control.set_max_depth(max_depth);
+    control.set_drop_newest(drop_newest);
+    control.set_priority(priority);
+    send_control_msg(control);
 }
+
+void goby::zeromq::InterProcessPortalMainThread::wait_for_ack(
+    protobuf::InprocControl::InprocControlType ack_type)
+{
+    // received data (and the publish configuration) may be queued ahead of the ack: keep them for
+    // the next recv()
+    while (true)
+    {
+        zmq::message_t zmq_msg;
+        if (!zmq_socket_recv(control_socket_, zmq_msg))
+            continue;
+
+        protobuf::InprocControl control_msg;
+        control_msg.ParseFromArray((char*)zmq_msg.data(), zmq_msg.size());
+        if (control_msg.type() == ack_type)
+            return;
+        control_backlog_.push_back(std::move(control_msg));
+    }
+}
+
 void goby::zeromq::InterProcessPortalMainThread::reader_shutdown()
 {
     protobuf::InprocControl control;
@@ -176,8 +293,8 @@ void goby::zeromq::InterProcessPortalMainThread::reader_shutdown()
 void goby::zeromq::InterProcessPortalMainThread::send_control_msg(
     const protobuf::InprocControl& control)
 {
-    zmq::message_t zmq_control_msg(control.ByteSize());
-    control.SerializeToArray((char*)zmq_control_msg.data(), zmq_control_msg.size());
+    zmq::message_t zmq_control_msg;
+    zmq_serialize(control, zmq_control_msg);
 
     control_socket_.send(zmq_control_msg, zmq_send_flags_none);
 }
@@ -200,6 +317,9 @@ goby::zeromq::InterProcessPortalReadThread::InterProcessPortalReadThread(
     poll_items_[SOCKET_MANAGER] = {(void*)manager_socket_, 0, ZMQ_POLLIN, 0};
     poll_items_[SOCKET_SUBSCRIBE] = {(void*)subscribe_socket_, 0, ZMQ_POLLIN, 0};
 
+    // see InterProcessPortalMainThread: together at most handoff_queue_size (but at least 2)
+    int send_hwm = std::max(1u, cfg_.handoff_queue_size() - cfg_.handoff_queue_size() / 2);
+    control_socket_.setsockopt(ZMQ_SNDHWM, &send_hwm, sizeof(send_hwm));
     control_socket_.connect("inproc://control");
 
     protobuf::Socket query_socket;
@@ -226,6 +346,19 @@ goby::zeromq::InterProcessPortalReadThread::InterProcessPortalReadThread(
 
 void goby::zeromq::InterProcessPortalReadThread::run()
 {
+    if (cfg_.has_read_thread_scheduling())
+    {
+        try
+        {
+            goby::middleware::apply_thread_scheduling(cfg_.read_thread_scheduling(),
+                                                      "zeromq_read");
+        }
+        catch (goby::Exception& e)
+        {
+            goby::glog.is(goby::util::logger::DIE) && goby::glog << e.what() << std::endl;
+        }
+    }
+
     while (alive_)
     {
         if (have_pubsub_sockets_)
@@ -237,8 +370,8 @@ void goby::zeromq::InterProcessPortalReadThread::run()
             protobuf::ManagerRequest req;
             req.set_request(protobuf::PROVIDE_PUB_SUB_SOCKETS);
 
-            zmq::message_t msg(req.ByteSize());
-            req.SerializeToArray(static_cast<char*>(msg.data()), req.ByteSize());
+            zmq::message_t msg;
+            zmq_serialize(req, msg);
             manager_socket_.send(msg, zmq_send_flags_none);
 
             auto start = goby::time::SystemClock::now();
@@ -257,8 +390,13 @@ void goby::zeromq::InterProcessPortalReadThread::run()
 
 void goby::zeromq::InterProcessPortalReadThread::poll(long timeout_ms)
 {
+    // wake up when the main thread has room for held data
+    poll_items_[SOCKET_CONTROL].events = held_empty() ? ZMQ_POLLIN : (ZMQ_POLLIN | ZMQ_POLLOUT);
     zmq::poll(&poll_items_[0], poll_items_.size(), timeout_ms);
 
+    if (poll_items_[SOCKET_CONTROL].revents & ZMQ_POLLOUT)
+        flush_received();
+
     for (int i = 0, n = poll_items_.size(); i < n; ++i)
     {
         if (poll_items_[i].revents & ZMQ_POLLIN)
@@ -271,8 +409,17 @@ void goby::zeromq::InterProcessPortalReadThread::poll(long timeout_ms)
                         control_data(zmq_msg);
                     break;
                 case SOCKET_SUBSCRIBE:
-                    if (zmq_socket_recv(subscribe_socket_, zmq_msg))
+                    // batched publications (multipart) contain one publication per part
+                    while (zmq_socket_recv(subscribe_socket_, zmq_msg))
+                    {
                         subscribe_data(zmq_msg);
+
+                        int rcvmore = 0;
+                        std::size_t rcvmore_size = sizeof(rcvmore);
+                        subscribe_socket_.getsockopt(ZMQ_RCVMORE, &rcvmore, &rcvmore_size);
+                        if (!rcvmore)
+                            break;
+                    }
                     break;
                 case SOCKET_MANAGER:
                     if (zmq_socket_recv(manager_socket_, zmq_msg))
@@ -303,6 +450,9 @@ void goby::zeromq::InterProcessPortalReadThread::control_data(const zmq::message
             control_ack.set_type(protobuf::InprocControl::SUBSCRIBE_ACK);
             send_control_msg(control_ack);
 
+            if (cfg_.last_value_cache())
+                request_last_value(zmq_filter);
+
             break;
         }
         case protobuf::InprocControl::UNSUBSCRIBE:
@@ -312,6 +462,8 @@ void goby::zeromq::InterProcessPortalReadThread::control_data(const zmq::message
                                     << std::endl;
 
             subscribe_socket_.setsockopt(ZMQ_UNSUBSCRIBE, zmq_filter.c_str(), zmq_filter.size());
+            // the main thread discards anything still held for it
+            held_queues_.erase(zmq_filter);
 
             protobuf::InprocControl control_ack;
             control_ack.set_type(protobuf::InprocControl::UNSUBSCRIBE_ACK);
@@ -319,6 +471,15 @@ void goby::zeromq::InterProcessPortalReadThread::control_data(const zmq::message
 
             break;
         }
+        case protobuf::InprocControl::QUEUE_POLICY:
+        {
+            auto& queue = held_queues_[control_msg.subscription_identifier()];
+            queue.max_depth = control_msg.max_depth();
+            queue.drop_newest = control_msg.drop_newest();
+            queue.priority = control_msg.priority();
+            break;
+        }
+
         case protobuf::InprocControl::SHUTDOWN: { alive_ = false;
         }
         default: break;
@@ -327,17 +488,139 @@ void goby::zeromq::InterProcessPortalReadThread::control_data(const zmq::message
 void goby::zeromq::InterProcessPortalReadThread::subscribe_data(const zmq::message_t& zmq_msg)
 {
     // data from goby - forward to the main thread
+    const char* data = static_cast<const char*>(zmq_msg.data());
+    if (!last_value_superseded_.empty())
+    {
+        // a cached value requested before this arrived is now stale
+        auto it = last_value_superseded_.find(subscription_identifier(data, zmq_msg.size()));
+        if (it != last_value_superseded_.end())
+            it->second = true;
+    }
+    forward_received(data, zmq_msg.size());
+}
+
+void goby::zeromq::InterProcessPortalReadThread::forward_received(const char* data,
+                                                                  std::size_t size)
+{
     protobuf::InprocControl control;
     control.set_type(protobuf::InprocControl::RECEIVE);
-    control.set_received_data(std::string((char*)zmq_msg.data(), zmq_msg.size()));
-    send_control_msg(control);
+    control.set_received_data(std::string(data, size));
+    if (goby::middleware::TransportStats::enabled())
+        control.set_received_time(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                goby::middleware::TransportStats::Clock::now().time_since_epoch())
+                .count());
+
+    // otherwise the main thread's queue is full: the rest are sent once it makes room
+    bool send_now = held_empty();
+    hold_received(subscription_identifier(data, size), control);
+    if (send_now)
+        flush_received();
 }
+
+void goby::zeromq::InterProcessPortalReadThread::hold_received(const std::string& identifier,
+                                                               protobuf::InprocControl& control)
+{
+    auto queue_it = held_queues_.find(identifier);
+    if (queue_it != held_queues_.end() && queue_it->second.max_depth > 0)
+    {
+        // apply the limit shared by all the main thread's subscriptions to this identifier
+        auto& queue = queue_it->second;
+        if (queue.drop_newest && queue.seqs.size() >= queue.max_depth)
+        {
+            ++queue.dropped;
+            return;
+        }
+        while (queue.seqs.size() >= queue.max_depth)
+        {
+            auto& oldest_class = held_[queue.seqs.front().first];
+            auto& oldest = oldest_class.queue[queue.seqs.front().second - oldest_class.front_seq];
+            oldest.dropped = true;
+            oldest.control.Clear();
+            --oldest_class.size;
+            queue.seqs.pop_front();
+            ++queue.dropped;
+        }
+    }
+
+    int index = middleware::PollScheduler::index(
+        queue_it != held_queues_.end()
+            ? queue_it->second.priority
+            : middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL);
+    auto& held_class = held_[index];
+    if (queue_it != held_queues_.end())
+        queue_it->second.seqs.push_back(
+            std::make_pair(index, held_class.front_seq + held_class.queue.size()));
+    held_class.queue.emplace_back();
+    held_class.queue.back().identifier = identifier;
+    held_class.queue.back().control.Swap(&control);
+    ++held_class.size;
+}
+
+void goby::zeromq::InterProcessPortalReadThread::flush_received()
+{
+    bool sent = false;
+    auto deliver = [&](int priority, std::size_t max, bool& stop) -> std::size_t {
+        int index = middleware::PollScheduler::index(priority);
+        auto& held_class = held_[index];
+        std::size_t n = 0;
+        while (n < max && !held_class.queue.empty())
+        {
+            auto& front = held_class.queue.front();
+            if (!front.dropped)
+            {
+                auto queue_it = held_queues_.find(front.identifier);
+                if (queue_it != held_queues_.end() && queue_it->second.dropped > 0)
+                    front.control.set_dropped(queue_it->second.dropped);
+
+                zmq::message_t zmq_control_msg;
+                zmq_serialize(front.control, zmq_control_msg);
+                if (!zmq_socket_send(control_socket_, zmq_control_msg, zmq_send_flags_dontwait))
+                {
+                    // main thread's queue is full: keep holding
+                    stop = true;
+                    break;
+                }
+
+                sent = true;
+                ++n;
+                --held_class.size;
+                if (queue_it != held_queues_.end())
+                {
+                    auto& queue = queue_it->second;
+                    queue.dropped = 0;
+                    if (!queue.seqs.empty() &&
+                        queue.seqs.front() == std::make_pair(index, held_class.front_seq))
+                        queue.seqs.pop_front();
+                }
+            }
+            held_class.queue.pop_front();
+            ++held_class.front_seq;
+        }
+        return n;
+    };
+    auto queued = [&](int priority) {
+        return held_[middleware::PollScheduler::index(priority)].size > 0;
+    };
+    held_deficits_.schedule(middleware::PriorityDeficits::unlimited,
+                            middleware::protobuf::LAYER_INTERPROCESS, deliver, queued);
+
+    if (sent)
+        poller_cv_->notify_all();
+}
+
+bool goby::zeromq::InterProcessPortalReadThread::held_empty() const
+{
+    return std::all_of(held_.begin(), held_.end(),
+                       [](const HeldClass& held_class) { return held_class.queue.empty(); });
+}
+
 void goby::zeromq::InterProcessPortalReadThread::manager_data(const zmq::message_t& zmq_msg)
 {
     // manager (gobyd) reply
     protobuf::ManagerResponse response;
     response.ParseFromArray(zmq_msg.data(), zmq_msg.size());
-    if (response.request() == protobuf::PROVIDE_PUB_SUB_SOCKETS)
+    if (response.request() == protobuf::PROVIDE_PUB_SUB_SOCKETS && !have_pubsub_sockets_)
     {
         if (response.subscribe_socket().transport() == protobuf::Socket::TCP)
             response.mutable_subscribe_socket()->set_ethernet_address(cfg_.ipv4_address());
@@ -356,13 +639,62 @@ void goby::zeromq::InterProcessPortalReadThread::manager_data(const zmq::message
         glog.is(DEBUG3) && glog << "Received manager sockets: " << response.DebugString()
                                 << std::endl;
     }
+    else if (response.request() == protobuf::PROVIDE_LAST_VALUE)
+    {
+        manager_request_outstanding_ = false;
+
+        auto it = last_value_superseded_.find(response.subscription_identifier());
+        if (it != last_value_superseded_.end())
+        {
+            if (!it->second && response.has_last_value())
+            {
+                glog.is(DEBUG2) && glog << "Received last value for identifier: ["
+                                        << response.subscription_identifier() << "]"
+                                        << std::endl;
+                forward_received(response.last_value().data(), response.last_value().size());
+            }
+            last_value_superseded_.erase(it);
+        }
+
+        if (!last_value_requests_.empty())
+        {
+            auto identifier = last_value_requests_.front();
+            last_value_requests_.pop_front();
+            request_last_value(identifier);
+        }
+    }
+}
+
+void goby::zeromq::InterProcessPortalReadThread::request_last_value(const std::string& identifier)
+{
+    // only exact subscriptions ("/group/scheme/type/"), not regex ("/")
+    if (std::count(identifier.begin(), identifier.end(), '/') != 4)
+        return;
+
+    // keeps the superseded flag if this identifier was already queued
+    last_value_superseded_.insert(std::make_pair(identifier, false));
+
+    if (manager_request_outstanding_)
+    {
+        last_value_requests_.push_back(identifier);
+        return;
+    }
+
+    protobuf::ManagerRequest req;
+    req.set_request(protobuf::PROVIDE_LAST_VALUE);
+    req.set_subscription_identifier(identifier);
+
+    zmq::message_t msg;
+    zmq_serialize(req, msg);
+    manager_socket_.send(msg, zmq_send_flags_none);
+    manager_request_outstanding_ = true;
 }
 
 void goby::zeromq::InterProcessPortalReadThread::send_control_msg(
     const protobuf::InprocControl& control)
 {
-    zmq::message_t zmq_control_msg(control.ByteSize());
-    control.SerializeToArray((char*)zmq_control_msg.data(), zmq_control_msg.size());
+    zmq::message_t zmq_control_msg;
+    zmq_serialize(control, zmq_control_msg);
     control_socket_.send(zmq_control_msg, zmq_send_flags_none);
     poller_cv_->notify_all();
 }
@@ -424,11 +756,18 @@ void goby::zeromq::Router::run()
     }
     try
     {
+        if (cfg_.last_value_cache() || cfg_.has_federation())
+        {
+            proxy(frontend, backend);
+        }
+        else
+        {
 #ifdef USE_OLD_ZMQ_CPP_API
-        zmq::proxy((void*)frontend, (void*)backend, nullptr);
+            zmq::proxy((void*)frontend, (void*)backend, nullptr);
 #else
-        zmq::proxy(frontend, backend);
+            zmq::proxy(frontend, backend);
 #endif
+        }
     }
     catch (const zmq::error_t& e)
     {
@@ -440,8 +779,134 @@ void goby::zeromq::Router::run()
     }
 }
 
+void goby::zeromq::Router::proxy(zmq::socket_t& frontend, zmq::socket_t& backend)
+{
+    std::unique_ptr<Federation> federation;
+    if (cfg_.has_federation())
+        federation.reset(new Federation(context_, cfg_.federation()));
+
+    // receive all publications (not only those with a current subscriber) so they can be cached
+    if (cfg_.last_value_cache())
+    {
+        zmq::message_t subscribe_all(1);
+        *static_cast<char*>(subscribe_all.data()) = 1;
+        backend.send(subscribe_all, zmq_send_flags_none);
+    }
+
+    std::vector<zmq::pollitem_t> items{{(void*)frontend, 0, ZMQ_POLLIN, 0},
+                                       {(void*)backend, 0, ZMQ_POLLIN, 0}};
+    if (federation)
+    {
+        items.push_back({(void*)federation->peer_publish_socket(), 0, ZMQ_POLLIN, 0});
+        items.push_back({(void*)federation->peer_subscribe_socket(), 0, ZMQ_POLLIN, 0});
+    }
+
+    while (true)
+    {
+        zmq::poll(items.data(), items.size(), federation ? federation->flush_timeout_ms() : -1);
+
+        // (un)subscriptions from the local subscribers
+        if (items[0].revents & ZMQ_POLLIN)
+        {
+            forward(frontend, backend, [&](const zmq::message_t& msg) {
+                if (federation)
+                    federation->local_subscription(msg);
+                return true;
+            });
+        }
+
+        // local publications
+        if (items[1].revents & ZMQ_POLLIN)
+        {
+            forward(backend, frontend, [&](const zmq::message_t& msg) {
+                cache(msg);
+                if (federation &&
+                    federation->publish(static_cast<const char*>(msg.data()), msg.size()))
+                    ++federated_publications_sent;
+                return true;
+            });
+        }
+
+        if (federation)
+        {
+            // (un)subscriptions from the peers
+            if (items[2].revents & ZMQ_POLLIN)
+            {
+                forward(federation->peer_publish_socket(), backend,
+                        [&](const zmq::message_t& msg) {
+                            return federation->peer_subscription(msg);
+                        });
+            }
+
+            // batches of publications from the peers: delivered locally only (never to the other
+            // peers)
+            if (items[3].revents & ZMQ_POLLIN)
+            {
+                zmq::message_t batch;
+                zmq_socket_recv(federation->peer_subscribe_socket(), batch);
+                federated_publications_received +=
+                    federation->receive(batch, [&](const char* data, std::size_t size) {
+                        zmq::message_t msg(data, size);
+                        cache(msg);
+                        frontend.send(msg, zmq_send_flags_none);
+                    });
+            }
+
+            federation->flush_if_due();
+        }
+    }
+}
+
+template <typename Handler>
+void goby::zeromq::Router::forward(zmq::socket_t& from, zmq::socket_t& to, Handler handle)
+{
+    bool more = true;
+    for (bool first = true; more; first = false)
+    {
+        zmq::message_t msg;
+        zmq_socket_recv(from, msg);
+
+        int rcvmore = 0;
+        std::size_t rcvmore_size = sizeof(rcvmore);
+        from.getsockopt(ZMQ_RCVMORE, &rcvmore, &rcvmore_size);
+        more = rcvmore;
+
+        // goby subscriptions are single part messages, as are publications except when batched
+        // by the publisher (InterProcessPortalConfig.publication_batching), in which case each
+        // part is a publication. Only single part messages may be dropped.
+        if (!handle(msg) && first && !more)
+            return;
+
+        to.send(msg, more ? zmq_send_flags_more : zmq_send_flags_none);
+    }
+}
+
+void goby::zeromq::Router::cache(const zmq::message_t& msg)
+{
+    if (!cfg_.last_value_cache())
+        return;
+
+    auto key = subscription_identifier(static_cast<const char*>(msg.data()), msg.size());
+    if (!key.empty())
+    {
+        std::lock_guard<std::mutex> lock(last_value_mutex_);
+        // reuses the previous value's storage
+        last_values_[key].assign(static_cast<const char*>(msg.data()), msg.size());
+    }
+}
+
+bool goby::zeromq::Router::last_value(const std::string& identifier, std::string* value) const
+{
+    std::lock_guard<std::mutex> lock(last_value_mutex_);
+    auto it = last_values_.find(identifier);
+    if (it == last_values_.end())
+        return false;
+    *value = it->second;
+    return true;
+}
+
 //
-// Router
+// Manager
 //
 void goby::zeromq::Manager::run()
 {
@@ -520,9 +985,16 @@ void goby::zeromq::Manager::run()
                         break;
                 }
             }
+            else if (pb_request.request() == protobuf::PROVIDE_LAST_VALUE)
+            {
+                pb_response.set_subscription_identifier(pb_request.subscription_identifier());
+                std::string value;
+                if (router_.last_value(pb_request.subscription_identifier(), &value))
+                    pb_response.set_last_value(value);
+            }
 
-            zmq::message_t reply(pb_response.ByteSize());
-            pb_response.SerializeToArray((char*)reply.data(), reply.size());
+            zmq::message_t reply;
+            zmq_serialize(pb_response, reply);
             socket.send(reply, zmq_send_flags_none);
         }
     }
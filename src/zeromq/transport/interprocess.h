@@ -24,11 +24,19 @@
 #ifndef TransportInterProcessZeroMQ20170807H
 #define TransportInterProcessZeroMQ20170807H
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <tuple>
+#include <unordered_map>
 #include <zmq.hpp>
 
 #include "goby/middleware/common.h"
 #include "goby/middleware/transport/interprocess.h"
+#include "goby/middleware/transport/poll_scheduler.h"
+#include "goby/middleware/transport/stats.h"
 #include "goby/zeromq/protobuf/interprocess_config.pb.h"
 #include "goby/zeromq/protobuf/interprocess_zeromq.pb.h"
 
@@ -42,6 +50,9 @@ namespace zeromq
 {
 void setup_socket(zmq::socket_t& socket, const protobuf::Socket& cfg);
 
+/// \brief The identifier that portals subscribe to ("/group/scheme/type/") for a publication ("/group/scheme/type/process/thread/\0data"), or an empty string if data is not a publication
+std::string subscription_identifier(const char* data, std::size_t size);
+
 #ifdef USE_OLD_ZMQ_CPP_API
 using zmq_recv_flags_type = int;
 using zmq_send_flags_type = int;
@@ -54,26 +65,47 @@ using zmq_send_flags_type = zmq::send_flags;
 class InterProcessPortalMainThread
 {
   public:
-    InterProcessPortalMainThread(zmq::context_t& context);
+    InterProcessPortalMainThread(const protobuf::InterProcessPortalConfig& cfg,
+                                 zmq::context_t& context);
     bool ready() { return publish_socket_configured_; }
 
     bool recv(protobuf::InprocControl* control_msg,
               zmq_recv_flags_type flags = zmq_recv_flags_type());
     void set_publish_cfg(const protobuf::Socket& cfg);
     void publish(const std::string& identifier, const char* bytes, int size);
+    /// \brief Send any publications pending in batches (cfg.publication_batching())
+    void flush_publications();
     void subscribe(const std::string& identifier);
     void unsubscribe(const std::string& identifier);
+    /// \brief Set the limit on the messages for identifier held by the read thread (max_depth: 0 = unlimited), and the priority class they are held in
+    void set_queue_policy(const std::string& identifier, std::size_t max_depth, bool drop_newest,
+                          int priority);
     void reader_shutdown();
 
   private:
     void send_control_msg(const protobuf::InprocControl& control);
+    void wait_for_ack(protobuf::InprocControl::InprocControlType ack_type);
+    void batch_publication(const std::string& identifier, zmq::message_t& msg);
 
   private:
+    const protobuf::InterProcessPortalConfig& cfg_;
     zmq::socket_t control_socket_;
     zmq::socket_t publish_socket_;
     bool publish_socket_configured_{false};
     std::deque<std::pair<std::string, std::vector<char>>>
         publish_queue_; //used before publish_socket_configured_ == true
+    // messages from the read thread that arrived while waiting for an ack, returned by recv()
+    std::deque<protobuf::InprocControl> control_backlog_;
+
+    // pending runs of consecutive publications to the same identifier, in publication order
+    struct PublicationBatch
+    {
+        std::string identifier;
+        std::vector<zmq::message_t> parts;
+    };
+    std::vector<PublicationBatch> batches_;
+    std::size_t batch_bytes_{0};
+    std::chrono::steady_clock::time_point batch_start_;
 };
 
 // run in a separate thread to allow zmq_.poll() to block without interrupting the main thread
@@ -91,6 +123,11 @@ class InterProcessPortalReadThread
     void subscribe_data(const zmq::message_t& zmq_msg);
     void manager_data(const zmq::message_t& zmq_msg);
     void send_control_msg(const protobuf::InprocControl& control);
+    void request_last_value(const std::string& identifier);
+    void forward_received(const char* data, std::size_t size);
+    void hold_received(const std::string& identifier, protobuf::InprocControl& control);
+    void flush_received();
+    bool held_empty() const;
 
   private:
     const protobuf::InterProcessPortalConfig& cfg_;
@@ -111,6 +148,46 @@ class InterProcessPortalReadThread
         NUMBER_SOCKETS = 3
     };
     bool have_pubsub_sockets_{false};
+
+    // last-value cache: identifiers waiting for a PROVIDE_LAST_VALUE request to gobyd (the
+    // manager socket allows only one outstanding request)
+    std::deque<std::string> last_value_requests_;
+    bool manager_request_outstanding_{false};
+    // identifiers requested from gobyd, and whether newer data has since been received
+    std::unordered_map<std::string, bool> last_value_superseded_;
+
+    // received data not yet accepted by the main thread (control socket at its high water mark),
+    // in order of receipt for each priority class (of the subscriptions to their identifier)
+    struct HeldReceive
+    {
+        std::string identifier;
+        protobuf::InprocControl control;
+        bool dropped{false};
+    };
+    struct HeldClass
+    {
+        std::deque<HeldReceive> queue;
+        // numbers the front entry, and each later one is numbered one higher
+        std::uint64_t front_seq{0};
+        // entries not dropped
+        std::size_t size{0};
+    };
+    std::array<HeldClass, middleware::PollScheduler::num_priorities> held_;
+    // shares the room made by the main thread between the priority classes
+    middleware::PriorityDeficits held_deficits_;
+    // limit on the held messages for each identifier (from the main thread's QUEUE_POLICY)
+    struct HeldQueue
+    {
+        std::size_t max_depth{0};
+        bool drop_newest{false};
+        int priority{middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL};
+        // class index and number of the held (not dropped) messages for this identifier, oldest
+        // first
+        std::deque<std::pair<int, std::uint64_t>> seqs;
+        // discarded since the last RECEIVE for this identifier
+        std::uint64_t dropped{0};
+    };
+    std::unordered_map<std::string, HeldQueue> held_queues_;
 };
 
 template <typename InnerTransporter,
@@ -126,7 +203,7 @@ class InterProcessPortalImplementation
     InterProcessPortalImplementation(const protobuf::InterProcessPortalConfig& cfg)
         : cfg_(cfg),
           zmq_context_(cfg.zeromq_number_io_threads()),
-          zmq_main_(zmq_context_),
+          zmq_main_(cfg_, zmq_context_),
           zmq_read_thread_(cfg_, zmq_context_, zmq_alive_, middleware::PollerInterface::cv())
     {
         _init();
@@ -137,7 +214,7 @@ class InterProcessPortalImplementation
         : Base(inner),
           cfg_(cfg),
           zmq_context_(cfg.zeromq_number_io_threads()),
-          zmq_main_(zmq_context_),
+          zmq_main_(cfg_, zmq_context_),
           zmq_read_thread_(cfg_, zmq_context_, zmq_alive_, middleware::PollerInterface::cv())
     {
         _init();
@@ -147,11 +224,31 @@ class InterProcessPortalImplementation
     {
         if (zmq_thread_)
         {
+            zmq_main_.flush_publications();
             zmq_main_.reader_shutdown();
             zmq_thread_->join();
         }
     }
 
+    /// \brief Publish data that is already serialized (e.g. read back from a goby_logger file) without parsing it
+    ///
+    /// \param type_name Type name as given by SerializerParserHelper<Data, scheme>::type_name()
+    /// \param scheme Marshalling scheme of the data
+    /// \param bytes Serialized data
+    /// \param size Number of bytes
+    /// \param group Group to publish to
+    void publish_serialized(const std::string& type_name, int scheme, const char* bytes, int size,
+                            const std::string& group)
+    {
+        std::string identifier =
+            _make_identifier(type_name, scheme, group, IdentifierWildcard::NO_WILDCARDS) + '\0';
+        zmq_main_.publish(identifier, bytes, size);
+
+        if (middleware::TransportStats::enabled())
+            middleware::TransportStats::group(middleware::protobuf::LAYER_INTERPROCESS, group)
+                .publish(size);
+    }
+
     friend Base;
     friend typename Base::Base;
 
@@ -183,9 +280,14 @@ class InterProcessPortalImplementation
     void _publish(const Data& d, const goby::middleware::Group& group,
                   const middleware::Publisher<Data>& publisher)
     {
-        std::vector<char> bytes(middleware::SerializerParserHelper<Data, scheme>::serialize(d));
+        publish_buffer_.clear();
+        middleware::serialize_memoized<Data, scheme>(d, &publish_buffer_);
         std::string identifier = _make_fully_qualified_identifier<Data, scheme>(d, group) + '\0';
-        zmq_main_.publish(identifier, &bytes[0], bytes.size());
+        zmq_main_.publish(identifier, publish_buffer_.data(), publish_buffer_.size());
+
+        if (middleware::TransportStats::enabled())
+            middleware::TransportStats::group(middleware::protobuf::LAYER_INTERPROCESS, group)
+                .publish(publish_buffer_.size());
     }
 
     template <typename Data, int scheme>
@@ -198,15 +300,33 @@ class InterProcessPortalImplementation
 
         auto subscription = std::make_shared<middleware::SerializationSubscription<Data, scheme>>(
             f, group,
-            middleware::Subscriber<Data>(goby::middleware::protobuf::TransporterConfig(),
-                                         [=](const Data& d) { return group; }));
+            middleware::Subscriber<Data>(subscriber.cfg(), [=](const Data& d) { return group; }));
 
         if (forwarder_subscriptions_.count(identifier) == 0 &&
             portal_subscriptions_.count(identifier) == 0)
             zmq_main_.subscribe(identifier);
+        else if (last_values_.count(identifier))
+            // gobyd is only asked on the first subscription, so deliver our copy on the next poll
+            pending_last_values_.push_back(std::make_pair(identifier, subscription));
         portal_subscriptions_.insert(std::make_pair(identifier, subscription));
+        _update_read_thread_queue_policy(identifier);
+    }
+
+  public:
+    /// \brief Number of messages of the given data type and group discarded (since subscribing) before delivery to this portal's subscriptions due to their queue limits (Subscriber::cfg().qos())
+    template <typename Data, int scheme = middleware::scheme<Data>()>
+    std::uint64_t subscription_drops(const goby::middleware::Group& group)
+    {
+        std::string identifier =
+            _make_identifier<Data, scheme>(group, IdentifierWildcard::PROCESS_THREAD_WILDCARD);
+        std::uint64_t drops = 0;
+        auto range = portal_subscriptions_.equal_range(identifier);
+        for (auto it = range.first; it != range.second; ++it) drops += it->second->drops();
+        return drops;
     }
 
+  private:
+
     void _subscribe_regex(
         std::function<void(const std::vector<unsigned char>&, int scheme, const std::string& type,
                            const goby::middleware::Group& group)>
@@ -230,7 +350,77 @@ class InterProcessPortalImplementation
 
         // If no forwarded subscriptions, do the actual unsubscribe
         if (forwarder_subscriptions_.count(identifier) == 0)
-            zmq_main_.unsubscribe(identifier);
+            _zmq_unsubscribe(identifier);
+        else
+            _update_read_thread_queue_policy(identifier);
+    }
+
+    void _zmq_unsubscribe(const std::string& identifier)
+    {
+        zmq_main_.unsubscribe(identifier);
+        // no longer kept up to date
+        last_values_.erase(identifier);
+        // the read thread forgets its policy upon unsubscribing
+        read_thread_queue_policies_.erase(identifier);
+    }
+
+    // the read thread holds received data while this thread is busy (handoff_queue_size), and
+    // discards what no subscription to the identifier would deliver: give it the limit that all of
+    // them share (if any)
+    void _update_read_thread_queue_policy(const std::string& identifier)
+    {
+        middleware::SubscriptionQueuePolicy shared;
+        auto portal_range = portal_subscriptions_.equal_range(identifier);
+        auto forwarder_it = forwarder_subscriptions_.find(identifier);
+
+        // the read thread holds the identifier in the class of its highest priority subscription
+        int priority = middleware::protobuf::TransporterConfig::QoS::PRIORITY_LOW;
+        for (auto it = portal_range.first; it != portal_range.second; ++it)
+            priority = std::min<int>(priority, it->second->queue_policy().priority);
+        if (forwarder_it != forwarder_subscriptions_.end())
+            priority = std::min<int>(priority, forwarder_it->second->queue_policy().priority);
+
+        // forwarded (limited on the interthread delivery) and regex subscriptions take everything
+        if (forwarder_it == forwarder_subscriptions_.end() && regex_subscriptions_.empty())
+        {
+            for (auto it = portal_range.first; it != portal_range.second; ++it)
+            {
+                auto policy = it->second->queue_policy();
+                if (!policy.bounded() ||
+                    (it != portal_range.first && policy.drop_newest != shared.drop_newest))
+                {
+                    shared = middleware::SubscriptionQueuePolicy();
+                    break;
+                }
+                shared.max_depth = std::max(shared.max_depth, policy.max_depth);
+                shared.drop_newest = policy.drop_newest;
+            }
+        }
+
+        auto policy = std::make_tuple(shared.max_depth, shared.drop_newest, priority);
+        auto it = read_thread_queue_policies_.find(identifier);
+        if (it == read_thread_queue_policies_.end())
+        {
+            // unlimited and normal priority until told otherwise
+            if (!shared.bounded() &&
+                priority == middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL)
+                return;
+            read_thread_queue_policies_.insert(std::make_pair(identifier, policy));
+        }
+        else if (it->second != policy)
+        {
+            it->second = policy;
+        }
+        else
+        {
+            return;
+        }
+        zmq_main_.set_queue_policy(identifier, shared.max_depth, shared.drop_newest, priority);
+    }
+
+    void _update_read_thread_queue_policies()
+    {
+        for (const auto& p : portal_subscriptions_) _update_read_thread_queue_policy(p.first);
     }
 
     void _unsubscribe_all(const std::string subscriber_id = to_string(std::this_thread::get_id()))
@@ -242,7 +432,7 @@ class InterProcessPortalImplementation
             {
                 const auto& identifier = p.first;
                 if (forwarder_subscriptions_.count(identifier) == 0)
-                    zmq_main_.unsubscribe(identifier);
+                    _zmq_unsubscribe(identifier);
             }
             portal_subscriptions_.clear();
         }
@@ -259,13 +449,18 @@ class InterProcessPortalImplementation
         {
             regex_subscriptions_.erase(subscriber_id);
             if (regex_subscriptions_.empty())
+            {
                 zmq_main_.unsubscribe("/");
+                _update_read_thread_queue_policies();
+            }
         }
     }
 
     int _poll(std::unique_ptr<std::unique_lock<std::timed_mutex>>& lock)
     {
-        int items = 0;
+        // this thread is done publishing for now
+        zmq_main_.flush_publications();
+
         protobuf::InprocControl control_msg;
 
 #ifdef USE_OLD_ZMQ_CPP_API
@@ -274,82 +469,199 @@ class InterProcessPortalImplementation
         auto flags = zmq::recv_flags::dontwait;
 #endif
 
-        while (zmq_main_.recv(&control_msg, flags))
+        // read everything that is queued first, so that the subscription queue limits
+        // apply to the entire backlog, up to the layer budget (the rest stay with the read
+        // thread, which shares the room made for them between the priority classes by weight)
+        std::size_t budget = this->layer_budget();
+        std::vector<Received> received;
+        while ((budget == 0 || received.size() < budget) && zmq_main_.recv(&control_msg, flags))
         {
             switch (control_msg.type())
             {
                 case protobuf::InprocControl::RECEIVE:
                 {
-                    ++items;
-                    if (lock)
-                        lock.reset();
-
-                    const auto& data = control_msg.received_data();
-
-                    std::string group, type, thread;
-                    int scheme, process;
-                    std::tie(group, scheme, type, process, thread) = parse_identifier(data);
-                    std::string identifier = _make_identifier(
-                        type, scheme, group, IdentifierWildcard::PROCESS_THREAD_WILDCARD);
-
-                    // build a set so if any of the handlers unsubscribes, we still have a pointer to the middleware::SerializationHandlerBase<>
-                    std::vector<std::weak_ptr<const middleware::SerializationHandlerBase<>>>
-                        subs_to_post;
-                    auto portal_range = portal_subscriptions_.equal_range(identifier);
-                    for (auto it = portal_range.first; it != portal_range.second; ++it)
-                        subs_to_post.push_back(it->second);
-                    auto forwarder_it = forwarder_subscriptions_.find(identifier);
-                    if (forwarder_it != forwarder_subscriptions_.end())
-                        subs_to_post.push_back(forwarder_it->second);
-
-                    // actually post the data
-                    {
-                        const auto& data = control_msg.received_data();
-                        auto null_delim_it = std::find(std::begin(data), std::end(data), '\0');
-                        for (auto& sub : subs_to_post)
-                        {
-                            if (auto sub_sp = sub.lock())
-                                sub_sp->post(null_delim_it + 1, data.end());
-                        }
-                    }
+                    received.emplace_back();
+                    auto& r = received.back();
+                    r.data = std::move(*control_msg.mutable_received_data());
+                    if (control_msg.has_received_time())
+                        r.received_time = control_msg.received_time();
+                    r.read_thread_drops = control_msg.dropped();
+                    std::string thread;
+                    int process;
+                    std::tie(r.group, r.scheme, r.type, process, thread) = parse_identifier(r.data);
+                    r.identifier = _make_identifier(r.type, r.scheme, r.group,
+                                                    IdentifierWildcard::PROCESS_THREAD_WILDCARD);
+                }
+                break;
 
-                    if (!regex_subscriptions_.empty())
+                default: break;
+            }
+        }
+
+        if (received.empty() && pending_last_values_.empty())
+            return 0;
+        if (lock)
+            lock.reset();
+
+        // cached values for subscriptions made since the last poll, before any newer data
+        int last_values_delivered = 0;
+        for (const auto& p : pending_last_values_)
+        {
+            auto it = last_values_.find(p.first);
+            auto sub = p.second.lock();
+            if (it == last_values_.end() || !sub)
+                continue;
+            const auto& data = it->second;
+            sub->post(std::find(std::begin(data), std::end(data), '\0') + 1, std::end(data));
+            ++last_values_delivered;
+        }
+        pending_last_values_.clear();
+
+        // number of messages received for each identifier, when any subscription is bounded
+        std::unordered_map<std::string, std::size_t> identifier_counts;
+        bool any_bounded =
+            std::any_of(portal_subscriptions_.begin(), portal_subscriptions_.end(),
+                        [](const auto& p) { return p.second->queue_policy().bounded(); });
+        if (any_bounded)
+            for (auto& r : received) r.index = identifier_counts[r.identifier]++;
+
+        // deliver higher priority identifiers first (keeping the order for each identifier)
+        auto prioritized = [](const auto& p) {
+            return p.second->queue_policy().priority !=
+                   middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL;
+        };
+        bool any_prioritized =
+            std::any_of(portal_subscriptions_.begin(), portal_subscriptions_.end(), prioritized) ||
+            std::any_of(forwarder_subscriptions_.begin(), forwarder_subscriptions_.end(),
+                        prioritized);
+        if (any_prioritized)
+        {
+            for (auto& r : received)
+            {
+                auto range = portal_subscriptions_.equal_range(r.identifier);
+                bool first = true;
+                for (auto it = range.first; it != range.second; ++it, first = false)
+                {
+                    int priority = it->second->queue_policy().priority;
+                    r.priority = first ? priority : std::min<int>(r.priority, priority);
+                }
+                auto forwarder_it = forwarder_subscriptions_.find(r.identifier);
+                if (forwarder_it != forwarder_subscriptions_.end())
+                {
+                    int priority = forwarder_it->second->queue_policy().priority;
+                    r.priority = first ? priority : std::min<int>(r.priority, priority);
+                }
+            }
+            std::stable_sort(received.begin(), received.end(),
+                             [](const Received& a, const Received& b) {
+                                 return a.priority < b.priority;
+                             });
+        }
+
+        for (const auto& r : received)
+        {
+            const auto& data = r.data;
+            auto null_delim_it = std::find(std::begin(data), std::end(data), '\0');
+
+            middleware::TransportStats::GroupStats* stats = nullptr;
+            if (middleware::TransportStats::enabled())
+            {
+                stats = &middleware::TransportStats::group(middleware::protobuf::LAYER_INTERPROCESS,
+                                                           r.group);
+                stats->receive(std::distance(null_delim_it, std::end(data)) - 1);
+                auto& class_stats = middleware::TransportStats::priority_class(
+                    middleware::protobuf::LAYER_INTERPROCESS, r.priority);
+                class_stats.receive();
+                if (r.received_time)
+                {
+                    auto queue_time = middleware::TransportStats::Clock::now().time_since_epoch() -
+                                      std::chrono::microseconds(r.received_time);
+                    stats->queue_time.record(queue_time);
+                    class_stats.queue_time.record(queue_time);
+                }
+            }
+            middleware::TransportStats::HandlerTimer handler_timer(stats);
+
+            // build a set so if any of the handlers unsubscribes, we still have a pointer to the middleware::SerializationHandlerBase<>
+            std::vector<std::weak_ptr<const middleware::SerializationHandlerBase<>>> subs_to_post;
+            auto portal_range = portal_subscriptions_.equal_range(r.identifier);
+            for (auto it = portal_range.first; it != portal_range.second; ++it)
+            {
+                // discarded by the read thread on behalf of all of them
+                if (r.read_thread_drops > 0 && it->second->queue_policy().bounded())
+                {
+                    it->second->add_drops(r.read_thread_drops);
+                    if (stats)
+                        stats->drop(r.read_thread_drops);
+                }
+
+                if (any_bounded)
+                {
+                    auto policy = it->second->queue_policy();
+                    auto count = identifier_counts[r.identifier];
+                    // keep the first (drop newest) or last (drop oldest) max_depth messages
+                    bool keep = !policy.bounded() ||
+                                (policy.drop_newest ? r.index < policy.max_depth
+                                                    : r.index + policy.max_depth >= count);
+                    if (!keep)
                     {
-                        auto null_delim_it = std::find(std::begin(data), std::end(data), '\0');
-
-                        bool forwarder_subscription_posted = false;
-                        for (auto& sub : regex_subscriptions_)
-                        {
-                            // only post at most once for forwarders as the threads will filter
-                            bool is_forwarded_sub =
-                                sub.first != to_string(std::this_thread::get_id());
-                            if (is_forwarded_sub && forwarder_subscription_posted)
-                                continue;
-
-                            if (sub.second->post(null_delim_it + 1, data.end(), scheme, type,
-                                                 group) &&
-                                is_forwarded_sub)
-                                forwarder_subscription_posted = true;
-                        }
+                        it->second->add_drops(1);
+                        if (stats)
+                            stats->drop();
+                        continue;
                     }
                 }
-                break;
+                subs_to_post.push_back(it->second);
+            }
+            // forwarded subscriptions apply their limits on the interthread delivery
+            auto forwarder_it = forwarder_subscriptions_.find(r.identifier);
+            if (forwarder_it != forwarder_subscriptions_.end())
+                subs_to_post.push_back(forwarder_it->second);
 
-                default: break;
+            // actually post the data
+            for (auto& sub : subs_to_post)
+            {
+                if (auto sub_sp = sub.lock())
+                    sub_sp->post(null_delim_it + 1, data.end());
+            }
+
+            if (!regex_subscriptions_.empty())
+            {
+                bool forwarder_subscription_posted = false;
+                for (auto& sub : regex_subscriptions_)
+                {
+                    // only post at most once for forwarders as the threads will filter
+                    bool is_forwarded_sub = sub.first != to_string(std::this_thread::get_id());
+                    if (is_forwarded_sub && forwarder_subscription_posted)
+                        continue;
+
+                    if (sub.second->post(null_delim_it + 1, data.end(), r.scheme, r.type,
+                                         r.group) &&
+                        is_forwarded_sub)
+                        forwarder_subscription_posted = true;
+                }
             }
         }
-        return items;
+
+        // per-process copy of the newest value, for later subscriptions to the same identifier
+        if (cfg_.last_value_cache())
+        {
+            for (auto& r : received)
+            {
+                if (portal_subscriptions_.count(r.identifier) ||
+                    forwarder_subscriptions_.count(r.identifier))
+                    last_values_[r.identifier] = std::move(r.data);
+            }
+        }
+
+        return received.size() + last_values_delivered;
     }
 
     void _receive_publication_forwarded(
         const goby::middleware::protobuf::SerializerTransporterMessage& msg)
     {
-        std::string identifier =
-            _make_identifier(msg.key().type(), msg.key().marshalling_scheme(), msg.key().group(),
-                             IdentifierWildcard::NO_WILDCARDS) +
-            '\0';
-        auto& bytes = msg.data();
-        zmq_main_.publish(identifier, &bytes[0], bytes.size());
+        publish_serialized(msg.key().type(), msg.key().marshalling_scheme(), msg.data().data(),
+                           msg.data().size(), msg.key().group());
     }
 
     void _receive_subscription_forwarded(
@@ -367,18 +679,24 @@ class InterProcessPortalImplementation
                 if (forwarder_subscription_identifiers_[subscription->subscriber_id()].count(
                         identifier) == 0)
                 {
+                    bool zmq_subscribed = forwarder_subscriptions_.count(identifier) != 0 ||
+                                          portal_subscriptions_.count(identifier) != 0;
                     // first to subscribe from a Forwarder
                     if (forwarder_subscriptions_.count(identifier) == 0)
                     {
                         // first to subscribe (locally or forwarded)
-                        if (portal_subscriptions_.count(identifier) == 0)
+                        if (!zmq_subscribed)
                             zmq_main_.subscribe(identifier);
 
                         // create Forwarder subscription
                         forwarder_subscriptions_.insert(std::make_pair(identifier, subscription));
+                        _update_read_thread_queue_policy(identifier);
                     }
                     forwarder_subscription_identifiers_[subscription->subscriber_id()].insert(
                         std::make_pair(identifier, forwarder_subscriptions_.find(identifier)));
+
+                    if (zmq_subscribed)
+                        _forward_last_value(identifier, *subscription);
                 }
             }
             break;
@@ -393,6 +711,30 @@ class InterProcessPortalImplementation
         }
     }
 
+    // sends the cached last value for identifier to the thread that made subscription only
+    // (the other threads subscribed to it have already received it)
+    void _forward_last_value(const std::string& identifier,
+                             const middleware::SerializationHandlerBase<>& subscription)
+    {
+        auto it = last_values_.find(identifier);
+        if (it == last_values_.end())
+            return;
+
+        const auto& data = it->second;
+        auto null_delim_it = std::find(std::begin(data), std::end(data), '\0');
+
+        middleware::protobuf::SerializerTransporterMessage msg;
+        auto* key = msg.mutable_key();
+        key->set_marshalling_scheme(subscription.scheme());
+        key->set_type(subscription.type_name());
+        key->set_group(std::string(subscription.subscribed_group()));
+        msg.set_data(std::string(null_delim_it + 1, std::end(data)));
+
+        goby::middleware::DynamicGroup group(Base::last_value_group_prefix_ +
+                                             subscription.subscriber_id());
+        this->inner().publish_dynamic(msg, group);
+    }
+
     void _forwarder_unsubscribe(std::string subscriber_id, std::string identifier)
     {
         auto it = forwarder_subscription_identifiers_[subscriber_id].find(identifier);
@@ -416,7 +758,9 @@ class InterProcessPortalImplementation
 
                 // do the actual unsubscribe if we aren't subscribe locally as well
                 if (portal_subscriptions_.count(identifier) == 0)
-                    zmq_main_.unsubscribe(identifier);
+                    _zmq_unsubscribe(identifier);
+                else
+                    _update_read_thread_queue_policy(identifier);
             }
 
             forwarder_subscription_identifiers_[subscriber_id].erase(it);
@@ -431,10 +775,13 @@ class InterProcessPortalImplementation
 
     void _subscribe_regex(std::shared_ptr<const middleware::SerializationSubscriptionRegex> new_sub)
     {
-        if (regex_subscriptions_.empty())
+        bool first_regex = regex_subscriptions_.empty();
+        if (first_regex)
             zmq_main_.subscribe("/");
 
         regex_subscriptions_.insert(std::make_pair(new_sub->subscriber_id(), new_sub));
+        if (first_regex)
+            _update_read_thread_queue_policies();
     }
 
     enum class IdentifierWildcard
@@ -527,6 +874,25 @@ class InterProcessPortalImplementation
     InterProcessPortalMainThread zmq_main_;
     InterProcessPortalReadThread zmq_read_thread_;
 
+    // reused by each _publish() call
+    middleware::SerializeBuffer publish_buffer_;
+
+    // data read from the zeromq read thread by _poll()
+    struct Received
+    {
+        std::string data;
+        std::int64_t received_time{0};
+        std::string group, type, identifier;
+        int scheme{0};
+        // position of this message among those in the same _poll() with the same identifier
+        std::size_t index{0};
+        // highest priority (lowest value) of the portal and forwarder subscriptions to the
+        // identifier
+        int priority{middleware::protobuf::TransporterConfig::QoS::PRIORITY_NORMAL};
+        // messages for the identifier discarded by the read thread before this one
+        std::uint64_t read_thread_drops{0};
+    };
+
     // maps identifier to subscription
     std::unordered_multimap<std::string,
                             std::shared_ptr<const middleware::SerializationHandlerBase<>>>
@@ -542,6 +908,18 @@ class InterProcessPortalImplementation
     std::unordered_multimap<std::string,
                             std::shared_ptr<const middleware::SerializationSubscriptionRegex>>
         regex_subscriptions_;
+    // last_value_cache: newest publication received for each subscribed identifier, given to
+    // subscriptions made after the first one (which gobyd's copy is requested for)
+    std::unordered_map<std::string, std::string> last_values_;
+    // portal subscriptions waiting for their copy from last_values_ on the next _poll()
+    std::vector<
+        std::pair<std::string, std::weak_ptr<const middleware::SerializationHandlerBase<>>>>
+        pending_last_values_;
+    // queue policy (max_depth, drop_newest, priority) last given to the read thread for each
+    // identifier, if any (absent is unlimited, normal priority)
+    std::unordered_map<std::string, std::tuple<std::size_t, bool, int>>
+        read_thread_queue_policies_;
+
     std::string process_{std::to_string(getpid())};
     std::unordered_map<int, std::string> schemes_;
     std::unordered_map<std::thread::id, std::string> threads_;
@@ -558,6 +936,11 @@ class Router
     void run();
     unsigned last_port(zmq::socket_t& socket);
 
+    /// \brief Most recent publication (identifier and data) for the given "/group/scheme/type/" identifier, if cfg.last_value_cache() is true (may be called from any thread)
+    ///
+    /// \return true if a publication was found and copied to \c value
+    bool last_value(const std::string& identifier, std::string* value) const;
+
     Router(Router&) = delete;
     Router& operator=(Router&) = delete;
 
@@ -565,9 +948,27 @@ class Router
     std::atomic<unsigned> pub_port{0};
     std::atomic<unsigned> sub_port{0};
 
+    /// \brief Number of local publications queued for the federation peers (cfg.federation())
+    std::atomic<std::uint64_t> federated_publications_sent{0};
+    /// \brief Number of publications received from the federation peers
+    std::atomic<std::uint64_t> federated_publications_received{0};
+
+  private:
+    // replaces zmq::proxy when the last-value cache or federation is enabled
+    void proxy(zmq::socket_t& frontend, zmq::socket_t& backend);
+    // forwards a message, handing single part messages to handle (bool(const zmq::message_t&)),
+    // which returns false to drop them
+    template <typename Handler>
+    void forward(zmq::socket_t& from, zmq::socket_t& to, Handler handle);
+    void cache(const zmq::message_t& msg);
+
   private:
     zmq::context_t& context_;
     const protobuf::InterProcessPortalConfig& cfg_;
+
+    mutable std::mutex last_value_mutex_;
+    // "/group/scheme/type/" -> identifier and data
+    std::unordered_map<std::string, std::string> last_values_;
 };
 
 class Manager